@@ -0,0 +1,164 @@
+/* Benchmark the line scanners of the libcpp lexer.
+   Copyright (C) 2014 Free Software Foundation, Inc.
+
+   This file is part of GCC.
+
+   GCC is free software; you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 3, or (at your option) any later
+   version.
+
+   GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+   for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING3.  If not see
+   <http://www.gnu.org/licenses/>.  */
+
+/* _cpp_clean_line looks for the next \n, \r, \\ or ? with one of
+   several scanners, chosen by the host CPU at startup.  This program
+   runs each scanner the host supports over the files named on the
+   command line, the way _cpp_clean_line does, and prints the
+   throughput of each.  Real headers make the best input, e.g.
+
+     bench-search-line $(find /usr/include -name "*.h")
+
+   Build it in the libcpp build directory, with the compiler libcpp
+   was built with:
+
+     g++ -O2 -I. -I$srcdir/libcpp -I$srcdir/libcpp/include \
+       -I$srcdir/include $srcdir/contrib/bench-search-line.c \
+       libcpp.a ../libiberty/libiberty.a -o bench-search-line
+
+   The -r option sets how many times each scanner reads the input;
+   by default that adds up to about 1 GB.  */
+
+#include "config.h"
+#include "system.h"
+#include "cpplib.h"
+#include "internal.h"
+
+struct input
+{
+  uchar *buf;
+  size_t len;
+};
+
+/* Read FILENAME into memory the way read_file_guts does: terminated
+   by a newline, with some slack after it.  Return false if it
+   can't be read.  */
+
+static bool
+read_input (const char *filename, struct input *in)
+{
+  FILE *f = fopen (filename, "rb");
+  size_t size = 0, alloc = 8192, n;
+
+  if (!f)
+    {
+      perror (filename);
+      return false;
+    }
+
+  in->buf = XNEWVEC (uchar, alloc + 32);
+  while ((n = fread (in->buf + size, 1, alloc - size, f)) > 0)
+    {
+      size += n;
+      if (size == alloc)
+	{
+	  alloc *= 2;
+	  in->buf = XRESIZEVEC (uchar, in->buf, alloc + 32);
+	}
+    }
+  fclose (f);
+
+  in->buf[size] = '\n';
+  memset (in->buf + size + 1, 0, 31);
+  in->len = size;
+  return true;
+}
+
+/* Find every special character in IN with SEARCH; return how many
+   there are.  */
+
+static unsigned long
+scan (const unsigned char *(*search) (const unsigned char *,
+				      const unsigned char *),
+      const struct input *in)
+{
+  const uchar *s = in->buf, *end = in->buf + in->len;
+  unsigned long found = 0;
+
+  for (; s <= end; s++)
+    {
+      s = search (s, end);
+      found++;
+    }
+  return found;
+}
+
+int
+main (int argc, char **argv)
+{
+  const struct search_line_kernel *k;
+  struct input *inputs;
+  size_t total = 0;
+  unsigned long expected = 0;
+  int i, n = 0, rounds = 0, status = 0;
+
+  if (argc > 2 && !strcmp (argv[1], "-r"))
+    {
+      rounds = atoi (argv[2]);
+      argc -= 2;
+      argv += 2;
+    }
+  if (argc < 2)
+    {
+      fprintf (stderr, "usage: bench-search-line [-r rounds] file...\n");
+      return 2;
+    }
+
+  inputs = XNEWVEC (struct input, argc - 1);
+  for (i = 1; i < argc; i++)
+    if (read_input (argv[i], &inputs[n]))
+      total += inputs[n++].len;
+  if (total == 0)
+    return 1;
+
+  if (rounds <= 0)
+    rounds = (1 << 30) / total + 1;
+  printf ("%d files, %lu bytes, %d rounds\n", n, (unsigned long) total,
+	  rounds);
+
+  _cpp_init_lexer ();
+  for (k = _cpp_search_line_kernels (); k->name; k++)
+    {
+      unsigned long found = 0;
+      clock_t start = clock ();
+      double seconds;
+      int r;
+
+      for (r = 0; r < rounds; r++)
+	for (i = 0; i < n; i++)
+	  found += scan (k->search, &inputs[i]);
+
+      seconds = (double) (clock () - start) / CLOCKS_PER_SEC;
+      if (seconds <= 0)
+	seconds = 1e-6;
+      printf ("%-10s %10.1f MB/s\n", k->name,
+	      (double) total * rounds / seconds / (1024 * 1024));
+
+      if (k == _cpp_search_line_kernels ())
+	expected = found;
+      else if (found != expected)
+	{
+	  printf ("%s found %lu special characters instead of %lu\n",
+		  k->name, found, expected);
+	  status = 1;
+	}
+    }
+
+  return status;
+}
@@ -346,8 +346,13 @@ struct c_common_resword
 /* A token type for pre-parsed C++0x decltype.  */
 #define CPP_DECLTYPE ((enum cpp_ttype) (CPP_NESTED_NAME_SPECIFIER + 1))
 
+/* Token types marking the beginning and the end of a chunk of the C++
+   lexer's token buffer.  The parser never sees them.  */
+#define CPP_CHUNK_BEGIN ((enum cpp_ttype) (CPP_DECLTYPE + 1))
+#define CPP_CHUNK_END ((enum cpp_ttype) (CPP_CHUNK_BEGIN + 1))
+
 /* The number of token types, including C++-specific ones.  */
-#define N_CP_TTYPES ((int) (CPP_DECLTYPE + 1))
+#define N_CP_TTYPES ((int) (CPP_CHUNK_END + 1))
 
 /* Disable mask.  Keywords are disabled if (reswords[i].disable &
    mask) is _true_.  Thus for keywords which are present in all
@@ -35,6 +35,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "opts.h"
 #include "options.h"
 #include "mkdeps.h"
+#include "timevar.h"
 #include "c-target.h"
 #include "tm.h"			/* For BYTES_BIG_ENDIAN,
 				   DOLLARS_IN_IDENTIFIERS,
@@ -560,6 +561,10 @@ c_common_handle_option (size_t scode, const char *arg, int value,
       cpp_opts->input_charset = arg;
       break;
 
+    case OPT_fheader_cache_:
+      cpp_opts->header_cache = arg;
+      break;
+
     case OPT_ftemplate_depth_:
       max_tinst_depth = value;
       break;
@@ -1092,6 +1097,19 @@ c_common_finish (void)
      with cpp_destroy ().  */
   cpp_finish (parse_in, deps_stream);
 
+  if (time_report && !timevar_json && cpp_opts->header_cache)
+    {
+      struct cpp_header_cache_stats stats;
+
+      cpp_get_header_cache_stats (parse_in, &stats);
+      fprintf (stderr, "\nHeader cache %s: %u lookups, %u hits, "
+	       "%u known missing, %u misses, %u stale, %u listings, "
+	       "%u guards; %u added, %u written\n",
+	       cpp_opts->header_cache, stats.probes, stats.hits,
+	       stats.absent_hits, stats.misses, stats.stale,
+	       stats.listings, stats.guards, stats.added, stats.written);
+    }
+
   if (deps_stream && deps_stream != out_stream
       && (ferror (deps_stream) || fclose (deps_stream)))
     fatal_error ("closing dependency file %s: %m", deps_file);
@@ -136,7 +136,9 @@ along with GCC; see the file COPYING3.  If not see
 	    (expand_all_functions)
 
 	    At this stage functions that needs to be output into
-	    assembler are identified and compiled in topological order
+	    assembler are identified and compiled in topological order.
+	    With --param expand-jobs, contiguous runs of that order are
+	    compiled by worker processes in parallel.
 	 6) Output of variables and aliases
 	    Now it is known what variable references was not optimized
 	    out and thus all variables are output to the file.
@@ -192,6 +194,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "ipa-utils.h"
 #include "lto-streamer.h"
 #include "except.h"
+#include "dwarf2asm.h"
 #include "regset.h"     /* FIXME: For reg_obstack.  */
 
 /* Queue of cgraph nodes scheduled to be added into cgraph.  This is a
@@ -1708,6 +1711,436 @@ expand_function (struct cgraph_node *node)
 }
 
 
+#ifdef HAVE_WORKING_FORK
+
+/* Each worker process of expand_functions_in_parallel numbers its labels
+   from a range of this size above the numbers of the previous one.  */
+#define EXPAND_JOB_LABEL_RANGE (1 << 24)
+
+/* The fewest functions worth starting a worker process for.  */
+#define MIN_FUNCTIONS_PER_EXPAND_JOB 4
+
+/* A worker process of expand_functions_in_parallel.  */
+
+struct expand_job
+{
+  /* The process.  */
+  pid_t pid;
+
+  /* The run of functions it compiles, as indices into the expansion
+     order.  */
+  int first, last;
+
+  /* The temporary file it writes the assembly of the functions into.  */
+  char *asm_name;
+
+  /* The temporary file it writes the records of expand_job_write_log
+     into.  */
+  char *log_name;
+};
+
+/* Return an estimate of the time it takes to compile NODE: the number
+   of statements in its body and in the bodies inlined into it.  */
+
+static int
+expansion_weight (struct cgraph_node *node)
+{
+  struct function *fn = DECL_STRUCT_FUNCTION (node->symbol.decl);
+  struct cgraph_edge *e;
+  gimple_stmt_iterator gsi;
+  basic_block bb;
+  int weight = 1;
+
+  if (fn && fn->cfg)
+    FOR_EACH_BB_FN (bb, fn)
+      for (gsi = gsi_start_bb (bb); !gsi_end_p (gsi); gsi_next (&gsi))
+	weight++;
+  for (e = node->callees; e; e = e->next_callee)
+    if (!e->inline_failed)
+      weight += expansion_weight (e->callee);
+  return weight;
+}
+
+/* Write a record of KIND with TEXT to the log of a worker process.  */
+
+static void
+expand_job_write_record (FILE *log, int kind, const char *text)
+{
+  fputc (kind, log);
+  fputs (text, log);
+  fputc ('\0', log);
+}
+
+/* Called via ht_forall.  Record the identifier NODE in the log LOG if it
+   is referenced.  */
+
+static int
+expand_job_write_referenced (struct cpp_reader *pfile ATTRIBUTE_UNUSED,
+			     hashnode node, const void *log)
+{
+  tree id = HT_IDENT_TO_GCC_IDENT (node);
+
+  if (TREE_SYMBOL_REFERENCED (id))
+    expand_job_write_record ((FILE *) CONST_CAST (void *, log), 'R',
+			     IDENTIFIER_POINTER (id));
+  return 1;
+}
+
+/* Write to the log of JOB what the compiler must know about the functions
+   FUNCS the worker process compiled:
+     'D' the symbol of a constant shared across the application, for
+	 dw2_force_const_mem to emit once;
+     'R' the name of a referenced symbol, for weak_finish,
+	 assemble_external and the PIC thunks of the target;
+     'S' the index of a function and its preferred incoming stack
+	 boundary;
+     'V' the order of a variable the functions refer to, for
+	 varpool_remove_unreferenced_decls;
+     'E' the number of errors the worker reported.
+   Each record is its kind followed by a nul-terminated string.  The 'D'
+   records come first, since dw2_force_const_mem wants to create the
+   names of those constants itself.  */
+
+static void
+expand_job_write_log (struct expand_job *job, struct cgraph_node **funcs)
+{
+  struct varpool_node *vnode;
+  vec<const char *> syms;
+  const char *sym;
+  char buf[32];
+  FILE *log;
+  int i;
+
+  log = fopen (job->log_name, "wb");
+  if (!log)
+    fatal_error ("can%'t open %s for writing: %m", job->log_name);
+
+  syms = dw2_remove_public_constants ();
+  FOR_EACH_VEC_ELT (syms, i, sym)
+    expand_job_write_record (log, 'D', sym);
+  syms.release ();
+
+  ht_forall (ident_hash, expand_job_write_referenced, log);
+
+  for (i = job->first; i < job->last; i++)
+    {
+      sprintf (buf, "%d %u", i,
+	       funcs[i]->rtl.preferred_incoming_stack_boundary);
+      expand_job_write_record (log, 'S', buf);
+    }
+
+  FOR_EACH_DEFINED_VARIABLE (vnode)
+    if (DECL_RTL_SET_P (vnode->symbol.decl))
+      {
+	sprintf (buf, "%d", vnode->symbol.order);
+	expand_job_write_record (log, 'V', buf);
+      }
+
+  if (seen_error ())
+    {
+      sprintf (buf, "%d", errorcount + sorrycount);
+      expand_job_write_record (log, 'E', buf);
+    }
+
+  if (fclose (log) != 0)
+    fatal_error ("can%'t write %s: %m", job->log_name);
+}
+
+/* Compile the functions of JOB, the INDEXth one, in its worker process
+   and exit.  */
+
+static void ATTRIBUTE_NORETURN
+expand_job_run (struct expand_job *job, int index, struct cgraph_node **funcs)
+{
+  int skip = (index + 1) * EXPAND_JOB_LABEL_RANGE;
+  int i;
+
+  asm_out_file = fopen (job->asm_name, "w");
+  if (!asm_out_file)
+    fatal_error ("can%'t open %s for writing: %m", job->asm_name);
+  in_section = NULL;
+
+  /* All workers write into the same assembly file in the end.  */
+  skip_label_numbers (skip);
+  skip_const_label_numbers (skip);
+  skip_call_site_numbers (skip);
+  skip_dw2_const_label_numbers (skip);
+  skip_insn_numbers (skip);
+
+  for (i = job->first; i < job->last; i++)
+    if (funcs[i]->process)
+      {
+	funcs[i]->process = 0;
+	expand_function (funcs[i]);
+      }
+
+  /* The constants only these functions refer to are emitted here, the
+     ones shared across the application by the parent.  */
+  expand_job_write_log (job, funcs);
+  output_shared_constant_pool ();
+  dw2_output_indirect_constants ();
+  app_disable ();
+
+  if (fclose (asm_out_file) != 0)
+    fatal_error ("can%'t write %s: %m", job->asm_name);
+  fflush (NULL);
+  _exit (SUCCESS_EXIT_CODE);
+}
+
+/* Read a record from the log LOG of a worker process into *BUF, of
+   *SIZE bytes, and return its kind, or EOF at the end of the log.  */
+
+static int
+expand_job_read_record (FILE *log, char **buf, size_t *size)
+{
+  int kind, c;
+  size_t len = 0;
+
+  kind = getc (log);
+  if (kind == EOF)
+    return EOF;
+  if (!*buf)
+    *buf = XNEWVEC (char, *size = 64);
+  while ((c = getc (log)) != EOF && c != '\0')
+    {
+      if (len + 1 == *size)
+	*buf = XRESIZEVEC (char, *buf, *size *= 2);
+      (*buf)[len++] = c;
+    }
+  if (c == EOF)
+    fatal_error ("truncated worker process log");
+  (*buf)[len] = '\0';
+  return kind;
+}
+
+/* Wait for the worker process of JOB, append the assembly it wrote to
+   asm_out_file and replay its log.  Add the orders of the variables the
+   worker referred to to USED_VARS.  */
+
+static void
+expand_job_finish (struct expand_job *job, struct cgraph_node **funcs,
+		   bitmap used_vars)
+{
+  char *buf = NULL, copy[8192];
+  size_t size = 0, n;
+  unsigned boundary;
+  int status, kind, i;
+  FILE *f;
+  pid_t pid;
+
+  do
+    pid = waitpid (job->pid, &status, 0);
+  while (pid < 0 && errno == EINTR);
+  if (pid < 0)
+    fatal_error ("waiting for a worker process: %m");
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != SUCCESS_EXIT_CODE)
+    fatal_error ("worker process compiling functions failed");
+
+  f = fopen (job->asm_name, "r");
+  if (!f)
+    fatal_error ("can%'t open %s for reading: %m", job->asm_name);
+  while ((n = fread (copy, 1, sizeof (copy), f)) > 0)
+    fwrite (copy, 1, n, asm_out_file);
+  fclose (f);
+
+  f = fopen (job->log_name, "rb");
+  if (!f)
+    fatal_error ("can%'t open %s for reading: %m", job->log_name);
+  while ((kind = expand_job_read_record (f, &buf, &size)) != EOF)
+    switch (kind)
+      {
+      case 'D':
+	dw2_force_const_mem (gen_rtx_SYMBOL_REF (Pmode, ggc_strdup (buf)),
+			     true);
+	break;
+
+      case 'R':
+	mark_referenced (get_identifier (buf));
+	break;
+
+      case 'S':
+	if (sscanf (buf, "%d %u", &i, &boundary) == 2
+	    && i >= job->first && i < job->last)
+	  funcs[i]->rtl.preferred_incoming_stack_boundary = boundary;
+	break;
+
+      case 'V':
+	bitmap_set_bit (used_vars, atoi (buf));
+	break;
+
+      case 'E':
+	errorcount += atoi (buf);
+	break;
+
+      default:
+	fatal_error ("corrupt worker process log %s", job->log_name);
+      }
+  fclose (f);
+  free (buf);
+
+  unlink_if_ordinary (job->asm_name);
+  unlink_if_ordinary (job->log_name);
+  free (job->asm_name);
+  free (job->log_name);
+}
+
+/* Do what assemble_thunks_and_aliases did for NODE in a worker process to
+   the thunks and aliases here.  */
+
+static void
+mark_thunks_and_aliases_written (struct cgraph_node *node)
+{
+  struct cgraph_edge *e;
+  int i;
+  struct ipa_ref *ref;
+
+  for (e = node->callers; e;)
+    if (e->caller->thunk.thunk_p)
+      {
+	struct cgraph_node *thunk = e->caller;
+
+	e = e->next_caller;
+	mark_thunks_and_aliases_written (thunk);
+	TREE_ASM_WRITTEN (thunk->symbol.decl) = 1;
+	thunk->thunk.thunk_p = false;
+	thunk->analyzed = false;
+	cgraph_node_remove_callees (thunk);
+      }
+    else
+      e = e->next_caller;
+  for (i = 0; ipa_ref_list_referring_iterate (&node->symbol.ref_list,
+					     i, ref); i++)
+    if (ref->use == IPA_REF_ALIAS)
+      {
+	struct cgraph_node *alias = ipa_ref_referring_node (ref);
+
+	TREE_ASM_WRITTEN (alias->symbol.decl) = 1;
+	TREE_ASM_WRITTEN (DECL_ASSEMBLER_NAME (alias->symbol.decl)) = 1;
+	mark_thunks_and_aliases_written (alias);
+      }
+}
+
+/* Compile the NFUNCS functions FUNCS, in this order, in NJOBS worker
+   processes running in parallel.  Each worker compiles a contiguous run
+   of the functions, of about the same weight, on a copy of the state of
+   the compiler and writes their assembly into a file of its own.  The
+   files are appended to asm_out_file in order, so the output is the same
+   as if the functions had been compiled here, except for the numbers of
+   the local labels.  */
+
+static void
+expand_functions_in_parallel (struct cgraph_node **funcs, int nfuncs,
+			      int njobs)
+{
+  struct expand_job *jobs = XCNEWVEC (struct expand_job, njobs);
+  int *weights = XNEWVEC (int, nfuncs);
+  HOST_WIDE_INT total = 0, sum = 0;
+  struct varpool_node *vnode;
+  symtab_node snode;
+  bitmap used_vars;
+  int i, j;
+
+  for (i = 0; i < nfuncs; i++)
+    total += weights[i] = expansion_weight (funcs[i]);
+
+  /* Cut the functions into runs of about TOTAL / NJOBS, leaving at least
+     one function for each of the remaining jobs.  */
+  for (i = 0, j = 0; j < njobs; j++)
+    {
+      jobs[j].first = i;
+      do
+	sum += weights[i++];
+      while (i < nfuncs - (njobs - j - 1)
+	     && sum + weights[i] / 2 <= total * (j + 1) / njobs);
+      if (j == njobs - 1)
+	i = nfuncs;
+      jobs[j].last = i;
+    }
+  free (weights);
+
+  /* The constants that have a label already might be referred to by
+     functions in several workers.  */
+  output_pending_constants ();
+
+  /* Don't let the workers repeat buffered output.  */
+  fflush (NULL);
+  for (j = 0; j < njobs; j++)
+    {
+      jobs[j].asm_name = make_temp_file (".s");
+      jobs[j].log_name = make_temp_file (NULL);
+      jobs[j].pid = fork ();
+      if (jobs[j].pid < 0)
+	fatal_error ("starting a worker process: %m");
+      if (jobs[j].pid == 0)
+	expand_job_run (&jobs[j], j, funcs);
+    }
+
+  bitmap_obstack_initialize (NULL);
+  used_vars = BITMAP_ALLOC (NULL);
+  for (j = 0; j < njobs; j++)
+    expand_job_finish (&jobs[j], funcs, used_vars);
+  free (jobs);
+
+  /* Give the variables the functions refer to their RTL, which is what
+     keeps them alive in varpool_remove_unreferenced_decls.  */
+  FOR_EACH_DEFINED_VARIABLE (vnode)
+    if (bitmap_bit_p (used_vars, vnode->symbol.order))
+      make_decl_rtl (vnode->symbol.decl);
+  BITMAP_FREE (used_vars);
+  bitmap_obstack_release (NULL);
+
+  /* Release the functions as expand_function would have.  */
+  for (i = 0; i < nfuncs; i++)
+    {
+      struct cgraph_node *node = funcs[i];
+
+      node->process = 0;
+      TREE_ASM_WRITTEN (node->symbol.decl) = 1;
+      mark_thunks_and_aliases_written (node);
+      cgraph_release_function_body (node);
+      cgraph_node_remove_callees (node);
+    }
+
+  /* Queue the .weak and visibility directives of the external symbols
+     the workers referred to.  */
+  FOR_EACH_SYMBOL (snode)
+    if (DECL_EXTERNAL (snode->symbol.decl)
+	&& DECL_ASSEMBLER_NAME_SET_P (snode->symbol.decl)
+	&& TREE_SYMBOL_REFERENCED (DECL_ASSEMBLER_NAME (snode->symbol.decl)))
+      assemble_external (snode->symbol.decl);
+
+  /* The workers left the assembly file in a section unknown here.  */
+  in_section = NULL;
+}
+
+/* Return the number of worker processes to compile the NFUNCS functions
+   to be expanded in, or one to compile them here.  The workers cannot
+   share the data structures debug information, unwind tables built by
+   the compiler, section anchors and some instrumentation collect for
+   the whole unit, nor write into the same stack usage file.  */
+
+static int
+expand_jobs_for (int nfuncs)
+{
+  int njobs = MIN (PARAM_VALUE (PARAM_EXPAND_JOBS),
+		   nfuncs / MIN_FUNCTIONS_PER_EXPAND_JOB);
+
+  if (njobs <= 1
+      || write_symbols != NO_DEBUG
+      || (dwarf2out_do_frame () && !dwarf2out_do_cfi_asm ())
+      || flag_section_anchors
+      || flag_mudflap
+      || flag_asan
+      || flag_tsan
+      || flag_stack_check
+      || flag_stack_usage
+      || flag_dump_final_insns)
+    return 1;
+  return njobs;
+}
+
+#endif /* HAVE_WORKING_FORK */
+
 /* Expand all functions that must be output.
 
    Attempt to topologically sort the nodes so function is output when
@@ -1725,6 +2158,9 @@ expand_all_functions (void)
   struct cgraph_node **order = XCNEWVEC (struct cgraph_node *, cgraph_n_nodes);
   int order_pos, new_order_pos = 0;
   int i;
+#ifdef HAVE_WORKING_FORK
+  int njobs;
+#endif
 
   order_pos = ipa_reverse_postorder (order);
   gcc_assert (order_pos == cgraph_n_nodes);
@@ -1735,6 +2171,20 @@ expand_all_functions (void)
     if (order[i]->process)
       order[new_order_pos++] = order[i];
 
+#ifdef HAVE_WORKING_FORK
+  njobs = expand_jobs_for (new_order_pos);
+  if (njobs > 1)
+    {
+      for (i = 0; i < new_order_pos / 2; i++)
+	{
+	  node = order[i];
+	  order[i] = order[new_order_pos - 1 - i];
+	  order[new_order_pos - 1 - i] = node;
+	}
+      expand_functions_in_parallel (order, new_order_pos, njobs);
+    }
+  else
+#endif
   for (i = new_order_pos - 1; i >= 0; i--)
     {
       node = order[i];
@@ -8592,12 +8592,18 @@ ix86_code_end (void)
   for (regno = AX_REG; regno <= SP_REG; regno++)
     {
       char name[32];
-      tree decl;
+      tree decl, id;
 
-      if (!(pic_labels_used & (1 << regno)))
-	continue;
+      if (TARGET_64BIT)
+	break;
 
+      /* Functions expanded in a worker process of expand_all_functions
+	 only leave the thunk's name marked as referenced.  */
       get_pc_thunk_name (name, regno);
+      id = maybe_get_identifier (name);
+      if (!(pic_labels_used & (1 << regno))
+	  && !(id && TREE_SYMBOL_REFERENCED (id)))
+	continue;
 
       decl = build_decl (BUILTINS_LOCATION, FUNCTION_DECL,
 			 get_identifier (name),
@@ -8716,6 +8722,7 @@ output_set_got (rtx dest, rtx label ATTRIBUTE_UNUSED)
       char name[32];
       get_pc_thunk_name (name, REGNO (dest));
       pic_labels_used |= 1 << REGNO (dest);
+      mark_referenced (get_identifier (name));
 
       xops[2] = gen_rtx_SYMBOL_REF (Pmode, ggc_strdup (name));
       xops[2] = gen_rtx_MEM (QImode, xops[2]);
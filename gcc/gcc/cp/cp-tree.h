@@ -5497,6 +5497,8 @@ extern void pop_tinst_level                     (void);
 extern struct tinst_level *outermost_tinst_level(void);
 extern void init_template_processing		(void);
 extern void print_template_statistics		(void);
+extern void mark_pch_specializations		(void);
+extern void print_specialization_stats		(FILE *);
 bool template_template_parameter_p		(const_tree);
 bool template_type_parameter_p                  (const_tree);
 extern bool primary_template_instantiation_p    (const_tree);
@@ -4007,6 +4007,12 @@ cp_write_global_declarations (void)
      In that case we do not want to do anything else.  */
   if (pch_file)
     {
+      /* With -fpch-instantiate-templates, instantiate the templates the
+	 header has used now, so that the instantiations are saved in the
+	 PCH instead of being redone by every unit that reads it.  */
+      if (flag_pch_instantiate_templates)
+	instantiate_pending_templates (0);
+      mark_pch_specializations ();
       c_common_write_pch ();
       dump_tu ();
       return;
@@ -4385,6 +4391,8 @@ cp_write_global_declarations (void)
       dump_tree_statistics ();
       dump_time_statistics ();
     }
+  if (time_report && !timevar_json)
+    print_specialization_stats (stderr);
   input_location = locus;
 
 #ifdef ENABLE_CHECKING
@@ -38,6 +38,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "plugin.h"
 #include "tree-pretty-print.h"
 #include "parser.h"
+#include "params.h"
 
 
 /* The lexer.  */
@@ -189,6 +190,8 @@ static int cp_lexer_saving_tokens
   (const cp_lexer *);
 static cp_token *cp_lexer_token_at
   (cp_lexer *, cp_token_position);
+static vec<cp_token, va_gc> *cp_lexer_chunk_of
+  (cp_lexer *, cp_token_position);
 static void cp_lexer_get_preprocessor_token
   (cp_lexer *, cp_token *);
 static inline cp_token *cp_lexer_peek_token
@@ -233,6 +236,7 @@ static tree cp_literal_operator_id
 
 /* Manifest constants.  */
 #define CP_LEXER_BUFFER_SIZE ((256 * 1024) / sizeof (cp_token))
+#define CP_LEXER_READ_AHEAD 256
 #define CP_SAVED_TOKEN_STACK 5
 
 /* Variables.  */
@@ -283,7 +287,9 @@ cp_lexer_dump_tokens (FILE *file, vec<cp_token, va_gc> *buffer,
       if (token == start_token)
 	do_print = true;
 
-      if (!do_print)
+      if (!do_print
+	  || token->type == CPP_CHUNK_BEGIN
+	  || token->type == CPP_CHUNK_END)
 	continue;
 
       nprinted++;
@@ -447,17 +453,21 @@ static void
 cp_debug_parser_tokens (FILE *file, cp_parser *parser, int window_size)
 {
   cp_token *next_token, *first_token, *start_token;
+  vec<cp_token, va_gc> *buffer;
 
   if (file == NULL)
     file = stderr;
 
   next_token = parser->lexer->next_token;
-  first_token = parser->lexer->buffer->address ();
-  start_token = (next_token > first_token + window_size / 2)
+  buffer = cp_lexer_chunk_of (parser->lexer, next_token);
+  if (buffer == NULL)
+    buffer = parser->lexer->buffer;
+  first_token = buffer->address ();
+  start_token = (next_token > first_token + window_size / 2
+		 && next_token < first_token + buffer->length ())
 		? next_token - window_size / 2
 		: first_token;
-  cp_lexer_dump_tokens (file, parser->lexer->buffer, start_token, window_size,
-			next_token);
+  cp_lexer_dump_tokens (file, buffer, start_token, window_size, next_token);
 }
 
 
@@ -546,6 +556,71 @@ cp_debug_parser (FILE *file, cp_parser *parser)
 }
 
 
+/* Return the number of tokens in a chunk of the main lexer's buffer,
+   including the markers at both ends.  */
+
+static unsigned
+cp_lexer_chunk_size (void)
+{
+  unsigned size = PARAM_VALUE (CXX_LEXER_CHUNK_SIZE);
+
+  if (size == 0)
+    return CP_LEXER_BUFFER_SIZE;
+  /* Leave room for at least one token between the markers.  */
+  return MAX (size, 3);
+}
+
+/* Add a new chunk to the buffer of the main LEXER, after the one
+   tokens are currently read into, and read new tokens into it.  */
+
+static void
+cp_lexer_new_chunk (cp_lexer *lexer)
+{
+  vec<cp_token, va_gc> *chunk = NULL;
+  cp_token marker;
+
+  memset (&marker, 0, sizeof (marker));
+  marker.keyword = RID_MAX;
+  marker.purged_p = true;
+
+  vec_alloc (chunk, cp_lexer_chunk_size ());
+  marker.type = CPP_CHUNK_BEGIN;
+  marker.u.chunk = lexer->chunk;
+  chunk->quick_push (marker);
+
+  if (lexer->chunk)
+    {
+      marker.type = CPP_CHUNK_END;
+      marker.u.chunk = chunk;
+      lexer->chunk->quick_push (marker);
+    }
+  else
+    lexer->buffer = chunk;
+
+  lexer->chunk = chunk;
+  lexer->last_token = chunk->address () + 1;
+}
+
+/* Append TOKEN to the buffer of the main LEXER.  The CPP_EOF token is
+   stored at LAST_TOKEN without advancing it, where a lexer created from
+   a cp_token_cache ending the file finds it.  */
+
+static void
+cp_lexer_push_token (cp_lexer *lexer, cp_token *token)
+{
+  lexer->chunk->quick_push (*token);
+  if (token->type == CPP_EOF)
+    {
+      lexer->chunk = NULL;
+      return;
+    }
+
+  lexer->last_token++;
+  /* Keep the last slot of the chunk for the CPP_CHUNK_END marker.  */
+  if (lexer->chunk->length () == cp_lexer_chunk_size () - 1)
+    cp_lexer_new_chunk (lexer);
+}
+
 /* Allocate memory for a new lexer object and return it.  */
 
 static cp_lexer *
@@ -564,7 +639,7 @@ cp_lexer_alloc (void)
   lexer->saved_tokens.create (CP_SAVED_TOKEN_STACK);
 
   /* Create the buffer.  */
-  vec_alloc (lexer->buffer, CP_LEXER_BUFFER_SIZE);
+  cp_lexer_new_chunk (lexer);
 
   return lexer;
 }
@@ -586,22 +661,10 @@ cp_lexer_new_main (void)
 
   lexer = cp_lexer_alloc ();
 
-  /* Put the first token in the buffer.  */
-  lexer->buffer->quick_push (token);
-
-  /* Get the remaining tokens from the preprocessor.  */
-  while (token.type != CPP_EOF)
-    {
-      cp_lexer_get_preprocessor_token (lexer, &token);
-      vec_safe_push (lexer->buffer, token);
-    }
-
-  lexer->last_token = lexer->buffer->address ()
-                      + lexer->buffer->length ()
-		      - 1;
-  lexer->next_token = lexer->buffer->length ()
-		      ? lexer->buffer->address ()
-		      : &eof_token;
+  /* Put the first token in the buffer.  The remaining tokens are read
+     from the preprocessor as the parser needs them.  */
+  cp_lexer_push_token (lexer, &token);
+  lexer->next_token = lexer->buffer->address () + 1;
 
   /* Subsequent preprocessor diagnostics should use compiler
      diagnostic functions to get the compiler source location.  */
@@ -640,7 +703,14 @@ cp_lexer_new_from_tokens (cp_token_cache *cache)
 static void
 cp_lexer_destroy (cp_lexer *lexer)
 {
-  vec_free (lexer->buffer);
+  while (lexer->buffer)
+    {
+      vec<cp_token, va_gc> *chunk = lexer->buffer;
+
+      lexer->buffer = (chunk->last ().type == CPP_CHUNK_END
+		       ? chunk->last ().u.chunk : NULL);
+      vec_free (chunk);
+    }
   lexer->saved_tokens.release ();
   ggc_free (lexer);
 }
@@ -654,12 +724,78 @@ cp_lexer_debugging_p (cp_lexer *lexer)
 }
 
 
+/* Read up to CP_LEXER_READ_AHEAD more tokens from the preprocessor into
+   the buffer of the main LEXER.  Return false if there are none left.  */
+
+static bool
+cp_lexer_read_tokens (cp_lexer *lexer)
+{
+  location_t saved_loc = input_location;
+  cp_token token;
+  bool read_p = false;
+  unsigned i;
+
+  if (lexer->chunk == NULL)
+    return false;
+
+  /* The preprocessor moves input_location as it goes, and its
+     diagnostics use its own locations until lexing is done.  */
+  done_lexing = false;
+  for (i = 0; i < CP_LEXER_READ_AHEAD && lexer->chunk; i++)
+    {
+      cp_lexer_get_preprocessor_token (lexer, &token);
+      cp_lexer_push_token (lexer, &token);
+      read_p |= token.type != CPP_EOF;
+    }
+  done_lexing = true;
+  input_location = saved_loc;
+
+  return read_p;
+}
+
+/* Return the position following POS in LEXER, skipping the markers
+   between chunks and reading more tokens from the preprocessor if
+   needed.  Return &eof_token if there are no more tokens.  */
+
+static inline cp_token_position
+cp_lexer_next_position (cp_lexer *lexer, cp_token_position pos)
+{
+  ++pos;
+  while (true)
+    {
+      if (pos == lexer->last_token && !cp_lexer_read_tokens (lexer))
+	return &eof_token;
+      if (pos->type != CPP_CHUNK_END)
+	return pos;
+      pos = pos->u.chunk->address () + 1;
+    }
+}
+
+/* Return the position preceding POS, skipping the markers between
+   chunks.  */
+
+static inline cp_token_position
+cp_lexer_previous_position (cp_token_position pos)
+{
+  --pos;
+  if (pos->type == CPP_CHUNK_BEGIN)
+    {
+      vec<cp_token, va_gc> *prev = pos->u.chunk;
+
+      gcc_assert (prev != NULL);
+      pos = prev->address () + prev->length () - 2;
+    }
+  return pos;
+}
+
 static inline cp_token_position
 cp_lexer_token_position (cp_lexer *lexer, bool previous_p)
 {
   gcc_assert (!previous_p || lexer->next_token != &eof_token);
 
-  return lexer->next_token - previous_p;
+  if (previous_p)
+    return cp_lexer_previous_position (lexer->next_token);
+  return lexer->next_token;
 }
 
 static inline cp_token *
@@ -678,7 +814,7 @@ static inline cp_token_position
 cp_lexer_previous_token_position (cp_lexer *lexer)
 {
   if (lexer->next_token == &eof_token)
-    return lexer->last_token - 1;
+    return cp_lexer_previous_position (lexer->last_token);
   else
     return cp_lexer_token_position (lexer, true);
 }
@@ -691,6 +827,51 @@ cp_lexer_previous_token (cp_lexer *lexer)
   return cp_lexer_token_at (lexer, tp);
 }
 
+/* Return the chunk of the buffer of the main LEXER that holds POS, or
+   NULL if POS is not in the buffer.  */
+
+static vec<cp_token, va_gc> *
+cp_lexer_chunk_of (cp_lexer *lexer, cp_token_position pos)
+{
+  vec<cp_token, va_gc> *chunk = lexer->buffer;
+
+  while (chunk)
+    {
+      if (pos >= chunk->address ()
+	  && pos < chunk->address () + chunk->length ())
+	return chunk;
+      chunk = (chunk->last ().type == CPP_CHUNK_END
+	       ? chunk->last ().u.chunk : NULL);
+    }
+  return NULL;
+}
+
+/* Release the chunks of the buffer of the main LEXER that come before
+   the chunk preceding the one holding the next token.  The caller makes
+   sure no position in them is used again: no tokens are being saved and
+   no cp_token_cache refers to them.  The chunk before the next token's
+   is kept for cp_lexer_previous_token.  */
+
+static void
+cp_lexer_release_tokens (cp_lexer *lexer)
+{
+  vec<cp_token, va_gc> *chunk, *first;
+
+  if (lexer->next_token == &eof_token)
+    return;
+
+  chunk = cp_lexer_chunk_of (lexer, lexer->next_token);
+  gcc_assert (chunk != NULL);
+  first = (*chunk)[0].u.chunk;
+  if (first == NULL || first == lexer->buffer)
+    return;
+
+  /* Unlink the older chunks; they are reclaimed by the next garbage
+     collection.  */
+  (*first)[0].u.chunk = NULL;
+  lexer->buffer = first;
+}
+
 /* nonzero if we are presently saving tokens.  */
 
 static inline int
@@ -939,12 +1120,9 @@ cp_lexer_peek_nth_token (cp_lexer* lexer, size_t n)
   gcc_assert (!n || token != &eof_token);
   while (n != 0)
     {
-      ++token;
-      if (token == lexer->last_token)
-	{
-	  token = &eof_token;
-	  break;
-	}
+      token = cp_lexer_next_position (lexer, token);
+      if (token == &eof_token)
+	break;
 
       if (!token->purged_p)
 	--n;
@@ -972,13 +1150,9 @@ cp_lexer_consume_token (cp_lexer* lexer)
 
   do
     {
-      lexer->next_token++;
-      if (lexer->next_token == lexer->last_token)
-	{
-	  lexer->next_token = &eof_token;
-	  break;
-	}
-
+      lexer->next_token = cp_lexer_next_position (lexer, lexer->next_token);
+      if (lexer->next_token == &eof_token)
+	break;
     }
   while (lexer->next_token->purged_p);
 
@@ -1012,12 +1186,9 @@ cp_lexer_purge_token (cp_lexer *lexer)
 
   do
     {
-      tok++;
-      if (tok == lexer->last_token)
-	{
-	  tok = &eof_token;
-	  break;
-	}
+      tok = cp_lexer_next_position (lexer, tok);
+      if (tok == &eof_token)
+	break;
     }
   while (tok->purged_p);
   lexer->next_token = tok;
@@ -1035,9 +1206,11 @@ cp_lexer_purge_tokens_after (cp_lexer *lexer, cp_token *tok)
   if (peek == &eof_token)
     peek = lexer->last_token;
 
-  gcc_assert (tok < peek);
+  gcc_assert (tok != peek);
 
-  for ( tok += 1; tok != peek; tok += 1)
+  for (tok = cp_lexer_next_position (lexer, tok);
+       tok != peek && tok != &eof_token;
+       tok = cp_lexer_next_position (lexer, tok))
     {
       tok->purged_p = true;
       tok->location = UNKNOWN_LOCATION;
@@ -3835,6 +4008,10 @@ cp_parser_translation_unit (cp_parser* parser)
   else
     {
       cp_parser_error (parser, "expected declaration");
+      /* Let the preprocessor see the rest of the file, as it would
+	 have if the whole file had been read up front.  */
+      while (cp_lexer_read_tokens (parser->lexer))
+	;
       success = false;
     }
 
@@ -10290,6 +10467,15 @@ cp_parser_declaration_seq_opt (cp_parser* parser)
     {
       cp_token *token;
 
+      /* Between namespace-scope declarations, the tokens consumed so far
+	 are not used again unless we are saving tokens or still parsing
+	 a class, whose member functions are parsed from cached tokens
+	 when it is complete.  */
+      if (parser->lexer->buffer
+	  && !parser->num_classes_being_defined
+	  && !cp_lexer_saving_tokens (parser->lexer))
+	cp_lexer_release_tokens (parser->lexer);
+
       token = cp_lexer_peek_token (parser->lexer);
 
       if (token->type == CPP_CLOSE_BRACE
@@ -64,9 +64,12 @@ typedef struct GTY (()) cp_token {
   union cp_token_value {
     /* Used for CPP_NESTED_NAME_SPECIFIER and CPP_TEMPLATE_ID.  */
     struct tree_check* GTY((tag ("1"))) tree_check_value;
+    /* Used for CPP_CHUNK_BEGIN and CPP_CHUNK_END: the previous and the
+       next chunk of the lexer's buffer, respectively.  */
+    vec<cp_token, va_gc> * GTY((tag ("2"))) chunk;
     /* Use for all other tokens.  */
     tree GTY((tag ("0"))) value;
-  } GTY((desc ("(%1.type == CPP_TEMPLATE_ID) || (%1.type == CPP_NESTED_NAME_SPECIFIER)"))) u;
+  } GTY((desc ("(%1.type == CPP_TEMPLATE_ID) || (%1.type == CPP_NESTED_NAME_SPECIFIER) ? 1 : (%1.type == CPP_CHUNK_BEGIN) || (%1.type == CPP_CHUNK_END) ? 2 : 0"))) u;
 } cp_token;
 
 
@@ -75,16 +78,26 @@ typedef struct cp_token *cp_token_position;
 
 /* The cp_lexer structure represents the C++ lexer.  It is responsible
    for managing the token stream from the preprocessor and supplying
-   it to the parser.  Tokens are never added to the cp_lexer after
-   it is created.  */
+   it to the parser.  The main lexer reads tokens from the preprocessor
+   as the parser asks for them, into a list of fixed-size chunks.  Each
+   chunk starts with a CPP_CHUNK_BEGIN token and, once it is full, ends
+   with a CPP_CHUNK_END token, linking it to its neighbors.  Tokens never
+   move once they are read, and the chunks consumed by the parser are
+   released between namespace-scope declarations.  */
 
 typedef struct GTY (()) cp_lexer {
-  /* The memory allocated for the buffer.  NULL if this lexer does not
-     own the token buffer.  */
+  /* The oldest chunk of the buffer still in use.  NULL if this lexer
+     does not own the token buffer.  */
   vec<cp_token, va_gc> *buffer;
 
+  /* The chunk the main lexer reads new tokens into.  NULL once the
+     CPP_EOF token has been read, and for other lexers.  */
+  vec<cp_token, va_gc> *chunk;
+
   /* A pointer just past the last available token.  The tokens
-     in this lexer are [buffer, last_token).  */
+     in this lexer are [buffer, last_token).  For the main lexer, this
+     is where the next token read from the preprocessor goes, or the
+     CPP_EOF token once it has been read.  */
   cp_token_position GTY ((skip)) last_token;
 
   /* The next available token.  If NEXT_TOKEN is &eof_token, then there are
@@ -110,10 +123,11 @@ typedef struct GTY (()) cp_lexer {
 
 
 /* cp_token_cache is a range of tokens.  There is no need to represent
-   allocate heap memory for it, since tokens are never removed from the
-   lexer's array.  There is also no need for the GC to walk through
-   a cp_token_cache, since everything in here is referenced through
-   a lexer.  */
+   allocate heap memory for it, since tokens are never moved within the
+   lexer's buffer, and the buffer is not released while a class
+   definition, and so any cache, is being parsed.  There is also no need
+   for the GC to walk through a cp_token_cache, since everything in here
+   is referenced through a lexer.  */
 
 typedef struct GTY(()) cp_token_cache {
   /* The beginning of the token range.  */
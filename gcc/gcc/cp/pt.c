@@ -85,6 +85,8 @@ typedef struct GTY(()) spec_entry
   tree tmpl;
   tree args;
   tree spec;
+  /* True if this entry is saved in a precompiled header.  */
+  bool pch_p;
 } spec_entry;
 
 static GTY ((param_is (spec_entry)))
@@ -93,6 +95,13 @@ static GTY ((param_is (spec_entry)))
 static GTY ((param_is (spec_entry)))
   htab_t type_specializations;
 
+/* The number of lookups in the tables above, the number that found a
+   specialization, and the number of those that found one saved in a
+   precompiled header, for -ftime-report.  */
+static unsigned specialization_lookups;
+static unsigned specialization_hits;
+static unsigned specialization_pch_hits;
+
 /* Contains canonical template parameter types. The vector is indexed by
    the TEMPLATE_TYPE_IDX of the template parameter. Each element is a
    TREE_LIST, whose TREE_VALUEs contain the canonical template
@@ -928,6 +937,7 @@ maybe_process_partial_specialization (tree type)
 		  slot = htab_find_slot (type_specializations, &elt, INSERT);
 		  entry = ggc_alloc_spec_entry ();
 		  *entry = elt;
+		  entry->pch_p = false;
 		  *slot = entry;
 		}
 	      else if (COMPLETE_OR_OPEN_TYPE_P (inst))
@@ -996,6 +1006,20 @@ optimize_specialization_lookup_p (tree tmpl)
 	  && !DECL_FRIEND_P (DECL_TEMPLATE_RESULT (tmpl)));
 }
 
+/* Count a lookup in the specialization tables that found FOUND.  */
+
+static inline void
+count_specialization_lookup (spec_entry *found)
+{
+  specialization_lookups++;
+  if (found)
+    {
+      specialization_hits++;
+      if (found->pch_p)
+	specialization_pch_hits++;
+    }
+}
+
 /* Retrieve the specialization (in the sense of [temp.spec] - a
    specialization is either an instantiation or an explicit
    specialization) of TMPL for the given template ARGS.  If there is
@@ -1073,6 +1097,7 @@ retrieve_specialization (tree tmpl, tree args, hashval_t hash)
       if (hash == 0)
 	hash = hash_specialization (&elt);
       found = (spec_entry *) htab_find_with_hash (specializations, &elt, hash);
+      count_specialization_lookup (found);
       if (found)
 	return found->spec;
     }
@@ -1452,6 +1477,7 @@ register_specialization (tree spec, tree tmpl, tree args, bool is_friend,
       spec_entry *entry = ggc_alloc_spec_entry ();
       gcc_assert (tmpl && args && spec);
       *entry = elt;
+      entry->pch_p = false;
       *slot = entry;
       if (TREE_CODE (spec) == FUNCTION_DECL && DECL_NAMESPACE_SCOPE_P (spec)
 	  && PRIMARY_TEMPLATE_P (tmpl)
@@ -7319,6 +7345,7 @@ lookup_template_class_1 (tree d1, tree arglist, tree in_decl, tree context,
       hash = hash_specialization (&elt);
       entry = (spec_entry *) htab_find_with_hash (type_specializations,
 						  &elt, hash);
+      count_specialization_lookup (entry);
 
       if (entry)
 	return entry->spec;
@@ -7548,6 +7575,7 @@ lookup_template_class_1 (tree d1, tree arglist, tree in_decl, tree context,
 				       &elt, hash, INSERT);
       entry = ggc_alloc_spec_entry ();
       *entry = elt;
+      entry->pch_p = false;
       *slot = entry;
 
       /* Note this use of the partial instantiation so we can check it
@@ -20982,4 +21010,38 @@ print_template_statistics (void)
 	   htab_collisions (type_specializations));
 }
 
+/* Called via htab_traverse_noresize from mark_pch_specializations.  */
+
+static int
+mark_pch_specialization (void **slot, void *data ATTRIBUTE_UNUSED)
+{
+  ((spec_entry *) *slot)->pch_p = true;
+  return 1;
+}
+
+/* Note that the specializations known so far are about to be saved in a
+   precompiled header, so that lookups finding them can be counted by
+   the units reading it.  */
+
+void
+mark_pch_specializations (void)
+{
+  htab_traverse_noresize (decl_specializations, mark_pch_specialization,
+			  NULL);
+  htab_traverse_noresize (type_specializations, mark_pch_specialization,
+			  NULL);
+}
+
+/* Print the statistics about specialization lookups to FILE.  */
+
+void
+print_specialization_stats (FILE *file)
+{
+  fprintf (file, "\nTemplate specializations: %u lookups, %u hits, "
+	   "%u hits from the PCH; %ld decls, %ld types\n",
+	   specialization_lookups, specialization_hits,
+	   specialization_pch_hits, (long) htab_elements (decl_specializations),
+	   (long) htab_elements (type_specializations));
+}
+
 #include "gt-cp-pt.h"
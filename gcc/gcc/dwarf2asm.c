@@ -42,6 +42,8 @@ dw2_assemble_integer (int size, rtx x)
 {
   const char *op = integer_asm_op (size, FALSE);
 
+  flush_data_block ();
+
   if (op)
     {
       fputs (op, asm_out_file);
@@ -97,6 +99,12 @@ dw2_asm_output_data (int size, unsigned HOST_WIDE_INT value,
   if (size * 8 < HOST_BITS_PER_WIDE_INT)
     value &= ~(~(unsigned HOST_WIDE_INT) 0 << (size * 8));
 
+  if (add_integer_to_data_block (value, size))
+    {
+      va_end (ap);
+      return;
+    }
+
   if (op)
     {
       fputs (op, asm_out_file);
@@ -129,6 +137,8 @@ dw2_asm_output_delta (int size, const char *lab1, const char *lab2,
 
   va_start (ap, comment);
 
+  flush_data_block ();
+
 #ifdef ASM_OUTPUT_DWARF_DELTA
   ASM_OUTPUT_DWARF_DELTA (asm_out_file, size, lab1, lab2);
 #else
@@ -164,6 +174,7 @@ dw2_asm_output_vms_delta (int size ATTRIBUTE_UNUSED,
      called on alpha-vms so it has to do something sane.  */
   dw2_asm_output_delta (size, lab1, lab2, comment);
 #else
+  flush_data_block ();
   ASM_OUTPUT_DWARF_VMS_DELTA (asm_out_file, size, lab1, lab2);
   if (flag_debug_asm && comment)
     {
@@ -192,6 +203,8 @@ dw2_asm_output_offset (int size, const char *label,
 
   va_start (ap, comment);
 
+  flush_data_block ();
+
 #ifdef ASM_OUTPUT_DWARF_OFFSET
   ASM_OUTPUT_DWARF_OFFSET (asm_out_file, size, label, base);
 #else
@@ -307,7 +320,9 @@ dw2_asm_output_nstring (const char *str, size_t orig_len,
   if (len == (size_t) -1)
     len = strlen (str);
 
-  if (flag_debug_asm && comment)
+  if (add_bytes_to_data_block (str, len))
+    add_bytes_to_data_block ("", 1);
+  else if (flag_debug_asm && comment)
     {
       fputs ("\t.ascii \"", asm_out_file);
       for (i = 0; i < len; i++)
@@ -580,6 +595,42 @@ dw2_asm_output_data_uleb128_raw (unsigned HOST_WIDE_INT value)
     }
 }
 
+/* Encode VALUE as a LEB128 quantity, signed if IS_SIGNED, and add it to
+   the block of bytes being collected.  Return false if no block is being
+   collected.  */
+
+static bool
+output_leb128_to_data_block (unsigned HOST_WIDE_INT value, bool is_signed)
+{
+  char buf[(HOST_BITS_PER_WIDE_INT + 6) / 7];
+  size_t len = 0;
+  int more;
+
+  do
+    {
+      int byte = (value & 0x7f);
+      if (is_signed)
+	{
+	  HOST_WIDE_INT work = (HOST_WIDE_INT) value >> 7;
+	  more = !((work == 0 && (byte & 0x40) == 0)
+		   || (work == -1 && (byte & 0x40) != 0));
+	  value = work;
+	}
+      else
+	{
+	  value >>= 7;
+	  more = value != 0;
+	}
+      if (more)
+	/* More bytes to follow.  */
+	byte |= 0x80;
+      buf[len++] = byte;
+    }
+  while (more);
+
+  return add_bytes_to_data_block (buf, len);
+}
+
 /* Output an unsigned LEB128 quantity.  */
 
 void
@@ -590,6 +641,12 @@ dw2_asm_output_data_uleb128 (unsigned HOST_WIDE_INT value,
 
   va_start (ap, comment);
 
+  if (output_leb128_to_data_block (value, false))
+    {
+      va_end (ap);
+      return;
+    }
+
 #ifdef HAVE_AS_LEB128
   fputs ("\t.uleb128 ", asm_out_file);
   fprint_whex (asm_out_file, value);
@@ -675,6 +732,12 @@ dw2_asm_output_data_sleb128 (HOST_WIDE_INT value,
 
   va_start (ap, comment);
 
+  if (output_leb128_to_data_block (value, true))
+    {
+      va_end (ap);
+      return;
+    }
+
 #ifdef HAVE_AS_LEB128
   fprintf (asm_out_file, "\t.sleb128 " HOST_WIDE_INT_PRINT_DEC, value);
 
@@ -738,6 +801,8 @@ dw2_asm_output_delta_uleb128 (const char *lab1 ATTRIBUTE_UNUSED,
 
   va_start (ap, comment);
 
+  flush_data_block ();
+
 #ifdef HAVE_AS_LEB128
   fputs ("\t.uleb128 ", asm_out_file);
   assemble_name (asm_out_file, lab1);
@@ -933,6 +998,49 @@ dw2_output_indirect_constants (void)
     splay_tree_foreach (indirect_pool, dw2_output_indirect_constant_1, NULL);
 }
 
+/* A helper function for dw2_remove_public_constants called through
+   splay_tree_foreach.  Push the symbol of a public constant onto DATA.  */
+
+static int
+dw2_add_public_constant (splay_tree_node node, void *data)
+{
+  vec<const char *> *syms = (vec<const char *> *) data;
+
+  if (TREE_PUBLIC ((tree) node->value))
+    syms->safe_push ((const char *) node->key);
+  return 0;
+}
+
+/* Remove the constants queued through dw2_force_const_mem that are
+   shared across the application from the pool and return their symbols.
+   The worker processes of expand_all_functions hand these over to their
+   parent, since the assembly file may define each of them only once.  */
+
+vec<const char *>
+dw2_remove_public_constants (void)
+{
+  vec<const char *> syms = vNULL;
+  unsigned i;
+  const char *sym;
+
+  if (indirect_pool)
+    {
+      splay_tree_foreach (indirect_pool, dw2_add_public_constant, &syms);
+      FOR_EACH_VEC_ELT (syms, i, sym)
+	splay_tree_remove (indirect_pool, (splay_tree_key) sym);
+    }
+  return syms;
+}
+
+/* Skip the next COUNT numbers for the labels of the private constants,
+   like skip_label_numbers.  */
+
+void
+skip_dw2_const_label_numbers (int count)
+{
+  dw2_const_labelno += count;
+}
+
 /* Like dw2_asm_output_addr_rtx, but encode the pointer as directed.
    If PUBLIC is set and the encoding is DW_EH_PE_indirect, the indirect
    reference is shared across the entire application (or DSO).  */
@@ -946,6 +1054,8 @@ dw2_asm_output_encoded_addr_rtx (int encoding, rtx addr, bool is_public,
 
   va_start (ap, comment);
 
+  flush_data_block ();
+
   size = size_of_encoded_value (encoding);
 
   if (encoding == DW_EH_PE_aligned)
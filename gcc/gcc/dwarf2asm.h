@@ -75,6 +75,8 @@ extern const char *eh_data_format_name (int);
 
 extern rtx dw2_force_const_mem (rtx, bool);
 extern void dw2_output_indirect_constants (void);
+extern vec<const char *> dw2_remove_public_constants (void);
+extern void skip_dw2_const_label_numbers (int);
 
 /* These are currently unused.  */
 
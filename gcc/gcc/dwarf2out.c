@@ -621,8 +621,23 @@ output_fde (dw_fde_ref fde, bool for_eh, bool second,
     else
       from = fde->dw_fde_switch_cfi_index;
 
+    begin_data_block ();
     for (i = from; i < until; i++)
-      output_cfi ((*fde->dw_fde_cfi)[i], fde, for_eh);
+      {
+	dw_cfi_ref cfi = (*fde->dw_fde_cfi)[i];
+
+	/* The assembler can only shrink a DW_CFA_advance_loc4 and its
+	   label delta if it sees the opcode as a separate byte.  */
+	if (cfi->dw_cfi_opc == DW_CFA_advance_loc4)
+	  {
+	    end_data_block ();
+	    output_cfi (cfi, fde, for_eh);
+	    begin_data_block ();
+	  }
+	else
+	  output_cfi (cfi, fde, for_eh);
+      }
+    end_data_block ();
   }
 
   /* If we are to emit a ref/link from function bodies to their frame tables,
@@ -1707,6 +1722,7 @@ output_loc_operands (dw_loc_descr_ref loc, int for_eh_or_skip)
       if (loc->dtprel)
 	{
 	  gcc_assert (targetm.asm_out.output_dwarf_dtprel);
+	  flush_data_block ();
 	  targetm.asm_out.output_dwarf_dtprel (asm_out_file, 4,
 					       val1->v.val_addr);
 	  fputc ('\n', asm_out_file);
@@ -1720,6 +1736,7 @@ output_loc_operands (dw_loc_descr_ref loc, int for_eh_or_skip)
       if (loc->dtprel)
 	{
 	  gcc_assert (targetm.asm_out.output_dwarf_dtprel);
+	  flush_data_block ();
 	  targetm.asm_out.output_dwarf_dtprel (asm_out_file, 8,
 					       val1->v.val_addr);
 	  fputc ('\n', asm_out_file);
@@ -1902,6 +1919,7 @@ output_loc_operands (dw_loc_descr_ref loc, int for_eh_or_skip)
 	{
 	  if (targetm.asm_out.output_dwarf_dtprel)
 	    {
+	      flush_data_block ();
 	      targetm.asm_out.output_dwarf_dtprel (asm_out_file,
 						   DWARF2_ADDR_SIZE,
 						   val1->v.val_addr);
@@ -8086,11 +8104,15 @@ output_abbrev_section (void)
 {
   unsigned long abbrev_id;
 
+  begin_data_block ();
+
   for (abbrev_id = 1; abbrev_id < abbrev_die_table_in_use; ++abbrev_id)
     output_die_abbrevs (abbrev_id, abbrev_die_table[abbrev_id]);
 
   /* Terminate the table.  */
   dw2_asm_output_data (1, 0, NULL);
+
+  end_data_block ();
 }
 
 /* Output a symbol we can use to refer to this DIE from another CU.  */
@@ -8105,6 +8127,8 @@ output_die_symbol (dw_die_ref die)
   if (sym == 0)
     return;
 
+  flush_data_block ();
+
   if (strncmp (sym, DIE_LABEL_PREFIX, sizeof (DIE_LABEL_PREFIX) - 1) == 0)
     /* We make these global, not weak; if the target doesn't support
        .linkonce, it doesn't support combining the sections, so debugging
@@ -8155,6 +8179,8 @@ output_loc_list (dw_loc_list_ref list_head)
 
   ASM_OUTPUT_LABEL (asm_out_file, list_head->ll_symbol);
 
+  begin_data_block ();
+
   /* Walk the location list, and output each range + expression.  */
   for (curr = list_head; curr != NULL; curr = curr->dw_loc_next)
     {
@@ -8223,6 +8249,8 @@ output_loc_list (dw_loc_list_ref list_head)
                            "Location list terminator end (%s)",
                            list_head->ll_symbol);
     }
+
+  end_data_block ();
 }
 
 /* Output a range_list offset into the debug_range section.  Emit a
@@ -8630,9 +8658,12 @@ output_comp_unit (dw_die_ref die, int output_if_empty)
       info_section_emitted = true;
     }
 
-  /* Output debugging information.  */
+  /* Output debugging information.  With -fcompact-asm everything but the
+     relocated references is written as blocks of bytes.  */
+  begin_data_block ();
   output_compilation_unit_header ();
   output_die (die);
+  end_data_block ();
 
   /* Leave the marks on the main CU, so we can check them in
      output_pubnames.  */
@@ -8804,11 +8835,13 @@ output_comdat_type_unit (comdat_type_node *node)
 #endif
 
   /* Output debugging information.  */
+  begin_data_block ();
   output_compilation_unit_header ();
   output_signature (node->signature, "Type Signature");
   dw2_asm_output_data (DWARF_OFFSET_SIZE, node->type_die->die_offset,
 		       "Offset to Type DIE");
   output_die (node->root_die);
+  end_data_block ();
 
   unmark_dies (node->root_die);
 
@@ -9621,6 +9654,8 @@ output_one_line_info_table (dw_line_info_table *table)
   dw_line_info_entry *ent;
   size_t i;
 
+  begin_data_block ();
+
   FOR_EACH_VEC_SAFE_ELT (table->entries, i, ent)
     {
       switch (ent->opcode)
@@ -9719,6 +9754,8 @@ output_one_line_info_table (dw_line_info_table *table)
   dw2_asm_output_data (1, 0, "end sequence");
   dw2_asm_output_data_uleb128 (1, NULL);
   dw2_asm_output_data (1, DW_LNE_end_sequence, NULL);
+
+  end_data_block ();
 }
 
 /* Output the source line number correspondence information.  This
@@ -9747,6 +9784,7 @@ output_line_info (bool prologue_only)
   dw2_asm_output_data (2, ver, "DWARF Version");
   dw2_asm_output_delta (DWARF_OFFSET_SIZE, p2, p1, "Prolog Length");
   ASM_OUTPUT_LABEL (asm_out_file, p1);
+  begin_data_block ();
 
   /* Define the architecture-dependent minimum instruction length (in bytes).
      In this implementation of DWARF, this field is used for information
@@ -9794,6 +9832,7 @@ output_line_info (bool prologue_only)
 
   /* Write out the information about the files we use.  */
   output_file_names ();
+  end_data_block ();
   ASM_OUTPUT_LABEL (asm_out_file, p2);
   if (prologue_only)
     {
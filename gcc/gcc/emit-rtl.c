@@ -1192,6 +1192,16 @@ maybe_set_first_label_num (rtx x)
   if (CODE_LABEL_NUMBER (x) < first_label_num)
     first_label_num = CODE_LABEL_NUMBER (x);
 }
+
+/* Skip the next COUNT label numbers.  The worker processes of
+   expand_all_functions all write into the same assembly file, so each
+   of them numbers its labels from a range of its own.  */
+
+void
+skip_label_numbers (int count)
+{
+  label_num += count;
+}
 
 /* Return a value representing some low-order bits of X, where the number
    of low-order bits is given by MODE.  Note that no conversion is done
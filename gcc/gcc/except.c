@@ -2766,6 +2766,15 @@ sjlj_output_call_site_table (void)
   call_site_base += n;
 }
 
+/* Skip the next COUNT call-site numbers, which name the labels around
+   the call sites in the DWARF 2 exception tables.  */
+
+void
+skip_call_site_numbers (int count)
+{
+  call_site_base += count;
+}
+
 /* Switch to the section that should be used for exception tables.  */
 
 static void
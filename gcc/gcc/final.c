@@ -284,6 +284,14 @@ app_disable (void)
       app_on = 0;
     }
 }
+
+/* Skip the next COUNT insn numbers, which `%=' prints in asm templates.  */
+
+void
+skip_insn_numbers (int count)
+{
+  insn_counter += count;
+}
 
 /* Return the number of slots filled in the current
    delayed branch sequence (we don't count the insn needing the
@@ -139,6 +139,20 @@ enum excess_precision
   EXCESS_PRECISION_STANDARD
 };
 
+/* The output format of -ftime-report and -fmem-report.  */
+enum report_format
+{
+  REPORT_FORMAT_TEXT,
+  REPORT_FORMAT_JSON
+};
+
+/* The codecs LTO sections can be compressed with.  */
+enum lto_compression_codec
+{
+  LTO_CODEC_ZLIB,
+  LTO_CODEC_LZ4
+};
+
 /* Type of stack check.  */
 enum stack_check_type
 {
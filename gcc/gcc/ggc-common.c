@@ -27,6 +27,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "ggc.h"
 #include "ggc-internal.h"
 #include "diagnostic-core.h"
+#include "flags.h"
 #include "params.h"
 #include "hosthooks.h"
 #include "hosthooks-def.h"
@@ -49,11 +50,15 @@ static int ggc_htab_delete (void **, void *);
 static hashval_t saving_htab_hash (const void *);
 static int saving_htab_eq (const void *, const void *);
 static int call_count (void **, void *);
-static int call_alloc (void **, void *);
 static int compare_ptr_data (const void *, const void *);
 static void relocate_ptrs (void *, void *);
+static void note_reloc (struct traversal_state *, size_t);
+static void note_changed_ptrs (struct traversal_state *, const char *,
+			       size_t);
 static void write_pch_globals (const struct ggc_root_tab * const *tab,
 			       struct traversal_state *state);
+static void relocate_pch_globals (const struct ggc_root_tab * const *tab,
+				  char *old_base, size_t size, size_t delta);
 
 /* Maintain global roots that are preserved during GC.  */
 
@@ -161,6 +166,10 @@ ggc_mark_roots (void)
   if (ggc_protect_identifiers)
     ggc_mark_stringpool ();
 
+  /* This must come before the hash tables are scanned, as it may mark
+     their keys.  */
+  ggc_mark_dirty_pages ();
+
   /* Now scan all hash tables that have objects which are to be deleted if
      they are not already marked.  */
   for (ct = gt_ggc_cache_rtab; *ct; ct++)
@@ -301,6 +310,9 @@ struct ptr_data
   void *new_addr;
 };
 
+/* The entries of saving_htab in the order they were noted.  */
+static vec<struct ptr_data *> saving_order;
+
 #define POINTER_HASH(x) (hashval_t)((intptr_t)x >> 3)
 
 /* Register an object in the hash table.  */
@@ -332,6 +344,7 @@ gt_pch_note_object (void *obj, void *note_ptr_cookie,
     (*slot)->size = strlen ((const char *)obj) + 1;
   else
     (*slot)->size = ggc_get_size (obj);
+  saving_order.safe_push (*slot);
   return 1;
 }
 
@@ -376,9 +389,21 @@ struct traversal_state
   size_t count;
   struct ptr_data **ptrs;
   size_t ptrs_i;
+  /* The object being written, and where the PCH image starts.  */
+  struct ptr_data *current;
+  char *base;
+  /* One bit per pointer-sized word of the PCH image, set for the words
+     that hold a pointer into the image.  */
+  unsigned HOST_WIDE_INT *reloc_bits;
 };
 
-/* Callbacks for htab_traverse.  */
+/* The number of words of a relocation bitmap for a PCH image of
+   SIZE bytes.  */
+#define PCH_RELOC_WORDS(SIZE) \
+  (((SIZE) / sizeof (void *) + HOST_BITS_PER_WIDE_INT - 1) \
+   / HOST_BITS_PER_WIDE_INT)
+
+/* Callback for htab_traverse.  */
 
 static int
 call_count (void **slot, void *state_p)
@@ -392,18 +417,6 @@ call_count (void **slot, void *state_p)
   return 1;
 }
 
-static int
-call_alloc (void **slot, void *state_p)
-{
-  struct ptr_data *d = (struct ptr_data *)*slot;
-  struct traversal_state *state = (struct traversal_state *)state_p;
-
-  d->new_addr = ggc_pch_alloc_object (state->d, d->obj, d->size,
-				      d->note_ptr_fn == gt_pch_p_S);
-  state->ptrs[state->ptrs_i++] = d;
-  return 1;
-}
-
 /* Callback for qsort.  */
 
 static int
@@ -421,9 +434,9 @@ static void
 relocate_ptrs (void *ptr_p, void *state_p)
 {
   void **ptr = (void **)ptr_p;
-  struct traversal_state *state ATTRIBUTE_UNUSED
-    = (struct traversal_state *)state_p;
+  struct traversal_state *state = (struct traversal_state *)state_p;
   struct ptr_data *result;
+  size_t offset;
 
   if (*ptr == NULL || *ptr == (void *)1)
     return;
@@ -432,6 +445,53 @@ relocate_ptrs (void *ptr_p, void *state_p)
     htab_find_with_hash (saving_htab, *ptr, POINTER_HASH (*ptr));
   gcc_assert (result);
   *ptr = result->new_addr;
+
+  /* Some callers pass a copy of the field; see note_changed_ptrs.  */
+  offset = (char *) ptr_p - (char *) state->current->obj;
+  if (offset < state->current->size)
+    note_reloc (state, offset);
+}
+
+/* Remember that the word at OFFSET in the object being written holds a
+   pointer into the image, so that gt_pch_restore can adjust it if the
+   image has to be loaded elsewhere.  */
+
+static void
+note_reloc (struct traversal_state *state, size_t offset)
+{
+  size_t word;
+
+  offset += (char *) state->current->new_addr - state->base;
+  gcc_assert (offset % sizeof (void *) == 0);
+  word = offset / sizeof (void *);
+  state->reloc_bits[word / HOST_BITS_PER_WIDE_INT]
+    |= (unsigned HOST_WIDE_INT) 1 << (word % HOST_BITS_PER_WIDE_INT);
+}
+
+/* Note the pointers of the object being written that were relocated
+   through a copy rather than in place, e.g. the fields with a nested_ptr
+   option.  They now differ from ORIG, the object's old contents, and
+   point into the image of SIZE bytes.  */
+
+static void
+note_changed_ptrs (struct traversal_state *state, const char *orig,
+		   size_t size)
+{
+  const char *obj = (const char *) state->current->obj;
+  size_t offset;
+
+  for (offset = 0; offset + sizeof (void *) <= state->current->size;
+       offset += sizeof (void *))
+    {
+      char *ptr;
+
+      if (memcmp (obj + offset, orig + offset, sizeof (void *)) == 0)
+	continue;
+      memcpy (&ptr, obj + offset, sizeof (void *));
+      if (ptr != NULL && ptr != (char *) 1
+	  && (size_t) ptr - (size_t) state->base < size)
+	note_reloc (state, offset);
+    }
 }
 
 /* Write out, after relocation, the pointers in TAB.  */
@@ -466,6 +526,29 @@ write_pch_globals (const struct ggc_root_tab * const *tab,
 	}
 }
 
+/* Add DELTA to the pointers in TAB that point into the SIZE bytes at
+   OLD_BASE.  */
+
+static void
+relocate_pch_globals (const struct ggc_root_tab * const *tab,
+		      char *old_base, size_t size, size_t delta)
+{
+  const struct ggc_root_tab *const *rt;
+  const struct ggc_root_tab *rti;
+  size_t i;
+
+  for (rt = tab; *rt; rt++)
+    for (rti = *rt; rti->base != NULL; rti++)
+      for (i = 0; i < rti->nelt; i++)
+	{
+	  char **ptr = (char **)((char *)rti->base + rti->stride * i);
+	  if (*ptr == NULL || *ptr == (char *)1
+	      || (size_t) *ptr - (size_t) old_base >= size)
+	    continue;
+	  *ptr = (char *) ((size_t) *ptr + delta);
+	}
+}
+
 /* Hold the information we need to mmap the file back in.  */
 
 struct mmap_info
@@ -487,12 +570,20 @@ gt_pch_save (FILE *f)
   char *this_object = NULL;
   size_t this_object_size = 0;
   struct mmap_info mmi;
+  struct ptr_data *d;
   const size_t mmap_offset_alignment = host_hooks.gt_pch_alloc_granularity();
 
   gt_pch_save_stringpool ();
 
   timevar_push (TV_PCH_PTR_REALLOC);
   saving_htab = htab_create (50000, saving_htab_hash, saving_htab_eq, free);
+  saving_order.create (50000);
+
+  /* The objects are laid out in the order they are noted here, which is
+     depth first.  Start with the identifiers, so that the declarations
+     reachable from each one end up together, and a compilation that only
+     looks up a few of them only pages in those parts of the image.  */
+  gt_pch_note_stringpool ();
 
   for (rt = gt_ggc_rtab; *rt; rt++)
     for (rti = *rt; rti->base != NULL; rti++)
@@ -523,8 +614,16 @@ gt_pch_save (FILE *f)
 
   state.ptrs = XNEWVEC (struct ptr_data *, state.count);
   state.ptrs_i = 0;
+  state.base = (char *) mmi.preferred_base;
+  state.reloc_bits = XCNEWVEC (unsigned HOST_WIDE_INT,
+			       PCH_RELOC_WORDS (mmi.size));
 
-  htab_traverse (saving_htab, call_alloc, &state);
+  FOR_EACH_VEC_ELT (saving_order, i, d)
+    {
+      d->new_addr = ggc_pch_alloc_object (state.d, d->obj, d->size,
+					  d->note_ptr_fn == gt_pch_p_S);
+      state.ptrs[state.ptrs_i++] = d;
+    }
   timevar_pop (TV_PCH_PTR_REALLOC);
 
   timevar_push (TV_PCH_PTR_SORT);
@@ -618,6 +717,7 @@ gt_pch_save (FILE *f)
 	}
 #endif
       memcpy (this_object, state.ptrs[i]->obj, state.ptrs[i]->size);
+      state.current = state.ptrs[i];
       if (state.ptrs[i]->reorder_fn != NULL)
 	state.ptrs[i]->reorder_fn (state.ptrs[i]->obj,
 				   state.ptrs[i]->note_ptr_cookie,
@@ -625,6 +725,8 @@ gt_pch_save (FILE *f)
       state.ptrs[i]->note_ptr_fn (state.ptrs[i]->obj,
 				  state.ptrs[i]->note_ptr_cookie,
 				  relocate_ptrs, &state);
+      if (state.ptrs[i]->note_ptr_fn != gt_pch_p_S)
+	note_changed_ptrs (&state, this_object, mmi.size);
       ggc_pch_write_object (state.d, state.f, state.ptrs[i]->obj,
 			    state.ptrs[i]->new_addr, state.ptrs[i]->size,
 			    state.ptrs[i]->note_ptr_fn == gt_pch_p_S);
@@ -651,11 +753,91 @@ gt_pch_save (FILE *f)
   ggc_pch_finish (state.d, state.f);
   gt_pch_fixup_stringpool ();
 
+  /* Write out where the pointers in the image are.  */
+  if (fwrite (state.reloc_bits, sizeof (unsigned HOST_WIDE_INT),
+	      PCH_RELOC_WORDS (mmi.size), state.f)
+      != PCH_RELOC_WORDS (mmi.size))
+    fatal_error ("can%'t write PCH file: %m");
+
+  XDELETE (state.reloc_bits);
   XDELETE (state.ptrs);
   XDELETE (this_object);
+  saving_order.release ();
   htab_delete (saving_htab);
 }
 
+/* Allocate memory for the PCH image described by MMI somewhere other
+   than at its preferred base, which HOST_HOOKS_GT_PCH_USE_ADDRESS
+   couldn't get.  Map the image from F if possible.  Return the address,
+   and set *RESULT the way HOST_HOOKS_GT_PCH_USE_ADDRESS would.  */
+
+static char *
+pch_alloc_anywhere (FILE *f, const struct mmap_info *mmi, int *result)
+{
+  const size_t granularity = host_hooks.gt_pch_alloc_granularity ();
+  char *addr;
+
+#if HAVE_MMAP_FILE
+  addr = (char *) mmap (NULL, mmi->size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fileno (f), mmi->offset);
+  if (addr != (char *) MAP_FAILED)
+    {
+      *result = 1;
+      return addr;
+    }
+#endif
+
+  /* ggc_pch_read wants the image to start on a page boundary.  */
+  addr = XNEWVEC (char, mmi->size + granularity);
+  *result = 0;
+  return addr + (granularity - (size_t) addr % granularity) % granularity;
+}
+
+/* Read the relocation bitmap of the PCH image described by MMI from F.
+   If the image ended up at BASE rather than at its preferred base,
+   adjust the pointers in the image and in the global roots.  */
+
+static void
+relocate_pch (FILE *f, const struct mmap_info *mmi, char *base)
+{
+  char *old_base = (char *) mmi->preferred_base;
+  const size_t nwords = PCH_RELOC_WORDS (mmi->size);
+  unsigned HOST_WIDE_INT *bits;
+  size_t delta, i;
+
+  if (base == old_base)
+    {
+      if (fseek (f, nwords * sizeof (unsigned HOST_WIDE_INT), SEEK_CUR) != 0)
+	fatal_error ("can%'t read PCH file: %m");
+      return;
+    }
+
+  timevar_push (TV_PCH_RELOCATE);
+  bits = XNEWVEC (unsigned HOST_WIDE_INT, nwords);
+  if (fread (bits, sizeof (unsigned HOST_WIDE_INT), nwords, f) != nwords)
+    fatal_error ("can%'t read PCH file: %m");
+
+  /* Only the pages that hold pointers are written to; the others stay
+     shared with the file.  */
+  delta = (size_t) base - (size_t) old_base;
+  for (i = 0; i < nwords; i++)
+    {
+      unsigned HOST_WIDE_INT w = bits[i];
+      while (w)
+	{
+	  size_t word = i * HOST_BITS_PER_WIDE_INT + ctz_hwi (w);
+	  char **ptr = (char **) (base + word * sizeof (void *));
+	  *ptr = (char *) ((size_t) *ptr + delta);
+	  w &= w - 1;
+	}
+    }
+  XDELETEVEC (bits);
+
+  relocate_pch_globals (gt_ggc_rtab, old_base, mmi->size, delta);
+  relocate_pch_globals (gt_pch_cache_rtab, old_base, mmi->size, delta);
+  timevar_pop (TV_PCH_RELOCATE);
+}
+
 /* Read the state of the compiler back in from F.  */
 
 void
@@ -665,6 +847,7 @@ gt_pch_restore (FILE *f)
   const struct ggc_root_tab *rti;
   size_t i;
   struct mmap_info mmi;
+  char *base;
   int result;
 
   /* Delete any deletable objects.  This makes ggc_pch_read much
@@ -698,20 +881,29 @@ gt_pch_restore (FILE *f)
   if (fread (&mmi, sizeof (mmi), 1, f) != 1)
     fatal_error ("can%'t read PCH file: %m");
 
-  result = host_hooks.gt_pch_use_address (mmi.preferred_base, mmi.size,
-					  fileno (f), mmi.offset);
+  /* If the preferred base is taken, e.g. because of address space
+     randomization, load the image elsewhere and relocate it.  With
+     --param pch-relocate=1 that is always done, for testing.  */
+  base = (char *) mmi.preferred_base;
+  if (PARAM_VALUE (PCH_RELOCATE))
+    result = -1;
+  else
+    result = host_hooks.gt_pch_use_address (mmi.preferred_base, mmi.size,
+					    fileno (f), mmi.offset);
   if (result < 0)
-    fatal_error ("had to relocate PCH");
+    base = pch_alloc_anywhere (f, &mmi, &result);
   if (result == 0)
     {
       if (fseek (f, mmi.offset, SEEK_SET) != 0
-	  || fread (mmi.preferred_base, mmi.size, 1, f) != 1)
+	  || fread (base, mmi.size, 1, f) != 1)
 	fatal_error ("can%'t read PCH file: %m");
     }
   else if (fseek (f, mmi.offset + mmi.size, SEEK_SET) != 0)
     fatal_error ("can%'t read PCH file: %m");
 
-  ggc_pch_read (f, mmi.preferred_base);
+  ggc_pch_read (f, base);
+
+  relocate_pch (f, &mmi, base);
 
   gt_pch_restore_stringpool ();
 }
@@ -730,7 +922,7 @@ default_gt_pch_get_address (size_t size ATTRIBUTE_UNUSED,
 /* Default version of HOST_HOOKS_GT_PCH_USE_ADDRESS when mmap is not present.
    Allocate SIZE bytes with malloc.  Return 0 if the address we got is the
    same as base, indicating that the memory has been allocated but needs to
-   be read in from the file.  Return -1 if the address differs, to relocation
+   be read in from the file.  Return -1 if the address differs, so relocation
    of the PCH file would be required.  */
 
 int
@@ -738,7 +930,12 @@ default_gt_pch_use_address (void *base, size_t size, int fd ATTRIBUTE_UNUSED,
 			    size_t offset ATTRIBUTE_UNUSED)
 {
   void *addr = xmalloc (size);
-  return (addr == base) - 1;
+  if (addr != base)
+    {
+      free (addr);
+      return -1;
+    }
+  return 0;
 }
 
 /* Default version of HOST_HOOKS_GT_PCH_GET_ADDRESS.   Return the
@@ -793,7 +990,11 @@ mmap_gt_pch_use_address (void *base, size_t size, int fd, size_t offset)
   addr = mmap ((caddr_t) base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
 	       fd, offset);
 
-  return addr == base ? 1 : -1;
+  if (addr == base)
+    return 1;
+  if (addr != (void *) MAP_FAILED)
+    munmap ((caddr_t) addr, size);
+  return -1;
 }
 #endif /* HAVE_MMAP_FILE */
 
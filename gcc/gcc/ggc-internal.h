@@ -27,6 +27,10 @@ along with GCC; see the file COPYING3.  If not see
 /* Call ggc_set_mark on all the roots.  */
 extern void ggc_mark_roots (void);
 
+/* In a minor collection, mark the young objects referenced from old
+   objects that have been written to since the last collection.  */
+extern void ggc_mark_dirty_pages (void);
+
 /* Stringpool.  */
 
 /* Mark the entries in the string pool.  */
@@ -38,6 +42,7 @@ extern void ggc_purge_stringpool (void);
 /* Save and restore the string pool entries for PCH.  */
 
 extern void gt_pch_save_stringpool (void);
+extern void gt_pch_note_stringpool (void);
 extern void gt_pch_fixup_stringpool (void);
 extern void gt_pch_restore_stringpool (void);
 
@@ -54,6 +54,12 @@ along with GCC; see the file COPYING3.  If not see
 # define USING_MADVISE
 #endif
 
+/* Generational collection needs to write-protect pages and catch the
+   faults.  */
+#if defined(USING_MMAP) && defined(PROT_READ) && defined(SA_SIGINFO)
+# define USING_WRITE_BARRIER
+#endif
+
 /* Strategy:
 
    This garbage-collecting allocator allocates objects on one of a set
@@ -81,7 +87,13 @@ along with GCC; see the file COPYING3.  If not see
    Empty pages (of all orders) are kept on a single page cache list,
    and are considered first when new pages are required; they are
    deallocated at the start of the next collection if they haven't
-   been recycled by then.  */
+   been recycled by then.
+
+   With --param ggc-generational=1, the pages holding the objects that
+   survived the last collection are write-protected, and objects
+   allocated since are recorded as young.  Most collections are then
+   minor ones, which free only young objects; see ggc_collect_minor
+   for the details.  */
 
 /* Define GGC_DEBUG_LEVEL to print debugging information.
      0: No debugging output.
@@ -288,6 +300,20 @@ typedef struct page_entry
   /* Discarded page? */
   bool discarded;
 
+#ifdef USING_WRITE_BARRIER
+  /* True if the page was write-protected at the end of the last
+     collection.  Writes since may have made parts of it writable.  */
+  bool write_protected;
+
+  /* A bit vector indicating which objects have been allocated since
+     the last collection, in generational mode, or NULL if there are
+     none.  */
+  unsigned long *young_p;
+
+  /* The next page-entry with young objects.  */
+  struct page_entry *next_young;
+#endif
+
   /* A bit vector indicating whether or not objects are in use.  The
      Nth bit is one if the Nth object on this page is allocated.  This
      array is dynamically sized.  */
@@ -342,6 +368,25 @@ struct free_object
 };
 #endif
 
+#ifdef USING_WRITE_BARRIER
+/* A range of write-protected memory.  */
+struct protected_range
+{
+  char *start;
+  size_t size;
+};
+
+/* The number of bits in G.young_filter.  */
+#define YOUNG_FILTER_BITS 65536
+
+/* A slot of G.young_table.  */
+struct young_slot
+{
+  uintptr_t key;
+  struct page_entry *entry;
+};
+#endif
+
 /* The rest of the global variables.  */
 static struct globals
 {
@@ -431,6 +476,75 @@ static struct globals
   struct free_object *free_object_list;
 #endif
 
+#ifdef USING_WRITE_BARRIER
+  /* True if the pages of the old generation are write-protected, so
+     that the next collection may be a minor one.  */
+  bool barrier_armed;
+
+  /* Set by the fault handler if too many old pages were written to
+     and the barrier had to be dropped.  The next collection must be a
+     major one.  */
+  volatile bool barrier_overflowed;
+
+  /* True while marking for a minor collection.  */
+  bool minor_collection_p;
+
+  /* True once ggc_write_fault is the SIGSEGV handler.  */
+  bool fault_handler_installed;
+
+  /* The SIGSEGV handler ggc_write_fault replaced.  */
+  struct sigaction old_segv_action;
+
+  /* The page-entries of the old generation, sorted by address.  The
+     page table only knows the first page of page-entries spanning
+     several pages.  */
+  page_entry **old_pages;
+  size_t n_old_pages;
+
+  /* The write-protected address ranges, sorted by address.  */
+  struct protected_range *protected_ranges;
+  size_t n_protected_ranges;
+
+  /* The system pages of the old generation written to since the last
+     collection.  The fault handler can't allocate memory, so this
+     array has a fixed size.  */
+  char **dirty_pages;
+  volatile size_t n_dirty_pages;
+  size_t max_dirty_pages;
+
+  /* The page-entries with young objects, chained by NEXT_YOUNG.  */
+  page_entry *young_pages;
+
+  /* Bytes allocated since the last collection.  */
+  size_t young_allocated;
+
+  /* During a minor collection, an open-addressed hash table of the
+     collectable page-entries with young objects, keyed by the number
+     of their first page.  Most words scanned conservatively point to
+     old objects or nowhere, and this rejects them quickly.  */
+  struct young_slot *young_table;
+  size_t young_table_size;
+  unsigned int young_table_shift;
+
+  /* A bitmap small enough to stay in the cache, with the bit for the
+     low bits of the number of each page in G.young_table set.  */
+  unsigned long young_filter[YOUNG_FILTER_BITS / HOST_BITS_PER_LONG];
+
+  /* Young objects found by the conservative scan whose contents
+     remain to be scanned.  */
+  vec<char *> scan_stack;
+#endif
+
+  /* The number of major and minor collections so far, and the time
+     spent in them in microseconds.  */
+  unsigned long major_collections;
+  unsigned long minor_collections;
+  long major_collection_time;
+  long minor_collection_time;
+
+  /* The number of write faults on the old generation.  */
+  unsigned long write_faults;
+
   struct
   {
     /* Total GC-allocated memory.  */
@@ -479,6 +593,12 @@ static struct globals
 
 /* Initial guess as to how many page table entries we might need.  */
 #define INITIAL_PTE_COUNT 128
+
+/* The maximum number of old system pages that may be written to
+   between two collections before the write barrier is dropped.  Each
+   of them can split a mapping in three, and the kernel limits the
+   number of mappings of a process.  */
+#define GGC_MAX_DIRTY_PAGES 16384
 
 static int ggc_allocated_p (const void *);
 static page_entry *lookup_page_table_entry (const void *);
@@ -495,7 +615,7 @@ static struct page_entry * alloc_page (unsigned);
 static void free_page (struct page_entry *);
 static void release_pages (void);
 static void clear_marks (void);
-static void sweep_pages (void);
+static void sweep_pages (bool);
 static void ggc_recalculate_in_use_p (page_entry *);
 static void compute_inverse (unsigned);
 static inline void adjust_depth (void);
@@ -504,6 +624,10 @@ static void move_ptes_to_front (int, int);
 void debug_print_page_list (int);
 static void push_depth (unsigned int);
 static void push_by_depth (page_entry *, unsigned long *);
+#ifdef USING_WRITE_BARRIER
+static inline void note_young_object (page_entry *, size_t, size_t, size_t);
+static void drop_write_barrier (void);
+#endif
 
 /* Push an entry onto G.depth.  */
 
@@ -950,6 +1074,16 @@ free_page (page_entry *entry)
   clear_page_group_in_use (entry->group, entry->page);
 #endif
 
+#ifdef USING_WRITE_BARRIER
+  /* The page will be reused for new objects.  */
+  if (entry->write_protected)
+    {
+      mprotect (entry->page, entry->bytes, PROT_READ | PROT_WRITE);
+      entry->write_protected = false;
+    }
+  gcc_checking_assert (!entry->young_p);
+#endif
+
   if (G.by_depth_in_use > 1)
     {
       page_entry *top = G.by_depth[G.by_depth_in_use-1];
@@ -1287,6 +1421,11 @@ ggc_internal_alloc_stat (size_t size MEM_STAT_DECL)
   /* Set the in-use bit.  */
   entry->in_use_p[word] |= ((unsigned long) 1 << bit);
 
+#ifdef USING_WRITE_BARRIER
+  if (G.barrier_armed)
+    note_young_object (entry, word, bit, object_size);
+#endif
+
   /* Keep a running total of the number of free objects.  If this page
      fills up, we may have to move it to the end of the list if the
      next page isn't full.  If the next page is full, all subsequent
@@ -1567,6 +1706,10 @@ ggc_free (void *p)
     word = bit_offset / HOST_BITS_PER_LONG;
     bit = bit_offset % HOST_BITS_PER_LONG;
     pe->in_use_p[word] &= ~(1UL << bit);
+#ifdef USING_WRITE_BARRIER
+    if (pe->young_p)
+      pe->young_p[word] &= ~(1UL << bit);
+#endif
 
     if (pe->num_free_objects++ == 0)
       {
@@ -1812,10 +1955,12 @@ clear_marks (void)
 }
 
 /* Free all empty pages.  Partially empty pages need no attention
-   because the `mark' bit doubles as an `unused' bit.  */
+   because the `mark' bit doubles as an `unused' bit.  MINOR is true
+   after a minor collection, which leaves the in-use bits of pages
+   from outer contexts alone.  */
 
 static void
-sweep_pages (void)
+sweep_pages (bool minor)
 {
   unsigned order;
 
@@ -1938,9 +2083,10 @@ sweep_pages (void)
 
       /* Now, restore the in_use_p vectors for any pages from contexts
          other than the current one.  */
-      for (p = G.pages[order]; p; p = p->next)
-	if (p->context_depth != G.context_depth)
-	  ggc_recalculate_in_use_p (p);
+      if (!minor)
+	for (p = G.pages[order]; p; p = p->next)
+	  if (p->context_depth != G.context_depth)
+	    ggc_recalculate_in_use_p (p);
     }
 }
 
@@ -2038,6 +2184,465 @@ validate_free_objects (void)
 #define validate_free_objects()
 #endif
 
+#ifdef USING_WRITE_BARRIER
+/* Generational collection.
+
+   In generational mode, every collection ends by write-protecting
+   the pages of the objects that survived it, the old generation.
+   Objects allocated afterwards are young; the YOUNG_P bitmaps of
+   their pages record them.  The first write to an old page raises
+   SIGSEGV; ggc_write_fault notes the page as dirty and makes it
+   writable again, so that a minor collection knows where old objects
+   may have been changed to point to young ones.  */
+
+/* Record that the object at bit BIT of word WORD of ENTRY's bitmaps,
+   OBJECT_SIZE bytes long, has just been allocated.  */
+
+static inline void
+note_young_object (page_entry *entry, size_t word, size_t bit,
+		   size_t object_size)
+{
+  if (!entry->young_p)
+    {
+      entry->young_p
+	= XCNEWVAR (unsigned long, BITMAP_SIZE (OBJECTS_IN_PAGE (entry) + 1));
+      entry->next_young = G.young_pages;
+      G.young_pages = entry;
+    }
+  entry->young_p[word] |= (unsigned long) 1 << bit;
+  G.young_allocated += object_size;
+}
+
+/* Forget which objects are young.  */
+
+static void
+forget_young_objects (void)
+{
+  page_entry *p, *next;
+
+  for (p = G.young_pages; p; p = next)
+    {
+      next = p->next_young;
+      free (p->young_p);
+      p->young_p = NULL;
+      p->next_young = NULL;
+    }
+  G.young_pages = NULL;
+  G.young_allocated = 0;
+}
+
+/* Make the old generation writable again.  This is called from the
+   fault handler, so it must not allocate memory.  */
+
+static void
+unprotect_old_pages (void)
+{
+  size_t i;
+
+  for (i = 0; i < G.n_protected_ranges; i++)
+    mprotect (G.protected_ranges[i].start, G.protected_ranges[i].size,
+	      PROT_READ | PROT_WRITE);
+  G.n_protected_ranges = 0;
+
+  for (i = 0; i < G.n_old_pages; i++)
+    G.old_pages[i]->write_protected = false;
+  G.n_old_pages = 0;
+}
+
+/* Return the page-entry of the old generation containing ADDR, or
+   NULL if there is none.  */
+
+static page_entry *
+find_old_page (const char *addr)
+{
+  size_t lo = 0, hi = G.n_old_pages;
+
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+      page_entry *p = G.old_pages[mid];
+
+      if (addr < p->page)
+	hi = mid;
+      else if (addr >= p->page + p->bytes)
+	lo = mid + 1;
+      else
+	return p;
+    }
+  return NULL;
+}
+
+/* Handle a write to a write-protected page of the old generation.
+   Any other fault is passed on to the previous handler, by
+   reinstating it and letting the faulting instruction run again.  */
+
+static void
+ggc_write_fault (int signo ATTRIBUTE_UNUSED, siginfo_t *info,
+		 void *context ATTRIBUTE_UNUSED)
+{
+  char *addr = (char *) info->si_addr;
+  char *page = (char *) ((uintptr_t) addr & -(uintptr_t) G.pagesize);
+  page_entry *entry = NULL;
+
+  if (G.barrier_armed)
+    entry = find_old_page (addr);
+
+  if (entry == NULL || !entry->write_protected)
+    {
+      sigaction (SIGSEGV, &G.old_segv_action, NULL);
+      return;
+    }
+
+  G.write_faults++;
+  if (G.n_dirty_pages < G.max_dirty_pages
+      && mprotect (page, G.pagesize, PROT_READ | PROT_WRITE) == 0)
+    G.dirty_pages[G.n_dirty_pages++] = page;
+  else
+    {
+      /* Too many old pages were written to.  Give up on the barrier
+	 until the next major collection.  */
+      unprotect_old_pages ();
+      G.barrier_overflowed = true;
+    }
+}
+
+/* qsort comparison function to sort page-entries by address.  */
+
+static int
+compare_page_addresses (const void *a, const void *b)
+{
+  const page_entry *pa = *(const page_entry *const *) a;
+  const page_entry *pb = *(const page_entry *const *) b;
+
+  if (pa->page == pb->page)
+    return 0;
+  return pa->page < pb->page ? -1 : 1;
+}
+
+/* Write-protect all pages in use, which become the old generation,
+   and arm the write barrier.  If that fails, leave the barrier
+   unarmed; the next collection will be a major one again.  */
+
+static void
+protect_old_pages (void)
+{
+  page_entry **pages;
+  size_t i, n = G.by_depth_in_use, n_ranges = 0, n_system_pages = 0;
+
+  if (!G.fault_handler_installed)
+    {
+      struct sigaction sa;
+
+      memset (&sa, 0, sizeof (sa));
+      sa.sa_sigaction = ggc_write_fault;
+      sa.sa_flags = SA_SIGINFO;
+      sigemptyset (&sa.sa_mask);
+      if (sigaction (SIGSEGV, &sa, &G.old_segv_action) != 0)
+	return;
+      G.fault_handler_installed = true;
+      G.dirty_pages = XNEWVEC (char *, GGC_MAX_DIRTY_PAGES);
+    }
+
+  /* Coalesce adjacent pages, to keep the number of system calls and
+     of mappings down.  */
+  pages = G.old_pages = XRESIZEVEC (page_entry *, G.old_pages, n);
+  memcpy (pages, G.by_depth, n * sizeof (page_entry *));
+  qsort (pages, n, sizeof (page_entry *), compare_page_addresses);
+  G.n_old_pages = n;
+  G.protected_ranges = XRESIZEVEC (struct protected_range,
+				   G.protected_ranges, n);
+  for (i = 0; i < n; i++)
+    {
+      page_entry *p = pages[i];
+      struct protected_range *r = G.protected_ranges + n_ranges;
+
+      p->write_protected = true;
+      n_system_pages += p->bytes >> G.lg_pagesize;
+      if (n_ranges && r[-1].start + r[-1].size == p->page)
+	r[-1].size += p->bytes;
+      else
+	{
+	  G.protected_ranges[n_ranges].start = p->page;
+	  G.protected_ranges[n_ranges].size = p->bytes;
+	  n_ranges++;
+	}
+    }
+
+  G.n_dirty_pages = 0;
+  G.max_dirty_pages = MIN (n_system_pages, GGC_MAX_DIRTY_PAGES);
+  G.barrier_overflowed = false;
+  G.barrier_armed = true;
+
+  for (i = 0; i < n_ranges; i++)
+    if (mprotect (G.protected_ranges[i].start, G.protected_ranges[i].size,
+		  PROT_READ) != 0)
+      {
+	G.n_protected_ranges = i;
+	unprotect_old_pages ();
+	G.barrier_armed = false;
+	return;
+      }
+  G.n_protected_ranges = n_ranges;
+}
+
+/* Unprotect the old generation and forget about young objects, e.g.
+   before a major collection.  */
+
+static void
+drop_write_barrier (void)
+{
+  unprotect_old_pages ();
+  forget_young_objects ();
+  G.n_dirty_pages = 0;
+  G.barrier_armed = false;
+  G.barrier_overflowed = false;
+}
+
+/* Hash the page number KEY for G.young_table.  Runs of consecutive
+   pages are common, so scatter them.  */
+#define YOUNG_HASH(KEY) \
+  ((size_t) (((KEY) * (uintptr_t) 0x9e3779b97f4a7c15ULL) \
+	     >> G.young_table_shift))
+
+/* Fill G.young_table with the page-entries whose young objects may
+   be collected.  */
+
+static void
+build_young_table (void)
+{
+  page_entry *p;
+  size_t n = 0, size = 64, mask;
+  unsigned int lg_size = 6;
+
+  for (p = G.young_pages; p; p = p->next_young)
+    n++;
+  while (size < 2 * n)
+    size *= 2, lg_size++;
+  if (size > G.young_table_size)
+    G.young_table = XRESIZEVEC (struct young_slot, G.young_table, size);
+  G.young_table_size = size;
+  G.young_table_shift = HOST_BITS_PER_PTR - lg_size;
+  memset (G.young_table, 0, size * sizeof (struct young_slot));
+  memset (G.young_filter, 0, sizeof (G.young_filter));
+
+  mask = size - 1;
+  for (p = G.young_pages; p; p = p->next_young)
+    if (p->context_depth == G.context_depth)
+      {
+	uintptr_t key = (uintptr_t) p->page >> G.lg_pagesize;
+	size_t i = YOUNG_HASH (key);
+
+	while (G.young_table[i].entry)
+	  i = (i + 1) & mask;
+	G.young_table[i].key = key;
+	G.young_table[i].entry = p;
+
+	key %= YOUNG_FILTER_BITS;
+	G.young_filter[key / HOST_BITS_PER_LONG]
+	  |= (unsigned long) 1 << (key % HOST_BITS_PER_LONG);
+      }
+}
+
+/* Return the collectable page-entry with young objects on whose first
+   page P lies, or NULL if there is none.  */
+
+static inline page_entry *
+lookup_young_page (const void *p)
+{
+  uintptr_t key = (uintptr_t) p >> G.lg_pagesize;
+  size_t bit = key % YOUNG_FILTER_BITS;
+  size_t mask = G.young_table_size - 1;
+  size_t i;
+
+  if (!((G.young_filter[bit / HOST_BITS_PER_LONG]
+	 >> (bit % HOST_BITS_PER_LONG)) & 1))
+    return NULL;
+
+  for (i = YOUNG_HASH (key); G.young_table[i].entry; i = (i + 1) & mask)
+    if (G.young_table[i].key == key)
+      return G.young_table[i].entry;
+  return NULL;
+}
+
+/* If P points into a young object that isn't marked yet, mark it and
+   queue it to be scanned.  P need not be a valid pointer at all.  */
+
+static inline void
+mark_young_conservatively (const void *p)
+{
+  page_entry *entry = lookup_young_page (p);
+  size_t i, word;
+  unsigned long mask;
+
+  if (!entry)
+    return;
+
+  i = ((const char *) p - entry->page) / OBJECT_SIZE (entry->order);
+  if (i >= OBJECTS_IN_PAGE (entry))
+    return;
+
+  word = i / HOST_BITS_PER_LONG;
+  mask = (unsigned long) 1 << (i % HOST_BITS_PER_LONG);
+  if (!(entry->young_p[word] & mask) || (entry->in_use_p[word] & mask))
+    return;
+
+  entry->in_use_p[word] |= mask;
+  entry->num_free_objects -= 1;
+  G.scan_stack.safe_push (entry->page + i * OBJECT_SIZE (entry->order));
+}
+
+/* Mark the young objects pointed to by any pointer-sized word between
+   START and END.  */
+
+static void
+scan_conservatively (const char *start, const char *end)
+{
+  const char *p;
+
+  for (p = start; p + sizeof (void *) <= end; p += sizeof (void *))
+    mark_young_conservatively (*(const void *const *) p);
+}
+
+/* Scan the objects in use on the dirty system page PAGE.  */
+
+static void
+scan_dirty_page (char *page)
+{
+  page_entry *entry = find_old_page (page);
+  char *end = page + G.pagesize;
+  size_t size = OBJECT_SIZE (entry->order);
+  size_t i, n = OBJECTS_IN_PAGE (entry);
+
+  for (i = (page - entry->page) / size; i < n; i++)
+    {
+      char *object = entry->page + i * size;
+
+      if (object >= end)
+	break;
+      if ((entry->in_use_p[i / HOST_BITS_PER_LONG]
+	   >> (i % HOST_BITS_PER_LONG)) & 1)
+	scan_conservatively (MAX (object, page), MIN (object + size, end));
+    }
+}
+#endif
+
+/* In a minor collection, mark the young objects that old objects
+   written to since the last collection point to.  The roots have
+   already been marked, and the marks of old objects are all set, so
+   this finds every young object that is still reachable.  Since the
+   types of the objects on a dirty page aren't known, the pages, and
+   the young objects found, are scanned conservatively.  */
+
+void
+ggc_mark_dirty_pages (void)
+{
+#ifdef USING_WRITE_BARRIER
+  size_t i;
+
+  if (!G.minor_collection_p)
+    return;
+
+  build_young_table ();
+  for (i = 0; i < G.n_dirty_pages; i++)
+    scan_dirty_page (G.dirty_pages[i]);
+
+  while (!G.scan_stack.is_empty ())
+    {
+      char *object = G.scan_stack.pop ();
+      page_entry *entry = lookup_page_table_entry (object);
+
+      scan_conservatively (object, object + OBJECT_SIZE (entry->order));
+    }
+#endif
+}
+
+#ifdef USING_WRITE_BARRIER
+/* Collect the young objects only.  Their marks are cleared, while
+   those of the old objects stay set, so marking from the roots stops
+   at the old generation; ggc_mark_dirty_pages then marks the young
+   objects reachable from it.  Finally, the surviving young objects
+   join the old generation.  */
+
+static void
+ggc_collect_minor (void)
+{
+  long start = get_run_time ();
+  page_entry *p;
+
+  timevar_push (TV_GC_MINOR);
+  if (!quiet_flag)
+    fprintf (stderr, " {minor GC %luk -> ", (unsigned long) G.allocated / 1024);
+
+  G.allocated = 0;
+  release_pages ();
+
+  invoke_plugin_callbacks (PLUGIN_GGC_START, NULL);
+
+  /* Young objects on pages of outer contexts, if any, can't be
+     collected anyway.  */
+  for (p = G.young_pages; p; p = p->next_young)
+    if (p->context_depth == G.context_depth)
+      {
+	size_t i, n = BITMAP_SIZE (OBJECTS_IN_PAGE (p) + 1) / sizeof (long);
+
+	for (i = 0; i < n; i++)
+	  {
+	    unsigned long young = p->in_use_p[i] & p->young_p[i];
+
+	    p->in_use_p[i] &= ~young;
+	    p->num_free_objects += popcount_hwi (young);
+	  }
+      }
+
+  G.minor_collection_p = true;
+  ggc_mark_roots ();
+  G.minor_collection_p = false;
+
+  if (GATHER_STATISTICS)
+    ggc_prune_overhead_list ();
+
+#ifdef ENABLE_GC_CHECKING
+  /* Clobber the young objects that died.  */
+  for (p = G.young_pages; p; p = p->next_young)
+    if (p->context_depth == G.context_depth)
+      {
+	size_t size = OBJECT_SIZE (p->order);
+	size_t i, n = OBJECTS_IN_PAGE (p);
+
+	for (i = 0; i < n; i++)
+	  {
+	    size_t word = i / HOST_BITS_PER_LONG;
+	    unsigned long mask = (unsigned long) 1 << (i % HOST_BITS_PER_LONG);
+
+	    if ((p->young_p[word] & mask) && !(p->in_use_p[word] & mask))
+	      {
+		char *object = p->page + i * size;
+
+		VALGRIND_DISCARD (VALGRIND_MAKE_MEM_UNDEFINED (object, size));
+		memset (object, 0xa5, size);
+		VALGRIND_DISCARD (VALGRIND_MAKE_MEM_NOACCESS (object, size));
+	      }
+	  }
+      }
+#endif
+
+  forget_young_objects ();
+  sweep_pages (true);
+  protect_old_pages ();
+  timevar_note_collection (G.allocated);
+
+  invoke_plugin_callbacks (PLUGIN_GGC_END, NULL);
+
+  timevar_pop (TV_GC_MINOR);
+
+  G.minor_collections++;
+  G.minor_collection_time += get_run_time () - start;
+
+  if (!quiet_flag)
+    fprintf (stderr, "%luk}", (unsigned long) G.allocated / 1024);
+}
+#endif
+
 /* Top level mark-and-sweep routine.  */
 
 void
@@ -2050,10 +2655,29 @@ ggc_collect (void)
     MAX (G.allocated_last_gc, (size_t)PARAM_VALUE (GGC_MIN_HEAPSIZE) * 1024);
 
   float min_expand = allocated_last_gc * PARAM_VALUE (GGC_MIN_EXPAND) / 100;
+  long start;
 
   if (G.allocated < allocated_last_gc + min_expand && !ggc_force_collect)
-    return;
+    {
+#ifdef USING_WRITE_BARRIER
+      /* In generational mode, collect the young objects once enough
+	 of them have accumulated.  If the barrier overflowed, only a
+	 major collection will do.  */
+      if (!G.barrier_armed
+	  || (G.young_allocated
+	      < (size_t) PARAM_VALUE (GGC_NURSERY_SIZE) * 1024))
+	return;
+      if (!G.barrier_overflowed)
+	{
+	  ggc_collect_minor ();
+	  return;
+	}
+#else
+      return;
+#endif
+    }
 
+  start = get_run_time ();
   timevar_push (TV_GC);
   if (!quiet_flag)
     fprintf (stderr, " {GC %luk -> ", (unsigned long) G.allocated / 1024);
@@ -2064,6 +2688,11 @@ ggc_collect (void)
      sweep phase.  */
   G.allocated = 0;
 
+#ifdef USING_WRITE_BARRIER
+  /* A major collection treats all objects alike.  */
+  drop_write_barrier ();
+#endif
+
   /* Release the pages we freed the last time we collected, but didn't
      reuse in the interim.  */
   release_pages ();
@@ -2081,14 +2710,23 @@ ggc_collect (void)
 
   poison_pages ();
   validate_free_objects ();
-  sweep_pages ();
+  sweep_pages (false);
 
   G.allocated_last_gc = G.allocated;
+  timevar_note_collection (G.allocated);
+
+#ifdef USING_WRITE_BARRIER
+  if (PARAM_VALUE (GGC_GENERATIONAL))
+    protect_old_pages ();
+#endif
 
   invoke_plugin_callbacks (PLUGIN_GGC_END, NULL);
 
   timevar_pop (TV_GC);
 
+  G.major_collections++;
+  G.major_collection_time += get_run_time () - start;
+
   if (!quiet_flag)
     fprintf (stderr, "%luk}", (unsigned long) G.allocated / 1024);
   if (GGC_DEBUG_LEVEL >= 2)
@@ -2103,12 +2741,13 @@ ggc_collect (void)
 		     : (x) / (1024*1024))))
 #define STAT_LABEL(x) ((x) < 1024*10 ? ' ' : ((x) < 1024*1024*10 ? 'k' : 'M'))
 
-void
-ggc_print_statistics (void)
+/* Collect garbage for the statistics, so that only memory that is
+   still in use is counted.  */
+
+static void
+collect_for_statistics (void)
 {
   struct ggc_statistics stats;
-  unsigned int i;
-  size_t total_overhead = 0;
 
   /* Clear the statistics.  */
   memset (&stats, 0, sizeof (stats));
@@ -2122,6 +2761,36 @@ ggc_print_statistics (void)
   /* Release free pages so that we will not count the bytes allocated
      there as part of the total allocated memory.  */
   release_pages ();
+}
+
+/* Figure out the total number of bytes allocated for objects of size
+   order ORDER, and how many of them are actually in use.  Also figure
+   out how much memory the page table is using.  */
+
+static void
+order_statistics (unsigned order, size_t *allocated, size_t *in_use,
+		  size_t *overhead)
+{
+  page_entry *p;
+
+  *overhead = *allocated = *in_use = 0;
+  for (p = G.pages[order]; p; p = p->next)
+    {
+      *allocated += p->bytes;
+      *in_use += ((OBJECTS_IN_PAGE (p) - p->num_free_objects)
+		  * OBJECT_SIZE (order));
+      *overhead += (sizeof (page_entry) - sizeof (long)
+		    + BITMAP_SIZE (OBJECTS_IN_PAGE (p) + 1));
+    }
+}
+
+void
+ggc_print_statistics (void)
+{
+  unsigned int i;
+  size_t total_overhead = 0;
+
+  collect_for_statistics ();
 
   /* Collect some information about the various sizes of
      allocation.  */
@@ -2131,7 +2800,6 @@ ggc_print_statistics (void)
 	   "Size", "Allocated", "Used", "Overhead");
   for (i = 0; i < NUM_ORDERS; ++i)
     {
-      page_entry *p;
       size_t allocated;
       size_t in_use;
       size_t overhead;
@@ -2140,20 +2808,7 @@ ggc_print_statistics (void)
       if (!G.pages[i])
 	continue;
 
-      overhead = allocated = in_use = 0;
-
-      /* Figure out the total number of bytes allocated for objects of
-	 this size, and how many of them are actually in use.  Also figure
-	 out how much memory the page table is using.  */
-      for (p = G.pages[i]; p; p = p->next)
-	{
-	  allocated += p->bytes;
-	  in_use +=
-	    (OBJECTS_IN_PAGE (p) - p->num_free_objects) * OBJECT_SIZE (i);
-
-	  overhead += (sizeof (page_entry) - sizeof (long)
-		       + BITMAP_SIZE (OBJECTS_IN_PAGE (p) + 1));
-	}
+      order_statistics (i, &allocated, &in_use, &overhead);
       fprintf (stderr, "%-5lu %10lu%c %10lu%c %10lu%c\n",
 	       (unsigned long) OBJECT_SIZE (i),
 	       SCALE (allocated), STAT_LABEL (allocated),
@@ -2166,6 +2821,13 @@ ggc_print_statistics (void)
 	   SCALE (G.allocated), STAT_LABEL(G.allocated),
 	   SCALE (total_overhead), STAT_LABEL (total_overhead));
 
+  fprintf (stderr, "\nGarbage collections: %lu major (%.2f s), "
+	   "%lu minor (%.2f s)\n",
+	   G.major_collections, G.major_collection_time * 1e-6,
+	   G.minor_collections, G.minor_collection_time * 1e-6);
+  if (G.minor_collections)
+    fprintf (stderr, "Write faults on old pages: %lu\n", G.write_faults);
+
   if (GATHER_STATISTICS)
     {
       fprintf (stderr, "\nTotal allocations and overheads during the compilation process\n");
@@ -2200,6 +2862,48 @@ ggc_print_statistics (void)
 	  }
   }
 }
+
+/* Print allocation statistics to STREAM as the members of a JSON
+   object, for -fmem-report=json.  */
+
+void
+ggc_print_json_statistics (FILE *stream)
+{
+  unsigned int i;
+  size_t total_overhead = 0;
+  const char *sep = "";
+
+  collect_for_statistics ();
+
+  fputs ("\"orders\": [", stream);
+  for (i = 0; i < NUM_ORDERS; ++i)
+    {
+      size_t allocated;
+      size_t in_use;
+      size_t overhead;
+
+      if (!G.pages[i])
+	continue;
+
+      order_statistics (i, &allocated, &in_use, &overhead);
+      fprintf (stream, "%s\n  {\"size\": %lu, \"allocated\": %lu, "
+	       "\"in_use\": %lu, \"overhead\": %lu}", sep,
+	       (unsigned long) OBJECT_SIZE (i), (unsigned long) allocated,
+	       (unsigned long) in_use, (unsigned long) overhead);
+      total_overhead += overhead;
+      sep = ",";
+    }
+  fprintf (stream, "],\n\"mapped\": %lu, \"in_use\": %lu, "
+	   "\"overhead\": %lu,\n", (unsigned long) G.bytes_mapped,
+	   (unsigned long) G.allocated, (unsigned long) total_overhead);
+  fprintf (stream, "\"major_collections\": %lu, "
+	   "\"major_collection_time\": %.6f, "
+	   "\"minor_collections\": %lu, "
+	   "\"minor_collection_time\": %.6f, \"write_faults\": %lu",
+	   G.major_collections, G.major_collection_time * 1e-6,
+	   G.minor_collections, G.minor_collection_time * 1e-6,
+	   G.write_faults);
+}
 
 struct ggc_pch_ondisk
 {
@@ -2411,6 +3115,12 @@ ggc_pch_read (FILE *f, void *addr)
 
   count_old_page_tables = G.by_depth_in_use;
 
+#ifdef USING_WRITE_BARRIER
+  /* The PCH pages aren't write-protected, so the next collection has
+     to be a major one.  */
+  drop_write_barrier ();
+#endif
+
   /* We've just read in a PCH file.  So, every object that used to be
      allocated is now free.  */
   clear_marks ();
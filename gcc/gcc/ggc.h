@@ -240,6 +240,10 @@ extern void gt_pch_restore (FILE *f);
 /* Print allocation statistics.  */
 extern void ggc_print_statistics (void);
 
+/* Print allocation statistics to a stream as the members of a JSON
+   object.  */
+extern void ggc_print_json_statistics (FILE *);
+
 extern void stringpool_statistics (void);
 
 /* Heuristics.  */
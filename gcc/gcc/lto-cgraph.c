@@ -57,6 +57,10 @@ static void input_cgraph_opt_summary (vec<symtab_node>  nodes);
 /* All node orders are ofsetted by ORDER_BASE.  */
 static int order_base;
 
+/* In WPA, the sorted orders of the symbols and top-level asms of the
+   partition being written.  */
+static vec<int> partition_orders;
+
 /* Cgraph streaming is organized as set of record whose type
    is indicated by a tag.  */
 enum LTO_symtab_tags
@@ -387,7 +391,8 @@ lto_output_node (struct lto_simple_output_block *ob, struct cgraph_node *node,
 
   streamer_write_enum (ob->main_stream, LTO_symtab_tags, LTO_symtab_last_tag,
 		       tag);
-  streamer_write_hwi_stream (ob->main_stream, node->symbol.order);
+  streamer_write_hwi_stream (ob->main_stream,
+			    lto_output_order (node->symbol.order));
 
   /* In WPA mode, we only output part of the call-graph.  Also, we
      fake cgraph node attributes.  There are two cases that we care.
@@ -528,7 +533,8 @@ lto_output_varpool_node (struct lto_simple_output_block *ob, struct varpool_node
 
   streamer_write_enum (ob->main_stream, LTO_symtab_tags, LTO_symtab_last_tag,
 		       LTO_symtab_variable);
-  streamer_write_hwi_stream (ob->main_stream, node->symbol.order);
+  streamer_write_hwi_stream (ob->main_stream,
+			    lto_output_order (node->symbol.order));
   lto_output_var_decl_index (ob->decl_state, ob->main_stream, node->symbol.decl);
   bp = bitpack_create (ob->main_stream);
   bp_pack_value (&bp, node->symbol.externally_visible, 1);
@@ -794,6 +800,36 @@ compute_ltrans_boundary (lto_symtab_encoder_t in_encoder)
  return encoder;
 }
 
+/* Compare the orders pointed to by P1 and P2 for qsort and bsearch.  */
+
+static int
+compare_orders (const void *p1, const void *p2)
+{
+  int o1 = *(const int *) p1, o2 = *(const int *) p2;
+
+  return o1 < o2 ? -1 : o1 > o2;
+}
+
+/* Return the order to stream for a symbol or top-level asm of ORDER.
+   Only the relative order matters to LTRANS, so WPA writes the index of
+   ORDER in the partition; that way a partition stays the same when
+   symbols are added elsewhere in the program, and lto-wrapper can reuse
+   its LTRANS compilation.  */
+
+int
+lto_output_order (int order)
+{
+  int *p;
+
+  if (!flag_wpa)
+    return order;
+  p = (int *) bsearch (&order, partition_orders.address (),
+		       partition_orders.length (), sizeof (int),
+		       compare_orders);
+  gcc_assert (p);
+  return p - partition_orders.address ();
+}
+
 /* Output the part of the symtab in SET and VSET.  */
 
 void
@@ -817,11 +853,24 @@ output_symtab (void)
      ipa_write_summaries_1.  */
   gcc_assert (ob->decl_state->symtab_node_encoder);
   encoder = ob->decl_state->symtab_node_encoder;
+  n_nodes = lto_symtab_encoder_size (encoder);
+
+  if (flag_wpa)
+    {
+      struct asm_node *can;
+
+      for (i = 0; i < n_nodes; i++)
+	partition_orders.safe_push
+	  (lto_symtab_encoder_deref (encoder, i)->symbol.order);
+      if (!asm_nodes_output)
+	for (can = asm_nodes; can; can = can->next)
+	  partition_orders.safe_push (can->order);
+      partition_orders.qsort (compare_orders);
+    }
 
   /* Write out the nodes.  We must first output a node and then its clones,
      otherwise at a time reading back the node there would be nothing to clone
      from.  */
-  n_nodes = lto_symtab_encoder_size (encoder);
   for (i = 0; i < n_nodes; i++)
     {
       symtab_node node = lto_symtab_encoder_deref (encoder, i);
@@ -854,6 +903,7 @@ output_symtab (void)
       asm_nodes_output = true;
       lto_output_toplevel_asms ();
     }
+  partition_orders.release ();
 
   output_refs (encoder);
 }
@@ -32,6 +32,34 @@ along with GCC; see the file COPYING3.  If not see
 #include "langhooks.h"
 #include "lto-streamer.h"
 #include "lto-compress.h"
+#include "params.h"
+
+/* The compressed data of a section is a sequence of segments, each
+   compressed by itself.  Every codec starts its segments with bytes that
+   tell it from the others, so sections compressed with different codecs,
+   e.g. by compilations with different -flto-compression-codec options,
+   can be read by the same link; the section headers don't change.  */
+
+struct lto_codec
+{
+  /* Return true if the LEN bytes at DATA start a segment of this codec.  */
+  bool (*segment_p) (const unsigned char *data, size_t len);
+
+  /* Compress the LEN bytes at DATA into segments, passing them to
+     CALLBACK with OPAQUE.  Return the number of compressed bytes.  */
+  size_t (*compress) (const unsigned char *data, size_t len,
+		      void (*callback) (const char *, unsigned, void *),
+		      void *opaque);
+
+  /* Uncompress the segment at the start of the LEN bytes at DATA,
+     appending it to *OUT, which has *ALLOCATION bytes, *BYTES of them
+     in use, and growing *OUT as needed.  Store the length of the segment
+     in *CONSUMED.  Return NULL, or an error message on failure.  This
+     must not touch any global state, since helper threads use it.  */
+  const char *(*uncompress) (const unsigned char *data, size_t len,
+			     char **out, size_t *bytes, size_t *allocation,
+			     size_t *consumed);
+};
 
 /* Compression stream structure, holds the flush callback and opaque token,
    the buffered data, and a note of whether compressing or uncompressing.  */
@@ -90,6 +118,421 @@ lto_normalized_zlib_level (void)
   return level;
 }
 
+/* Compress the LEN bytes at DATA into one zlib stream, passing it to
+   CALLBACK with OPAQUE.  Return the number of compressed bytes.  */
+
+static size_t
+lto_zlib_compress (const unsigned char *data, size_t len,
+		   void (*callback) (const char *, unsigned, void *),
+		   void *opaque)
+{
+  unsigned char *cursor = CONST_CAST (unsigned char *, data);
+  size_t remaining = len;
+  const size_t outbuf_length = Z_BUFFER_LENGTH;
+  unsigned char *outbuf = (unsigned char *) xmalloc (outbuf_length);
+  z_stream out_stream;
+  size_t compressed_bytes = 0;
+  int status;
+
+  out_stream.next_out = outbuf;
+  out_stream.avail_out = outbuf_length;
+  out_stream.next_in = cursor;
+  out_stream.avail_in = remaining;
+  out_stream.zalloc = lto_zalloc;
+  out_stream.zfree = lto_zfree;
+  out_stream.opaque = Z_NULL;
+
+  status = deflateInit (&out_stream, lto_normalized_zlib_level ());
+  if (status != Z_OK)
+    internal_error ("compressed stream: %s", zError (status));
+
+  do
+    {
+      size_t in_bytes, out_bytes;
+
+      status = deflate (&out_stream, Z_FINISH);
+      if (status != Z_OK && status != Z_STREAM_END)
+	internal_error ("compressed stream: %s", zError (status));
+
+      in_bytes = remaining - out_stream.avail_in;
+      out_bytes = outbuf_length - out_stream.avail_out;
+
+      callback ((const char *) outbuf, out_bytes, opaque);
+      compressed_bytes += out_bytes;
+
+      cursor += in_bytes;
+      remaining -= in_bytes;
+
+      out_stream.next_out = outbuf;
+      out_stream.avail_out = outbuf_length;
+      out_stream.next_in = cursor;
+      out_stream.avail_in = remaining;
+    }
+  while (status != Z_STREAM_END);
+
+  status = deflateEnd (&out_stream);
+  if (status != Z_OK)
+    internal_error ("compressed stream: %s", zError (status));
+
+  free (outbuf);
+  return compressed_bytes;
+}
+
+/* Inflate the zlib stream at the start of the LEN bytes at DATA; see
+   struct lto_codec for the arguments.  */
+
+static const char *
+lto_zlib_uncompress (const unsigned char *data, size_t len, char **out,
+		     size_t *bytes, size_t *allocation, size_t *consumed)
+{
+  z_stream in_stream;
+  int status;
+
+  in_stream.next_in = CONST_CAST (unsigned char *, data);
+  in_stream.avail_in = len;
+  in_stream.zalloc = lto_zalloc;
+  in_stream.zfree = lto_zfree;
+  in_stream.opaque = Z_NULL;
+
+  status = inflateInit (&in_stream);
+  if (status != Z_OK)
+    return zError (status);
+
+  do
+    {
+      size_t avail;
+
+      if (*bytes == *allocation)
+	{
+	  *allocation *= 2;
+	  *out = (char *) xrealloc (*out, *allocation);
+	}
+      avail = *allocation - *bytes;
+      in_stream.next_out = (unsigned char *) *out + *bytes;
+      in_stream.avail_out = avail;
+
+      /* With room left in the output buffer, Z_BUF_ERROR means the
+	 input ended in the middle of a segment.  */
+      status = inflate (&in_stream, Z_NO_FLUSH);
+      if (status != Z_OK && status != Z_STREAM_END)
+	{
+	  inflateEnd (&in_stream);
+	  return zError (status == Z_BUF_ERROR ? Z_DATA_ERROR : status);
+	}
+      *bytes += avail - in_stream.avail_out;
+    }
+  while (status != Z_STREAM_END);
+
+  *consumed = len - in_stream.avail_in;
+  status = inflateEnd (&in_stream);
+  if (status != Z_OK)
+    return zError (status);
+  return NULL;
+}
+
+/* The LZ4 codec trades compression ratio for speed: on LTO IL it
+   compresses about eight times and decompresses about twice as fast as
+   zlib at its default level, for output half again as big.  Its segments
+   start with LZ4_MAGIC, which can't start a zlib stream (whose first byte
+   has the low nibble Z_DEFLATED), followed by the uncompressed and the
+   compressed size as 32-bit little-endian numbers and a block in the LZ4
+   block format: a sequence of literal runs, each but the last followed
+   by a match of at least LZ4_MIN_MATCH bytes at most 65535 bytes back.  */
+
+static const unsigned char LZ4_MAGIC[4] = { 'L', 'Z', '4', 1 };
+#define LZ4_HEADER_LENGTH 12
+#define LZ4_MIN_MATCH 4
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 14
+
+/* The format requires the last match to start at least 12 bytes and to
+   end at least 5 bytes before the end of the block.  */
+#define LZ4_MATCH_START_LIMIT 12
+#define LZ4_MATCH_END_LIMIT 5
+
+/* Return the 32-bit little-endian number at P.  */
+
+static inline unsigned
+lto_lz4_read32 (const unsigned char *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned) p[3] << 24);
+}
+
+/* Store V at P as a 32-bit little-endian number.  */
+
+static inline void
+lto_lz4_write32 (unsigned char *p, unsigned v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+/* Write the LZ4 length LEN, less than 15 of which went into the token,
+   at OP and return the end of it.  */
+
+static inline unsigned char *
+lto_lz4_write_length (unsigned char *op, size_t len)
+{
+  for (len -= 15; len >= 255; len -= 255)
+    *op++ = 255;
+  *op++ = len;
+  return op;
+}
+
+/* Return true if the LEN bytes at DATA start an LZ4 segment.  */
+
+static bool
+lto_lz4_segment_p (const unsigned char *data, size_t len)
+{
+  return len >= sizeof (LZ4_MAGIC)
+	 && memcmp (data, LZ4_MAGIC, sizeof (LZ4_MAGIC)) == 0;
+}
+
+/* Compress the LEN bytes at SRC into the LZ4 block at DST, which has room
+   for at least LEN + LEN / 255 + 16 bytes, and return its length.  This
+   is the greedy single-probe matcher of the reference implementation.  */
+
+static size_t
+lto_lz4_compress_block (const unsigned char *src, size_t len,
+			unsigned char *dst)
+{
+  const unsigned char *ip = src, *anchor = src, *end = src + len;
+  unsigned char *op = dst;
+  unsigned *table = XCNEWVEC (unsigned, 1 << LZ4_HASH_BITS);
+  size_t lit;
+
+  if (len > LZ4_MATCH_START_LIMIT)
+    {
+      const unsigned char *match_start_limit = end - LZ4_MATCH_START_LIMIT;
+      const unsigned char *match_end_limit = end - LZ4_MATCH_END_LIMIT;
+      unsigned misses = 0;
+
+      while (ip <= match_start_limit)
+	{
+	  unsigned seq = lto_lz4_read32 (ip);
+	  unsigned h = (seq * 2654435761U) >> (32 - LZ4_HASH_BITS);
+	  const unsigned char *ref = src + table[h];
+	  const unsigned char *mp, *rp;
+	  unsigned char *token;
+	  size_t mlen;
+
+	  table[h] = ip - src;
+	  if (ref >= ip || ip - ref > LZ4_MAX_OFFSET
+	      || lto_lz4_read32 (ref) != seq)
+	    {
+	      /* Skip faster through data that doesn't compress.  */
+	      ip += 1 + (misses++ >> 6);
+	      continue;
+	    }
+	  misses = 0;
+
+	  for (mp = ip + LZ4_MIN_MATCH, rp = ref + LZ4_MIN_MATCH;
+	       mp < match_end_limit && *mp == *rp; mp++, rp++)
+	    ;
+
+	  lit = ip - anchor;
+	  mlen = mp - ip - LZ4_MIN_MATCH;
+	  token = op++;
+	  *token = (MIN (lit, 15) << 4) | MIN (mlen, 15);
+	  if (lit >= 15)
+	    op = lto_lz4_write_length (op, lit);
+	  memcpy (op, anchor, lit);
+	  op += lit;
+	  *op++ = (ip - ref) & 0xff;
+	  *op++ = (ip - ref) >> 8;
+	  if (mlen >= 15)
+	    op = lto_lz4_write_length (op, mlen);
+
+	  ip = anchor = mp;
+	}
+    }
+
+  lit = end - anchor;
+  *op++ = MIN (lit, 15) << 4;
+  if (lit >= 15)
+    op = lto_lz4_write_length (op, lit);
+  memcpy (op, anchor, lit);
+  op += lit;
+
+  free (table);
+  return op - dst;
+}
+
+/* Compress the LEN bytes at DATA into LZ4 segments, passing them to
+   CALLBACK with OPAQUE.  Return the number of compressed bytes.  */
+
+static size_t
+lto_lz4_compress (const unsigned char *data, size_t len,
+		  void (*callback) (const char *, unsigned, void *),
+		  void *opaque)
+{
+  /* Bigger sections are split into several segments.  */
+  size_t max_segment = PARAM_VALUE (PARAM_LTO_LZ4_SEGMENT_SIZE);
+  size_t chunk = MIN (len, max_segment);
+  unsigned char *outbuf
+    = XNEWVEC (unsigned char, LZ4_HEADER_LENGTH + chunk + chunk / 255 + 16);
+  size_t compressed_bytes = 0;
+
+  do
+    {
+      size_t out_bytes;
+
+      chunk = MIN (len, max_segment);
+      out_bytes = lto_lz4_compress_block (data, chunk,
+					  outbuf + LZ4_HEADER_LENGTH);
+      memcpy (outbuf, LZ4_MAGIC, sizeof (LZ4_MAGIC));
+      lto_lz4_write32 (outbuf + 4, chunk);
+      lto_lz4_write32 (outbuf + 8, out_bytes);
+      out_bytes += LZ4_HEADER_LENGTH;
+
+      callback ((const char *) outbuf, out_bytes, opaque);
+      compressed_bytes += out_bytes;
+      data += chunk;
+      len -= chunk;
+    }
+  while (len > 0);
+
+  free (outbuf);
+  return compressed_bytes;
+}
+
+/* Read an LZ4 length that didn't fit into the token, having read LEN of
+   it, from *IP, which must stay below END.  Return false if the data
+   ends before the length does.  */
+
+static inline bool
+lto_lz4_read_length (const unsigned char **ip, const unsigned char *end,
+		     size_t *len)
+{
+  unsigned char c;
+
+  do
+    {
+      if (*ip >= end)
+	return false;
+      c = *(*ip)++;
+      *len += c;
+    }
+  while (c == 255);
+  return true;
+}
+
+/* Uncompress the LZ4 segment at the start of the LEN bytes at DATA; see
+   struct lto_codec for the arguments.  */
+
+static const char *
+lto_lz4_uncompress (const unsigned char *data, size_t len, char **out,
+		    size_t *bytes, size_t *allocation, size_t *consumed)
+{
+  const char *corrupt = "corrupt LZ4 segment";
+  const unsigned char *ip, *end;
+  unsigned char *op, *out_start, *out_end;
+  size_t raw_len, block_len, i;
+
+  if (len < LZ4_HEADER_LENGTH)
+    return corrupt;
+  raw_len = lto_lz4_read32 (data + 4);
+  block_len = lto_lz4_read32 (data + 8);
+  if (block_len > len - LZ4_HEADER_LENGTH)
+    return corrupt;
+
+  if (*allocation - *bytes < raw_len)
+    {
+      *allocation = MAX (*allocation * 2, *bytes + raw_len);
+      *out = (char *) xrealloc (*out, *allocation);
+    }
+
+  ip = data + LZ4_HEADER_LENGTH;
+  end = ip + block_len;
+  out_start = op = (unsigned char *) *out + *bytes;
+  out_end = out_start + raw_len;
+  for (;;)
+    {
+      size_t lit, mlen, offset;
+      unsigned char token;
+      const unsigned char *ref;
+
+      if (ip >= end)
+	return corrupt;
+      token = *ip++;
+
+      lit = token >> 4;
+      if (lit == 15 && !lto_lz4_read_length (&ip, end, &lit))
+	return corrupt;
+      if (lit > (size_t) (end - ip) || lit > (size_t) (out_end - op))
+	return corrupt;
+      memcpy (op, ip, lit);
+      ip += lit;
+      op += lit;
+      if (ip == end)
+	break;
+
+      if (end - ip < 2)
+	return corrupt;
+      offset = ip[0] | (ip[1] << 8);
+      ip += 2;
+      if (offset == 0 || offset > (size_t) (op - out_start))
+	return corrupt;
+
+      mlen = token & 15;
+      if (mlen == 15 && !lto_lz4_read_length (&ip, end, &mlen))
+	return corrupt;
+      mlen += LZ4_MIN_MATCH;
+      if (mlen > (size_t) (out_end - op))
+	return corrupt;
+
+      /* The match may overlap the bytes it produces.  */
+      ref = op - offset;
+      if (offset >= mlen)
+	memcpy (op, ref, mlen);
+      else
+	for (i = 0; i < mlen; i++)
+	  op[i] = ref[i];
+      op += mlen;
+    }
+  if (op != out_end)
+    return corrupt;
+
+  *bytes += raw_len;
+  *consumed = LZ4_HEADER_LENGTH + block_len;
+  return NULL;
+}
+
+/* Return true if the LEN bytes at DATA start a zlib stream: its header
+   names the deflate method and has a valid check value.  */
+
+static bool
+lto_zlib_segment_p (const unsigned char *data, size_t len)
+{
+  return len >= 2
+	 && (data[0] & 0xf) == Z_DEFLATED
+	 && (data[0] * 256 + data[1]) % 31 == 0;
+}
+
+/* The codecs, indexed by enum lto_compression_codec.  */
+
+static const struct lto_codec lto_codecs[] =
+{
+  { lto_zlib_segment_p, lto_zlib_compress, lto_zlib_uncompress },
+  { lto_lz4_segment_p, lto_lz4_compress, lto_lz4_uncompress }
+};
+
+/* Return the codec of the segment at the start of the LEN bytes at DATA.
+   Data no codec recognizes is left to zlib to diagnose.  */
+
+static const struct lto_codec *
+lto_segment_codec (const unsigned char *data, size_t len)
+{
+  size_t i;
+
+  for (i = 0; i < ARRAY_SIZE (lto_codecs); i++)
+    if (lto_codecs[i].segment_p (data, len))
+      return &lto_codecs[i];
+  return &lto_codecs[LTO_CODEC_ZLIB];
+}
+
 /* Create a new compression stream, with CALLBACK flush function passed
    OPAQUE token, IS_COMPRESSION indicates if compressing or uncompressing.  */
 
@@ -161,64 +604,21 @@ lto_compress_block (struct lto_compression_stream *stream,
   lto_stats.num_output_il_bytes += num_chars;
 }
 
-/* Finalize STREAM compression, and free stream allocations.  */
+/* Finalize STREAM compression with the codec chosen by
+   -flto-compression-codec, and free stream allocations.  */
 
 void
 lto_end_compression (struct lto_compression_stream *stream)
 {
-  unsigned char *cursor = (unsigned char *) stream->buffer;
-  size_t remaining = stream->bytes;
-  const size_t outbuf_length = Z_BUFFER_LENGTH;
-  unsigned char *outbuf = (unsigned char *) xmalloc (outbuf_length);
-  z_stream out_stream;
-  size_t compressed_bytes = 0;
-  int status;
+  const struct lto_codec *codec = &lto_codecs[flag_lto_compression_codec];
 
   gcc_assert (stream->is_compression);
 
-  out_stream.next_out = outbuf;
-  out_stream.avail_out = outbuf_length;
-  out_stream.next_in = cursor;
-  out_stream.avail_in = remaining;
-  out_stream.zalloc = lto_zalloc;
-  out_stream.zfree = lto_zfree;
-  out_stream.opaque = Z_NULL;
-
-  status = deflateInit (&out_stream, lto_normalized_zlib_level ());
-  if (status != Z_OK)
-    internal_error ("compressed stream: %s", zError (status));
-
-  do
-    {
-      size_t in_bytes, out_bytes;
-
-      status = deflate (&out_stream, Z_FINISH);
-      if (status != Z_OK && status != Z_STREAM_END)
-	internal_error ("compressed stream: %s", zError (status));
-
-      in_bytes = remaining - out_stream.avail_in;
-      out_bytes = outbuf_length - out_stream.avail_out;
-
-      stream->callback ((const char *) outbuf, out_bytes, stream->opaque);
-      lto_stats.num_compressed_il_bytes += out_bytes;
-      compressed_bytes += out_bytes;
-
-      cursor += in_bytes;
-      remaining -= in_bytes;
-
-      out_stream.next_out = outbuf;
-      out_stream.avail_out = outbuf_length;
-      out_stream.next_in = cursor;
-      out_stream.avail_in = remaining;
-    }
-  while (status != Z_STREAM_END);
-
-  status = deflateEnd (&out_stream);
-  if (status != Z_OK)
-    internal_error ("compressed stream: %s", zError (status));
+  lto_stats.num_compressed_il_bytes
+    += codec->compress ((const unsigned char *) stream->buffer, stream->bytes,
+			stream->callback, stream->opaque);
 
   lto_destroy_compression_stream (stream);
-  free (outbuf);
 }
 
 /* Return a new uncompression stream, with CALLBACK flush function passed
@@ -252,62 +652,63 @@ lto_uncompress_block (struct lto_compression_stream *stream,
 void
 lto_end_uncompression (struct lto_compression_stream *stream)
 {
-  unsigned char *cursor = (unsigned char *) stream->buffer;
-  size_t remaining = stream->bytes;
-  const size_t outbuf_length = Z_BUFFER_LENGTH;
-  unsigned char *outbuf = (unsigned char *) xmalloc (outbuf_length);
-  size_t uncompressed_bytes = 0;
+  char *buffer;
+  size_t uncompressed_bytes;
+  const char *error;
 
   gcc_assert (!stream->is_compression);
 
-  while (remaining > 0)
-    {
-      z_stream in_stream;
-      size_t out_bytes;
-      int status;
-
-      in_stream.next_out = outbuf;
-      in_stream.avail_out = outbuf_length;
-      in_stream.next_in = cursor;
-      in_stream.avail_in = remaining;
-      in_stream.zalloc = lto_zalloc;
-      in_stream.zfree = lto_zfree;
-      in_stream.opaque = Z_NULL;
-
-      status = inflateInit (&in_stream);
-      if (status != Z_OK)
-	internal_error ("compressed stream: %s", zError (status));
+  error = lto_uncompress_data (stream->buffer, stream->bytes, 0, &buffer,
+			       &uncompressed_bytes);
+  if (error)
+    internal_error ("compressed stream: %s", error);
 
-      do
-	{
-	  size_t in_bytes;
+  stream->callback (buffer, uncompressed_bytes, stream->opaque);
+  lto_stats.num_uncompressed_il_bytes += uncompressed_bytes;
 
-	  status = inflate (&in_stream, Z_SYNC_FLUSH);
-	  if (status != Z_OK && status != Z_STREAM_END)
-	    internal_error ("compressed stream: %s", zError (status));
+  free (buffer);
+  lto_destroy_compression_stream (stream);
+}
 
-	  in_bytes = remaining - in_stream.avail_in;
-	  out_bytes = outbuf_length - in_stream.avail_out;
+/* Uncompress the NUM_CHARS bytes at BASE, which may hold several
+   concatenated compressed segments like the data accumulated by
+   lto_uncompress_block, into a single newly allocated buffer, leaving
+   OFFSET bytes of room at its start.  On success, store the buffer in
+   *BUFFER and the number of uncompressed bytes in *UNCOMPRESSED_CHARS,
+   and return NULL.  On failure, return the error message of the codec.
 
-	  stream->callback ((const char *) outbuf, out_bytes, stream->opaque);
-	  lto_stats.num_uncompressed_il_bytes += out_bytes;
-	  uncompressed_bytes += out_bytes;
+   Unlike the stream interface, this uncompresses straight into the
+   buffer, growing it geometrically, and touches no global state, so that
+   it can be called from several threads at once.  */
 
-	  cursor += in_bytes;
-	  remaining -= in_bytes;
+const char *
+lto_uncompress_data (const char *base, size_t num_chars, size_t offset,
+		     char **buffer, size_t *uncompressed_chars)
+{
+  const unsigned char *cursor = (const unsigned char *) base;
+  size_t remaining = num_chars;
+  size_t allocation = offset + MAX (4 * num_chars, Z_BUFFER_LENGTH);
+  size_t bytes = offset;
+  char *out = (char *) xmalloc (allocation);
 
-	  in_stream.next_out = outbuf;
-	  in_stream.avail_out = outbuf_length;
-	  in_stream.next_in = cursor;
-	  in_stream.avail_in = remaining;
-	}
-      while (!(status == Z_STREAM_END && out_bytes == 0));
+  while (remaining > 0)
+    {
+      const struct lto_codec *codec = lto_segment_codec (cursor, remaining);
+      size_t consumed;
+      const char *error;
 
-      status = inflateEnd (&in_stream);
-      if (status != Z_OK)
-	internal_error ("compressed stream: %s", zError (status));
+      error = codec->uncompress (cursor, remaining, &out, &bytes,
+				 &allocation, &consumed);
+      if (error)
+	{
+	  free (out);
+	  return error;
+	}
+      cursor += consumed;
+      remaining -= consumed;
     }
 
-  lto_destroy_compression_stream (stream);
-  free (outbuf);
+  *buffer = out;
+  *uncompressed_chars = bytes - offset;
+  return NULL;
 }
@@ -38,5 +38,8 @@ extern struct lto_compression_stream
 extern void lto_uncompress_block (struct lto_compression_stream *stream,
 				  const char *base, size_t num_chars);
 extern void lto_end_uncompression (struct lto_compression_stream *stream);
+extern const char *lto_uncompress_data (const char *base, size_t num_chars,
+				       size_t offset, char **buffer,
+				       size_t *uncompressed_chars);
 
 #endif /* GCC_LTO_COMPRESS_H  */
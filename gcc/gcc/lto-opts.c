@@ -103,6 +103,13 @@ lto_write_options (void)
 	case OPT_SPECIAL_input_file:
 	  continue;
 
+	/* The temporary files of WPA differ from one link to the next
+	   and mean nothing to the LTRANS units it writes.  */
+	case OPT_fresolution_:
+	case OPT_fltrans_output_list_:
+	case OPT_fltrans_estimates_:
+	  continue;
+
 	default:
 	  break;
       }
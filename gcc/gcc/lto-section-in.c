@@ -42,6 +42,10 @@ along with GCC; see the file COPYING3.  If not see
 #include "lto-compress.h"
 #include "ggc.h"
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 /* Section names.  These must correspond to the values of
    enum lto_section_type.  */
 const char *lto_section_name[LTO_N_SECTION_TYPES] =
@@ -96,37 +100,495 @@ lto_get_file_decl_data (void)
   return file_decl_data;
 }
 
-/* Buffer structure for accumulating data from compression callbacks.  */
+/* Header placed in returned uncompressed data streams.  Allows the
+   uncompressed allocated data to be mapped back to the underlying
+   compressed data for use with free_section_f.  */
 
-struct lto_buffer
+struct lto_data_header
 {
-  char *data;
-  size_t length;
+  const char *data;
+  size_t len;
 };
 
-/* Compression callback, append LENGTH bytes from DATA to the buffer pointed
-   to by OPAQUE.  */
+/* Statistics about the decompression of sections, for -ftime-report.  */
 
-static void
-lto_append_data (const char *data, unsigned length, void *opaque)
+static struct
 {
-  struct lto_buffer *buffer = (struct lto_buffer *) opaque;
+  /* The number of sections decompressed, and how many of them the
+     helper threads decompressed ahead of their use.  */
+  unsigned sections;
+  unsigned prefetched;
+
+  /* The number of helper threads.  */
+  int threads;
+
+  /* The compressed and uncompressed size of the sections.  */
+  size_t compressed_bytes;
+  size_t uncompressed_bytes;
 
-  buffer->data = (char *) xrealloc (buffer->data, buffer->length + length);
-  memcpy (buffer->data + buffer->length, data, length);
-  buffer->length += length;
+  /* The time spent decompressing them, summed over all threads.  */
+  double seconds;
+} decompress_stats;
+
+/* Return the wall clock time in seconds, or zero if the host can't
+   tell.  */
+
+static double
+get_wall_time (void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+  return 0;
+#endif
 }
 
-/* Header placed in returned uncompressed data streams.  Allows the
-   uncompressed allocated data to be mapped back to the underlying
-   compressed data for use with free_section_f.  */
+/* Decompress the LEN bytes of section data at DATA.  Return a buffer
+   holding a mapping header for DATA, followed by the uncompressed data,
+   and store the length of the uncompressed data in *UNCOMPRESSED_LEN
+   and the time it took in *SECONDS.  On failure, return NULL and store
+   the error message in *ERROR.  This runs in the helper threads too,
+   so it must not touch any global state.  */
+
+static char *
+lto_decompress_section (const char *data, size_t len,
+			size_t *uncompressed_len, double *seconds,
+			const char **error)
+{
+  const size_t header_length = sizeof (struct lto_data_header);
+  double start = get_wall_time ();
+  struct lto_data_header *header;
+  char *buffer;
 
-struct lto_data_header
+  *error = lto_uncompress_data (data, len, header_length, &buffer,
+				uncompressed_len);
+  *seconds = get_wall_time () - start;
+  if (*error)
+    return NULL;
+
+  /* Create a mapping header containing the underlying data and length,
+     and prepend this to the uncompressed data.  */
+  header = (struct lto_data_header *) buffer;
+  header->data = data;
+  header->len = len;
+  return buffer;
+}
+
+#ifdef HAVE_PTHREAD
+
+/* Sections can be decompressed by helper threads ahead of their use.
+   The LTO front end schedules the sections it is going to read with
+   lto_prefetch_section_data, in the order it is going to read them.
+   Up to PARAM_LTO_PREFETCH_WINDOW of them at a time are read from
+   their file and queued for the helpers, which do nothing but
+   decompress them; reading and freeing the raw data, reporting errors
+   and keeping statistics is left to the main thread.  If a section is
+   needed before a helper got to it, the main thread decompresses it
+   itself.  The sections scheduled before a section that is read are
+   assumed not to be needed any more and are dropped.  */
+
+enum lto_prefetch_state
 {
+  LTO_PREFETCH_SCHEDULED,	/* Not yet read from its file.  */
+  LTO_PREFETCH_QUEUED,		/* Waiting for a helper.  */
+  LTO_PREFETCH_RUNNING,		/* Being decompressed by a helper.  */
+  LTO_PREFETCH_DONE		/* Decompressed, or failed to.  */
+};
+
+struct lto_prefetch
+{
+  /* The section, as passed to lto_get_section_data.  */
+  struct lto_file_decl_data *file_data;
+  enum lto_section_type section_type;
+  char *name;
+
+  /* The position of the section in PREFETCH_SCHEDULE, and the entry
+     for the next time the same section is scheduled.  */
+  unsigned index;
+  struct lto_prefetch *next_same;
+
+  enum lto_prefetch_state state;
+
+  /* The raw section data, once read.  */
   const char *data;
   size_t len;
+
+  /* What lto_decompress_section returned, once done.  */
+  char *buffer;
+  size_t uncompressed_len;
+  double seconds;
+  const char *error;
 };
 
+typedef struct lto_prefetch *lto_prefetch_p;
+
+/* The scheduled sections, in the order they are going to be read.
+   Entries are cleared when their section is read or dropped.  */
+static vec<lto_prefetch_p> prefetch_schedule;
+
+/* The first entry of PREFETCH_SCHEDULE for each section, hashed by
+   section.  */
+static htab_t prefetch_table;
+
+/* The first entry of PREFETCH_SCHEDULE that may still be scheduled,
+   the first one not read from its file, and the first one the helpers
+   haven't looked at.  */
+static unsigned prefetch_first;
+static unsigned prefetch_next;
+static unsigned prefetch_next_run;
+
+/* The number of sections read from their file and not yet dropped or
+   taken by lto_get_section_data.  */
+static unsigned prefetch_in_flight;
+
+/* The helper threads.  PREFETCH_LOCK protects PREFETCH_SCHEDULE,
+   PREFETCH_NEXT and the state of the entries against the helpers.
+   PREFETCH_WORK is signalled when a section is queued or the helpers
+   are to exit, PREFETCH_DONE when a helper is done with a section.  */
+static pthread_t *prefetch_threads;
+static int n_prefetch_threads;
+static bool prefetch_exit;
+static pthread_mutex_t prefetch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t prefetch_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t prefetch_done = PTHREAD_COND_INITIALIZER;
+
+/* Hash and equality functions for PREFETCH_TABLE.  */
+
+static hashval_t
+hash_prefetch (const void *p)
+{
+  const struct lto_prefetch *entry = (const struct lto_prefetch *) p;
+  hashval_t hash = htab_hash_pointer (entry->file_data);
+
+  hash = iterative_hash_hashval_t (entry->section_type, hash);
+  if (entry->name)
+    hash = iterative_hash_hashval_t (htab_hash_string (entry->name), hash);
+  return hash;
+}
+
+static int
+eq_prefetch (const void *p1, const void *p2)
+{
+  const struct lto_prefetch *entry1 = (const struct lto_prefetch *) p1;
+  const struct lto_prefetch *entry2 = (const struct lto_prefetch *) p2;
+
+  return (entry1->file_data == entry2->file_data
+	  && entry1->section_type == entry2->section_type
+	  && (entry1->name == entry2->name
+	      || (entry1->name && entry2->name
+		  && strcmp (entry1->name, entry2->name) == 0)));
+}
+
+/* The body of the helper threads: decompress the queued sections in
+   schedule order until told to exit.  */
+
+static void *
+lto_prefetch_thread (void *)
+{
+  pthread_mutex_lock (&prefetch_lock);
+  for (;;)
+    {
+      struct lto_prefetch *entry = NULL;
+
+      while (!entry && prefetch_next_run < prefetch_next)
+	{
+	  entry = prefetch_schedule[prefetch_next_run++];
+	  if (entry && entry->state != LTO_PREFETCH_QUEUED)
+	    entry = NULL;
+	}
+
+      if (!entry)
+	{
+	  if (prefetch_exit)
+	    break;
+	  pthread_cond_wait (&prefetch_work, &prefetch_lock);
+	  continue;
+	}
+
+      entry->state = LTO_PREFETCH_RUNNING;
+      pthread_mutex_unlock (&prefetch_lock);
+      entry->buffer = lto_decompress_section (entry->data, entry->len,
+					      &entry->uncompressed_len,
+					      &entry->seconds, &entry->error);
+      pthread_mutex_lock (&prefetch_lock);
+      entry->state = LTO_PREFETCH_DONE;
+      pthread_cond_broadcast (&prefetch_done);
+    }
+  pthread_mutex_unlock (&prefetch_lock);
+  return NULL;
+}
+
+/* Start the helper threads, as many of them as
+   PARAM_LTO_DECOMPRESS_THREADS asks for and the host allows.  */
+
+static void
+lto_start_prefetch_threads (void)
+{
+  int n = PARAM_VALUE (PARAM_LTO_DECOMPRESS_THREADS);
+  sigset_t all_signals, old_signals;
+
+  prefetch_threads = XNEWVEC (pthread_t, n);
+  prefetch_table = htab_create (37, hash_prefetch, eq_prefetch, NULL);
+
+  /* Leave all signals to the main thread.  */
+  sigfillset (&all_signals);
+  pthread_sigmask (SIG_SETMASK, &all_signals, &old_signals);
+  while (n_prefetch_threads < n
+	 && pthread_create (&prefetch_threads[n_prefetch_threads], NULL,
+			    lto_prefetch_thread, NULL) == 0)
+    n_prefetch_threads++;
+  pthread_sigmask (SIG_SETMASK, &old_signals, NULL);
+
+  decompress_stats.threads = MAX (decompress_stats.threads,
+				  n_prefetch_threads);
+}
+
+/* Remove ENTRY, the first entry for its section, from PREFETCH_TABLE.  */
+
+static void
+lto_unhash_prefetch (struct lto_prefetch *entry)
+{
+  void **slot = htab_find_slot (prefetch_table, entry, NO_INSERT);
+
+  gcc_assert (slot && *slot == entry);
+  if (entry->next_same)
+    *slot = entry->next_same;
+  else
+    htab_clear_slot (prefetch_table, slot);
+}
+
+/* Read scheduled sections from their files and queue them for the
+   helpers until PARAM_LTO_PREFETCH_WINDOW of them are in flight.  */
+
+static void
+lto_fill_prefetch_window (void)
+{
+  unsigned window = PARAM_VALUE (PARAM_LTO_PREFETCH_WINDOW);
+
+  while (prefetch_in_flight < window
+	 && prefetch_next < prefetch_schedule.length ())
+    {
+      struct lto_prefetch *entry = prefetch_schedule[prefetch_next];
+
+      if (entry)
+	entry->data = (get_section_f) (entry->file_data, entry->section_type,
+				       entry->name, &entry->len);
+
+      pthread_mutex_lock (&prefetch_lock);
+      if (entry && entry->data)
+	{
+	  entry->state = LTO_PREFETCH_QUEUED;
+	  prefetch_in_flight++;
+	  pthread_cond_signal (&prefetch_work);
+	}
+      else if (entry)
+	{
+	  /* The section doesn't exist; lto_get_section_data will find
+	     out by itself.  */
+	  prefetch_schedule[prefetch_next] = NULL;
+	  lto_unhash_prefetch (entry);
+	  free (entry->name);
+	  free (entry);
+	}
+      prefetch_next++;
+      pthread_mutex_unlock (&prefetch_lock);
+    }
+}
+
+/* Remove ENTRY from the schedule, waiting for the helper decompressing
+   it if there is one.  Once this returns, the state of ENTRY is no
+   longer LTO_PREFETCH_RUNNING.  */
+
+static void
+lto_unschedule_prefetch (struct lto_prefetch *entry)
+{
+  lto_unhash_prefetch (entry);
+
+  pthread_mutex_lock (&prefetch_lock);
+  prefetch_schedule[entry->index] = NULL;
+  if (entry->state == LTO_PREFETCH_RUNNING)
+    {
+      timevar_push (TV_IPA_LTO_DECOMPRESS_WAIT);
+      while (entry->state == LTO_PREFETCH_RUNNING)
+	pthread_cond_wait (&prefetch_done, &prefetch_lock);
+      timevar_pop (TV_IPA_LTO_DECOMPRESS_WAIT);
+    }
+  pthread_mutex_unlock (&prefetch_lock);
+
+  if (entry->state != LTO_PREFETCH_SCHEDULED)
+    prefetch_in_flight--;
+}
+
+/* Drop the scheduled ENTRY, freeing everything it holds.  */
+
+static void
+lto_drop_prefetch (struct lto_prefetch *entry)
+{
+  lto_unschedule_prefetch (entry);
+  if (entry->state != LTO_PREFETCH_SCHEDULED)
+    (free_section_f) (entry->file_data, entry->section_type, entry->name,
+		      entry->data, entry->len);
+  free (entry->buffer);
+  free (entry->name);
+  free (entry);
+}
+
+/* If the section of SECTION_TYPE with NAME in FILE_DATA is scheduled,
+   remove it from the schedule and return its entry, which the caller
+   must free; otherwise return NULL.  The entry is not returned while
+   a helper is still decompressing the section.  */
+
+static struct lto_prefetch *
+lto_take_prefetch (struct lto_file_decl_data *file_data,
+		   enum lto_section_type section_type,
+		   const char *name)
+{
+  struct lto_prefetch key, *entry;
+
+  if (!prefetch_table)
+    return NULL;
+
+  key.file_data = file_data;
+  key.section_type = section_type;
+  key.name = CONST_CAST (char *, name);
+  entry = (struct lto_prefetch *) htab_find (prefetch_table, &key);
+  if (!entry)
+    return NULL;
+
+  /* The sections scheduled before this one are not going to be read.  */
+  for (; prefetch_first < entry->index; prefetch_first++)
+    if (prefetch_schedule[prefetch_first])
+      lto_drop_prefetch (prefetch_schedule[prefetch_first]);
+  prefetch_first++;
+
+  lto_unschedule_prefetch (entry);
+  lto_fill_prefetch_window ();
+  return entry;
+}
+
+/* Schedule the section of SECTION_TYPE with NAME in FILE_DATA to be
+   decompressed by the helper threads ahead of its use.  Sections
+   should be scheduled in the order lto_get_section_data is going to
+   be asked for them, as often as it is going to be asked for them.  */
+
+void
+lto_prefetch_section_data (struct lto_file_decl_data *file_data,
+			   enum lto_section_type section_type,
+			   const char *name)
+{
+  struct lto_prefetch *entry, *last;
+  void **slot;
+
+  /* FIXME lto: WPA mode does not write compressed sections, so there
+     is nothing to decompress if flag_ltrans.  */
+  if (flag_ltrans || PARAM_VALUE (PARAM_LTO_DECOMPRESS_THREADS) == 0)
+    return;
+
+  if (!prefetch_threads)
+    lto_start_prefetch_threads ();
+  if (n_prefetch_threads == 0)
+    return;
+
+  entry = XCNEW (struct lto_prefetch);
+  entry->file_data = file_data;
+  entry->section_type = section_type;
+  entry->name = name ? xstrdup (name) : NULL;
+  slot = htab_find_slot (prefetch_table, entry, INSERT);
+  if (*slot)
+    {
+      for (last = (struct lto_prefetch *) *slot; last->next_same;
+	   last = last->next_same)
+	;
+      last->next_same = entry;
+    }
+  else
+    *slot = entry;
+
+  pthread_mutex_lock (&prefetch_lock);
+  entry->index = prefetch_schedule.length ();
+  prefetch_schedule.safe_push (entry);
+  pthread_mutex_unlock (&prefetch_lock);
+
+  lto_fill_prefetch_window ();
+}
+
+/* Drop the sections that are still scheduled and stop the helper
+   threads.  */
+
+void
+lto_finish_section_prefetch (void)
+{
+  unsigned i;
+
+  if (!prefetch_threads)
+    return;
+
+  for (i = prefetch_first; i < prefetch_schedule.length (); i++)
+    if (prefetch_schedule[i])
+      lto_drop_prefetch (prefetch_schedule[i]);
+  gcc_assert (prefetch_in_flight == 0);
+
+  pthread_mutex_lock (&prefetch_lock);
+  prefetch_exit = true;
+  pthread_cond_broadcast (&prefetch_work);
+  pthread_mutex_unlock (&prefetch_lock);
+  for (i = 0; i < (unsigned) n_prefetch_threads; i++)
+    pthread_join (prefetch_threads[i], NULL);
+
+  free (prefetch_threads);
+  prefetch_threads = NULL;
+  n_prefetch_threads = 0;
+  prefetch_exit = false;
+  prefetch_schedule.release ();
+  htab_delete (prefetch_table);
+  prefetch_table = NULL;
+  prefetch_first = prefetch_next = prefetch_next_run = 0;
+}
+
+#else /* !HAVE_PTHREAD */
+
+/* Without threads, sections are always decompressed when they are
+   read.  */
+
+void
+lto_prefetch_section_data (struct lto_file_decl_data *,
+			   enum lto_section_type, const char *)
+{
+}
+
+void
+lto_finish_section_prefetch (void)
+{
+}
+
+#endif /* !HAVE_PTHREAD */
+
+/* Print the statistics about the decompression of sections to FILE,
+   for -ftime-report.  */
+
+void
+lto_print_decompression_stats (FILE *file)
+{
+  const double mb = 1024 * 1024;
+
+  if (decompress_stats.sections == 0)
+    return;
+
+  fprintf (file, "\nLTO decompression: %u sections, %u of them ahead of use "
+	   "by %d threads\n", decompress_stats.sections,
+	   decompress_stats.prefetched, decompress_stats.threads);
+  fprintf (file, " %lu kB to %lu kB in %.2f s (%.1f MB/s)\n",
+	   (unsigned long) (decompress_stats.compressed_bytes >> 10),
+	   (unsigned long) (decompress_stats.uncompressed_bytes >> 10),
+	   decompress_stats.seconds,
+	   decompress_stats.seconds > 0
+	   ? decompress_stats.uncompressed_bytes / mb / decompress_stats.seconds
+	   : 0.0);
+}
+
 /* Return a char pointer to the start of a data stream for an LTO pass
    or function.  FILE_DATA indicates where to obtain the data.
    SECTION_TYPE is the type of information to be obtained.  NAME is
@@ -140,38 +602,70 @@ lto_get_section_data (struct lto_file_decl_data *file_data,
 		      const char *name,
 		      size_t *len)
 {
-  const char *data = (get_section_f) (file_data, section_type, name, len);
   const size_t header_length = sizeof (struct lto_data_header);
-  struct lto_data_header *header;
-  struct lto_buffer buffer;
-  struct lto_compression_stream *stream;
-  lto_stats.section_size[section_type] += *len;
-
-  if (data == NULL)
-    return NULL;
+  const char *data = NULL;
+  char *buffer = NULL;
+  size_t uncompressed_len = 0;
+  double seconds = 0;
+  const char *error = NULL;
+  bool prefetched = false;
 
   /* FIXME lto: WPA mode does not write compressed sections, so for now
      suppress uncompression if flag_ltrans.  */
   if (flag_ltrans)
-    return data;
+    {
+      data = (get_section_f) (file_data, section_type, name, len);
+      lto_stats.section_size[section_type] += *len;
+      return data;
+    }
 
-  /* Create a mapping header containing the underlying data and length,
-     and prepend this to the uncompression buffer.  The uncompressed data
-     then follows, and a pointer to the start of the uncompressed data is
-     returned.  */
-  header = (struct lto_data_header *) xmalloc (header_length);
-  header->data = data;
-  header->len = *len;
+#ifdef HAVE_PTHREAD
+  struct lto_prefetch *entry = lto_take_prefetch (file_data, section_type,
+						  name);
+  if (entry)
+    {
+      data = entry->data;
+      *len = entry->len;
+      if (entry->state == LTO_PREFETCH_DONE)
+	{
+	  buffer = entry->buffer;
+	  uncompressed_len = entry->uncompressed_len;
+	  seconds = entry->seconds;
+	  error = entry->error;
+	  prefetched = true;
+	}
+      free (entry->name);
+      free (entry);
+    }
+#endif
 
-  buffer.data = (char *) header;
-  buffer.length = header_length;
+  if (data == NULL)
+    data = (get_section_f) (file_data, section_type, name, len);
+  lto_stats.section_size[section_type] += *len;
 
-  stream = lto_start_uncompression (lto_append_data, &buffer);
-  lto_uncompress_block (stream, data, *len);
-  lto_end_uncompression (stream);
+  if (data == NULL)
+    return NULL;
 
-  *len = buffer.length - header_length;
-  return buffer.data + header_length;
+  if (!prefetched)
+    {
+      timevar_push (TV_IPA_LTO_DECOMPRESS);
+      buffer = lto_decompress_section (data, *len, &uncompressed_len,
+				       &seconds, &error);
+      timevar_pop (TV_IPA_LTO_DECOMPRESS);
+    }
+  if (buffer == NULL)
+    internal_error ("compressed stream: %s", error);
+
+  lto_stats.num_input_il_bytes += *len;
+  lto_stats.num_uncompressed_il_bytes += uncompressed_len;
+  decompress_stats.sections++;
+  decompress_stats.prefetched += prefetched;
+  decompress_stats.compressed_bytes += *len;
+  decompress_stats.uncompressed_bytes += uncompressed_len;
+  decompress_stats.seconds += seconds;
+
+  *len = uncompressed_len;
+  return buffer + header_length;
 }
 
 
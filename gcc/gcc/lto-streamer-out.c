@@ -858,7 +858,7 @@ lto_output_toplevel_asms (void)
   for (can = asm_nodes; can; can = can->next)
     {
       streamer_write_string_cst (ob, ob->main_stream, can->asm_str);
-      streamer_write_hwi (ob, can->order);
+      streamer_write_hwi (ob, lto_output_order (can->order));
     }
 
   streamer_write_string_cst (ob, ob->main_stream, NULL_TREE);
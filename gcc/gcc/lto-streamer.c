@@ -166,11 +166,16 @@ lto_get_section_name (int section_type, const char *name, struct lto_file_decl_d
      doesn't confuse the reader with merged sections.
 
      For options don't add a ID, the option reader cannot deal with them
-     and merging should be ok here. */
+     and merging should be ok here.  The LTRANS units written by WPA are
+     never combined, so they are written with a fixed ID; that keeps them
+     identical from one link to the next for the LTRANS cache of
+     lto-wrapper.  */
   if (section_type == LTO_section_opts)
     strcpy (post, "");
   else if (f != NULL) 
     sprintf (post, "." HOST_WIDE_INT_PRINT_HEX_PURE, f->id);
+  else if (flag_wpa)
+    strcpy (post, ".0");
   else
     sprintf (post, "." HOST_WIDE_INT_PRINT_HEX_PURE, get_random_seed (false)); 
   return concat (LTO_SECTION_NAME_PREFIX, sep, add, post, NULL);
@@ -35,6 +35,17 @@ along with GCC; see the file COPYING3.  If not see
    If WHOPR is used instead, more than one file might be produced
    ./ccXj2DTk.lto.ltrans.o
    ./ccCJuXGv.lto.ltrans.o
+
+   With -flto=N or -flto=jobserver, the LTRANS compilations run in
+   parallel.  Each file is printed as soon as it and the files before
+   it are complete, so the linker plugin can add it right away while
+   the link order stays the same.
+
+   With -flto-incremental=DIR, the output of each LTRANS compilation is
+   kept in DIR under the MD5 sum of its input and options.  When a later
+   link produces the same partition again, the cached object is copied
+   instead of compiling it.  DIR is created if needed; nothing is ever
+   removed from it.
 */
 
 #include "config.h"
@@ -46,6 +57,12 @@ along with GCC; see the file COPYING3.  If not see
 #include "opts.h"
 #include "options.h"
 #include "simple-object.h"
+#include "md5.h"
+#include "version.h"
+
+#ifdef HAVE_SYS_SELECT_H
+#include <sys/select.h>
+#endif
 
 /* From lto-streamer.h which we cannot include with -fkeep-inline-functions.
    ???  Split out a lto-streamer-core.h.  */
@@ -67,14 +84,54 @@ enum lto_mode_d {
 static enum lto_mode_d lto_mode = LTO_MODE_NONE;
 
 static char *ltrans_output_file;
+static char *ltrans_estimates_file;
+static const char *ltrans_cache_dir;
 static char *flto_out;
 static char *args_name;
 static unsigned int nr;
 static char **input_names;
 static char **output_names;
-static char *makefile;
+
+/* An LTRANS compilation.  */
+
+struct ltrans_job
+{
+  /* The command line, or NULL if the input file is passed through.  */
+  char **argv;
+
+  /* The file holding the command line while the compilation runs.  */
+  char *args_name;
+
+  /* The running compilation, and the read end of its standard output,
+     or -1 if it isn't read.  */
+  struct pex_obj *pex;
+  int output_fd;
+
+  /* The jobserver token the compilation runs under, or -1 if it
+     doesn't hold one.  */
+  int token;
+
+  /* True if the output file is complete.  */
+  bool done;
+
+  /* With -flto-incremental, the file in the LTRANS cache that holds the
+     output of the compilation.  */
+  char *cache_name;
+
+  /* With -v, the user and system time the compilation took.  */
+  double seconds;
+};
+
+/* The LTRANS compilations, one for each of the NR input files.  */
+static struct ltrans_job *ltrans_jobs;
+
+/* The file descriptors of the GNU make jobserver that tokens are read
+   from and written back to, or -1 if there is none.  */
+static int jobserver_rfd = -1;
+static int jobserver_wfd = -1;
 
 static void maybe_unlink_file (const char *);
+static void release_token (int);
 
  /* Delete tempfiles.  */
 
@@ -93,18 +150,26 @@ lto_wrapper_cleanup (void)
 
   if (ltrans_output_file)
     maybe_unlink_file (ltrans_output_file);
+  if (ltrans_estimates_file)
+    maybe_unlink_file (ltrans_estimates_file);
   if (flto_out)
     maybe_unlink_file (flto_out);
   if (args_name)
     maybe_unlink_file (args_name);
-  if (makefile)
-    maybe_unlink_file (makefile);
   for (i = 0; i < nr; ++i)
     {
       maybe_unlink_file (input_names[i]);
       if (output_names[i])
 	maybe_unlink_file (output_names[i]);
     }
+  if (ltrans_jobs)
+    for (i = 0; i < nr; ++i)
+      {
+	if (ltrans_jobs[i].args_name)
+	  maybe_unlink_file (ltrans_jobs[i].args_name);
+	if (ltrans_jobs[i].pex)
+	  release_token (ltrans_jobs[i].token);
+      }
 }
 
 static void
@@ -155,10 +220,11 @@ fatal_perror (const char *cmsgid, ...)
 
 
 /* Execute a program, and wait for the reply. ARGV are the arguments. The
-   last one must be NULL. */
+   last one must be NULL.  FLAGS are passed to pex_init; with PEX_USE_PIPES
+   the standard output of the program can be read with pex_read_output.  */
 
 static struct pex_obj *
-collect_execute (char **argv)
+collect_execute (char **argv, int flags)
 {
   struct pex_obj *pex;
   const char *errmsg;
@@ -178,7 +244,7 @@ collect_execute (char **argv)
   fflush (stdout);
   fflush (stderr);
 
-  pex = pex_init (0, "lto-wrapper", NULL);
+  pex = pex_init (flags, "lto-wrapper", NULL);
   if (pex == NULL)
     fatal_perror ("pex_init failed");
 
@@ -251,35 +317,46 @@ maybe_unlink_file (const char *file)
 }
 
 
-/* Execute program ARGV[0] with arguments ARGV. Wait for it to finish.  */
+/* Write the arguments of ARGV[0], ARGV[1...], to the temporary file
+   NAME.  Return the argument that makes ARGV[0] read them.  */
 
-static void
-fork_execute (char **argv)
+static char *
+write_args_file (char **argv, const char *name)
 {
-  struct pex_obj *pex;
-  char *new_argv[3];
-  char *at_args;
   FILE *args;
   int status;
 
-  args_name = make_temp_file (".args");
-  at_args = concat ("@", args_name, NULL);
-  args = fopen (args_name, "w");
+  args = fopen (name, "w");
   if (args == NULL)
-    fatal ("failed to open %s", args_name);
+    fatal ("failed to open %s", name);
 
   status = writeargv (&argv[1], args);
 
   if (status)
-    fatal ("could not write to temporary file %s",  args_name);
+    fatal ("could not write to temporary file %s",  name);
 
   fclose (args);
 
+  return concat ("@", name, NULL);
+}
+
+/* Execute program ARGV[0] with arguments ARGV. Wait for it to finish.  */
+
+static void
+fork_execute (char **argv)
+{
+  struct pex_obj *pex;
+  char *new_argv[3];
+  char *at_args;
+
+  args_name = make_temp_file (".args");
+  at_args = write_args_file (argv, args_name);
+
   new_argv[0] = argv[0];
   new_argv[1] = at_args;
   new_argv[2] = NULL;
 
-  pex = collect_execute (new_argv);
+  pex = collect_execute (new_argv, 0);
   collect_wait (new_argv[0], pex);
 
   maybe_unlink_file (args_name);
@@ -287,6 +364,458 @@ fork_execute (char **argv)
   free (at_args);
 }
 
+/* Look for the GNU make jobserver in MAKEFLAGS and set JOBSERVER_RFD and
+   JOBSERVER_WFD if it is available.  Return true if so.  */
+
+static bool
+jobserver_init (void)
+{
+#ifdef HAVE_SYS_SELECT_H
+  const char *makeflags = getenv ("MAKEFLAGS");
+  const char *auth = NULL, *p;
+  static const char *const options[]
+    = { "--jobserver-auth=", "--jobserver-fds=" };
+  unsigned i;
+  int rfd, wfd;
+
+  if (!makeflags)
+    return false;
+
+  /* The last option wins; make 4.2 renamed --jobserver-fds.  */
+  for (i = 0; i < ARRAY_SIZE (options); i++)
+    for (p = makeflags; (p = strstr (p, options[i])) != NULL; p++)
+      if (!auth || p > auth)
+	auth = p + strlen (options[i]);
+  if (!auth)
+    return false;
+
+  if (strncmp (auth, "fifo:", 5) == 0)
+    {
+      /* Since make 4.4, the jobserver may be a named pipe.  */
+      char *path = xstrdup (auth + 5);
+
+      path[strcspn (path, " ")] = '\0';
+      rfd = wfd = open (path, O_RDWR);
+      free (path);
+      if (rfd < 0)
+	return false;
+    }
+  else if (sscanf (auth, "%d,%d", &rfd, &wfd) != 2
+	   || rfd < 0 || wfd < 0
+	   /* make closes the file descriptors for commands that it doesn't
+	      consider recursive.  */
+	   || fcntl (rfd, F_GETFD) < 0 || fcntl (wfd, F_GETFD) < 0)
+    return false;
+
+  jobserver_rfd = rfd;
+  jobserver_wfd = wfd;
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* Give TOKEN, if it is a jobserver token, back to the jobserver.  */
+
+static void
+release_token (int token)
+{
+  unsigned char c = token;
+
+  if (token < 0)
+    return;
+  while (write (jobserver_wfd, &c, 1) < 0 && errno == EINTR)
+    ;
+}
+
+#ifdef HAVE_SYS_SELECT_H
+/* A duplicate of JOBSERVER_RFD that a token is being read from, or -1.
+   SIGCHLD closes it, so that the read doesn't block once one of our
+   compilations is done; the read might otherwise wait for a token that
+   only we can give back.  This is how make itself reads tokens.  */
+static volatile int jobserver_rfd_dup = -1;
+
+static void
+jobserver_sigchld (int signum ATTRIBUTE_UNUSED)
+{
+  if (jobserver_rfd_dup >= 0)
+    {
+      close (jobserver_rfd_dup);
+      jobserver_rfd_dup = -1;
+    }
+}
+
+/* Read a token from the jobserver.  SIGCHLD is blocked while the LTRANS
+   compilations run, except here; if one of them finished in the
+   meantime, the pending signal makes the read fail at once.  Return the
+   token, or -1 if there wasn't one.  */
+
+static int
+jobserver_get_token (sigset_t *sigchld)
+{
+  unsigned char c;
+  ssize_t n;
+  int fd;
+
+  fd = dup (jobserver_rfd);
+  if (fd < 0)
+    fatal_perror ("dup");
+  jobserver_rfd_dup = fd;
+
+  sigprocmask (SIG_UNBLOCK, sigchld, NULL);
+  n = read (fd, &c, 1);
+  sigprocmask (SIG_BLOCK, sigchld, NULL);
+
+  /* Don't ask again if the jobserver has gone away.  */
+  if (n == 0)
+    jobserver_rfd = -1;
+
+  if (jobserver_rfd_dup >= 0)
+    {
+      close (jobserver_rfd_dup);
+      jobserver_rfd_dup = -1;
+    }
+  return n == 1 ? c : -1;
+}
+#endif
+
+/* Return the name of the file in the LTRANS cache for the compilation of
+   INPUT_NAME with the ARGC arguments ARGV: the MD5 sum of the compiler
+   version, the arguments and the contents of INPUT_NAME.  */
+
+static char *
+ltrans_cache_name (const char *input_name, const char **argv, int argc)
+{
+  struct md5_ctx ctx;
+  unsigned char digest[16];
+  char hex[sizeof (digest) * 2 + 1];
+  char buf[4096];
+  size_t n;
+  FILE *stream;
+  int i;
+
+  md5_init_ctx (&ctx);
+  md5_process_bytes (version_string, strlen (version_string) + 1, &ctx);
+  for (i = 0; i < argc; i++)
+    md5_process_bytes (argv[i], strlen (argv[i]) + 1, &ctx);
+
+  stream = fopen (input_name, "rb");
+  if (!stream)
+    fatal_perror ("fopen: %s", input_name);
+  while ((n = fread (buf, 1, sizeof (buf), stream)) > 0)
+    md5_process_bytes (buf, n, &ctx);
+  fclose (stream);
+  md5_finish_ctx (&ctx, digest);
+
+  for (i = 0; i < (int) sizeof (digest); i++)
+    sprintf (&hex[i * 2], "%02x", digest[i]);
+  return concat (ltrans_cache_dir, "/", hex, ".o", NULL);
+}
+
+/* Copy the file FROM to TO.  Return false if FROM can't be opened or
+   the copy fails.  */
+
+static bool
+copy_file (const char *from, const char *to)
+{
+  FILE *in, *out;
+  char buf[4096];
+  size_t n;
+  bool ok = true;
+
+  in = fopen (from, "rb");
+  if (!in)
+    return false;
+  out = fopen (to, "wb");
+  if (!out)
+    {
+      fclose (in);
+      return false;
+    }
+  while ((n = fread (buf, 1, sizeof (buf), in)) > 0)
+    if (fwrite (buf, 1, n, out) != n)
+      {
+	ok = false;
+	break;
+      }
+  if (ferror (in))
+    ok = false;
+  fclose (in);
+  if (fclose (out) != 0)
+    ok = false;
+  return ok;
+}
+
+/* Put the output OUTPUT_NAME of JOB into the LTRANS cache.  It is copied
+   under a name of its own and renamed, so that concurrent links never
+   see a partial file.  */
+
+static void
+store_in_ltrans_cache (struct ltrans_job *job, const char *output_name)
+{
+  char suffix[32];
+  char *tmp_name;
+
+  sprintf (suffix, ".%ld", (long) getpid ());
+  tmp_name = concat (job->cache_name, suffix, NULL);
+  if (!copy_file (output_name, tmp_name)
+      || rename (tmp_name, job->cache_name) != 0)
+    {
+      fprintf (stderr, "lto-wrapper: warning: can't write %s to the "
+	       "LTRANS cache\n", job->cache_name);
+      unlink_if_ordinary (tmp_name);
+    }
+  free (tmp_name);
+}
+
+/* Return true if JOB is a compilation that is still to be run, not a
+   pass-through file or a partition found in the LTRANS cache.  */
+
+static inline bool
+ltrans_job_pending_p (struct ltrans_job *job)
+{
+  return job->argv && !job->done;
+}
+
+/* Start the LTRANS compilation JOB under jobserver token TOKEN, or -1.
+   Its standard output is read if READ_OUTPUT, to find out when it is
+   done.  */
+
+static void
+start_ltrans_job (struct ltrans_job *job, int token, bool read_output)
+{
+  char *new_argv[3];
+  char *at_args;
+
+  job->args_name = make_temp_file (".args");
+  at_args = write_args_file (job->argv, job->args_name);
+
+  new_argv[0] = job->argv[0];
+  new_argv[1] = at_args;
+  new_argv[2] = NULL;
+
+  job->token = token;
+  job->pex = collect_execute (new_argv,
+			      (read_output ? PEX_USE_PIPES : 0)
+			      | (verbose ? PEX_RECORD_TIMES : 0));
+  job->output_fd = -1;
+  if (read_output)
+    {
+      FILE *output = pex_read_output (job->pex, 0);
+
+      if (!output)
+	fatal_perror ("can't read LTRANS output");
+      job->output_fd = fileno (output);
+    }
+  free (at_args);
+}
+
+/* Wait for the LTRANS compilation JOB to finish.  */
+
+static void
+finish_ltrans_job (struct ltrans_job *job, unsigned i)
+{
+  struct pex_time time;
+
+  if (verbose && pex_get_times (job->pex, 1, &time))
+    job->seconds = (time.user_seconds + time.system_seconds
+		    + (time.user_microseconds + time.system_microseconds) * 1e-6);
+  collect_wait (job->argv[0], job->pex);
+  job->pex = NULL;
+  release_token (job->token);
+
+  maybe_unlink_file (job->args_name);
+  free (job->args_name);
+  job->args_name = NULL;
+  if (job->cache_name)
+    store_in_ltrans_cache (job, output_names[i]);
+  maybe_unlink_file (input_names[i]);
+  job->done = true;
+}
+
+/* Run the LTRANS compilations, PARALLEL at a time, or as many as the
+   jobserver allows if JOBSERVER.  The output files are printed in order
+   as soon as they are complete.  */
+
+static void
+run_ltrans_jobs (int parallel, bool jobserver)
+{
+  unsigned next = 0, printed = 0, i;
+  int free_slots = jobserver ? 1 : MAX (parallel, 1);
+  bool read_output = false;
+#ifdef HAVE_SYS_SELECT_H
+  struct sigaction action, old_action;
+  sigset_t sigchld;
+
+  /* The standard output of the compilations tells when they are done;
+     it must not end up in ours.  */
+  read_output = parallel > 1 || jobserver;
+  sigemptyset (&sigchld);
+  sigaddset (&sigchld, SIGCHLD);
+  if (jobserver)
+    {
+      memset (&action, 0, sizeof (action));
+      action.sa_handler = jobserver_sigchld;
+      sigemptyset (&action.sa_mask);
+      sigaction (SIGCHLD, &action, &old_action);
+    }
+#else
+  gcc_assert (!jobserver);
+#endif
+
+  for (;;)
+    {
+      int token = -1;
+
+      /* Start compilations while there are free slots.  */
+      while (next < nr
+	     && (!ltrans_job_pending_p (&ltrans_jobs[next]) || free_slots > 0))
+	{
+	  if (ltrans_job_pending_p (&ltrans_jobs[next]))
+	    {
+	      start_ltrans_job (&ltrans_jobs[next], -1, read_output);
+	      free_slots--;
+	    }
+	  else
+	    ltrans_jobs[next].done = true;
+	  next++;
+	}
+
+      /* Print the files that are complete.  */
+      while (printed < nr && ltrans_jobs[printed].done)
+	{
+	  fputs (output_names[printed++], stdout);
+	  putc ('\n', stdout);
+	  fflush (stdout);
+	}
+      if (printed == nr)
+	break;
+
+#ifdef HAVE_SYS_SELECT_H
+      if (read_output)
+	{
+	  bool want_token = jobserver && next < nr && jobserver_rfd >= 0;
+	  fd_set fds;
+	  int max_fd = -1;
+
+	  FD_ZERO (&fds);
+	  for (i = printed; i < next; i++)
+	    if (ltrans_jobs[i].pex)
+	      {
+		FD_SET (ltrans_jobs[i].output_fd, &fds);
+		max_fd = MAX (max_fd, ltrans_jobs[i].output_fd);
+	      }
+	  if (want_token)
+	    {
+	      FD_SET (jobserver_rfd, &fds);
+	      max_fd = MAX (max_fd, jobserver_rfd);
+	    }
+
+	  if (jobserver)
+	    sigprocmask (SIG_BLOCK, &sigchld, NULL);
+	  if (select (max_fd + 1, &fds, NULL, NULL, NULL) < 0)
+	    {
+	      if (errno != EINTR)
+		fatal_perror ("select");
+	      FD_ZERO (&fds);
+	    }
+
+	  for (i = printed; i < next; i++)
+	    {
+	      struct ltrans_job *job = &ltrans_jobs[i];
+	      char buf[4096];
+	      ssize_t n;
+
+	      if (!job->pex || !FD_ISSET (job->output_fd, &fds))
+		continue;
+
+	      /* Pass anything the compilation prints on to stderr.  */
+	      n = read (job->output_fd, buf, sizeof (buf));
+	      if (n > 0)
+		fwrite (buf, 1, n, stderr);
+	      else if (n == 0 || errno != EINTR)
+		{
+		  finish_ltrans_job (job, i);
+		  if (job->token < 0)
+		    free_slots++;
+		}
+	    }
+
+	  if (want_token && FD_ISSET (jobserver_rfd, &fds))
+	    token = jobserver_get_token (&sigchld);
+	  if (jobserver)
+	    sigprocmask (SIG_UNBLOCK, &sigchld, NULL);
+	}
+      else
+#endif
+	{
+	  /* Without a way to wait for any of them, wait for the oldest
+	     compilation.  */
+	  for (i = printed; !ltrans_jobs[i].pex; i++)
+	    ;
+	  finish_ltrans_job (&ltrans_jobs[i], i);
+	  free_slots++;
+	}
+
+      if (token >= 0)
+	{
+	  /* Find the next compilation to run under the token.  */
+	  while (next < nr && !ltrans_job_pending_p (&ltrans_jobs[next]))
+	    ltrans_jobs[next++].done = true;
+	  if (next < nr)
+	    start_ltrans_job (&ltrans_jobs[next++], token, read_output);
+	  else
+	    release_token (token);
+	}
+    }
+
+#ifdef HAVE_SYS_SELECT_H
+  if (jobserver)
+    sigaction (SIGCHLD, &old_action, NULL);
+#endif
+}
+
+/* Print how the estimates of the WPA stage for each LTRANS partition,
+   read from LTRANS_ESTIMATES_FILE, compare to the time the compilations
+   took.  The share of the estimated size of a partition in all of them
+   is the predicted share of its compilation in the LTRANS time.  */
+
+static void
+print_ltrans_estimates (void)
+{
+  FILE *stream = fopen (ltrans_estimates_file, "r");
+  int *insns = XCNEWVEC (int, nr), *memory = XCNEWVEC (int, nr);
+  double total_insns = 0, total_seconds = 0;
+  unsigned i;
+
+  if (!stream)
+    fatal_perror ("fopen: %s", ltrans_estimates_file);
+  for (i = 0; i < nr; i++)
+    {
+      if (!ltrans_jobs[i].argv)
+	continue;
+      if (fscanf (stream, "%d %d", &insns[i], &memory[i]) != 2)
+	fatal ("malformed LTRANS estimates %s", ltrans_estimates_file);
+      total_insns += insns[i];
+      total_seconds += ltrans_jobs[i].seconds;
+    }
+  fclose (stream);
+
+  fprintf (stderr, "LTRANS partitions: estimated size, memory and share of "
+	   "time; actual time and share\n");
+  for (i = 0; i < nr; i++)
+    if (ltrans_jobs[i].argv)
+      fprintf (stderr, "  %s: %d insns, %d kB, %.1f%%; %.2f s, %.1f%%\n",
+	       input_names[i], insns[i], memory[i],
+	       total_insns > 0 ? insns[i] * 100 / total_insns : 0.0,
+	       ltrans_jobs[i].seconds,
+	       total_seconds > 0
+	       ? ltrans_jobs[i].seconds * 100 / total_seconds : 0.0);
+
+  free (insns);
+  free (memory);
+}
+
 /* Template of LTRANS dumpbase suffix.  */
 #define DUMPBASE_SUFFIX ".ltrans18446744073709551615"
 
@@ -618,6 +1147,10 @@ run_gcc (unsigned argc, char *argv[])
 	  no_partition = true;
 	  break;
 
+	case OPT_flto_incremental_:
+	  ltrans_cache_dir = option->arg;
+	  continue;
+
 	case OPT_flto_:
 	  if (strcmp (option->arg, "jobserver") == 0)
 	    {
@@ -659,6 +1192,14 @@ run_gcc (unsigned argc, char *argv[])
       parallel = 0;
     }
 
+  if (jobserver && !jobserver_init ())
+    {
+      fprintf (stderr, "lto-wrapper: warning: jobserver is not available, "
+	       "running LTRANS serially\n");
+      jobserver = 0;
+      parallel = 0;
+    }
+
   if (linker_output)
     {
       char *output_dir, *base, *name;
@@ -730,6 +1271,19 @@ run_gcc (unsigned argc, char *argv[])
       tmp += list_option_len;
       strcpy (tmp, ltrans_output_file);
 
+      /* With -v, have WPA write its estimates for the partitions, to
+	 compare them to the LTRANS compilations.  */
+      if (verbose)
+	{
+	  if (linker_output && debug)
+	    ltrans_estimates_file = concat (linker_output, ".ltrans.est", NULL);
+	  else
+	    ltrans_estimates_file = make_temp_file (".ltrans.est");
+	  obstack_ptr_grow (&argv_obstack, concat ("-fltrans-estimates=",
+						   ltrans_estimates_file,
+						   NULL));
+	}
+
       obstack_ptr_grow (&argv_obstack, "-fwpa");
     }
 
@@ -751,7 +1305,6 @@ run_gcc (unsigned argc, char *argv[])
   else
     {
       FILE *stream = fopen (ltrans_output_file, "r");
-      FILE *mstream = NULL;
       struct obstack env_obstack;
 
       if (!stream)
@@ -793,14 +1346,13 @@ cont:
       maybe_unlink_file (ltrans_output_file);
       ltrans_output_file = NULL;
 
-      if (parallel)
-	{
-	  makefile = make_temp_file (".mk");
-	  mstream = fopen (makefile, "w");
-	}
+      /* A missing cache directory is only reported when the first
+	 object can't be stored in it.  */
+      if (ltrans_cache_dir)
+	mkdir (ltrans_cache_dir, 0777);
 
-      /* Execute the LTRANS stage for each input file (or prepare a
-	 makefile to invoke this in parallel).  */
+      /* Prepare the LTRANS stage for each input file.  */
+      ltrans_jobs = XCNEWVEC (struct ltrans_job, nr);
       for (i = 0; i < nr; ++i)
 	{
 	  char *output_name;
@@ -832,71 +1384,50 @@ cont:
 	  argv_ptr[3] = output_name;
 	  argv_ptr[4] = input_name;
 	  argv_ptr[5] = NULL;
-	  if (parallel)
-	    {
-	      fprintf (mstream, "%s:\n\t@%s ", output_name, new_argv[0]);
-	      for (j = 1; new_argv[j] != NULL; ++j)
-		fprintf (mstream, " '%s'", new_argv[j]);
-	      fprintf (mstream, "\n");
-	      /* If we are not preserving the ltrans input files then
-	         truncate them as soon as we have processed it.  This
-		 reduces temporary disk-space usage.  */
-	      if (! debug)
-		fprintf (mstream, "\t@-touch -r %s %s.tem > /dev/null 2>&1 "
-			 "&& mv %s.tem %s\n",
-			 input_name, input_name, input_name, input_name); 
-	    }
-	  else
-	    {
-	      fork_execute (CONST_CAST (char **, new_argv));
-	      maybe_unlink_file (input_name);
-	    }
+	  ltrans_jobs[i].argv = dupargv (CONST_CAST (char **, new_argv));
 
 	  output_names[i] = output_name;
-	}
-      if (parallel)
-	{
-	  struct pex_obj *pex;
-	  char jobs[32];
-
-	  fprintf (mstream, "all:");
-	  for (i = 0; i < nr; ++i)
-	    fprintf (mstream, " \\\n\t%s", output_names[i]);
-	  fprintf (mstream, "\n");
-	  fclose (mstream);
-	  if (!jobserver)
-	    {
-	      /* Avoid passing --jobserver-fd= and similar flags 
-		 unless jobserver mode is explicitly enabled.  */
-	      putenv (xstrdup ("MAKEFLAGS="));
-	      putenv (xstrdup ("MFLAGS="));
-	    }
-	  new_argv[0] = getenv ("MAKE");
-	  if (!new_argv[0])
-	    new_argv[0] = "make";
-	  new_argv[1] = "-f";
-	  new_argv[2] = makefile;
-	  i = 3;
-	  if (!jobserver)
+
+	  /* Reuse the output of an earlier link for the same partition.
+	     Only the options before the per-partition file names are
+	     part of the key.  */
+	  if (ltrans_cache_dir)
 	    {
-	      snprintf (jobs, 31, "-j%d", parallel);
-	      new_argv[i++] = jobs;
+	      char *cache_name = ltrans_cache_name (input_name, new_argv,
+						     new_head_argc);
+
+	      if (copy_file (cache_name, output_name))
+		{
+		  if (verbose)
+		    fprintf (stderr, "[Reusing LTRANS %s for %s]\n",
+			     cache_name, input_name);
+		  maybe_unlink_file (input_name);
+		  ltrans_jobs[i].done = true;
+		  free (cache_name);
+		}
+	      else
+		ltrans_jobs[i].cache_name = cache_name;
 	    }
-	  new_argv[i++] = "all";
-	  new_argv[i++] = NULL;
-	  pex = collect_execute (CONST_CAST (char **, new_argv));
-	  collect_wait (new_argv[0], pex);
-	  maybe_unlink_file (makefile);
-	  makefile = NULL;
-	  for (i = 0; i < nr; ++i)
-	    maybe_unlink_file (input_names[i]);
 	}
+
+      run_ltrans_jobs (parallel, jobserver);
+
+      if (ltrans_estimates_file)
+	{
+	  print_ltrans_estimates ();
+	  maybe_unlink_file (ltrans_estimates_file);
+	  free (ltrans_estimates_file);
+	  ltrans_estimates_file = NULL;
+	}
+
       for (i = 0; i < nr; ++i)
 	{
-	  fputs (output_names[i], stdout);
-	  putc ('\n', stdout);
+	  freeargv (ltrans_jobs[i].argv);
+	  free (ltrans_jobs[i].cache_name);
 	  free (input_names[i]);
 	}
+      free (ltrans_jobs);
+      ltrans_jobs = NULL;
       nr = 0;
       free (output_names);
       free (input_names);
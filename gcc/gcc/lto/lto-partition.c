@@ -46,6 +46,10 @@ enum symbol_class
 
 vec<ltrans_partition> ltrans_partitions;
 
+/* The estimated memory, in kB, an LTRANS compilation needs besides the
+   functions and variables of its partition.  */
+#define LTRANS_BASE_MEMORY (16 * 1024)
+
 static void add_symbol_to_partition (ltrans_partition part, symtab_node node);
 
 /* Classify symbol NODE.  */
@@ -308,6 +312,57 @@ undo_partition (ltrans_partition partition, unsigned int n_nodes)
     }
 }
 
+/* Return the estimated peak memory, in kB, of the LTRANS compilation of a
+   partition of INSNS estimated instructions.  The estimate is linear, a
+   fixed overhead plus PARAM_LTO_PARTITION_MEMORY_PER_INSN per instruction;
+   lto-wrapper -v compares the predictions with the actual compilations.  */
+
+int
+estimate_partition_memory (int insns)
+{
+  HOST_WIDE_INT kb = LTRANS_BASE_MEMORY
+		     + ((HOST_WIDE_INT) insns
+			* PARAM_VALUE (PARAM_LTO_PARTITION_MEMORY_PER_INSN)
+			>> 10);
+  return MIN (kb, INT_MAX);
+}
+
+/* Return the largest partition size, in estimated instructions, whose
+   LTRANS compilation stays within PARAM_LTO_MAX_PARTITION_MEMORY, or
+   INT_MAX if there is no limit.  */
+
+static int
+max_partition_size (void)
+{
+  HOST_WIDE_INT kb = (HOST_WIDE_INT) PARAM_VALUE
+		       (PARAM_LTO_MAX_PARTITION_MEMORY) * 1024;
+  HOST_WIDE_INT insns;
+
+  if (!kb)
+    return INT_MAX;
+  insns = ((kb - LTRANS_BASE_MEMORY) << 10)
+	  / PARAM_VALUE (PARAM_LTO_PARTITION_MEMORY_PER_INSN);
+  return MAX (MIN (insns, INT_MAX), 1);
+}
+
+/* Return the cost of cutting the call EDGE by a partition boundary.
+   With a profile, MAX_COUNT is the largest count of the edges being
+   partitioned and the cost is the count of EDGE scaled to the range of
+   the frequencies, so that hot calls stay inside partitions.  Otherwise
+   the static frequency of EDGE is used.  */
+
+static int
+edge_cost (struct cgraph_edge *edge, gcov_type max_count)
+{
+  int cost;
+
+  if (max_count)
+    cost = edge->count / ((max_count + CGRAPH_FREQ_MAX - 1) / CGRAPH_FREQ_MAX);
+  else
+    cost = edge->frequency;
+  return MAX (cost, 1);
+}
+
 /* Group cgrah nodes by input files.  This is used mainly for testing
    right now.  */
 
@@ -431,10 +486,14 @@ varpool_node_cmp (const void *pa, const void *pb)
    are not partitioned too much.  Creating too many partitions significantly
    increases the streaming overhead.
 
-   In the future, we would like to bound the maximal size of partitions so as
-   to prevent the LTRANS stage from consuming too much memory.  At the moment,
-   however, the WPA stage is the most memory intensive for large benchmarks,
-   since too many types and declarations are read into memory.
+   If PARAM_LTO_MAX_PARTITION_MEMORY is set, the expected size is further
+   bounded so that no partition is estimated to need more memory than that
+   in LTRANS (see estimate_partition_memory), and a partition is finished
+   once it exceeds the bound.
+
+   Calls cost their frequency when they cross a boundary, or with a
+   profile their execution count relative to the hottest call, so the
+   boundaries avoid hot calls.
 
    The function implements a simple greedy algorithm.  Nodes are being added
    to the current partition until after 3/4 of the expected partition size is
@@ -465,6 +524,8 @@ lto_balanced_map (void)
     INT_MAX, best_internal = 0;
   int npartitions;
   int current_order = -1;
+  int max_size = max_partition_size ();
+  gcov_type max_count = 0;
 
   FOR_EACH_VARIABLE (vnode)
     gcc_assert (!vnode->symbol.aux);
@@ -480,8 +541,12 @@ lto_balanced_map (void)
       node = postorder[i];
       if (get_symbol_class ((symtab_node) node) == SYMBOL_PARTITION)
 	{
+	  struct cgraph_edge *edge;
+
 	  order[n_nodes++] = node;
           total_size += inline_summary (node)->size;
+	  for (edge = node->callees; edge; edge = edge->next_callee)
+	    max_count = MAX (max_count, edge->count);
 	}
     }
   free (postorder);
@@ -507,11 +572,20 @@ lto_balanced_map (void)
   partition_size = total_size / PARAM_VALUE (PARAM_LTO_PARTITIONS);
   if (partition_size < PARAM_VALUE (MIN_PARTITION_SIZE))
     partition_size = PARAM_VALUE (MIN_PARTITION_SIZE);
+  if (partition_size > max_size / 5 * 4)
+    partition_size = MAX (max_size / 5 * 4, 1);
   npartitions = 1;
   partition = new_partition ("");
   if (cgraph_dump_file)
-    fprintf (cgraph_dump_file, "Total unit size: %i, partition size: %i\n",
-	     total_size, partition_size);
+    {
+      fprintf (cgraph_dump_file, "Total unit size: %i, partition size: %i\n",
+	       total_size, partition_size);
+      if (max_size != INT_MAX)
+	fprintf (cgraph_dump_file, "Maximal partition size: %i\n", max_size);
+      if (max_count)
+	fprintf (cgraph_dump_file, "Maximal call count: " HOST_WIDEST_INT_PRINT_DEC
+		 "\n", (HOST_WIDEST_INT) max_count);
+    }
 
   for (i = 0; i < n_nodes; i++)
     {
@@ -567,36 +641,30 @@ lto_balanced_map (void)
 	      for (edge = node->callees; edge; edge = edge->next_callee)
 		if (edge->callee->analyzed)
 		  {
-		    int edge_cost = edge->frequency;
+		    int cost_of_edge = edge_cost (edge, max_count);
 		    int index;
 
-		    if (!edge_cost)
-		      edge_cost = 1;
-		    gcc_assert (edge_cost > 0);
 		    index = lto_symtab_encoder_lookup (partition->encoder,
 						       (symtab_node)edge->callee);
 		    if (index != LCC_NOT_FOUND
 		        && index < last_visited_node - 1)
-		      cost -= edge_cost, internal += edge_cost;
+		      cost -= cost_of_edge, internal += cost_of_edge;
 		    else
-		      cost += edge_cost;
+		      cost += cost_of_edge;
 		  }
 	      for (edge = node->callers; edge; edge = edge->next_caller)
 		{
-		  int edge_cost = edge->frequency;
+		  int cost_of_edge = edge_cost (edge, max_count);
 		  int index;
 
 		  gcc_assert (edge->caller->analyzed);
-		  if (!edge_cost)
-		    edge_cost = 1;
-		  gcc_assert (edge_cost > 0);
 		  index = lto_symtab_encoder_lookup (partition->encoder,
 						     (symtab_node)edge->caller);
 		  if (index != LCC_NOT_FOUND
 		      && index < last_visited_node - 1)
-		    cost -= edge_cost;
+		    cost -= cost_of_edge;
 		  else
-		    cost += edge_cost;
+		    cost += cost_of_edge;
 		}
 	    }
 	  else
@@ -695,7 +763,8 @@ lto_balanced_map (void)
 		 best_cost, best_internal, best_i);
       /* Partition is too large, unwind into step when best cost was reached and
 	 start new partition.  */
-      if (partition->insns > 2 * partition_size)
+      if (partition->insns > 2 * partition_size
+	  || partition->insns > max_size)
 	{
 	  if (best_i != i)
 	    {
@@ -730,6 +799,8 @@ lto_balanced_map (void)
 
 	  if (partition_size < PARAM_VALUE (MIN_PARTITION_SIZE))
 	    partition_size = PARAM_VALUE (MIN_PARTITION_SIZE);
+	  if (partition_size > max_size / 5 * 4)
+	    partition_size = MAX (max_size / 5 * 4, 1);
 	  npartitions ++;
 	}
     }
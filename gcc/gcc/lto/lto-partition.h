@@ -37,3 +37,4 @@ void lto_max_map (void);
 void lto_balanced_map (void);
 void lto_promote_cross_file_statics (void);
 void free_ltrans_partitions (void);
+int estimate_partition_memory (int);
@@ -45,6 +45,11 @@ along with GCC; see the file COPYING3.  If not see
 #include "tree-streamer.h"
 #include "splay-tree.h"
 #include "lto-partition.h"
+#include "params.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 static GTY(()) tree first_personality_decl;
 
@@ -362,9 +367,31 @@ struct sccs
   } u;
 };
 
-static unsigned int next_dfs_num;
 static unsigned int gtc_next_dfs_num;
 
+/* State of a DFS walk of iterative_hash_gimple_type.  */
+
+struct type_hash_walk
+{
+  vec<tree> sccstack;
+  struct pointer_map_t *sccstate;
+  struct obstack sccstate_obstack;
+  unsigned int next_dfs_num;
+
+  /* When the walk runs in a helper thread of lto_hash_types, the hashes
+     it computes are recorded in HASHES instead of type_hash_cache, and
+     the hashed types are appended to ORDER.  */
+  struct pointer_map_t *hashes;
+  vec<tree> *order;
+};
+
+#ifdef HAVE_PTHREAD
+/* Serializes the lookups in type_hash_cache of the helper threads of
+   lto_hash_types: htab_find_slot updates the statistics of the table
+   even when it only looks.  */
+static pthread_mutex_t type_hash_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /* GIMPLE type merging cache.  A direct-mapped cache based on TYPE_UID.  */
 
 typedef struct GTY(()) gimple_type_leader_entry_s {
@@ -976,41 +1003,92 @@ gimple_types_compatible_p (tree t1, tree t2)
 }
 
 static hashval_t
-iterative_hash_gimple_type (tree, hashval_t, vec<tree> *,
-			    struct pointer_map_t *, struct obstack *);
+iterative_hash_gimple_type (tree, hashval_t, struct type_hash_walk *);
+
+/* If the hash value of type T is known to the walk W, store it in
+   *HASH and return true.  */
+
+static bool
+lookup_type_hash (struct type_hash_walk *w, tree t, hashval_t *hash)
+{
+  struct tree_int_map m, *entry = NULL;
+  void **slot;
+
+  if (w->hashes
+      && (slot = pointer_map_contains (w->hashes, t)) != NULL)
+    {
+      *hash = (hashval_t) (size_t) *slot;
+      return true;
+    }
+
+  m.base.from = t;
+#ifdef HAVE_PTHREAD
+  if (w->hashes)
+    pthread_mutex_lock (&type_hash_cache_lock);
+#endif
+  slot = htab_find_slot (type_hash_cache, &m, NO_INSERT);
+  if (slot)
+    entry = (struct tree_int_map *) *slot;
+#ifdef HAVE_PTHREAD
+  if (w->hashes)
+    pthread_mutex_unlock (&type_hash_cache_lock);
+#endif
+
+  if (!entry)
+    return false;
+  *hash = entry->to;
+  return true;
+}
+
+/* Record HASH as the hash value of type T found by the walk W.  */
+
+static void
+record_type_hash (struct type_hash_walk *w, tree t, hashval_t hash)
+{
+  struct tree_int_map *m;
+  void **slot;
+
+  if (w->hashes)
+    {
+      *pointer_map_insert (w->hashes, t) = (void *) (size_t) hash;
+      w->order->safe_push (t);
+      return;
+    }
+
+  m = ggc_alloc_cleared_tree_int_map ();
+  m->base.from = t;
+  m->to = hash;
+  slot = htab_find_slot (type_hash_cache, m, INSERT);
+  gcc_assert (!*slot);
+  *slot = (void *) m;
+}
 
 /* DFS visit the edge from the callers type with state *STATE to T.
    Update the callers type hash V with the hash for T if it is not part
    of the SCC containing the callers type and return it.
-   SCCSTACK, SCCSTATE and SCCSTATE_OBSTACK are state for the DFS walk done.  */
+   W is the state of the DFS walk done.  */
 
 static hashval_t
-visit (tree t, struct sccs *state, hashval_t v,
-       vec<tree> *sccstack,
-       struct pointer_map_t *sccstate,
-       struct obstack *sccstate_obstack)
+visit (tree t, struct sccs *state, hashval_t v, struct type_hash_walk *w)
 {
   struct sccs *cstate = NULL;
-  struct tree_int_map m;
+  hashval_t hash;
   void **slot;
 
   /* If there is a hash value recorded for this type then it can't
      possibly be part of our parent SCC.  Simply mix in its hash.  */
-  m.base.from = t;
-  if ((slot = htab_find_slot (type_hash_cache, &m, NO_INSERT))
-      && *slot)
-    return iterative_hash_hashval_t (((struct tree_int_map *) *slot)->to, v);
+  if (lookup_type_hash (w, t, &hash))
+    return iterative_hash_hashval_t (hash, v);
 
-  if ((slot = pointer_map_contains (sccstate, t)) != NULL)
+  if ((slot = pointer_map_contains (w->sccstate, t)) != NULL)
     cstate = (struct sccs *)*slot;
   if (!cstate)
     {
       hashval_t tem;
       /* Not yet visited.  DFS recurse.  */
-      tem = iterative_hash_gimple_type (t, v,
-					sccstack, sccstate, sccstate_obstack);
+      tem = iterative_hash_gimple_type (t, v, w);
       if (!cstate)
-	cstate = (struct sccs *)* pointer_map_contains (sccstate, t);
+	cstate = (struct sccs *)* pointer_map_contains (w->sccstate, t);
       state->low = MIN (state->low, cstate->low);
       /* If the type is no longer on the SCC stack and thus is not part
          of the parents SCC mix in its hash value.  Otherwise we will
@@ -1066,7 +1144,7 @@ type_hash_pair_compare (const void *p1_, const void *p2_)
 }
 
 /* Returning a hash value for gimple type TYPE combined with VAL.
-   SCCSTACK, SCCSTATE and SCCSTATE_OBSTACK are state for the DFS walk done.
+   W is the state of the DFS walk done.
 
    To hash a type we end up hashing in types that are reachable.
    Through pointers we can end up with cycles which messes up the
@@ -1079,21 +1157,18 @@ type_hash_pair_compare (const void *p1_, const void *p2_)
 
 static hashval_t
 iterative_hash_gimple_type (tree type, hashval_t val,
-			    vec<tree> *sccstack,
-			    struct pointer_map_t *sccstate,
-			    struct obstack *sccstate_obstack)
+			    struct type_hash_walk *w)
 {
   hashval_t v;
-  void **slot;
   struct sccs *state;
 
   /* Not visited during this DFS walk.  */
-  gcc_checking_assert (!pointer_map_contains (sccstate, type));
-  state = XOBNEW (sccstate_obstack, struct sccs);
-  *pointer_map_insert (sccstate, type) = state;
+  gcc_checking_assert (!pointer_map_contains (w->sccstate, type));
+  state = XOBNEW (&w->sccstate_obstack, struct sccs);
+  *pointer_map_insert (w->sccstate, type) = state;
 
-  sccstack->safe_push (type);
-  state->dfsnum = next_dfs_num++;
+  w->sccstack.safe_push (type);
+  state->dfsnum = w->next_dfs_num++;
   state->low = state->dfsnum;
   state->on_sccstack = true;
 
@@ -1106,13 +1181,11 @@ iterative_hash_gimple_type (tree type, hashval_t val,
       && TREE_CODE (TYPE_NAME (type)) == TYPE_DECL
       && DECL_CONTEXT (TYPE_NAME (type))
       && TYPE_P (DECL_CONTEXT (TYPE_NAME (type))))
-    v = visit (DECL_CONTEXT (TYPE_NAME (type)), state, v,
-	       sccstack, sccstate, sccstate_obstack);
+    v = visit (DECL_CONTEXT (TYPE_NAME (type)), state, v, w);
 
   /* Factor in the variant structure.  */
   if (TYPE_MAIN_VARIANT (type) != type)
-    v = visit (TYPE_MAIN_VARIANT (type), state, v,
-	       sccstack, sccstate, sccstate_obstack);
+    v = visit (TYPE_MAIN_VARIANT (type), state, v, w);
 
   v = iterative_hash_hashval_t (TREE_CODE (type), v);
   v = iterative_hash_hashval_t (TYPE_QUALS (type), v);
@@ -1134,8 +1207,7 @@ iterative_hash_gimple_type (tree type, hashval_t val,
   /* For pointer and reference types, fold in information about the type
      pointed to.  */
   if (POINTER_TYPE_P (type))
-    v = visit (TREE_TYPE (type), state, v,
-	       sccstack, sccstate, sccstate_obstack);
+    v = visit (TREE_TYPE (type), state, v, w);
 
   /* For integer types hash the types min/max values and the string flag.  */
   if (TREE_CODE (type) == INTEGER_TYPE)
@@ -1153,16 +1225,14 @@ iterative_hash_gimple_type (tree type, hashval_t val,
   if (TREE_CODE (type) == ARRAY_TYPE && TYPE_DOMAIN (type))
     {
       v = iterative_hash_hashval_t (TYPE_STRING_FLAG (type), v);
-      v = visit (TYPE_DOMAIN (type), state, v,
-		 sccstack, sccstate, sccstate_obstack);
+      v = visit (TYPE_DOMAIN (type), state, v, w);
     }
 
   /* Recurse for aggregates with a single element type.  */
   if (TREE_CODE (type) == ARRAY_TYPE
       || TREE_CODE (type) == COMPLEX_TYPE
       || TREE_CODE (type) == VECTOR_TYPE)
-    v = visit (TREE_TYPE (type), state, v,
-	       sccstack, sccstate, sccstate_obstack);
+    v = visit (TREE_TYPE (type), state, v, w);
 
   /* Incorporate function return and argument types.  */
   if (TREE_CODE (type) == FUNCTION_TYPE || TREE_CODE (type) == METHOD_TYPE)
@@ -1172,16 +1242,13 @@ iterative_hash_gimple_type (tree type, hashval_t val,
 
       /* For method types also incorporate their parent class.  */
       if (TREE_CODE (type) == METHOD_TYPE)
-	v = visit (TYPE_METHOD_BASETYPE (type), state, v,
-		   sccstack, sccstate, sccstate_obstack);
+	v = visit (TYPE_METHOD_BASETYPE (type), state, v, w);
 
       /* Check result and argument types.  */
-      v = visit (TREE_TYPE (type), state, v,
-		 sccstack, sccstate, sccstate_obstack);
+      v = visit (TREE_TYPE (type), state, v, w);
       for (p = TYPE_ARG_TYPES (type), na = 0; p; p = TREE_CHAIN (p))
 	{
-	  v = visit (TREE_VALUE (p), state, v,
-		     sccstack, sccstate, sccstate_obstack);
+	  v = visit (TREE_VALUE (p), state, v, w);
 	  na++;
 	}
 
@@ -1196,8 +1263,7 @@ iterative_hash_gimple_type (tree type, hashval_t val,
       for (f = TYPE_FIELDS (type), nf = 0; f; f = TREE_CHAIN (f))
 	{
 	  v = iterative_hash_name (DECL_NAME (f), v);
-	  v = visit (TREE_TYPE (f), state, v,
-		     sccstack, sccstate, sccstate_obstack);
+	  v = visit (TREE_TYPE (f), state, v, w);
 	  nf++;
 	}
 
@@ -1211,20 +1277,14 @@ iterative_hash_gimple_type (tree type, hashval_t val,
   if (state->low == state->dfsnum)
     {
       tree x;
-      struct tree_int_map *m;
 
       /* Pop off the SCC and set its hash values.  */
-      x = sccstack->pop ();
+      x = w->sccstack.pop ();
       /* Optimize SCC size one.  */
       if (x == type)
 	{
 	  state->on_sccstack = false;
-	  m = ggc_alloc_cleared_tree_int_map ();
-	  m->base.from = x;
-	  m->to = v;
-	  slot = htab_find_slot (type_hash_cache, m, INSERT);
-	  gcc_assert (!*slot);
-	  *slot = (void *) m;
+	  record_type_hash (w, x, v);
 	}
       else
 	{
@@ -1232,20 +1292,20 @@ iterative_hash_gimple_type (tree type, hashval_t val,
 	  unsigned first, i, size, j;
 	  struct type_hash_pair *pairs;
 	  /* Pop off the SCC and build an array of type, hash pairs.  */
-	  first = sccstack->length () - 1;
-	  while ((*sccstack)[first] != type)
+	  first = w->sccstack.length () - 1;
+	  while (w->sccstack[first] != type)
 	    --first;
-	  size = sccstack->length () - first + 1;
+	  size = w->sccstack.length () - first + 1;
 	  pairs = XALLOCAVEC (struct type_hash_pair, size);
 	  i = 0;
-	  cstate = (struct sccs *)*pointer_map_contains (sccstate, x);
+	  cstate = (struct sccs *)*pointer_map_contains (w->sccstate, x);
 	  cstate->on_sccstack = false;
 	  pairs[i].type = x;
 	  pairs[i].hash = cstate->u.hash;
 	  do
 	    {
-	      x = sccstack->pop ();
-	      cstate = (struct sccs *)*pointer_map_contains (sccstate, x);
+	      x = w->sccstack.pop ();
+	      cstate = (struct sccs *)*pointer_map_contains (w->sccstate, x);
 	      cstate->on_sccstack = false;
 	      ++i;
 	      pairs[i].type = x;
@@ -1263,8 +1323,6 @@ iterative_hash_gimple_type (tree type, hashval_t val,
 	  for (i = 0; i < size; ++i)
 	    {
 	      hashval_t hash;
-	      m = ggc_alloc_cleared_tree_int_map ();
-	      m->base.from = pairs[i].type;
 	      hash = pairs[i].hash;
 	      /* Skip same hashes.  */
 	      for (j = i + 1; j < size && pairs[j].hash == pairs[i].hash; ++j)
@@ -1273,12 +1331,9 @@ iterative_hash_gimple_type (tree type, hashval_t val,
 		hash = iterative_hash_hashval_t (pairs[j].hash, hash);
 	      for (j = 0; pairs[j].hash != pairs[i].hash; ++j)
 		hash = iterative_hash_hashval_t (pairs[j].hash, hash);
-	      m->to = hash;
 	      if (pairs[i].type == type)
 		v = hash;
-	      slot = htab_find_slot (type_hash_cache, m, INSERT);
-	      gcc_assert (!*slot);
-	      *slot = (void *) m;
+	      record_type_hash (w, pairs[i].type, hash);
 	    }
 	}
     }
@@ -1286,6 +1341,33 @@ iterative_hash_gimple_type (tree type, hashval_t val,
   return iterative_hash_hashval_t (v, val);
 }
 
+/* Return the hash value of type T, recording the hashes of the types
+   reachable from it as described at struct type_hash_walk.  */
+
+static hashval_t
+gimple_type_hash_1 (tree t, struct pointer_map_t *hashes, vec<tree> *order)
+{
+  struct type_hash_walk w;
+  hashval_t val;
+
+  w.hashes = hashes;
+  w.order = order;
+  if (lookup_type_hash (&w, t, &val))
+    return iterative_hash_hashval_t (val, 0);
+
+  /* Perform a DFS walk and pre-hash all reachable types.  */
+  w.sccstack = vNULL;
+  w.next_dfs_num = 1;
+  w.sccstate = pointer_map_create ();
+  gcc_obstack_init (&w.sccstate_obstack);
+  val = iterative_hash_gimple_type (t, 0, &w);
+  w.sccstack.release ();
+  pointer_map_destroy (w.sccstate);
+  obstack_free (&w.sccstate_obstack, NULL);
+
+  return val;
+}
+
 /* Returns a hash value for P (assumed to be a type).  The hash value
    is computed using some distinguishing features of the type.  Note
    that we cannot use pointer hashing here as we may be dealing with
@@ -1297,30 +1379,7 @@ iterative_hash_gimple_type (tree type, hashval_t val,
 static hashval_t
 gimple_type_hash (const void *p)
 {
-  const_tree t = (const_tree) p;
-  vec<tree> sccstack = vNULL;
-  struct pointer_map_t *sccstate;
-  struct obstack sccstate_obstack;
-  hashval_t val;
-  void **slot;
-  struct tree_int_map m;
-
-  m.base.from = CONST_CAST_TREE (t);
-  if ((slot = htab_find_slot (type_hash_cache, &m, NO_INSERT))
-      && *slot)
-    return iterative_hash_hashval_t (((struct tree_int_map *) *slot)->to, 0);
-
-  /* Perform a DFS walk and pre-hash all reachable types.  */
-  next_dfs_num = 1;
-  sccstate = pointer_map_create ();
-  gcc_obstack_init (&sccstate_obstack);
-  val = iterative_hash_gimple_type (CONST_CAST_TREE (t), 0,
-				    &sccstack, sccstate, &sccstate_obstack);
-  sccstack.release ();
-  pointer_map_destroy (sccstate);
-  obstack_free (&sccstate_obstack, NULL);
-
-  return val;
+  return gimple_type_hash_1 (CONST_CAST_TREE ((const_tree) p), NULL, NULL);
 }
 
 /* Returns nonzero if P1 and P2 are equal.  */
@@ -1839,15 +1898,14 @@ lto_register_function_decl_in_symtab (struct data_in *data_in, tree decl)
 
 
 /* Given a streamer cache structure DATA_IN (holding a sequence of trees
-   for one compilation unit) go over all trees starting at index FROM until the
-   end of the sequence and replace fields of those trees, and the trees
+   for one compilation unit) go over all trees starting at index FROM until
+   index LEN and replace fields of those trees, and the trees
    themself with their canonical variants as per gimple_register_type.  */
 
 static void
-uniquify_nodes (struct data_in *data_in, unsigned from)
+uniquify_nodes (struct data_in *data_in, unsigned from, unsigned len)
 {
   struct streamer_tree_cache_d *cache = data_in->reader_cache;
-  unsigned len = cache->nodes.length ();
   unsigned i;
 
   /* Go backwards because children streamed for the first time come
@@ -2051,6 +2109,221 @@ uniquify_nodes (struct data_in *data_in, unsigned from)
 }
 
 
+/* Statistics about hashing the types of each file before merging them,
+   for -ftime-report.  */
+
+static struct
+{
+  /* The number of files and types hashed.  */
+  unsigned files;
+  unsigned types;
+
+  /* The largest number of threads a file was hashed with.  */
+  int threads;
+
+  /* The time hashing took, and the time spent in all threads.  */
+  double seconds;
+  double thread_seconds;
+} type_hash_stats;
+
+/* Don't start a thread of lto_hash_types for fewer types than this.  */
+#define MIN_TYPES_PER_HASH_THREAD 256
+
+/* Return the wall clock time in seconds, or zero if the host can't
+   tell.  */
+
+static double
+lto_wall_time (void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+  return 0;
+#endif
+}
+
+#ifdef HAVE_PTHREAD
+
+/* The share of the types of a file hashed by one thread of
+   lto_hash_types.  */
+
+struct type_hash_job
+{
+  /* The N types to hash.  */
+  tree *types;
+  unsigned n;
+
+  /* The hashes of the types reachable from them that type_hash_cache
+     didn't have yet, and those types in the order they were hashed.  */
+  struct pointer_map_t *hashes;
+  vec<tree> order;
+
+  /* The time the job took.  */
+  double seconds;
+};
+
+/* Run the type_hash_job DATA.  This only reads the trees and
+   type_hash_cache, so several jobs can run at the same time.  */
+
+static void *
+lto_type_hash_thread (void *data)
+{
+  struct type_hash_job *job = (struct type_hash_job *) data;
+  double start = lto_wall_time ();
+  unsigned i;
+
+  for (i = 0; i < job->n; i++)
+    gimple_type_hash_1 (job->types[i], job->hashes, &job->order);
+  job->seconds = lto_wall_time () - start;
+  return NULL;
+}
+
+/* Hash TYPES in N_JOBS jobs, all but the first one in threads of their
+   own, and enter the results into type_hash_cache.  Return the number of
+   threads used.  */
+
+static int
+lto_hash_types_in_threads (vec<tree> types, int n_jobs)
+{
+  struct type_hash_job *jobs = XCNEWVEC (struct type_hash_job, n_jobs);
+  pthread_t *threads = XNEWVEC (pthread_t, n_jobs);
+  sigset_t all_signals, old_signals;
+  int k, n_started;
+  unsigned i;
+
+  for (k = 0; k < n_jobs; k++)
+    {
+      unsigned first = types.length () * k / n_jobs;
+      unsigned last = types.length () * (k + 1) / n_jobs;
+
+      jobs[k].types = types.address () + first;
+      jobs[k].n = last - first;
+      jobs[k].hashes = pointer_map_create ();
+    }
+
+  /* Leave all signals to the main thread.  */
+  sigfillset (&all_signals);
+  pthread_sigmask (SIG_SETMASK, &all_signals, &old_signals);
+  for (n_started = 1; n_started < n_jobs; n_started++)
+    if (pthread_create (&threads[n_started], NULL, lto_type_hash_thread,
+			&jobs[n_started]) != 0)
+      break;
+  pthread_sigmask (SIG_SETMASK, &old_signals, NULL);
+
+  /* Run the first job, and those no thread could be started for, here.  */
+  lto_type_hash_thread (&jobs[0]);
+  for (k = n_started; k < n_jobs; k++)
+    lto_type_hash_thread (&jobs[k]);
+  for (k = 1; k < n_started; k++)
+    pthread_join (threads[k], NULL);
+
+  /* Types reachable from the types of several jobs have been hashed by
+     each of them, to the same value.  Enter the hashes job by job in the
+     order they were found, so that the outcome doesn't depend on the
+     timing of the threads.  */
+  for (k = 0; k < n_jobs; k++)
+    {
+      tree t;
+
+      FOR_EACH_VEC_ELT (jobs[k].order, i, t)
+	{
+	  struct tree_int_map m, *entry;
+	  void **slot;
+
+	  m.base.from = t;
+	  slot = htab_find_slot (type_hash_cache, &m, INSERT);
+	  if (*slot)
+	    continue;
+	  entry = ggc_alloc_cleared_tree_int_map ();
+	  entry->base.from = t;
+	  entry->to = (hashval_t) (size_t) *pointer_map_contains (jobs[k].hashes,
+								   t);
+	  *slot = (void *) entry;
+	}
+      type_hash_stats.thread_seconds += jobs[k].seconds;
+      jobs[k].order.release ();
+      pointer_map_destroy (jobs[k].hashes);
+    }
+
+  free (threads);
+  free (jobs);
+  return n_started;
+}
+
+#endif /* HAVE_PTHREAD */
+
+/* Compute the hash values of the types the reader cache of DATA_IN holds
+   from index FROM on, using up to PARAM_LTO_TYPE_HASH_THREADS threads.
+   The hashes are entered into type_hash_cache, from where merging the
+   types picks them up.  */
+
+static void
+lto_hash_types (struct data_in *data_in, unsigned from)
+{
+  struct streamer_tree_cache_d *cache = data_in->reader_cache;
+  vec<tree> types = vNULL;
+  double start = lto_wall_time ();
+  int n_threads = 1;
+  unsigned i;
+
+  timevar_push (TV_IPA_LTO_TYPE_HASH);
+
+  for (i = from; i < cache->nodes.length (); i++)
+    {
+      tree t = cache->nodes[i];
+      if (t && TYPE_P (t))
+	types.safe_push (t);
+    }
+
+#ifdef HAVE_PTHREAD
+  /* The heap vectors of the threads can't record their overhead.  */
+  if (!GATHER_STATISTICS)
+    {
+      int n_jobs = MIN (PARAM_VALUE (PARAM_LTO_TYPE_HASH_THREADS),
+			(int) (types.length () / MIN_TYPES_PER_HASH_THREAD));
+      if (n_jobs > 1)
+	n_threads = lto_hash_types_in_threads (types, n_jobs);
+    }
+#endif
+  if (n_threads == 1)
+    {
+      double thread_start = lto_wall_time ();
+      tree t;
+
+      FOR_EACH_VEC_ELT (types, i, t)
+	gimple_type_hash (t);
+      type_hash_stats.thread_seconds += lto_wall_time () - thread_start;
+    }
+
+  type_hash_stats.files++;
+  type_hash_stats.types += types.length ();
+  type_hash_stats.threads = MAX (type_hash_stats.threads, n_threads);
+  type_hash_stats.seconds += lto_wall_time () - start;
+  types.release ();
+
+  timevar_pop (TV_IPA_LTO_TYPE_HASH);
+}
+
+/* Print the statistics about hashing types to FILE, for -ftime-report.  */
+
+static void
+lto_print_type_hash_stats (FILE *file)
+{
+  if (type_hash_stats.files == 0)
+    return;
+
+  fprintf (file, "\nLTO type hashing: %u types of %u files, by up to "
+	   "%d threads\n", type_hash_stats.types, type_hash_stats.files,
+	   type_hash_stats.threads);
+  fprintf (file, " %.2f s of work in %.2f s (%.1fx)\n",
+	   type_hash_stats.thread_seconds, type_hash_stats.seconds,
+	   type_hash_stats.seconds > 0
+	   ? type_hash_stats.thread_seconds / type_hash_stats.seconds : 1.0);
+}
+
 /* Read all the symbols from buffer DATA, using descriptors in DECL_DATA.
    RESOLUTIONS is the set of symbols picked by the linker (read from the
    resolution file when the linker plugin is being used).  */
@@ -2079,13 +2352,36 @@ lto_read_decls (struct lto_file_decl_data *decl_data, const void *data,
      internal types that should not be merged.  */
 
   /* Read the global declarations and types.  */
-  while (ib_main.p < ib_main.len)
+  if (PARAM_VALUE (PARAM_LTO_TYPE_HASH_THREADS) == 0)
+    while (ib_main.p < ib_main.len)
+      {
+	tree t;
+	unsigned from = data_in->reader_cache->nodes.length ();
+	t = stream_read_tree (&ib_main, data_in);
+	gcc_assert (t && ib_main.p <= ib_main.len);
+	uniquify_nodes (data_in, from, data_in->reader_cache->nodes.length ());
+      }
+  else
     {
-      tree t;
-      unsigned from = data_in->reader_cache->nodes.length ();
-      t = stream_read_tree (&ib_main, data_in);
-      gcc_assert (t && ib_main.p <= ib_main.len);
-      uniquify_nodes (data_in, from);
+      /* Read all the trees first and hash their types, possibly in
+	 several threads, then merge them tree by tree as above.  */
+      vec<unsigned> starts = vNULL;
+      unsigned first = data_in->reader_cache->nodes.length ();
+
+      while (ib_main.p < ib_main.len)
+	{
+	  tree t;
+	  starts.safe_push (data_in->reader_cache->nodes.length ());
+	  t = stream_read_tree (&ib_main, data_in);
+	  gcc_assert (t && ib_main.p <= ib_main.len);
+	}
+      starts.safe_push (data_in->reader_cache->nodes.length ());
+
+      lto_hash_types (data_in, first);
+
+      for (i = 0; i + 1 < starts.length (); i++)
+	uniquify_nodes (data_in, starts[i], starts[i + 1]);
+      starts.release ();
     }
 
   /* Read in lto_in_decl_state objects.  */
@@ -2311,7 +2607,7 @@ create_subid_section_table (struct lto_section_slot *ls, splay_tree file_ids,
 /* Read declarations and other initializations for a FILE_DATA. */
 
 static void
-lto_file_finalize (struct lto_file_decl_data *file_data, lto_file *file)
+lto_file_finalize (struct lto_file_decl_data *file_data)
 {
   const char *data;
   size_t len;
@@ -2328,7 +2624,6 @@ lto_file_finalize (struct lto_file_decl_data *file_data, lto_file *file)
   file_data->respairs.release ();
 
   file_data->renaming_hash_table = lto_create_renaming_table ();
-  file_data->file_name = file->filename;
   data = lto_get_section_data (file_data, LTO_section_decls, NULL, &len);
   if (data == NULL)
     {
@@ -2340,13 +2635,12 @@ lto_file_finalize (struct lto_file_decl_data *file_data, lto_file *file)
   lto_free_section_data (file_data, LTO_section_decls, NULL, data, len);
 }
 
-/* Finalize FILE_DATA in FILE and increase COUNT. */
+/* Finalize FILE_DATA and increase COUNT. */
 
 static int 
-lto_create_files_from_ids (lto_file *file, struct lto_file_decl_data *file_data,
-			   int *count)
+lto_create_files_from_ids (struct lto_file_decl_data *file_data, int *count)
 {
-  lto_file_finalize (file_data, file);
+  lto_file_finalize (file_data);
   if (cgraph_dump_file)
     fprintf (cgraph_dump_file, "Creating file %s with sub id " HOST_WIDE_INT_PRINT_HEX "\n", 
 	     file_data->file_name, file_data->id);
@@ -2354,15 +2648,13 @@ lto_create_files_from_ids (lto_file *file, struct lto_file_decl_data *file_data,
   return 0;
 }
 
-/* Generate a TREE representation for all types and external decls
-   entities in FILE.  
-
-   Read all of the globals out of the file.  Then read the cgraph
-   and process the .o index into the cgraph nodes so that it can open
-   the .o file to load the functions and ipa information.   */
+/* Read the section table of FILE and the symbol resolutions for it,
+   and return the list of the file datas for its sub modules.  Their
+   declarations are read later by lto_create_files_from_ids, so that
+   the sections of all files can be decompressed ahead of their use.  */
 
 static struct lto_file_decl_data *
-lto_file_read (lto_file *file, FILE *resolution_file, int *count)
+lto_file_read (lto_file *file, FILE *resolution_file)
 {
   struct lto_file_decl_data *file_data = NULL;
   splay_tree file_ids;
@@ -2384,9 +2676,8 @@ lto_file_read (lto_file *file, FILE *resolution_file, int *count)
   /* Add resolutions to file ids */
   lto_resolution_read (file_ids, resolution_file, file);
 
-  /* Finalize each lto file for each submodule in the merged object */
   for (file_data = file_list.first; file_data != NULL; file_data = file_data->next)
-    lto_create_files_from_ids (file, file_data, count);
+    file_data->file_name = file->filename;
  
   splay_tree_delete (file_ids);
   htab_delete (section_hash_table);
@@ -2576,6 +2867,175 @@ cmp_partitions_order (const void *a, const void *b)
   return orderb - ordera;
 }
 
+/* Schedule the function bodies lto_output copies into the partition
+   of ENCODER to be decompressed ahead of their use, in the order it
+   copies them.  */
+
+static void
+lto_prefetch_function_bodies (lto_symtab_encoder_t encoder)
+{
+  int i, n_nodes = lto_symtab_encoder_size (encoder);
+
+  for (i = 0; i < n_nodes; i++)
+    {
+      symtab_node snode = lto_symtab_encoder_deref (encoder, i);
+      cgraph_node *node = dyn_cast <cgraph_node> (snode);
+      struct lto_file_decl_data *file_data;
+      const char *name;
+
+      if (!node
+	  || !lto_symtab_encoder_encode_body_p (encoder, node)
+	  || node->alias
+	  || node->thunk.thunk_p
+	  || gimple_has_body_p (node->symbol.decl))
+	continue;
+
+      file_data = node->symbol.lto_file_data;
+      name = IDENTIFIER_POINTER (DECL_ASSEMBLER_NAME (node->symbol.decl));
+      lto_prefetch_section_data (file_data, LTO_section_function_body,
+				 lto_get_decl_name_mapping (file_data, name));
+    }
+}
+
+/* Stream out the partition PART to the file FILENAME.  */
+
+static void
+lto_write_partition (ltrans_partition part, const char *filename)
+{
+  lto_file *file = lto_obj_file_open (filename, true);
+  if (!file)
+    fatal_error ("lto_obj_file_open() failed");
+
+  lto_set_current_out_file (file);
+
+  ipa_write_optimization_summaries (part->encoder);
+
+  lto_set_current_out_file (NULL);
+  lto_obj_file_close (file);
+  free (file);
+}
+
+#ifdef HAVE_WORKING_FORK
+
+/* A process started by lto_start_partition_writer.  */
+
+struct partition_writer
+{
+  /* The process, or zero if the slot is free.  */
+  pid_t pid;
+
+  /* The read end of the pipe the process sends its lto_stats through.  */
+  int stats_fd;
+
+  /* The name of the file it writes.  */
+  char *filename;
+};
+
+/* The writer processes, at most N_PARTITION_WRITERS of them.  */
+static struct partition_writer *partition_writers;
+static int n_partition_writers;
+
+/* Wait for one of the writer processes to exit, add its statistics to
+   lto_stats and free its slot.  Fail if it didn't succeed.  */
+
+static void
+lto_wait_partition_writer (void)
+{
+  struct lto_stats_d stats;
+  unsigned HOST_WIDE_INT *from, *to;
+  struct partition_writer *writer = NULL;
+  int status, i;
+  pid_t pid;
+
+  do
+    pid = waitpid (-1, &status, 0);
+  while (pid < 0 && errno == EINTR);
+  if (pid < 0)
+    fatal_error ("waiting for LTRANS partition writers: %m");
+  for (i = 0; i < n_partition_writers; i++)
+    if (partition_writers[i].pid == pid)
+      writer = &partition_writers[i];
+  if (!writer)
+    return;
+
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != 0
+      || read (writer->stats_fd, &stats, sizeof (stats)) != sizeof (stats))
+    fatal_error ("writing LTRANS partition %s failed", writer->filename);
+
+  /* The statistics are all counters.  */
+  from = (unsigned HOST_WIDE_INT *) &stats;
+  to = (unsigned HOST_WIDE_INT *) &lto_stats;
+  for (i = 0; i < (int) (sizeof (stats) / sizeof (*from)); i++)
+    to[i] += from[i];
+
+  close (writer->stats_fd);
+  free (writer->filename);
+  writer->pid = 0;
+}
+
+/* Stream out the partition PART, the INDEXth one, to the file FILENAME
+   in a new process.  The process works on a copy of the WPA state, so
+   the output is the same as if it had been written here.  */
+
+static void
+lto_start_partition_writer (ltrans_partition part, unsigned index,
+			    const char *filename)
+{
+  struct partition_writer *writer = NULL;
+  int fds[2], i;
+
+  for (;;)
+    {
+      for (i = 0; i < n_partition_writers && !writer; i++)
+	if (partition_writers[i].pid == 0)
+	  writer = &partition_writers[i];
+      if (writer)
+	break;
+      lto_wait_partition_writer ();
+    }
+
+  if (pipe (fds) < 0)
+    fatal_error ("creating a pipe for an LTRANS partition writer: %m");
+
+  /* Don't let the new process repeat buffered output.  */
+  fflush (NULL);
+  writer->pid = fork ();
+  if (writer->pid < 0)
+    fatal_error ("starting an LTRANS partition writer: %m");
+
+  if (writer->pid == 0)
+    {
+      struct lto_stats_d before = lto_stats;
+      unsigned HOST_WIDE_INT *from, *to;
+
+      close (fds[0]);
+
+      /* output_symtab emits the toplevel asms into the first partition
+	 it writes.  Only the writer of the first partition may.  */
+      if (index != 0)
+	asm_nodes = NULL;
+
+      lto_write_partition (part, filename);
+
+      /* Send what the process added to lto_stats.  */
+      from = (unsigned HOST_WIDE_INT *) &before;
+      to = (unsigned HOST_WIDE_INT *) &lto_stats;
+      for (i = 0; i < (int) (sizeof (before) / sizeof (*from)); i++)
+	to[i] -= from[i];
+      if (write (fds[1], &lto_stats, sizeof (lto_stats))
+	  != sizeof (lto_stats))
+	fatal_error ("writing LTRANS partition statistics: %m");
+      fflush (NULL);
+      _exit (SUCCESS_EXIT_CODE);
+    }
+
+  close (fds[1]);
+  writer->stats_fd = fds[0];
+  writer->filename = xstrdup (filename);
+}
+
+#endif /* HAVE_WORKING_FORK */
+
 /* Write all output files in WPA mode and the file with the list of
    LTRANS units.  */
 
@@ -2583,9 +3043,9 @@ static void
 lto_wpa_write_files (void)
 {
   unsigned i, n_sets;
-  lto_file *file;
   ltrans_partition part;
   FILE *ltrans_output_list_stream;
+  FILE *ltrans_estimates_stream = NULL;
   char *temp_filename;
   size_t blen;
 
@@ -2595,6 +3055,12 @@ lto_wpa_write_files (void)
   ltrans_output_list_stream = fopen (ltrans_output_list, "w");
   if (ltrans_output_list_stream == NULL)
     fatal_error ("opening LTRANS output list %s: %m", ltrans_output_list);
+  if (ltrans_estimates)
+    {
+      ltrans_estimates_stream = fopen (ltrans_estimates, "w");
+      if (ltrans_estimates_stream == NULL)
+	fatal_error ("opening LTRANS estimates %s: %m", ltrans_estimates);
+    }
 
   timevar_push (TV_WHOPR_WPA);
 
@@ -2628,6 +3094,27 @@ lto_wpa_write_files (void)
   ltrans_partitions.qsort (flag_toplevel_reorder
 			   ? cmp_partitions_size
 			   : cmp_partitions_order);
+
+#ifdef HAVE_WORKING_FORK
+  /* Write the partitions in up to PARAM_LTO_PARTITION_WRITERS processes
+     at a time.  */
+  n_partition_writers = MIN ((unsigned) PARAM_VALUE
+			     (PARAM_LTO_PARTITION_WRITERS), n_sets);
+  if (n_partition_writers > 1)
+    {
+      partition_writers = XCNEWVEC (struct partition_writer,
+				    n_partition_writers);
+      /* The helper threads would not survive the fork; the writers
+	 decompress the function bodies themselves.  */
+      lto_finish_section_prefetch ();
+    }
+  else
+#endif
+    /* Copying the function bodies into the partitions decompresses them;
+       let helper threads do that ahead.  */
+    FOR_EACH_VEC_ELT (ltrans_partitions, i, part)
+      lto_prefetch_function_bodies (part->encoder);
+
   for (i = 0; i < n_sets; i++)
     {
       size_t len;
@@ -2635,9 +3122,6 @@ lto_wpa_write_files (void)
 
       /* Write all the nodes in SET.  */
       sprintf (temp_filename + blen, "%u.o", i);
-      file = lto_obj_file_open (temp_filename, true);
-      if (!file)
-	fatal_error ("lto_obj_file_open() failed");
 
       if (!quiet_flag)
 	fprintf (stderr, " %s (%s %i insns)", temp_filename, part->name, part->insns);
@@ -2645,8 +3129,9 @@ lto_wpa_write_files (void)
 	{
           lto_symtab_encoder_iterator lsei;
 	  
-	  fprintf (cgraph_dump_file, "Writing partition %s to file %s, %i insns\n",
-		   part->name, temp_filename, part->insns);
+	  fprintf (cgraph_dump_file, "Writing partition %s to file %s, %i insns, "
+		   "estimated %i kB\n", part->name, temp_filename, part->insns,
+		   estimate_partition_memory (part->insns));
 	  fprintf (cgraph_dump_file, "  Symbols in partition: ");
 	  for (lsei = lsei_start_in_partition (part->encoder); !lsei_end_p (lsei);
 	       lsei_next_in_partition (&lsei))
@@ -2679,13 +3164,12 @@ lto_wpa_write_files (void)
 	}
       gcc_checking_assert (lto_symtab_encoder_size (part->encoder) || !i);
 
-      lto_set_current_out_file (file);
-
-      ipa_write_optimization_summaries (part->encoder);
-
-      lto_set_current_out_file (NULL);
-      lto_obj_file_close (file);
-      free (file);
+#ifdef HAVE_WORKING_FORK
+      if (n_partition_writers > 1)
+	lto_start_partition_writer (part, i, temp_filename);
+      else
+#endif
+	lto_write_partition (part, temp_filename);
       part->encoder = NULL;
 
       len = strlen (temp_filename);
@@ -2693,13 +3177,31 @@ lto_wpa_write_files (void)
 	  || fwrite ("\n", 1, 1, ltrans_output_list_stream) < 1)
 	fatal_error ("writing to LTRANS output list %s: %m",
 		     ltrans_output_list);
+      if (ltrans_estimates_stream
+	  && fprintf (ltrans_estimates_stream, "%i %i\n", part->insns,
+		      estimate_partition_memory (part->insns)) < 0)
+	fatal_error ("writing to LTRANS estimates %s: %m", ltrans_estimates);
     }
 
+#ifdef HAVE_WORKING_FORK
+  if (n_partition_writers > 1)
+    {
+      for (i = 0; i < (unsigned) n_partition_writers; i++)
+	while (partition_writers[i].pid)
+	  lto_wait_partition_writer ();
+      free (partition_writers);
+      partition_writers = NULL;
+    }
+#endif
+
+  lto_finish_section_prefetch ();
   lto_stats.num_output_files += n_sets;
 
   /* Close the LTRANS output list.  */
   if (fclose (ltrans_output_list_stream))
     fatal_error ("closing LTRANS output list %s: %m", ltrans_output_list);
+  if (ltrans_estimates_stream && fclose (ltrans_estimates_stream))
+    fatal_error ("closing LTRANS estimates %s: %m", ltrans_estimates);
 
   free_ltrans_partitions();
   free (temp_filename);
@@ -2895,6 +3397,53 @@ lto_flatten_files (struct lto_file_decl_data **orig, int count, int last_file_ix
 static int real_file_count;
 static GTY((length ("real_file_count + 1"))) struct lto_file_decl_data **real_file_decl_data;
 
+/* Schedule the SECTION_TYPE sections of the file datas in FILES, the
+   first NFILES of which are used, to be decompressed ahead of their
+   use.  */
+
+static void
+lto_prefetch_sections (struct lto_file_decl_data **files, unsigned nfiles,
+		       enum lto_section_type section_type)
+{
+  struct lto_file_decl_data *file_data;
+  unsigned i;
+
+  for (i = 0; i < nfiles; i++)
+    for (file_data = files[i]; file_data; file_data = file_data->next)
+      lto_prefetch_section_data (file_data, section_type, NULL);
+}
+
+/* Schedule the sections read_cgraph_and_symbols is going to read from
+   the file datas in FILES, the first NFILES of which are used, to be
+   decompressed ahead of their use, in the order they are read.  */
+
+static void
+lto_schedule_prefetch (struct lto_file_decl_data **files, unsigned nfiles)
+{
+  struct lto_file_decl_data *file_data;
+  unsigned i;
+
+  lto_prefetch_sections (files, nfiles, LTO_section_decls);
+
+  /* input_symtab reads both sections of one file before the next.  */
+  for (i = 0; i < nfiles; i++)
+    for (file_data = files[i]; file_data; file_data = file_data->next)
+      {
+	lto_prefetch_section_data (file_data, LTO_section_symtab_nodes, NULL);
+	lto_prefetch_section_data (file_data, LTO_section_refs, NULL);
+      }
+
+  /* The IPA summaries, in the order of the passes reading them.  The
+     jump functions are read by IPA-CP, or else by the inliner after
+     its own summaries.  */
+  if (optimize && flag_ipa_cp)
+    lto_prefetch_sections (files, nfiles, LTO_section_jump_functions);
+  lto_prefetch_sections (files, nfiles, LTO_section_inline_summary);
+  if (optimize && !flag_ipa_cp)
+    lto_prefetch_sections (files, nfiles, LTO_section_jump_functions);
+  lto_prefetch_sections (files, nfiles, LTO_section_ipa_pure_const);
+}
+
 /* Read all the symbols from the input files FNAMES.  NFILES is the
    number of files requested in the command line.  Instantiate a
    global call graph by aggregating all the sub-graphs found in each
@@ -2947,7 +3496,8 @@ read_cgraph_and_symbols (unsigned nfiles, const char **fnames)
   if (!quiet_flag)
     fprintf (stderr, "Reading object files:");
 
-  /* Read all of the object files specified on the command line.  */
+  /* Read the section tables of all of the object files specified on
+     the command line.  */
   for (i = 0, last_file_ix = 0; i < nfiles; ++i)
     {
       struct lto_file_decl_data *file_data = NULL;
@@ -2961,7 +3511,7 @@ read_cgraph_and_symbols (unsigned nfiles, const char **fnames)
       if (!current_lto_file)
 	break;
 
-      file_data = lto_file_read (current_lto_file, resolution, &count);
+      file_data = lto_file_read (current_lto_file, resolution);
       if (!file_data)
 	{
 	  lto_obj_file_close (current_lto_file);
@@ -2975,6 +3525,17 @@ read_cgraph_and_symbols (unsigned nfiles, const char **fnames)
       lto_obj_file_close (current_lto_file);
       free (current_lto_file);
       current_lto_file = NULL;
+    }
+
+  /* Now read the declarations of all of them, while helper threads
+     decompress the sections read next.  */
+  lto_schedule_prefetch (decl_data, last_file_ix);
+  for (i = 0; i < last_file_ix; ++i)
+    {
+      struct lto_file_decl_data *file_data;
+
+      for (file_data = decl_data[i]; file_data; file_data = file_data->next)
+	lto_create_files_from_ids (file_data, &count);
       ggc_collect ();
     }
 
@@ -3063,6 +3624,7 @@ read_cgraph_and_symbols (unsigned nfiles, const char **fnames)
     ipa_read_optimization_summaries ();
   else
     ipa_read_summaries ();
+  lto_finish_section_prefetch ();
 
   for (i = 0; all_file_decl_data[i]; i++)
     {
@@ -3411,6 +3973,12 @@ lto_main (void)
 	}
     }
 
+  if (time_report && !timevar_json)
+    {
+      lto_print_decompression_stats (stderr);
+      lto_print_type_hash_stats (stderr);
+    }
+
   /* Here we make LTO pretend to be a parser.  */
   timevar_start (TV_PHASE_PARSING);
   timevar_push (TV_PARSE_GLOBAL);
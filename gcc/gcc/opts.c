@@ -1679,6 +1679,14 @@ common_handle_option (struct gcc_options *opts,
       /* Deferred.  */
       break;
 
+    case OPT_fmem_report_:
+      opts->x_mem_report = 1;
+      break;
+
+    case OPT_ftime_report_:
+      opts->x_time_report = 1;
+      break;
+
     case OPT_fstack_usage:
       opts->x_flag_stack_usage = value;
       opts->x_flag_stack_usage_info = value != 0;
@@ -32,6 +32,9 @@ extern void app_enable (void);
    Called from varasm.c before most kinds of output.  */
 extern void app_disable (void);
 
+/* Skip the given number of the insn numbers used for unique labels.  */
+extern void skip_insn_numbers (int);
+
 /* Return the number of slots filled in the current
    delayed branch sequence (we don't count the insn needing the
    delay slot).   Zero if not in a delayed branch sequence.  */
@@ -154,6 +157,21 @@ extern const char *get_insn_template (int, rtx);
 /* Emit any pending weak declarations.  */
 extern void weak_finish (void);
 
+/* Output the constants that have a label but haven't been written yet
+   and empty the shared constant pool.  */
+extern void output_pending_constants (void);
+
+/* Skip the given number of constant label numbers.  */
+extern void skip_const_label_numbers (int);
+
+/* With -fcompact-asm, collect constant data to be written as blocks of
+   bytes.  */
+extern void begin_data_block (void);
+extern void flush_data_block (void);
+extern void end_data_block (void);
+extern bool add_integer_to_data_block (unsigned HOST_WIDE_INT, unsigned int);
+extern bool add_bytes_to_data_block (const char *, size_t);
+
 /* Decode an `asm' spec for a declaration as a register name.
    Return the register number, or -1 if nothing specified,
    or -2 if the ASMSPEC is not `cc' or `memory' and is not recognized,
@@ -2153,11 +2153,15 @@ execute_one_ipa_transform_pass (struct cgraph_node *node,
 {
   struct opt_pass *pass = &ipa_pass->pass;
   unsigned int todo_after = 0;
+  bool pass_timed;
 
   current_pass = pass;
   if (!ipa_pass->function_transform)
     return;
 
+  pass_timed = timevar_pass_start (pass->static_pass_number, pass->name,
+				   pass->tv_id);
+
   /* Note that the folders should only create gimple expressions.
      This is a hack until the new folder is ready.  */
   in_gimple_form = (cfun && (cfun->curr_properties & PROP_trees)) != 0;
@@ -2190,6 +2194,8 @@ execute_one_ipa_transform_pass (struct cgraph_node *node,
   do_per_function (execute_function_dump, NULL);
   pass_fini_dump_file (pass);
 
+  timevar_pass_stop (pass->static_pass_number, pass_timed);
+
   current_pass = NULL;
 }
 
@@ -2259,6 +2265,7 @@ execute_one_pass (struct opt_pass *pass)
   unsigned int todo_after = 0;
 
   bool gate_status;
+  bool pass_timed;
 
   /* IPA passes are executed on whole program, so cfun should be NULL.
      Other passes need function context set.  */
@@ -2309,6 +2316,9 @@ execute_one_pass (struct opt_pass *pass)
   if (!quiet_flag && !cfun)
     fprintf (stderr, " <%s>", pass->name ? pass->name : "");
 
+  pass_timed = timevar_pass_start (pass->static_pass_number, pass->name,
+				   pass->tv_id);
+
   /* Note that the folders should only create gimple expressions.
      This is a hack until the new folder is ready.  */
   in_gimple_form = (cfun && (cfun->curr_properties & PROP_trees)) != 0;
@@ -2366,6 +2376,8 @@ execute_one_pass (struct opt_pass *pass)
     gcc_assert (!(cfun->curr_properties & PROP_trees)
 		|| pass->type != RTL_PASS);
 
+  timevar_pass_stop (pass->static_pass_number, pass_timed);
+
   current_pass = NULL;
 
   return true;
@@ -2527,6 +2527,7 @@ extern int condjump_in_parallel_p (const_rtx);
 extern int max_reg_num (void);
 extern int max_label_num (void);
 extern int get_first_label_num (void);
+extern void skip_label_numbers (int);
 extern void maybe_set_first_label_num (rtx);
 extern void delete_insns_since (rtx);
 extern void mark_reg_pointer (rtx, int);
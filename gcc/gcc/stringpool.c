@@ -266,6 +266,15 @@ gt_pch_save_stringpool (void)
 	  spd->nslots * sizeof (spd->entries[0]));
 }
 
+/* Note SPD, and through it every identifier and what it refers to,
+   for PCH.  */
+
+void
+gt_pch_note_stringpool (void)
+{
+  gt_pch_n_16string_pool_data (spd);
+}
+
 /* Return the stringpool to its state before gt_pch_save_stringpool
    was called.  */
 
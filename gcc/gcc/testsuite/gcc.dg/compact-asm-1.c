@@ -0,0 +1,51 @@
+/* { dg-do run } */
+/* { dg-options "-O2 -fcompact-asm" } */
+
+extern void abort (void);
+extern int memcmp (const void *, const void *, __SIZE_TYPE__);
+
+int ints[] = { 1, -2, 0x12345678, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 7 };
+double doubles[] = { 0.5, -3.25, 1e100 };
+
+/* A quote, a backslash, and a byte followed by a digit, which must not
+   be taken as part of its octal escape.  */
+const char text[] = "say \"hi\" \\ \0011 \2337 end";
+
+struct node
+{
+  int value;
+  const char *name;
+  struct node *next;
+  int pad[8];
+  double weight;
+};
+
+struct node last = { 3, "last", 0, { 0 }, 2.0 };
+struct node first = { 1, text, &last, { 0, 0, 0, 0, 0, 0, 0, 5 }, 1.5 };
+
+int
+main (void)
+{
+  static const unsigned char expect[] =
+    { 's', 'a', 'y', ' ', '"', 'h', 'i', '"', ' ', '\\', ' ', 1, '1', ' ',
+      0233, '7', ' ', 'e', 'n', 'd', 0 };
+
+  if (ints[0] != 1 || ints[1] != -2 || ints[2] != 0x12345678
+      || ints[15] != 0 || ints[16] != 7)
+    abort ();
+  if (doubles[0] != 0.5 || doubles[1] != -3.25 || doubles[2] != 1e100)
+    abort ();
+  if (sizeof (text) != sizeof (expect)
+      || memcmp (text, expect, sizeof (expect)) != 0)
+    abort ();
+  if (first.value != 1 || first.name != text || first.next != &last
+      || first.pad[7] != 5 || first.weight != 1.5)
+    abort ();
+  if (last.next != 0 || last.name[3] != 't' || last.weight != 2.0)
+    abort ();
+  return 0;
+}
+
+/* { dg-final { scan-assembler "\\.ascii" } } */
+/* { dg-final { scan-assembler "\\.zero" } } */
+/* { dg-final { scan-assembler {"say \\"hi\\" \\\\ \\0011 \\2337 end\\0"} } } */
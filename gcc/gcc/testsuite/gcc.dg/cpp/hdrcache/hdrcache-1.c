@@ -0,0 +1,9 @@
+/* Included twice, so that the second inclusion is skipped by its
+   guard.  */
+#include <hc-sys.h>
+#include "hc-usr.h"
+#include <hc-sys.h>
+#include "hc-usr.h"
+
+int sys_value = HC_SYS_VALUE;
+int usr_value = HC_USR_VALUE;
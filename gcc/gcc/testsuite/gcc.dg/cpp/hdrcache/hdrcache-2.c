@@ -0,0 +1,14 @@
+/* The guards are already defined, so neither header has any effect.  */
+#define HC_SYS_H
+#define HC_USR_H
+#include <hc-sys.h>
+#include "hc-usr.h"
+
+#ifdef HC_SYS_VALUE
+#error hc-sys.h was not skipped
+#endif
+#ifdef HC_USR_VALUE
+#error hc-usr.h was not skipped
+#endif
+
+int skipped;
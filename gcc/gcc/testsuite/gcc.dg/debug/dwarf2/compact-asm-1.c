@@ -0,0 +1,31 @@
+/* With -fcompact-asm the DIEs, abbreviations and line program are written
+   as .ascii blocks, but section offsets, addresses and label deltas are
+   still left to the assembler.  */
+/* { dg-do compile { target { { i?86-*-* x86_64-*-* } && lp64 } } } */
+/* { dg-options "-O0 -gdwarf-2 -fcompact-asm" } */
+/* { dg-final { scan-assembler "\\.Ldebug_info0:\[\n\r\]+\t\\.ascii" } } */
+/* { dg-final { scan-assembler "\\.Ldebug_abbrev0:\[\n\r\]+\t\\.ascii" } } */
+/* { dg-final { scan-assembler "\\.ascii\t\"\[^\n\r\]*counter\\\\0" } } */
+/* { dg-final { scan-assembler "\t\\.long\t\\.Ldebug_abbrev0" } } */
+/* { dg-final { scan-assembler "\t\\.long\t\\.Ldebug_line0" } } */
+/* { dg-final { scan-assembler "\t\\.long\t\\.LELT0-\\.LSLT0" } } */
+/* { dg-final { scan-assembler "\t\\.quad\t\\.Ltext0" } } */
+/* { dg-final { scan-assembler "\t\\.quad\t\\.LFB0" } } */
+/* { dg-final { scan-assembler "\t\\.quad\t\\.LM1" } } */
+/* { dg-final { scan-assembler "\t\\.quad\tcounter" } } */
+/* { dg-final { scan-assembler-not "\\.uleb128" } } */
+
+int counter;
+
+static int
+add (int a, int b)
+{
+  return a + b + counter;
+}
+
+int
+main (void)
+{
+  counter = add (1, 2);
+  return 0;
+}
@@ -0,0 +1,15 @@
+/* With -fcompact-asm the CFI of each FDE is written as .ascii blocks, but
+   DW_CFA_advance_loc4 stays a separate byte so that the assembler can
+   still shrink it together with the label delta after it.  */
+/* { dg-do compile { target { { i?86-*-* x86_64-*-* } && lp64 } } } */
+/* { dg-options "-O0 -gdwarf-2 -fno-dwarf2-cfi-asm -fcompact-asm" } */
+/* { dg-final { scan-assembler "\\.LASFDE0:\[^\n\r\]*\[\n\r\]+(\t\[^\n\r\]*\[\n\r\]+)*\t\\.ascii" } } */
+/* { dg-final { scan-assembler "\t\\.byte\t0x4\[\n\r\]+\t\\.long\t\\.LCFI0-\\.LFB0" } } */
+/* { dg-final { scan-assembler "\t\\.byte\t0x4\[\n\r\]+\t\\.long\t\\.LCFI1-\\.LCFI0" } } */
+/* { dg-final { scan-assembler-not "\\.ascii\t\"\[^\n\r\]*\\\\4\"\[\n\r\]+\t\\.long\t\\.LCFI" } } */
+
+int
+f (int x)
+{
+  return x + 1;
+}
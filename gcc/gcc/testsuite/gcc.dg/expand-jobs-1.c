@@ -0,0 +1,100 @@
+/* Functions compiled by parallel expand workers must agree on constant
+   pool entries, string literals and function-local statics, which are
+   numbered for the whole unit.  Unwind tables are turned off, as the
+   workers aren't used when they are written without .cfi directives.  */
+/* { dg-do run } */
+/* { dg-options "-O2 -fno-asynchronous-unwind-tables --param expand-jobs=4" } */
+
+extern void abort (void);
+extern int strcmp (const char *, const char *);
+
+#define FUNC(N)							\
+  static double __attribute__ ((noinline))			\
+  f##N (int x)							\
+  {								\
+    static int calls;						\
+    static const int table[] = { N, N + 1, N + 2, N + 3 };	\
+    double d;							\
+								\
+    calls++;							\
+    switch (x & 7)						\
+      {								\
+      case 0: d = 1.5; break;					\
+      case 1: d = 2.25 * N; break;				\
+      case 2: d = -0.125; break;				\
+      case 3: d = 1e10 + N; break;				\
+      case 4: d = 3.75; break;					\
+      case 5: d = table[x & 3]; break;				\
+      case 6: d = 0.5 * calls; break;				\
+      default: d = N / 4.0; break;				\
+      }								\
+    return d + table[N & 3];					\
+  }								\
+  static const char * __attribute__ ((noinline))		\
+  s##N (void)							\
+  {								\
+    static const char *last;					\
+    const char *r = last ? last : "f" #N;			\
+    last = "again";						\
+    return r;							\
+  }
+
+#define FUNC4(N) FUNC (N##0) FUNC (N##1) FUNC (N##2) FUNC (N##3)
+
+FUNC4 (1) FUNC4 (2) FUNC4 (3) FUNC4 (4)
+
+static double (*const funcs[]) (int) = {
+  f10, f11, f12, f13, f20, f21, f22, f23,
+  f30, f31, f32, f33, f40, f41, f42, f43
+};
+
+static const char *(*const names[]) (void) = {
+  s10, s11, s12, s13, s20, s21, s22, s23,
+  s30, s31, s32, s33, s40, s41, s42, s43
+};
+
+static const int numbers[] = {
+  10, 11, 12, 13, 20, 21, 22, 23, 30, 31, 32, 33, 40, 41, 42, 43
+};
+
+static double
+expect (int n, int x, int calls)
+{
+  double d;
+
+  switch (x & 7)
+    {
+    case 0: d = 1.5; break;
+    case 1: d = 2.25 * n; break;
+    case 2: d = -0.125; break;
+    case 3: d = 1e10 + n; break;
+    case 4: d = 3.75; break;
+    case 5: d = n + (x & 3); break;
+    case 6: d = 0.5 * calls; break;
+    default: d = n / 4.0; break;
+    }
+  return d + n + (n & 3);
+}
+
+int
+main (void)
+{
+  char buf[4];
+  int i, x;
+
+  for (i = 0; i < 16; i++)
+    {
+      for (x = 0; x < 8; x++)
+	if (funcs[i] (x) != expect (numbers[i], x, x + 1))
+	  abort ();
+
+      buf[0] = 'f';
+      buf[1] = '0' + numbers[i] / 10;
+      buf[2] = '0' + numbers[i] % 10;
+      buf[3] = 0;
+      if (strcmp (names[i] (), buf) != 0
+	  || strcmp (names[i] (), "again") != 0)
+	abort ();
+    }
+  return 0;
+}
@@ -0,0 +1,118 @@
+/* Collect at every opportunity in generational mode, so that minor
+   collections and the write barrier are exercised throughout the
+   compilation.  */
+/* { dg-do run } */
+/* { dg-options "-O2 --param ggc-generational=1 --param ggc-min-heapsize=0 --param ggc-nursery-size=0" } */
+
+extern void abort (void);
+
+struct node
+{
+  int key;
+  struct node *left, *right;
+};
+
+static struct node pool[64];
+static int used;
+
+static struct node *
+insert (struct node *t, int key)
+{
+  if (!t)
+    {
+      t = &pool[used++];
+      t->key = key;
+      t->left = t->right = 0;
+    }
+  else if (key < t->key)
+    t->left = insert (t->left, key);
+  else
+    t->right = insert (t->right, key);
+  return t;
+}
+
+static int
+walk (const struct node *t, int *out, int n)
+{
+  if (!t)
+    return n;
+  n = walk (t->left, out, n);
+  out[n++] = t->key;
+  return walk (t->right, out, n);
+}
+
+static inline unsigned
+mix (unsigned x)
+{
+  x ^= x >> 13;
+  x *= 0x5bd1e995;
+  return x ^ (x >> 15);
+}
+
+static int
+classify (int c)
+{
+  switch (c % 9)
+    {
+    case 0: return 3;
+    case 1: return -1;
+    case 2: return 7;
+    case 3: return 0;
+    case 4: return 11;
+    case 5: return -6;
+    case 6: return 2;
+    case 7: return 5;
+    default: return 1;
+    }
+}
+
+static double
+poly (double x)
+{
+  return ((0.5 * x - 1.25) * x + 3.0) * x - 0.75;
+}
+
+static void
+fill (char *buf, int n)
+{
+  int i;
+
+  for (i = 0; i < n - 1; i++)
+    buf[i] = 'a' + mix (i) % 26;
+  buf[n - 1] = 0;
+}
+
+int
+main (void)
+{
+  struct node *root = 0;
+  int keys[64], i, sum = 0;
+  char buf[32];
+  double d = 0;
+
+  for (i = 0; i < 64; i++)
+    root = insert (root, mix (i) % 1000);
+  if (walk (root, keys, 0) != 64)
+    abort ();
+  for (i = 1; i < 64; i++)
+    if (keys[i - 1] > keys[i])
+      abort ();
+
+  for (i = 0; i < 90; i++)
+    sum += classify (i);
+  if (sum != 10 * (3 - 1 + 7 + 0 + 11 - 6 + 2 + 5 + 1))
+    abort ();
+
+  for (i = 0; i < 4; i++)
+    d += poly (i);
+  if (d != -0.75 + 1.5 + 4.25 + 10.5)
+    abort ();
+
+  fill (buf, sizeof buf);
+  for (i = 0; i < 31; i++)
+    if (buf[i] < 'a' || buf[i] > 'z')
+      abort ();
+  if (buf[31] != 0)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,32 @@
+/* Objects whose LTO sections use different codecs link together: this
+   one uses the zlib default, codec-1_1.c uses LZ4.  */
+
+/* { dg-lto-do run } */
+/* { dg-lto-options {{-O2 -flto} {-O0 -flto} {-O2 -flto -flto-partition=none}} } */
+
+extern void abort (void);
+
+struct point
+{
+  int x, y;
+};
+
+extern int sum_table (int);
+extern const char *greeting (void);
+extern struct point mid (struct point, struct point);
+
+int
+main (void)
+{
+  struct point a = { 2, 10 }, b = { 6, -4 }, m;
+  const char *s = greeting ();
+
+  if (sum_table (4) != 1 + 4 + 9 + 16)
+    abort ();
+  if (s[0] != 'h' || s[4] != 'o' || s[5] != 0)
+    abort ();
+  m = mid (a, b);
+  if (m.x != 4 || m.y != 3)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,34 @@
+/* { dg-options "-flto-compression-codec=lz4" } */
+
+struct point
+{
+  int x, y;
+};
+
+static const int squares[] = { 0, 1, 4, 9, 16, 25, 36, 49 };
+
+int
+sum_table (int n)
+{
+  int i, sum = 0;
+
+  for (i = 1; i <= n; i++)
+    sum += squares[i];
+  return sum;
+}
+
+const char *
+greeting (void)
+{
+  return "hello";
+}
+
+struct point
+mid (struct point a, struct point b)
+{
+  struct point m;
+
+  m.x = (a.x + b.x) / 2;
+  m.y = (a.y + b.y) / 2;
+  return m;
+}
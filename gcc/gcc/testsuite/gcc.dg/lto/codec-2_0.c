@@ -0,0 +1,25 @@
+/* LZ4 sections split into many segments, and holding incompressible
+   data, link with zlib compressed ones.  */
+
+/* { dg-lto-do run } */
+/* { dg-lto-options {{-O2 -flto} {-O0 -flto -flto-partition=none}} } */
+
+extern void abort (void);
+
+extern const unsigned char noise[4096];
+extern unsigned noise_at (int);
+
+int
+main (void)
+{
+  unsigned x = 12345;
+  int i;
+
+  for (i = 0; i < 4096; i++)
+    {
+      x = x * 1103515245 + 12345;
+      if (noise[i] != ((x >> 24) & 0xff) || noise_at (i) != noise[i])
+	abort ();
+    }
+  return 0;
+}
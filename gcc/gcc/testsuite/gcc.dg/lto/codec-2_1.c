@@ -0,0 +1,268 @@
+/* { dg-options "-flto-compression-codec=lz4 --param lto-lz4-segment-size=1024" } */
+
+/* Pseudo-random bytes, which LZ4 can't compress, from the generator
+   in codec-2_0.c seeded with 12345.  */
+
+const unsigned char noise[4096] =
+  "\xd3\xa7\xd6\x0d\xc2\x3e\xcd\xaf\x20\xaf\x69\x96\x26\x52\x65\x7e"
+  "\xe6\xbb\x44\xd0\x9f\x5a\x5b\x7d\xaa\xb9\xda\x5e\x96\x02\x64\x05"
+  "\xcc\x1f\x47\xc1\xb2\x97\x52\x5b\x27\xfc\xea\xb1\xda\x90\xcd\x46"
+  "\xd9\x73\xb2\x6a\x4f\x82\xaf\x8e\x47\xaf\x13\xe6\x09\x8a\x19\x72"
+  "\x46\x3e\xb0\x0c\x3a\x27\x30\x0f\x79\xe5\xb7\xc8\x02\x7a\x94\xac"
+  "\xdf\xdc\xea\x17\x59\x06\x7e\x03\x94\x7f\x56\x05\x1e\xd1\x94\x74"
+  "\xb8\x6e\xbf\x94\x63\x00\x65\x25\x90\x1b\xb9\x9f\xde\xdb\xa4\x1a"
+  "\xd6\xcc\x70\x9b\x91\x47\xfe\x37\x30\x07\x24\x5c\x9c\xad\xb6\x30"
+  "\xe4\x74\x50\xbd\x48\x4f\xdf\x73\xb3\x2c\x86\x37\x3a\x15\x53\xf5"
+  "\xe5\x79\xf5\x77\xd4\xbf\x50\xfc\x87\x03\xa8\xce\xd3\x8f\xcc\xca"
+  "\xdb\x73\x69\xa3\x0d\x5e\x76\x4b\xf4\x81\x5f\xd0\x6b\x2b\x66\x9f"
+  "\x81\x72\x56\xe7\x0e\x07\x83\xa3\xd0\x0a\xba\x74\xa0\x86\x8f\x62"
+  "\xf6\xe9\x3c\x24\xe1\x93\xec\x7c\x2f\x5e\x32\xe2\x57\xb7\x0c\x74"
+  "\x6d\xa3\x9c\xe5\x34\xd0\x91\xf8\x10\x8d\xdd\xa7\x6d\x3d\x25\x12"
+  "\xdd\xaf\x29\xd4\x02\x6e\xf3\x4f\x10\xe4\x99\x23\x6b\xf2\xde\xcd"
+  "\xb3\x54\xfa\x25\x48\xec\x61\x43\x17\xdd\x41\xfb\x30\xfa\x1e\xf2"
+  "\x81\xfc\xb9\x07\xb6\x8e\x27\x8b\x0b\x11\xd9\x86\xa4\xb2\xe5\x00"
+  "\xae\x29\xd1\x17\x5a\x46\xc3\x49\x80\x25\xc1\x3f\x69\xa0\x78\x15"
+  "\x23\x61\xa3\xcc\x54\xab\x0f\x73\x64\xbd\xe4\x37\x89\x66\x94\x5f"
+  "\x02\x21\xaf\xe9\x84\xe4\x76\x49\xb3\x6b\xe6\x7f\x26\xae\x9c\x8a"
+  "\x4d\xcc\xca\xee\x3b\x9b\x20\xc4\x26\x9e\x57\xa0\x2d\x1b\xc9\x35"
+  "\x9f\x9a\x4b\x84\xeb\xeb\x25\x01\xe4\x92\xe2\x03\x01\x3c\x5e\x5d"
+  "\xd6\x88\x3d\xf2\xd7\x50\xba\xb8\x2d\x43\x7c\x67\x2f\x79\xd0\xce"
+  "\xc4\x4b\x8b\x8b\xc3\x99\x65\xa8\x12\x5a\x95\x4e\x1e\x03\x00\x94"
+  "\xe0\x3b\x35\x1c\xa1\xd7\x29\x06\x1f\x1b\x49\x6e\xbb\xc5\x60\x6d"
+  "\xf8\x47\x7e\x5f\x49\x4b\xb9\xf2\x0b\x5c\x8c\x21\x2f\x55\x2e\x33"
+  "\xdb\xe6\x1a\x6a\x1e\x59\xa5\xe1\x6c\x6e\x5f\xd3\x88\xe0\x9c\x53"
+  "\x10\x00\x62\x1e\xc7\x78\x8e\x10\x65\x11\xfc\x76\x71\x1f\x03\x39"
+  "\x81\xe7\x7f\x98\xdd\x1d\x52\xf5\x54\x62\x0b\xef\xda\x45\x13\xbf"
+  "\x2e\x40\x9f\xa0\x95\xb3\x3f\xae\x84\xcb\xcb\x86\xae\xed\x03\xa1"
+  "\xda\xf8\x21\x1b\x7a\x83\x41\x6e\xdf\xf6\x48\x58\x80\x0e\xc0\xea"
+  "\xbe\x30\xc9\x7a\x15\xab\x12\xf3\x99\xb9\x88\xc4\x3b\xe6\x1f\x63"
+  "\x37\x30\xec\x28\x9f\x09\x6c\xf2\xe3\x09\xbb\xdf\xd4\xee\x0b\x08"
+  "\x78\x54\xa2\xfc\xb5\x2d\x39\x85\x9e\xe7\x6d\xe1\xf9\xca\xb4\x72"
+  "\x38\xff\xf5\xab\x00\x49\xbd\xa2\x04\x53\xb5\x93\xc0\x36\xc5\x4b"
+  "\x63\x8b\x15\x34\xee\x20\xd1\x84\x5c\x3a\x64\xc7\x56\xf9\x8c\xbc"
+  "\xc8\x35\x81\x51\x5d\xf7\x08\x1e\xad\x68\x35\xbd\xb5\xd3\x2f\xe0"
+  "\xce\x12\x3c\xe9\x49\x86\xe6\x8b\x67\x77\xff\x9e\x4b\x6e\xdb\x2e"
+  "\x1e\xfc\xfc\x7f\x81\xe6\x0c\x7f\x1a\xbb\xe3\xe3\xb3\x4e\xf4\xf0"
+  "\x57\x81\x5b\xa1\x56\x81\x6d\xb3\x1f\x3b\x7e\xcb\x5e\xbf\x43\xae"
+  "\xbc\xd8\x02\x59\x47\x03\x76\x5b\x4f\x98\x15\xc7\x46\xc9\x2a\xa1"
+  "\xe5\xcb\xe2\x9d\xb4\x4a\x48\x91\xaf\x02\xcc\xec\x9f\x1e\xd0\x20"
+  "\x71\xac\x5a\xbd\x91\x57\xde\xc6\x20\x28\xce\x65\x85\x07\x55\x13"
+  "\xb0\x41\x6f\xd8\x0f\x3a\x45\x34\x0f\x24\x82\xdf\xad\x5a\xfd\x62"
+  "\x58\xb7\xf6\x46\x50\x08\xc8\x4c\x29\x70\xba\xf9\x13\x64\x64\x65"
+  "\x36\x8f\xc9\x0c\x1b\xc4\x1f\x28\x04\xd2\xe2\xb9\xaf\xdd\xad\x51"
+  "\xd8\x91\xf4\x4b\x82\x57\xa3\xf9\xd5\x50\x33\xf8\x20\xd7\xb1\xae"
+  "\x45\xbc\xe6\xae\x9b\x78\x7b\x76\x1c\x1c\xdd\xd0\x5d\xae\x31\xc3"
+  "\xa4\x32\x9f\xde\x2d\xa1\xcd\x52\x59\x87\x3f\x12\x66\xf6\x05\x05"
+  "\xf5\x2d\xe5\xee\x5e\x00\xec\xa3\xb4\xed\x0e\xb2\xf6\x6f\x48\x8b"
+  "\xbb\xeb\x6e\xce\x66\x61\x8d\x59\xb7\xac\x8f\x37\x2e\xf1\x91\x7a"
+  "\xac\xa1\x14\xb9\x3e\x25\xf0\xad\xf4\x0c\xbd\x2c\x49\x5e\x1a\x79"
+  "\x67\x69\x04\xa6\x4e\x2c\x17\x8e\xbd\x35\x80\x90\x4b\x94\xf6\x1c"
+  "\x1b\x34\xec\xb8\x21\xca\xf1\x12\xcf\x1c\xdc\x46\xaf\x57\x3d\x58"
+  "\x3f\xb7\x2e\xac\x12\xb3\x8c\xe9\x05\x73\x1e\x83\x1b\x48\x3e\xf2"
+  "\x3e\x5f\x10\x4f\xfa\xee\x44\xca\x06\x9c\x0d\x42\x0d\xcf\xb0\xef"
+  "\x27\x3c\xe8\xe4\xe8\xc3\xf7\xe2\xf5\x93\x1c\xb0\x8b\x11\xe0\x02"
+  "\x5e\xf5\x51\x9f\xc8\xad\x2d\x49\x23\xe6\x9a\xa1\xd5\xda\xe2\x01"
+  "\x4c\xb8\x58\x0c\x16\x46\x50\x6b\xbe\x9d\xdd\xf7\x12\x90\xc0\x4e"
+  "\x10\x27\xad\x85\x93\x3e\xd8\x7e\x80\x32\x7a\x1e\x03\x25\xac\x4e"
+  "\x2a\x4a\xd1\x9e\xed\x42\x7c\xf1\x5f\x78\x6f\x71\xb2\x02\x2d\xd3"
+  "\x34\x80\x4b\x99\x73\xf5\x61\xd8\x40\x92\x53\xb1\x21\xfb\x52\x90"
+  "\x88\x6c\xd1\xd2\xc7\xd8\x4b\x5f\xa1\xe2\x8a\x73\xfc\x3e\xe1\x89"
+  "\xf8\xe8\x80\x31\x8a\x41\xcd\x3c\x52\xf6\x72\x8e\x45\x43\x85\x80"
+  "\x79\xf3\x03\x9a\x0e\x46\x79\x1b\x1b\x7b\x94\x8f\x0a\xb9\x03\x67"
+  "\xd5\xa3\xcc\x5d\x07\xae\x0f\x11\x73\x29\xd4\x25\x10\x7e\x64\xd0"
+  "\x5b\x12\x3e\xa5\x37\xe4\xad\x08\x2d\xba\xa0\x93\x85\x85\x28\x5d"
+  "\x8f\x52\xdd\xe9\x23\xe3\x03\x35\x2a\xd2\x21\x21\xaf\xcc\x76\x2f"
+  "\xd9\x57\x83\x5d\xc1\x29\x7d\x84\x06\xf4\x6a\x89\x9f\x4c\x4d\x58"
+  "\x37\xef\x8b\x5f\x26\xa4\x76\x06\xcb\x73\xab\x6a\xdc\xe7\xb2\x49"
+  "\xea\xac\x03\xea\x38\xa6\x68\x68\xa0\x5b\x5d\xb6\x17\x58\xdf\x43"
+  "\x2a\xd4\xdb\x03\x60\xd0\x1c\x5b\x76\x6b\x73\x23\xdb\x25\x77\xc5"
+  "\xd1\x56\x16\x2d\x36\x08\xda\x0b\xc0\xfc\x8d\x9c\x3a\x8d\xb3\x01"
+  "\x11\xb4\xfc\xd6\x32\x63\x98\x89\x18\xf6\x24\xad\x7f\x79\x94\x46"
+  "\x1d\xf8\x45\xc7\x5e\x18\x2b\x3f\xf8\xbf\xbc\xf9\xde\x6b\x0e\x74"
+  "\xe0\x9f\x4c\x95\x05\x73\x78\x60\x67\x2b\x16\xa3\x24\x71\x40\x6b"
+  "\xa8\x8f\x41\x11\x61\xbe\xa0\x53\xa7\x6a\x59\xc6\x67\x10\x9e\x7a"
+  "\xd9\x02\x54\xb7\x4f\x35\x35\x2c\xe7\xfb\x4c\xdd\xb4\x38\x22\xd0"
+  "\x9a\x76\xe9\x21\xfb\xf8\x68\x11\xf5\x9d\x7c\x3a\xc4\x33\x7f\xec"
+  "\x88\xa3\xc7\x73\x93\xf8\x37\xb5\xea\x38\x75\x6f\xa5\x94\x4b\x0c"
+  "\x65\x63\x48\xcc\xf4\xe7\xa0\xbf\xda\xd5\xec\xc5\x70\x29\x37\x9e"
+  "\xc7\xa7\x87\xb9\x5f\x28\xcf\x40\x89\x8a\xef\xa8\xf7\xe8\x37\xb1"
+  "\xc8\x67\x94\xa0\x22\xc1\x4f\x1f\x16\x6c\x19\x16\x73\xe3\xb9\x63"
+  "\xb9\x8e\xa0\x35\x4d\x4b\x3b\x8c\xad\x7a\xbf\x14\x38\x32\xd0\x50"
+  "\xcf\xf0\x2f\xe6\x63\xde\x6a\x6f\x38\x95\x22\x17\x60\xec\x65\x07"
+  "\xd1\x34\x4a\x50\x05\x06\xa5\xd7\x0b\x6a\x9a\x7a\x81\x0d\x6a\x73"
+  "\xcf\xc9\xaa\xa7\xa5\xaf\xd1\x6a\x99\x64\xcf\xec\x57\x6e\x06\x53"
+  "\xca\xd1\xeb\x2f\x38\x18\x24\xd7\x21\x9a\xe0\xdf\x78\xaf\xc8\xa2"
+  "\x6b\x17\xbd\xa5\xe0\xc1\x50\x45\x5f\xc3\x97\xf9\x03\x2c\xd3\x0d"
+  "\xae\xf9\x12\xb2\xa4\x5c\xb9\xc2\x3c\x24\x9b\x82\x4e\xea\x15\x60"
+  "\x93\x5d\x50\x5e\x18\xbd\xa0\xb4\x7d\x7d\x9c\xda\x9a\x88\x6f\xf6"
+  "\xd1\x9c\x7d\x77\x14\xca\x53\x48\x74\xff\x84\xdf\xc0\x2e\xeb\x2b"
+  "\x82\x77\x75\x0d\x5e\x69\x63\xe4\xaf\x36\xaa\x69\xe1\x7e\xe9\xcb"
+  "\xd4\x05\x14\xd6\x5e\x75\xcc\x95\xab\xfe\xfe\xae\x18\x84\x4f\x80"
+  "\xbd\xa2\x6b\xa9\xcd\xa7\x2a\x7f\x80\x6f\x3b\xbc\x27\xa6\xbb\x46"
+  "\xa5\xde\xec\xe4\x65\x8d\xe9\x50\x93\xd0\x18\xe2\x2b\x93\xb2\xd6"
+  "\x19\x71\x9d\xe4\x8f\x74\x72\xac\x46\x85\x75\x25\x48\x34\xcf\x1b"
+  "\x7b\x29\x45\x71\x16\x5d\x5d\x9f\xa7\x00\x8f\xab\x5a\x9d\xf2\x9f"
+  "\xb4\xd8\xa0\x2e\xd7\xe9\xa2\x0d\x22\xb1\x2a\x31\xa9\xfa\x75\xfc"
+  "\xdd\x46\x8b\x0b\x6d\x4c\xc6\x22\x2f\xf6\xc9\x75\x93\x82\x57\x4b"
+  "\xf8\x24\x38\xb2\xe6\x3c\x0f\xc0\x03\x09\xd7\xaa\x40\x64\x6e\x96"
+  "\x9a\xf3\x58\xf9\x70\xdf\xaf\xf4\x3f\xf3\xdb\xe7\x4f\xba\x97\x45"
+  "\x9d\xff\x53\x54\x08\xbf\xf8\x5f\xa2\x7c\xa6\x96\x8b\x79\xe4\x92"
+  "\xcf\x46\x70\x41\x30\xb5\x8c\xae\xb6\x18\x84\xe6\x94\x5e\xd2\xf5"
+  "\xa5\x6f\x0c\xba\x96\xde\x8a\x01\x84\xd9\x6c\x37\x95\xe0\x6f\x96"
+  "\xe6\xb4\xc4\xa4\xcd\x88\xc1\x64\x41\x5e\x2f\x90\xf2\x1f\x95\xbd"
+  "\x5f\xd6\xa9\x40\xf4\x24\xdd\x38\xfd\xc7\xab\x0a\xf6\xd7\x12\x43"
+  "\x93\x0c\x70\x9d\x70\x31\x9b\xa7\x56\x9e\xf5\x42\x87\x4c\xdb\xfd"
+  "\x67\xf2\x9e\x03\x93\x35\xf5\x12\x29\xcc\x90\xc9\xd2\x3c\x3c\x35"
+  "\xd6\x7b\xbc\x66\x50\xa4\x54\x82\x3b\x89\x98\x93\xfd\xcf\x07\x11"
+  "\xa2\xde\x88\xd8\xed\xd4\xc1\x19\xf2\x49\xf6\x69\xd7\x86\xc7\x07"
+  "\xfe\x88\x1e\xf4\xb0\xee\x13\x7e\xff\xaf\x89\x58\x88\x2e\xeb\x4e"
+  "\x44\x0e\x32\x53\x8d\xdd\x1f\x53\x0f\x7b\x61\x1e\x41\xcc\xfb\x4d"
+  "\xa3\x18\x36\xf7\xdd\x3d\xea\x9f\x7e\x7c\xe3\x9f\xea\x8d\xc5\x09"
+  "\xcc\x55\x93\xc1\x06\x4b\xd6\x43\x02\x7b\x03\x53\xd7\xbc\x8c\x98"
+  "\xa9\x6a\xd1\xdc\x32\xd7\xd6\x66\x5f\x34\x6e\xb5\x71\xaa\x3c\x90"
+  "\x04\xe2\xcd\x2f\xf9\x32\x9a\xe7\x17\x3e\xba\xb3\xed\xa4\x97\x77"
+  "\x41\x1b\xe6\xcc\x16\x20\xc2\xce\x17\xfd\x9c\x21\xf6\xdf\x67\x30"
+  "\x04\x3d\x2f\x62\x12\xc5\x0c\xb9\x69\x95\x10\x24\x62\x6b\xa9\x71"
+  "\xe9\x22\x9c\xab\xfa\x97\x84\x4f\xe5\xd5\x8f\xa6\xde\x22\xc5\x2e"
+  "\x2e\x4d\x34\xdd\x09\x50\xb7\xaf\xde\x2c\x3a\xc7\xa1\x97\xb8\x0d"
+  "\x68\xd4\x41\x1a\x5d\xd8\xde\xdf\xd5\x96\x10\x46\x1a\x06\x46\xcf"
+  "\x31\x54\x81\xdf\xa3\x3d\x14\x3c\x27\x8d\x1a\xfa\xa2\x47\x28\xcb"
+  "\xd5\xe0\x54\x76\xca\x9b\x7f\xec\xbf\xf8\x99\x3b\x29\xba\x41\x52"
+  "\x07\xf0\xeb\x63\xb0\x11\x86\x4e\xc3\x1d\x3c\x56\xe8\x39\xc7\x28"
+  "\x8f\x52\x7c\xd7\xd6\xb2\xff\x64\x47\x8e\x4c\xfd\x12\x08\x7b\xf1"
+  "\xf8\x1a\x6f\x1f\x0c\x6f\x5e\x4e\xfc\x1c\xdc\xb3\x82\xc5\xd1\x9f"
+  "\x44\x92\x8e\x13\x24\x0d\xe6\xaf\xdd\xc6\xfa\x40\x6c\x57\x26\xe4"
+  "\x97\x29\x37\x87\xa0\x13\xd8\x24\xe6\xa8\xde\x20\x0c\xdf\xed\xa4"
+  "\xec\x65\x8b\xba\x63\xb8\xa5\xb0\xbc\xec\x1d\xf3\x58\xa8\xdf\x5f"
+  "\xc2\xcf\x9c\xc8\x60\xd7\x1b\x31\x64\xb9\xd4\xec\xad\x17\x2d\xa8"
+  "\xcd\xea\x9f\x18\x4c\xdb\x9a\xc9\xed\x26\xdd\x43\x82\x9b\xaf\x90"
+  "\xa5\x1a\x1e\xce\x4d\xb1\x3d\x54\x24\x26\xfc\xa1\x18\x9b\x11\x18"
+  "\x77\x9d\x23\x37\xa7\xb8\x10\xd4\x43\x78\x0f\x96\x26\x6a\x0a\xa2"
+  "\xb5\x74\x6d\x3f\x72\xb1\x3d\xe6\xa0\x9d\x3f\x05\x8d\x32\x85\x5f"
+  "\xc7\x56\x9c\xdb\x45\xaf\x3d\x2b\x5e\xc1\x30\x92\x07\xeb\xd3\xbe"
+  "\xb7\xa2\x63\x7e\xe8\x06\x07\xbf\x1d\xad\x32\x18\xd7\x42\xde\xe0"
+  "\xe5\x49\xba\x85\x05\x3c\x42\xa2\xaa\xbb\x6e\x15\x78\x91\x56\x06"
+  "\xb8\xc6\x08\xaa\xd4\xf8\x74\x30\xad\xbf\x19\x19\x4e\xca\xe1\xfe"
+  "\x47\x07\x59\x72\xd0\xf5\x2f\x89\x5e\xfd\xa0\x3a\x55\x6a\x4c\x98"
+  "\x13\x60\x8c\x9d\x65\xee\x46\x07\x2f\x17\xdf\x82\xd4\x67\xbc\x15"
+  "\xae\x7a\x83\x99\x9f\x90\xfc\xac\x7f\xfb\x49\x5b\x08\x21\xda\x92"
+  "\x70\x47\x50\xef\xd9\x69\x30\x8f\x4c\xd7\x1e\x07\xd9\x51\x0a\x7e"
+  "\x26\xec\x6b\xb1\x72\xda\x90\x53\xdd\x04\x99\x0a\x86\xfc\x92\x09"
+  "\xc2\xb4\xde\xf1\x77\x05\xcb\x8e\x79\xfa\x1d\x9c\x59\x5e\xd3\x90"
+  "\x09\xff\x73\x2a\x58\xbf\xbe\x42\x13\x41\x6b\x18\x51\xde\x71\x11"
+  "\x46\x36\xeb\xb3\x94\x7e\xa2\x46\xf9\x5c\xcd\x6d\xda\xfd\x89\x9b"
+  "\xfa\xb5\x27\x30\x6c\x48\x42\xba\x89\xbb\x48\x90\x76\x45\xdf\xba"
+  "\x89\xbd\x5c\xff\x90\xa7\x27\x76\xda\xaf\xcb\xe5\x71\x3b\x0c\xeb"
+  "\xeb\x68\x40\xac\xd3\x97\xc8\x78\x73\x55\x62\xb9\x8e\x4c\xb2\x0d"
+  "\x60\x93\x3e\x5c\xd8\x74\xbb\x57\xf5\x86\x61\xa9\xbc\xc0\xa7\xcc"
+  "\x19\xd2\xa2\x43\xc1\xec\xe6\xb2\xd1\xcc\x99\x18\xbf\xa8\x2a\x14"
+  "\xef\x5d\xcc\x0d\xe3\xf0\xaa\xa0\xf1\x4d\x85\x9b\xe7\xd1\x11\x81"
+  "\x0d\x05\x5e\x55\x74\xa2\x1c\x1e\x6e\xbd\x79\x6c\xba\xae\xf6\xd0"
+  "\xa4\x1d\x6c\x11\x37\x46\x2d\x83\x3e\x4d\xd7\xd8\xa9\x4e\x6c\x4c"
+  "\x9b\x72\xb0\x00\x35\x31\xdb\xec\xe3\x9e\x3a\xb0\xbc\x4a\x2d\x41"
+  "\x3b\x32\xb2\x21\x63\xbb\x66\xae\x1c\xac\xa7\xba\x45\xb4\x49\x6a"
+  "\xe4\xe5\x01\x1c\x5b\x2d\x7b\xc7\x93\xc2\xbf\x1e\x8f\x08\x56\x63"
+  "\xba\x55\x5c\xb6\x04\xb1\x66\x4c\x93\x69\xed\xd8\x8c\x1c\xa1\x15"
+  "\x55\x85\xe6\x3e\x49\x44\x43\xd9\xaf\x58\x97\x27\x88\x0e\x60\x2c"
+  "\x74\x9c\x54\x01\xc3\xa4\x2a\x02\x7a\x63\x4e\x02\xd7\x39\xdd\x81"
+  "\xa7\xd7\x1f\xb6\x6d\x42\x65\xc5\x31\x6c\xff\x7d\x88\x1e\xaa\x90"
+  "\x07\x7a\xb1\xf1\x53\x2f\x9a\xf4\x72\x52\x1e\x46\x10\x5c\xd0\xe1"
+  "\xdf\xbc\x99\x92\x41\x0f\xff\xab\xe3\xe3\xdd\x0b\xfd\x98\xfd\x7e"
+  "\x60\xbb\xb6\x32\x74\x07\x88\xbe\xe9\xcb\x58\xef\xa7\x72\xb7\x60"
+  "\x4e\x6d\x6c\x99\x4b\xae\x1a\x28\x57\x82\xc6\xf8\xe0\x74\x8d\xe0"
+  "\xb4\x8b\xd1\x29\xf4\xfd\xb7\x7c\x1a\x3f\xa7\x81\x9f\x03\x40\x28"
+  "\x90\x85\xdd\x51\x1f\x3e\xae\x54\xee\xe6\xf9\xa8\xb6\x4b\xfb\xa0"
+  "\x86\x6f\x9c\xfa\xab\xff\xd1\xc3\x0a\xfb\x61\xbf\x80\x34\x80\x5f"
+  "\x8f\xf6\x5d\xfa\x5a\xfc\x9d\xc3\xd3\x8c\x61\xbb\x91\x4e\x55\x9f"
+  "\xa6\x49\xe0\x83\x7d\x16\x6f\xa6\x8a\x28\x86\xa6\x64\xc4\xfa\x26"
+  "\x7e\x10\x88\x92\xa6\x3f\xb3\x86\xfe\xc9\x97\x0d\x0e\x4b\x14\xbc"
+  "\x2e\x57\x8d\x5f\x59\x68\x15\xb3\x39\xca\xc5\x70\xed\x12\x9e\x99"
+  "\xe0\x80\x27\xd0\xbb\x79\xac\x28\x34\xd2\xdd\xb5\x57\xae\x1d\xd4"
+  "\x85\x33\xc2\xe5\x3e\x37\x32\xf4\x81\xc4\x77\x93\x4a\x14\xc8\xd3"
+  "\x81\x4e\x2e\x2a\x59\x3b\x2e\xb2\x03\xb4\x24\x07\x20\x7d\xc0\xbd"
+  "\x5d\xd4\xcb\x27\x32\xdf\x24\xf0\x97\xd2\xa2\xc0\x38\x5f\x3d\xe8"
+  "\x79\xdd\xbe\xd0\x51\x30\xca\xa8\xc8\x5b\x07\x93\xab\x5a\xbc\x4b"
+  "\xb6\x8a\x1e\xf4\x4b\xda\x32\xa9\x7d\x8c\xf6\xe6\xfd\x25\x31\xea"
+  "\x2e\xee\x24\xaf\x7b\x1f\xff\x0a\xab\x8e\xcd\x24\xc6\x83\x38\x4c"
+  "\xdb\x04\x5c\xd7\xa9\xbe\x91\x9c\x02\x69\xd3\x2d\x6c\x31\x44\xe5"
+  "\x50\x9c\xd7\x70\xbf\xec\x37\x55\x9f\xf0\x6b\xc3\xca\xd4\xcb\x8c"
+  "\x62\x4c\x56\x17\x77\x3c\x5f\xc4\xbe\xb8\x41\xfc\xe5\xec\x7f\xe4"
+  "\xdc\x5f\x7e\x77\x0e\x96\xc7\x80\x65\x00\x7f\xb3\x9c\xc2\x76\xd2"
+  "\x2e\xc8\x06\xb5\xef\x22\xaa\x98\x18\xa7\xf7\xf5\x54\x5a\x5b\xeb"
+  "\x1b\x0c\xe8\xe5\x67\x3a\xf3\x01\x87\x18\x56\x73\xad\x61\xa4\xe2"
+  "\x6e\x39\x91\x72\x54\x59\x6a\x09\x41\x3e\x55\xf4\x2f\x1c\xbb\xfb"
+  "\xa3\xd2\x11\x97\xd5\x0d\xe8\xc6\x5f\x70\xe7\xc0\xfb\x5e\x30\x7a"
+  "\x9d\xbf\x4b\xc7\xf8\xe6\x82\x86\x38\x63\x69\x14\x7a\x6f\xed\x12"
+  "\x53\x3e\x24\x25\x6d\x65\xc0\x3d\x10\x1b\xd5\x91\x0f\x03\x5f\x56"
+  "\x81\xd2\xb3\xec\x36\xeb\xc4\xf9\xc6\xd7\xed\xaa\xc5\x2a\xac\x28"
+  "\x59\x37\x73\xe5\x53\xaf\x81\x4e\x89\x07\x70\x19\xff\x39\xe1\x2c"
+  "\x2e\x4a\x72\xd3\x76\xa6\xe9\xc8\x82\x37\x47\x49\x2a\xc2\x21\x34"
+  "\x2d\x00\x80\xe7\xb4\x79\x1e\x5c\x87\x00\xb4\xc9\x6c\x80\xd5\xb2"
+  "\x03\x56\x60\x2b\x2e\x70\x9c\xd5\xcc\xfb\x87\xbd\x51\x48\xdd\x26"
+  "\x94\x3c\xf8\xf7\xca\x68\x74\x48\x91\xad\x49\x4d\x82\xf8\xc2\x94"
+  "\xa9\x87\x7f\x5e\xdd\xbe\x70\x7f\xd3\x79\x6c\x12\x6e\x68\xe0\xec"
+  "\xa0\xe4\xb2\x9f\xdd\x41\x4d\x6e\xfb\x90\x81\x8b\xfd\x5b\x9e\x7f"
+  "\x19\xc5\xfe\x94\x10\x22\xe5\xa0\x91\xe1\x60\x8b\x3f\x6b\x95\x6f"
+  "\xac\x52\xb4\x23\x3e\xe4\x61\xa7\xe6\x08\x5d\xa8\x20\xff\xca\x1a"
+  "\x95\x57\x37\xae\x5f\x4a\x67\x8e\xcb\x40\x77\xac\x11\x35\xd4\x93"
+  "\x63\x38\x2e\x84\x4c\x4a\x50\x47\x3c\x51\x88\x04\xbd\xd6\x13\x09"
+  "\xab\xde\xb1\x4d\x6f\xfe\x4f\x1c\x13\x81\x73\x31\xba\x46\xde\x3b"
+  "\xb8\xa8\x7c\x7e\x71\x8d\xa8\x1d\xb6\x82\x59\x39\x33\x70\xb2\xe9"
+  "\x37\x59\x1f\xc9\xef\x24\xe0\x96\xc8\x66\xc3\x15\x9d\xbc\x64\x43"
+  "\xec\x0d\x28\x8b\x23\xe0\xe5\x77\xd8\x8d\xd5\x21\x69\xf7\x4d\x57"
+  "\x5f\x22\x5e\x3b\x9c\xbe\x4a\xc9\x13\x92\x7f\x8d\xab\x4e\x80\x85"
+  "\x8d\x2f\xe6\xdf\xe6\x91\x6c\x1c\xf1\x41\xab\xce\xd5\x31\xf4\xea"
+  "\x97\xee\x7a\x75\x3f\xea\xaa\xf9\xe9\x82\x6d\x0b\x5e\x50\xba\xd5"
+  "\x73\x31\x96\x6a\x46\x0d\x8f\x50\x1e\x4a\x36\x90\x79\x81\x25\x35"
+  "\x9d\xd0\xaa\x06\xab\xe0\x07\xea\x0d\x8e\x00\x3c\xbe\xb5\x04\x06"
+  "\xc3\x95\x46\xda\xdf\xdb\x8c\xd5\x45\x2e\x7f\xf3\xe1\xe5\xc9\xc7"
+  "\x7b\x35\x4f\x37\xc2\xf6\x57\xd9\x0d\xeb\x53\x0b\x5e\x07\xbe\xe4"
+  "\xee\x36\x2c\x97\x57\x9e\x8e\xe5\x1c\x50\x38\xbf\x28\xf8\x34\x2b"
+  "\x8a\xe7\xf8\x11\x6f\x9e\x78\x80\x42\xaa\x32\x9e\x5e\x70\xb2\x39"
+  "\xb1\x4c\xb0\xc6\x60\x16\xaa\x39\x21\xf0\xc1\xf8\xf3\xf0\x28\xe9"
+  "\x6b\x0d\x61\x55\xac\x65\x37\x17\xd3\xb9\x11\x54\x68\xb3\x19\xc9"
+  "\x14\x6a\x60\x48\xb8\x1e\xe2\x06\xa1\x28\x26\xdd\x73\x9f\xd1\x84"
+  "\x0e\x28\x70\x83\x7b\xf5\x4c\x4e\xb0\xdf\x12\xce\xb4\x32\x94\x56"
+  "\x6d\x81\xf9\xb9\x2a\xaf\x25\xfc\xb3\xef\x1f\xe9\x65\x74\xca\x7b"
+  "\xad\x16\x36\xd6\xee\x13\x5c\x54\x99\xc3\x03\xe3\x06\xe8\x34\x9e"
+  "\x5c\xdd\x64\x72\x8d\xda\x4d\x46\x3c\x18\x0e\xd5\x13\x7a\x17\x49"
+  "\xcf\x12\xf4\x43\x20\xa0\xf5\xd5\x16\xe6\x5d\xab\xad\x6f\x72\x58"
+  "\xce\x26\xb6\x88\xc2\xd0\x20\x8d\xeb\x52\x05\x95\x51\x57\x29\x66"
+  "\x47\xb1\x12\x7d\x3b\x9a\x95\xf4\x7e\xa3\x46\x76\x84\xfb\x37\x3c"
+  "\xfc\x60\x30\xcb\xb8\xdd\x4f\xf6\x3c\x29\xbd\x57\x82\x4d\xde\x44"
+  "\x34\xe5\x29\xf4\x73\x1b\xa4\x56\xf2\x34\x90\xd3\xf3\x5b\xd5\xf9"
+  "\x6b\xea\x3d\xc8\x69\x67\x79\x20\x77\x02\xa0\x88\x93\x3c\x7d\x54"
+  "\x01\xfd\xfb\xd2\x07\x57\x75\x18\x61\xaf\xb8\x8b\xec\xfe\x0c\x3d"
+  "\xeb\x81\x76\xc9\xdc\xf2\x29\x28\xb0\x22\xc0\xd0\xfd\x9c\xbd\xff"
+  "\x64\xa2\x75\xfe\x45\xa1\x48\xd4\x83\x03\xe8\xa3\xef\xea\x06\xb2"
+  "\x9a\x3d\xa1\xd1\x23\x1e\xd3\xa6\xc6\xa7\xdc\x12\xc5\x86\xbf\xae"
+  "\x61\xd9\xb4\x1a\x84\x66\x4a\xa0\xe0\xff\xf5\x5f\x09\xc5\x5a\xfc"
+  "\xe1\x91\xad\xa1\x5c\xa6\xdb\xae\x66\x8b\x62\x6e\x7d\xaa\x10\xc4"
+  "\x46\x06\xfc\x86\x2a\x2f\x93\x10\xc9\x4a\x60\x3a\xcf\xcf\x0d\xbd"
+  "\x73\x4e\xb7\xb7\xb1\x61\x8e\xd0\x07\xa7\x67\x40\x42\x59\xa8\x9f"
+  "\xae\xe6\xc2\x5c\xa5\xa1\x27\x30\x5b\x6b\x59\xef\x65\xe5\x8c\x92"
+  "\x52\xa0\x08\x4a\x5a\x44\x27\x19\xed\xac\xb1\x1e\xbe\x7c\xed\x9b"
+  "\x80\x93\xa3\x72\x73\x80\xf6\x8c\x80\xc1\xb7\x75\x7b\x7f\xb3\x13"
+  "\xcc\x0e\x14\x50\x97\x5d\xcb\x11\x27\x2b\xae\xde\x25\x99\xb0\x10"
+  "\xef\x83\x6b\x5b\x1c\xa6\xdc\x29\xf0\x8a\x01\xfb\x4c\xb1\xc9\xd8"
+  "\x78\x7c\x7c\x79\xb9\xd8\x8d\xbc\x93\x8d\x79\x8f\x39\xd4\x2d\x50"
+  "\x79\x88\x0f\x67\x35\x0f\xa1\x8a\x2a\xdf\x69\xf1\x9f\x2c\x81\x6f"
+  "\x3b\x2b\x0d\x31\x18\xfc\x6a\x9a\xd7\x1a\xdc\x7c\x48\xeb\x10\xab"
+  "\xea\xd0\xb3\x9f\x5d\xd0\xfa\xac\x7d\xb5\xcb\xff\xc7\x3c\xfa\x68"
+  "\x47\xb6\xbf\xa3\x1c\x2e\x4e\xa8\x68\xf5\x48\x2e\x2a\x37\x6b\x6c"
+  "\x58\xe5\xa4\xcb\x41\x1a\x85\x0b\x03\xdd\xb1\x0d\xa5\xcb\xc0\x4b"
+  "\x18\x16\xb7\xb2\x37\xeb\x0d\x5d\x85\x1d\xdf\x67\x46\xb0\xc0\xd9"
+  "\x27\xac\x5e\x6d\x99\x3a\xd1\x9c\xa2\x03\x52\x3a\xa3\x5b\xc9\x9c"
+  "\x77\x9e\x45\xff\xe6\xd1\x6a\xae\x3b\x6c\x6a\x28\x8c\xe9\xfd\x38"
+  "\x04\x69\x88\xc5\x2b\x9b\x53\xd2\x0c\xb1\x8f\xe6\xb9\x0f\x78\xdf"
+  "\x7a\xff\xe6\xe7\xb5\x96\x14\x0c\x60\x9a\x63\xac\x7a\x0e\x7b\xc5"
+  "\xeb\xb8\xf3\xcc\xc5\xc1\x72\x9a\xbe\x4c\xf4\xa9\x69\xa2\x9d\x8f"
+  "\x7f\x44\x43\x83\x3a\x0d\xa3\x61\x99\x3a\xec\x6c\x19\xec\xfe\xbe"
+  "\x23\x94\x9e\x39\x44\x4e\x7c\x5f\x02\x14\xbd\x5a\xc4\x6c\x73\x25"
+  "\x36\xd5\x2f\xa6\x16\x27\x9f\x18\x56\xba\xd5\x1a\xff\xe9\xb8\x58";
+
+unsigned
+noise_at (int i)
+{
+  return noise[i];
+}
@@ -0,0 +1,30 @@
+/* A second link with the same LTRANS cache reuses the objects stored by
+   the first one, and the program still works.  Each function gets a
+   partition of its own.  */
+
+/* { dg-lto-do run } */
+/* { dg-lto-options {{-O2 -flto -flto-partition=max -flto-incremental=incremental-1.cache} {-O2 -flto -flto-partition=max -flto-incremental=incremental-1.cache}} } */
+
+extern void abort (void);
+
+extern int scale (int);
+extern int offset (int);
+extern const char *name (void);
+
+static int __attribute__ ((noinline))
+combine (int x)
+{
+  return scale (x) + offset (x);
+}
+
+int
+main (void)
+{
+  const char *s = name ();
+
+  if (combine (3) != 3 * 7 + 3 + 100)
+    abort ();
+  if (s[0] != 'l' || s[2] != 'o' || s[3] != 0)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,17 @@
+int __attribute__ ((noinline))
+scale (int x)
+{
+  return x * 7;
+}
+
+int __attribute__ ((noinline))
+offset (int x)
+{
+  return x + 100;
+}
+
+const char *
+name (void)
+{
+  return "lto";
+}
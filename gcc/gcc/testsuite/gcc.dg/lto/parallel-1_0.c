@@ -0,0 +1,42 @@
+/* Every function and variable gets a partition of its own, and the
+   partitions are written, decompressed and their types merged by
+   several threads, or by a single one.  The program still works.  */
+
+/* { dg-lto-do run } */
+/* { dg-lto-options {{-O2 -flto=4 -flto-partition=max --param lto-partition-writers=1} {-O2 -flto=4 -flto-partition=max --param lto-partition-writers=4} {-O2 -flto=4 -flto-partition=max --param lto-decompress-threads=0 --param lto-type-hash-threads=0} {-O2 -flto=4 -flto-partition=max --param lto-decompress-threads=8 --param lto-type-hash-threads=8 --param lto-partition-writers=8}} } */
+
+extern void abort (void);
+
+struct point { int x, y; };
+struct shape { const char *name; struct point p[3]; int (*area) (const struct shape *); };
+
+extern struct shape shapes[];
+extern int nshapes;
+extern int triangle_area (const struct shape *);
+extern int box_area (const struct shape *);
+extern int total (int (*) (const struct shape *));
+
+static int __attribute__ ((noinline))
+twice (const struct shape *s)
+{
+  return 2 * s->area (s);
+}
+
+int
+main (void)
+{
+  int i;
+
+  if (nshapes != 3)
+    abort ();
+  if (triangle_area (&shapes[0]) != 6)
+    abort ();
+  if (box_area (&shapes[1]) != 12)
+    abort ();
+  if (total (twice) != 2 * (6 + 12 + 1))
+    abort ();
+  for (i = 0; i < nshapes; i++)
+    if (shapes[i].name[0] == 0)
+      abort ();
+  return 0;
+}
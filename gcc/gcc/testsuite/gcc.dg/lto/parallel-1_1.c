@@ -0,0 +1,16 @@
+struct point { int x, y; };
+struct shape { const char *name; struct point p[3]; int (*area) (const struct shape *); };
+
+int __attribute__ ((noinline))
+triangle_area (const struct shape *s)
+{
+  int a = (s->p[1].x - s->p[0].x) * (s->p[2].y - s->p[0].y)
+	  - (s->p[2].x - s->p[0].x) * (s->p[1].y - s->p[0].y);
+  return (a < 0 ? -a : a) / 2;
+}
+
+int __attribute__ ((noinline))
+box_area (const struct shape *s)
+{
+  return (s->p[1].x - s->p[0].x) * (s->p[1].y - s->p[0].y);
+}
@@ -0,0 +1,23 @@
+struct point { int x, y; };
+struct shape { const char *name; struct point p[3]; int (*area) (const struct shape *); };
+
+extern int triangle_area (const struct shape *);
+extern int box_area (const struct shape *);
+
+struct shape shapes[] = {
+  { "triangle", { { 0, 0 }, { 4, 0 }, { 0, 3 } }, triangle_area },
+  { "box", { { 1, 1 }, { 5, 4 } }, box_area },
+  { "unit", { { 0, 0 }, { 1, 1 } }, box_area }
+};
+
+int nshapes = sizeof shapes / sizeof shapes[0];
+
+int __attribute__ ((noinline))
+total (int (*f) (const struct shape *))
+{
+  int i, sum = 0;
+
+  for (i = 0; i < nshapes; i++)
+    sum += f (&shapes[i]);
+  return sum;
+}
@@ -0,0 +1,30 @@
+/* Partitions bounded by their estimated LTRANS memory: with a tiny
+   budget and a large cost per instruction, every partition holds as
+   little as it can.  The program still works.  */
+
+/* { dg-lto-do run } */
+/* { dg-lto-options {{-O2 -flto=2 -flto-partition=balanced --param lto-max-partition-memory=1 --param lto-partition-memory-per-insn=100000} {-O2 -flto=4 -flto-partition=balanced --param lto-max-partition-memory=17 --param lto-partition-memory-per-insn=1} {-O2 -flto=4 -flto-partition=max --param lto-partition-memory-per-insn=100000}} } */
+
+extern void abort (void);
+
+extern int step (int);
+extern int walk (int, int);
+extern int counter;
+
+static int __attribute__ ((noinline))
+run (int n)
+{
+  int x = walk (1, n);
+
+  return x + step (n);
+}
+
+int
+main (void)
+{
+  if (run (5) != 32 + 10)
+    abort ();
+  if (counter != 6)
+    abort ();
+  return 0;
+}
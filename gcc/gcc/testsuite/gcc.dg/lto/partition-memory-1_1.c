@@ -0,0 +1,16 @@
+int counter;
+
+int __attribute__ ((noinline))
+step (int x)
+{
+  counter++;
+  return x * 2;
+}
+
+int __attribute__ ((noinline))
+walk (int x, int n)
+{
+  while (n-- > 0)
+    x = step (x);
+  return x;
+}
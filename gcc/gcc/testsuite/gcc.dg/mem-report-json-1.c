@@ -0,0 +1,11 @@
+/* Check that -fmem-report=json writes one JSON object and nothing else.  */
+/* { dg-do compile } */
+/* { dg-options "-fmem-report=json" } */
+/* { dg-message "\"final\": true," "" { target *-*-* } 0 } */
+/* { dg-prune-output "\"(ggc|size|mapped|major_collections|peak_rss_kb)\": " } */
+
+int
+main (void)
+{
+  return 0;
+}
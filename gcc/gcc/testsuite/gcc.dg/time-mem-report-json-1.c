@@ -0,0 +1,13 @@
+/* Check that -ftime-report=json with -fmem-report=json writes a single
+   JSON object, with the memory report as its "mem" member.  */
+/* { dg-do compile } */
+/* { dg-options "-ftime-report=json -fmem-report=json" } */
+/* { dg-message "\"timevars\": \\\[" "" { target *-*-* } 0 } */
+/* { dg-message "mem\": \\\{\"final\": true," "" { target *-*-* } 0 } */
+/* { dg-prune-output "\"(id|number|passes|total|peak_rss_kb|checking|ggc|size|mapped|major_collections)\": " } */
+
+int
+main (void)
+{
+  return 0;
+}
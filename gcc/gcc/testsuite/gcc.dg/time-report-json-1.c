@@ -0,0 +1,11 @@
+/* Check that -ftime-report=json writes one JSON object and nothing else.  */
+/* { dg-do compile } */
+/* { dg-options "-ftime-report=json" } */
+/* { dg-message "\"timevars\": \\\[" "" { target *-*-* } 0 } */
+/* { dg-prune-output "\"(id|number|passes|total|peak_rss_kb|checking)\": " } */
+
+int
+main (void)
+{
+  return 0;
+}
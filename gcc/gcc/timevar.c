@@ -104,6 +104,14 @@ static double clocks_to_msec;
 
 bool timevar_enable;
 
+/* True if the report should be printed as JSON.  */
+
+bool timevar_json;
+
+/* Prints more members of the top-level object of the JSON report.  */
+
+void (*timevar_json_members) (FILE *);
+
 /* Total amount of memory allocated by garbage collector.  */
 
 size_t timevar_ggc_mem_total;
@@ -129,6 +137,20 @@ struct timevar_def
   /* The name of this timing variable.  */
   const char *name;
 
+  /* The identifier of this timing variable, e.g. "TV_EXPAND".  For a
+     pass, that of the timing variable the pass runs under.  */
+  const char *id;
+
+  /* The part of elapsed.ggc_mem estimated to have survived the garbage
+     collections so far.  Only computed for the JSON report.  */
+  size_t ggc_survived;
+
+  /* The memory allocated up to the last garbage collection.  */
+  unsigned ggc_mem_collected;
+
+  /* For a pass, the number of times it was executed.  */
+  unsigned runs;
+
   /* Nonzero if this timing variable is running as a standalone
      timer.  */
   unsigned standalone : 1;
@@ -166,6 +188,17 @@ static struct timevar_stack_def *unused_stack_instances;
    element.  */
 static struct timevar_time_def start_time;
 
+/* Per-pass statistics for the JSON report, indexed by the static pass
+   number.  Each pass is timed independently of the timing stack, like
+   a standalone timer, and of the other passes.  */
+static struct timevar_def *pass_timevars;
+static int n_pass_timevars;
+
+/* The garbage collector memory allocated, and the size of the heap,
+   as of the last collection.  */
+static unsigned ggc_mem_at_collection;
+static size_t ggc_heap_at_collection;
+
 static void get_time (struct timevar_time_def *);
 static void timevar_accumulate (struct timevar_time_def *,
 				struct timevar_time_def *,
@@ -203,6 +236,16 @@ get_time (struct timevar_time_def *now)
     now->user = clock () * clocks_to_msec;
 #endif
   }
+
+  now->peak_rss = 0;
+#ifdef HAVE_GETRUSAGE
+  if (timevar_json)
+    {
+      struct rusage rusage;
+      getrusage (RUSAGE_SELF, &rusage);
+      now->peak_rss = rusage.ru_maxrss;
+    }
+#endif
 }
 
 /* Add the difference between STOP_TIME and START_TIME to TIMER.  */
@@ -216,6 +259,7 @@ timevar_accumulate (struct timevar_time_def *timer,
   timer->sys += stop_time->sys - start_time->sys;
   timer->wall += stop_time->wall - start_time->wall;
   timer->ggc_mem += stop_time->ggc_mem - start_time->ggc_mem;
+  timer->peak_rss += stop_time->peak_rss - start_time->peak_rss;
 }
 
 /* Initialize timing variables.  */
@@ -227,10 +271,12 @@ timevar_init (void)
 
   /* Zero all elapsed times.  */
   memset (timevars, 0, sizeof (timevars));
+  timevars[TV_NONE].id = "TV_NONE";
 
   /* Initialize the names of timing variables.  */
 #define DEFTIMEVAR(identifier__, name__) \
-  timevars[identifier__].name = name__;
+  timevars[identifier__].name = name__; \
+  timevars[identifier__].id = #identifier__;
 #include "timevar.def"
 #undef DEFTIMEVAR
 
@@ -419,6 +465,117 @@ timevar_cond_stop (timevar_id_t timevar, bool running)
   timevar_accumulate (&tv->elapsed, &tv->start_time, &now);
 }
 
+/* Start timing the pass with static pass number NUMBER and name NAME
+   for the JSON report; TIMEVAR is the timing variable the pass runs
+   under.  Like timevar_cond_start, return true if the pass is already
+   being timed, i.e. if it is executed recursively.  */
+
+bool
+timevar_pass_start (int number, const char *name, timevar_id_t timevar)
+{
+  struct timevar_def *tv;
+
+  if (!timevar_json || number < 0)
+    return true;
+
+  if (number >= n_pass_timevars)
+    {
+      int n = MAX (number + 1, 2 * n_pass_timevars);
+
+      pass_timevars = XRESIZEVEC (struct timevar_def, pass_timevars, n);
+      memset (pass_timevars + n_pass_timevars, 0,
+	      (n - n_pass_timevars) * sizeof (struct timevar_def));
+      n_pass_timevars = n;
+    }
+
+  tv = &pass_timevars[number];
+  tv->used = 1;
+  tv->name = name;
+  tv->id = timevars[timevar].id;
+  if (tv->standalone)
+    return true;
+
+  tv->standalone = 1;
+  tv->runs++;
+  get_time (&tv->start_time);
+  return false;
+}
+
+/* Stop timing the pass with static pass number NUMBER; RUNNING is the
+   value returned by the matching timevar_pass_start.  */
+
+void
+timevar_pass_stop (int number, bool running)
+{
+  struct timevar_def *tv;
+  struct timevar_time_def now;
+
+  if (running)
+    return;
+
+  tv = &pass_timevars[number];
+  gcc_assert (tv->standalone);
+  tv->standalone = 0;
+
+  get_time (&now);
+  timevar_accumulate (&tv->elapsed, &tv->start_time, &now);
+}
+
+/* Attribute the survivors of the last garbage collection cycle to TV,
+   which allocated memory in the cycle; FRACTION of the memory allocated
+   in the cycle survived it.  NOW is the current time.  */
+
+static void
+note_collection_1 (struct timevar_def *tv, double fraction,
+		   const struct timevar_time_def *now)
+{
+  unsigned ggc_mem = tv->elapsed.ggc_mem;
+
+  /* Include the memory allocated since a running timer was last
+     accounted.  */
+  if (tv->standalone)
+    ggc_mem += now->ggc_mem - tv->start_time.ggc_mem;
+  else if (stack && stack->timevar == tv)
+    ggc_mem += now->ggc_mem - start_time.ggc_mem;
+
+  tv->ggc_survived += (size_t) ((ggc_mem - tv->ggc_mem_collected) * fraction);
+  tv->ggc_mem_collected = ggc_mem;
+}
+
+/* Called by the garbage collector after each collection; HEAP is the
+   memory in use after it.  The collector doesn't know who allocated
+   an object, so the growth of the heap since the last collection is
+   attributed to the timing variables and passes in proportion to the
+   memory they allocated in between.  */
+
+void
+timevar_note_collection (size_t heap)
+{
+  struct timevar_time_def now;
+  unsigned allocated;
+  double fraction = 0;
+  unsigned int /* timevar_id_t */ id;
+  int i;
+
+  if (!timevar_json)
+    return;
+
+  get_time (&now);
+  allocated = now.ggc_mem - ggc_mem_at_collection;
+  if (allocated && heap > ggc_heap_at_collection)
+    fraction = MIN (1.0, (double) (heap - ggc_heap_at_collection) / allocated);
+
+  for (id = 0; id < (unsigned int) TIMEVAR_LAST; ++id)
+    if (timevars[id].used)
+      note_collection_1 (&timevars[id], fraction, &now);
+  for (i = 0; i < n_pass_timevars; i++)
+    if (pass_timevars[i].used)
+      note_collection_1 (&pass_timevars[i], fraction, &now);
+
+  ggc_mem_at_collection = now.ggc_mem;
+  ggc_heap_at_collection = heap;
+}
+
 
 /* Validate that phase times are consistent.  */
 
@@ -471,6 +628,98 @@ validate_phases (FILE *fp)
 }
 
 
+/* Print S to FP as a JSON string.  */
+
+static void
+print_json_string (FILE *fp, const char *s)
+{
+  putc ('"', fp);
+  for (; *s; s++)
+    if (*s == '"' || *s == '\\')
+      fprintf (fp, "\\%c", *s);
+    else if ((unsigned char) *s < ' ')
+      fprintf (fp, "\\u%04x", (unsigned char) *s);
+    else
+      putc (*s, fp);
+  putc ('"', fp);
+}
+
+/* Print what was measured for TV to FP, as the last members of a JSON
+   object, and close the object.  */
+
+static void
+print_json_times (FILE *fp, const struct timevar_def *tv)
+{
+  fprintf (fp, "\"user\": %.6f, \"sys\": %.6f, \"wall\": %.6f, "
+	   "\"ggc_allocated\": %u, \"ggc_survived\": %lu, "
+	   "\"peak_rss_growth_kb\": %lu}",
+	   tv->elapsed.user, tv->elapsed.sys, tv->elapsed.wall,
+	   tv->elapsed.ggc_mem, (unsigned long) tv->ggc_survived,
+	   (unsigned long) tv->elapsed.peak_rss);
+}
+
+/* Summarize timing variables and passes to FP as a JSON object, for
+   -ftime-report=json.  Unlike timevar_print, this includes every
+   timing variable and pass that was used, however little time it
+   took.  */
+
+static void
+timevar_print_json (FILE *fp)
+{
+  unsigned int /* timevar_id_t */ id;
+  const char *sep = "";
+  int i;
+
+  fputs ("{\"timevars\": [", fp);
+  for (id = 0; id < (unsigned int) TIMEVAR_LAST; ++id)
+    {
+      struct timevar_def *tv = &timevars[(timevar_id_t) id];
+
+      if ((timevar_id_t) id == TV_TOTAL || !tv->used)
+	continue;
+
+      fprintf (fp, "%s\n  {\"id\": ", sep);
+      print_json_string (fp, tv->id);
+      fputs (", \"name\": ", fp);
+      print_json_string (fp, tv->name);
+      fputs (", ", fp);
+      print_json_times (fp, tv);
+      sep = ",";
+    }
+
+  fputs ("],\n\"passes\": [", fp);
+  sep = "";
+  for (i = 0; i < n_pass_timevars; i++)
+    {
+      struct timevar_def *tv = &pass_timevars[i];
+
+      if (!tv->used || !tv->runs)
+	continue;
+
+      fprintf (fp, "%s\n  {\"number\": %d, \"name\": ", sep, i);
+      print_json_string (fp, tv->name ? tv->name : "");
+      fputs (", \"timevar\": ", fp);
+      print_json_string (fp, tv->id);
+      fprintf (fp, ", \"runs\": %u, ", tv->runs);
+      print_json_times (fp, tv);
+      sep = ",";
+    }
+
+  fputs ("],\n\"total\": {", fp);
+  print_json_times (fp, &timevars[TV_TOTAL]);
+  fprintf (fp, ",\n\"peak_rss_kb\": %lu,\n\"checking\": %s",
+	   (unsigned long) start_time.peak_rss,
+#ifdef ENABLE_CHECKING
+	   "true"
+#else
+	   "false"
+#endif
+	   );
+  if (timevar_json_members)
+    timevar_json_members (fp);
+  fputs ("}\n", fp);
+}
+
 /* Summarize timing variables to FP.  The timing variable TV_TOTAL has
    a special meaning -- it's considered to be the total elapsed time,
    for normalizing the others, and is displayed last.  */
@@ -504,6 +753,13 @@ timevar_print (FILE *fp)
      TIMEVAR.  */
   start_time = now;
 
+  if (timevar_json)
+    {
+      timevar_print_json (fp);
+      validate_phases (fp);
+      return;
+    }
+
   fputs ("\nExecution times (seconds)\n", fp);
   for (id = 0; id < (unsigned int) TIMEVAR_LAST; ++id)
     {
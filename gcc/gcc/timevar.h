@@ -63,6 +63,10 @@ struct timevar_time_def
 
   /* Garbage collector memory.  */
   unsigned ggc_mem;
+
+  /* Peak resident set size of the process, in kilobytes.  Only
+     measured for the JSON report.  */
+  size_t peak_rss;
 };
 
 /* An enumeration of timing variable identifiers.  Constructed from
@@ -83,6 +87,15 @@ timevar_id_t;
    the -ftime-report flag.  */
 extern bool timevar_enable;
 
+/* True if the report should be printed as JSON, with -ftime-report=json.
+   This also enables the per-pass statistics.  */
+extern bool timevar_json;
+
+/* If set, called by the JSON report to print more members of its
+   top-level object, so that other reports (-fmem-report=json) can go
+   into the same document.  */
+extern void (*timevar_json_members) (FILE *);
+
 /* Total amount of memory allocated by garbage collector.  */
 extern size_t timevar_ggc_mem_total;
 
@@ -94,6 +107,9 @@ extern void timevar_stop (timevar_id_t);
 extern bool timevar_cond_start (timevar_id_t);
 extern void timevar_cond_stop (timevar_id_t, bool);
 extern void timevar_print (FILE *);
+extern bool timevar_pass_start (int, const char *, timevar_id_t);
+extern void timevar_pass_stop (int, bool);
+extern void timevar_note_collection (size_t);
 
 /* Provided for backward compatibility.  */
 static inline void
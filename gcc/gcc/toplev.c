@@ -1756,9 +1756,49 @@ target_reinit (void)
     }
 }
 
+/* Print the -fmem-report=json statistics to FP as a JSON object.  */
+
+static void
+print_memory_report_json (FILE *fp, bool final)
+{
+  unsigned long peak_rss = 0;
+#ifdef HAVE_GETRUSAGE
+  struct rusage rusage;
+
+  getrusage (RUSAGE_SELF, &rusage);
+  peak_rss = rusage.ru_maxrss;
+#endif
+  fprintf (fp, "{\"final\": %s,\n\"ggc\": {", final ? "true" : "false");
+  ggc_print_json_statistics (fp);
+  fprintf (fp, "},\n\"peak_rss_kb\": %lu}", peak_rss);
+}
+
+/* Print the final memory statistics as the "mem" member of the
+   -ftime-report=json object.  */
+
+static void
+print_final_memory_report_member (FILE *fp)
+{
+  fputs (",\n\"mem\": ", fp);
+  print_memory_report_json (fp, true);
+}
+
 void
 dump_memory_report (bool final)
 {
+  if (mem_report_format == REPORT_FORMAT_JSON)
+    {
+      /* With -ftime-report=json as well, write a single document.  */
+      if (final && timevar_enable && timevar_json)
+	timevar_json_members = print_final_memory_report_member;
+      else
+	{
+	  print_memory_report_json (stderr, final);
+	  fputc ('\n', stderr);
+	}
+      return;
+    }
+
   dump_line_table_statistics ();
   ggc_print_statistics ();
   stringpool_statistics ();
@@ -1826,6 +1866,7 @@ do_compile (void)
 {
   /* Initialize timing first.  The C front ends read the main file in
      the post_options hook, and C++ does file timings.  */
+  timevar_json = time_report_format == REPORT_FORMAT_JSON;
   if (time_report || !quiet_flag  || flag_detailed_statistics)
     timevar_init ();
   timevar_start (TV_TOTAL);
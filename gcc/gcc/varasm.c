@@ -1690,6 +1690,175 @@ assemble_end_function (tree decl, const char *fnname ATTRIBUTE_UNUSED)
     }
 }
 
+/* With -fcompact-asm, the bytes of the initializer or debug information
+   being output, which are written as a few ASCII_DATA_ASM_OP directives
+   rather than one directive per value.  Values that need a relocation
+   still get a directive of their own.  */
+
+static vec<char> data_block;
+
+/* True while bytes are collected in data_block.  */
+
+static bool in_data_block;
+
+/* The length of the runs of zeros data_block writes as ASM_OUTPUT_SKIP
+   rather than as characters.  */
+#define DATA_BLOCK_MIN_SKIP 16
+
+/* The number of bytes data_block writes per directive.  */
+#define DATA_BLOCK_LINE_BYTES 64
+
+/* Start collecting the bytes of constant data in data_block, if
+   -fcompact-asm is in effect and the target can write them.  They are
+   not collected with -dA, whose comments annotate each value.  */
+
+void
+begin_data_block (void)
+{
+#ifdef ASCII_DATA_ASM_OP
+  in_data_block = flag_compact_asm && !flag_debug_asm && BITS_PER_UNIT == 8;
+#endif
+}
+
+/* Write the bytes collected in data_block to asm_out_file.  Long runs of
+   zeros are skipped, the rest are written as strings of up to
+   DATA_BLOCK_LINE_BYTES bytes.  Anything else written to asm_out_file
+   while the bytes are collected must be preceded by a call to this.  */
+
+void
+flush_data_block (void)
+{
+#ifdef ASCII_DATA_ASM_OP
+  unsigned int i, j, len = data_block.length ();
+  unsigned int in_line = 0;
+  unsigned char c;
+
+  for (i = 0; i < len; i++)
+    {
+      for (j = i; j < len && data_block[j] == 0; j++)
+	continue;
+      if (j - i >= DATA_BLOCK_MIN_SKIP)
+	{
+	  if (in_line)
+	    fputs ("\"\n", asm_out_file);
+	  in_line = 0;
+	  ASM_OUTPUT_SKIP (asm_out_file, (unsigned HOST_WIDE_INT) (j - i));
+	  i = j - 1;
+	  continue;
+	}
+
+      if (in_line == DATA_BLOCK_LINE_BYTES)
+	{
+	  fputs ("\"\n", asm_out_file);
+	  in_line = 0;
+	}
+      if (!in_line)
+	fputs (ASCII_DATA_ASM_OP "\"", asm_out_file);
+      in_line++;
+
+      c = data_block[i];
+      if (c == '"' || c == '\\')
+	{
+	  putc ('\\', asm_out_file);
+	  putc (c, asm_out_file);
+	}
+      else if (c >= ' ' && c < 0177)
+	putc (c, asm_out_file);
+      /* An octal escape can be short unless a digit follows, which
+	 assemblers may read as part of it.  */
+      else if (i + 1 < len && in_line < DATA_BLOCK_LINE_BYTES
+	       && ISDIGIT (data_block[i + 1]))
+	fprintf (asm_out_file, "\\%03o", c);
+      else
+	fprintf (asm_out_file, "\\%o", c);
+    }
+  if (in_line)
+    fputs ("\"\n", asm_out_file);
+#endif
+  data_block.truncate (0);
+}
+
+/* Write the rest of the bytes collected since begin_data_block and stop
+   collecting them.  */
+
+void
+end_data_block (void)
+{
+  flush_data_block ();
+  in_data_block = false;
+}
+
+/* Add SIZE bytes of the integer whose low and high words are LOW and
+   HIGH to data_block, in target byte order.  Return false if they don't
+   fit.  */
+
+static bool
+add_wide_int_to_data_block (unsigned HOST_WIDE_INT low,
+			    unsigned HOST_WIDE_INT high, unsigned int size)
+{
+  unsigned int i, bit;
+
+  if (size > 2 * HOST_BITS_PER_WIDE_INT / BITS_PER_UNIT
+      || (size > UNITS_PER_WORD && BYTES_BIG_ENDIAN != WORDS_BIG_ENDIAN))
+    return false;
+
+  for (i = 0; i < size; i++)
+    {
+      bit = (BYTES_BIG_ENDIAN ? size - 1 - i : i) * BITS_PER_UNIT;
+      data_block.safe_push ((char) ((bit < HOST_BITS_PER_WIDE_INT
+				     ? low : high)
+				    >> (bit % HOST_BITS_PER_WIDE_INT)));
+    }
+  return true;
+}
+
+/* Add the integer constant X, SIZE bytes of it, to data_block.  Return
+   false if X is not a constant integer.  */
+
+static bool
+add_to_data_block (rtx x, unsigned int size)
+{
+  if (CONST_INT_P (x))
+    return add_wide_int_to_data_block (INTVAL (x), INTVAL (x) < 0 ? -1 : 0,
+				       size);
+  else if (CONST_DOUBLE_AS_INT_P (x))
+    return add_wide_int_to_data_block (CONST_DOUBLE_LOW (x),
+				       CONST_DOUBLE_HIGH (x), size);
+  return false;
+}
+
+/* Add SIZE bytes of VALUE to the bytes collected since begin_data_block.
+   Return false if they aren't being collected, or if VALUE can't be
+   added, in which case the bytes collected so far have been written and
+   the caller must write VALUE itself.  */
+
+bool
+add_integer_to_data_block (unsigned HOST_WIDE_INT value, unsigned int size)
+{
+  if (!in_data_block)
+    return false;
+  if (add_wide_int_to_data_block (value, 0, size))
+    return true;
+  flush_data_block ();
+  return false;
+}
+
+/* Add the LEN bytes at P to the bytes collected since begin_data_block.
+   Return false if they aren't being collected.  */
+
+bool
+add_bytes_to_data_block (const char *p, size_t len)
+{
+  size_t i;
+
+  if (!in_data_block)
+    return false;
+  data_block.reserve (len);
+  for (i = 0; i < len; i++)
+    data_block.quick_push (p[i]);
+  return true;
+}
+
 /* Assemble code to leave SIZE bytes of zeros.  */
 
 void
@@ -1699,6 +1868,16 @@ assemble_zeros (unsigned HOST_WIDE_INT size)
   if (flag_syntax_only)
     return;
 
+  if (in_data_block)
+    {
+      if (size < DATA_BLOCK_MIN_SKIP)
+	{
+	  data_block.safe_grow_cleared (data_block.length () + size);
+	  return;
+	}
+      flush_data_block ();
+    }
+
 #ifdef ASM_NO_SKIP_IN_TEXT
   /* The `space' pseudo in the text section outputs nop insns rather than 0s,
      so we must output 0s explicitly in the text section.  */
@@ -1733,6 +1912,9 @@ assemble_string (const char *p, int size)
   int pos = 0;
   int maximum = 2000;
 
+  if (add_bytes_to_data_block (p, size))
+    return;
+
   /* If the string is very long, split it up.  */
 
   while (pos < size)
@@ -1877,10 +2059,14 @@ assemble_variable_contents (tree decl, const char *name,
       if (DECL_INITIAL (decl)
 	  && DECL_INITIAL (decl) != error_mark_node
 	  && !initializer_zerop (DECL_INITIAL (decl)))
-	/* Output the actual data.  */
-	output_constant (DECL_INITIAL (decl),
-			 tree_low_cst (DECL_SIZE_UNIT (decl), 1),
-			 DECL_ALIGN (decl));
+	{
+	  /* Output the actual data.  */
+	  begin_data_block ();
+	  output_constant (DECL_INITIAL (decl),
+			   tree_low_cst (DECL_SIZE_UNIT (decl), 1),
+			   DECL_ALIGN (decl));
+	  end_data_block ();
+	}
       else
 	/* Leave space for it.  */
 	assemble_zeros (tree_low_cst (DECL_SIZE_UNIT (decl), 1));
@@ -2504,6 +2690,13 @@ assemble_integer (rtx x, unsigned int size, unsigned int align, int force)
 {
   int aligned_p;
 
+  if (in_data_block)
+    {
+      if (add_to_data_block (x, size))
+	return true;
+      flush_data_block ();
+    }
+
   aligned_p = (align >= MIN (size * BITS_PER_UNIT, BIGGEST_ALIGNMENT));
 
   /* See if the target hook can handle this kind of object.  */
@@ -3243,7 +3436,9 @@ assemble_constant_contents (tree exp, const char *label, unsigned int align)
   targetm.asm_out.declare_constant_name (asm_out_file, label, exp, size);
 
   /* Output the value of EXP.  */
+  begin_data_block ();
   output_constant (exp, size, align);
+  end_data_block ();
 }
 
 /* We must output the constant data referred to by SYMBOL; do so.  */
@@ -3340,6 +3535,15 @@ tree_output_constant_def (tree exp)
   varpool_finalize_decl (decl);
   return decl;
 }
+
+/* Skip the next COUNT numbers for the labels of constants, like
+   skip_label_numbers.  */
+
+void
+skip_const_label_numbers (int count)
+{
+  const_labelno += count;
+}
 
 /* Used in the hash tables to avoid outputting the same constant
    twice.  Unlike 'struct constant_descriptor_tree', RTX constants
@@ -3923,6 +4127,47 @@ output_shared_constant_pool (void)
 {
   output_constant_pool_contents (shared_constant_pool);
 }
+
+/* Called via htab_traverse.  Push the symbol of the constant described
+   by *SLOT onto the vector DATA unless it has been output already.  */
+
+static int
+add_pending_constant (void **slot, void *data)
+{
+  struct constant_descriptor_tree *desc
+    = (struct constant_descriptor_tree *) *slot;
+  vec<rtx> *pending = (vec<rtx> *) data;
+
+  if (!TREE_ASM_WRITTEN (desc->value))
+    pending->safe_push (XEXP (desc->rtl, 0));
+  return 1;
+}
+
+/* Output the contents of every constant that has a label but hasn't been
+   written yet, and of the shared constant pool, which is emptied.  Later
+   uses of its constants refer to the labels written here.
+   expand_all_functions does this before starting its worker processes,
+   so that no two of them emit the same constant.  */
+
+void
+output_pending_constants (void)
+{
+  vec<rtx> pending = vNULL;
+  struct constant_descriptor_rtx *desc;
+  unsigned i;
+  rtx symbol;
+
+  htab_traverse (const_desc_htab, add_pending_constant, &pending);
+  FOR_EACH_VEC_ELT (pending, i, symbol)
+    if (!TREE_ASM_WRITTEN (DECL_INITIAL (SYMBOL_REF_DECL (symbol))))
+      output_constant_def_contents (symbol);
+  pending.release ();
+
+  for (desc = shared_constant_pool->first; desc; desc = desc->next)
+    mark_constant (&desc->sym, NULL);
+  output_shared_constant_pool ();
+  shared_constant_pool->first = shared_constant_pool->last = NULL;
+}
 
 /* Determine what kind of relocations EXP may need.  */
 
@@ -4570,6 +4815,7 @@ output_constant (tree exp, unsigned HOST_WIDE_INT size, unsigned int align)
 #ifdef ASM_OUTPUT_FDESC
       HOST_WIDE_INT part = tree_low_cst (TREE_OPERAND (exp, 1), 0);
       tree decl = TREE_OPERAND (exp, 0);
+      flush_data_block ();
       ASM_OUTPUT_FDESC (asm_out_file, decl, part);
 #else
       gcc_unreachable ();
@@ -44,6 +44,7 @@ _cpp_preprocess_dir_only (cpp_reader *pfile,
   linenum_type lines;
   int col;
   source_location loc;
+  bool return_at_eof;
 
  restart:
   /* Buffer initialization ala _cpp_clean_line(). */
@@ -234,7 +235,8 @@ _cpp_preprocess_dir_only (cpp_reader *pfile,
       cb->print_lines (lines, base, cur - base);
     }
 
+  return_at_eof = buffer->return_at_eof;
   _cpp_pop_buffer (pfile);
-  if (pfile->buffer)
+  if (pfile->buffer && !return_at_eof)
     goto restart;
 }
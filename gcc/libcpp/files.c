@@ -111,6 +111,13 @@ struct _cpp_file
 
   /* If this file is implicitly preincluded.  */
   bool implicit_preinclude;
+
+  /* If the contents are to be taken from the -fheader-cache file.  */
+  bool in_header_cache;
+
+  /* If the file has been skipped because of an include guard taken
+     from the -fheader-cache file, before it was ever stacked.  */
+  bool skipped_by_guard;
 };
 
 /* A singly-linked list for all searches for a given file name, with
@@ -152,6 +159,38 @@ struct file_hash_entry
   } u;
 };
 
+/* The names in a directory of the include chain, used to reject
+   candidates for an #include without trying to open them.  Only the
+   first component of the file name is checked, so <sys/stat.h> is
+   rejected without a system call if there is no "sys" in the
+   directory.  */
+struct dir_listing
+{
+  /* Name of the directory, as in cpp_dir.  */
+  char *name;
+
+  /* Number of lookups so far.  A directory is only read on the second
+     lookup, since reading a big directory costs more than a single
+     failed open().  */
+  unsigned int lookups;
+
+  /* If the directory has been read successfully; otherwise the names
+     are unknown, and everything may be in it.  */
+  bool valid;
+
+  /* The NUL-separated names, and a hash table of pointers into them.  */
+  char *names;
+  struct htab *entries;
+};
+
+/* Listings can't be trusted on case insensitive file systems, where
+   the name in the directory may differ from the one included.  */
+#if defined (HAVE_CASE_INSENSITIVE_FILE_SYSTEM) || defined (__APPLE__)
+#define USE_DIR_LISTINGS 0
+#else
+#define USE_DIR_LISTINGS 1
+#endif
+
 /* Number of entries to put in a file_hash_entry pool.  */
 #define FILE_HASH_POOL_SIZE 127
 
@@ -193,6 +232,7 @@ static char *read_filename_string (int ch, FILE *f);
 static void read_name_map (cpp_dir *dir);
 static char *remap_filename (cpp_reader *pfile, _cpp_file *file);
 static char *append_file_to_dir (const char *fname, cpp_dir *dir);
+static bool dir_may_contain (cpp_reader *, cpp_dir *, const char *);
 static bool validate_pch (cpp_reader *, _cpp_file *file, const char *pchname);
 static int pchf_save_compare (const void *e1, const void *e2);
 static int pchf_compare (const void *d_p, const void *e_p);
@@ -373,6 +413,13 @@ find_file_in_dir (cpp_reader *pfile, _cpp_file *file, bool *invalid_pch)
 {
   char *path;
 
+  if (!dir_may_contain (pfile, file->dir, file->name))
+    {
+      file->err_no = ENOENT;
+      file->path = file->name;
+      return false;
+    }
+
   if (CPP_OPTION (pfile, remap) && (path = remap_filename (pfile, file)))
     ;
   else
@@ -386,6 +433,7 @@ find_file_in_dir (cpp_reader *pfile, _cpp_file *file, bool *invalid_pch)
       hashval_t hv;
       char *copy;
       void **pp;
+      enum hc_result cached = HC_UNKNOWN;
 
       /* We try to canonicalize system headers.  */
       if (CPP_OPTION (pfile, canonical_system_headers) && file->dir->sysp)
@@ -411,15 +459,36 @@ find_file_in_dir (cpp_reader *pfile, _cpp_file *file, bool *invalid_pch)
       if (pch_open_file (pfile, file, invalid_pch))
 	return true;
 
-      if (open_file (file))
-	return true;
+      /* The -fheader-cache file knows whether system headers exist,
+	 and has their contents.  */
+      if (CPP_OPTION (pfile, header_cache) && file->dir->sysp)
+	cached = _cpp_header_cache_probe (pfile, path, &file->st);
 
-      if (file->err_no != ENOENT)
+      if (cached == HC_PRESENT)
 	{
-	  open_file_failed (pfile, file, 0);
+	  file->fd = -1;
+	  file->err_no = 0;
+	  file->in_header_cache = true;
 	  return true;
 	}
 
+      if (cached == HC_ABSENT)
+	file->err_no = ENOENT;
+      else
+	{
+	  if (open_file (file))
+	    return true;
+
+	  if (file->err_no != ENOENT)
+	    {
+	      open_file_failed (pfile, file, 0);
+	      return true;
+	    }
+
+	  if (CPP_OPTION (pfile, header_cache) && file->dir->sysp)
+	    _cpp_header_cache_note_absent (pfile, path);
+	}
+
       /* We copy the path name onto an obstack partly so that we don't
 	 leak the memory, but mostly so that we don't fragment the
 	 heap.  */
@@ -732,6 +801,8 @@ read_file_guts (cpp_reader *pfile, _cpp_file *file)
 static bool
 read_file (cpp_reader *pfile, _cpp_file *file)
 {
+  struct stat st;
+
   /* If we already have its contents in memory, succeed immediately.  */
   if (file->buffer_valid)
     return true;
@@ -740,19 +811,97 @@ read_file (cpp_reader *pfile, _cpp_file *file)
   if (file->dont_read || file->err_no)
     return false;
 
+  if (file->in_header_cache
+      && _cpp_header_cache_read (pfile, file->path, &file->buffer,
+				 &file->buffer_start, &file->st.st_size))
+    {
+      file->buffer_valid = true;
+      return true;
+    }
+
   if (file->fd == -1 && !open_file (file))
     {
       open_file_failed (pfile, file, 0);
       return false;
     }
 
+  /* read_file_guts replaces the size by that of the converted text.  */
+  st = file->st;
   file->dont_read = !read_file_guts (pfile, file);
   close (file->fd);
   file->fd = -1;
 
+  if (!file->dont_read
+      && CPP_OPTION (pfile, header_cache)
+      && !file->main_file)
+    _cpp_header_cache_note_file (pfile, file->path, &st, file->buffer,
+				 file->st.st_size,
+				 file->dir && file->dir->sysp);
+
   return !file->dont_read;
 }
 
+/* Return the system header status FILE gets when it is included from
+   the current buffer.  */
+static int
+include_sysp (cpp_reader *pfile, _cpp_file *file)
+{
+  if (pfile->buffer == NULL || file->dir == NULL)
+    return 0;
+
+  return MAX (pfile->buffer->sysp, file->dir->sysp);
+}
+
+/* Add FILE, included with system header status SYSP, to the
+   dependencies if this is its first inclusion.  */
+static void
+add_file_dependency (cpp_reader *pfile, _cpp_file *file, int sysp)
+{
+  if (CPP_OPTION (pfile, deps.style) > !!sysp
+      && !file->stack_count && !file->skipped_by_guard)
+    {
+      if (!file->main_file || !CPP_OPTION (pfile, deps.ignore_main_file))
+	deps_add_dep (pfile->deps, file->path);
+    }
+}
+
+/* Return true if the include guard of FILE may be taken from the
+   -fheader-cache file.  That's only useful before FILE is stacked for
+   the first time; -H must see every header.  Traditional mode doesn't
+   share the guards, since it lexes differently.  */
+static bool
+want_cached_guard (cpp_reader *pfile, _cpp_file *file)
+{
+  return (CPP_OPTION (pfile, header_cache)
+	  && !CPP_OPTION (pfile, traditional)
+	  && !CPP_OPTION (pfile, print_include_names)
+	  && file->cmacro == NULL
+	  && file->stack_count == 0
+	  && !file->main_file
+	  && !file->pchname
+	  && file->err_no == 0);
+}
+
+/* Make GUARD, an include guard from the -fheader-cache file, that of
+   FILE.  Return true if FILE is to be skipped, because GUARD is
+   defined.  The file is still a dependency of the translation unit,
+   just as when it is skipped after reading it.  */
+static bool
+skip_by_cached_guard (cpp_reader *pfile, _cpp_file *file, const char *guard)
+{
+  if (guard == NULL)
+    return false;
+
+  file->cmacro = cpp_lookup (pfile, (const unsigned char *) guard,
+			     strlen (guard));
+  if (file->cmacro->type != NT_MACRO)
+    return false;
+
+  add_file_dependency (pfile, file, include_sysp (pfile, file));
+  file->skipped_by_guard = true;
+  return true;
+}
+
 /* Returns TRUE if FILE's contents have been successfully placed in
    FILE->buffer and the file should be stacked, otherwise false.  */
 static bool
@@ -776,6 +925,14 @@ should_stack_file (cpp_reader *pfile, _cpp_file *file, bool import)
 	return false;
     }
 
+  /* A header that hasn't changed since an earlier compilation needn't
+     even be read to find its guard.  */
+  if (want_cached_guard (pfile, file) && file->buffer == NULL
+      && skip_by_cached_guard (pfile, file,
+			       _cpp_header_cache_guard (pfile, file->path,
+							&file->st)))
+    return false;
+
   /* Skip if the file had a header guard and the macro is defined.
      PCH relies on this appearing before the PCH handler below.  */
   if (file->cmacro && file->cmacro->type == NT_MACRO)
@@ -794,6 +951,15 @@ should_stack_file (cpp_reader *pfile, _cpp_file *file, bool import)
   if (!read_file (pfile, file))
     return false;
 
+  /* A header with the same contents as one seen in an earlier
+     compilation has the same guard; that spares lexing it.  */
+  if (want_cached_guard (pfile, file) && !file->in_header_cache
+      && skip_by_cached_guard (pfile, file,
+			       _cpp_header_cache_guard_of_contents
+				 (pfile, file->path, file->buffer,
+				  file->st.st_size)))
+    return false;
+
   /* Check the file against the PCH file.  This is done before
      checking against files we've already seen, since it may save on
      I/O.  */
@@ -872,17 +1038,10 @@ _cpp_stack_file (cpp_reader *pfile, _cpp_file *file, bool import)
   if (!should_stack_file (pfile, file, import))
       return false;
 
-  if (pfile->buffer == NULL || file->dir == NULL)
-    sysp = 0;
-  else
-    sysp = MAX (pfile->buffer->sysp,  file->dir->sysp);
+  sysp = include_sysp (pfile, file);
 
   /* Add the file to the dependencies on its first inclusion.  */
-  if (CPP_OPTION (pfile, deps.style) > !!sysp && !file->stack_count)
-    {
-      if (!file->main_file || !CPP_OPTION (pfile, deps.ignore_main_file))
-	deps_add_dep (pfile->deps, file->path);
-    }
+  add_file_dependency (pfile, file, sysp);
 
   /* Clear buffer_valid since _cpp_clean_line messes it up.  */
   file->buffer_valid = false;
@@ -1249,6 +1408,32 @@ nonexistent_file_hash_eq (const void *p, const void *q)
   return filename_cmp ((const char *) p, (const char *) q) == 0;
 }
 
+/* Hash table functions for dir_listing.  */
+static hashval_t
+dir_listing_hash (const void *p)
+{
+  return htab_hash_string (((const struct dir_listing *) p)->name);
+}
+
+static int
+dir_listing_eq (const void *p, const void *q)
+{
+  return strcmp (((const struct dir_listing *) p)->name,
+		 (const char *) q) == 0;
+}
+
+static void
+dir_listing_free (void *p)
+{
+  struct dir_listing *listing = (struct dir_listing *) p;
+
+  if (listing->entries)
+    htab_delete (listing->entries);
+  free (listing->names);
+  free (listing->name);
+  free (listing);
+}
+
 /* Initialize everything in this source file.  */
 void
 _cpp_init_files (cpp_reader *pfile)
@@ -1264,6 +1449,9 @@ _cpp_init_files (cpp_reader *pfile)
   _obstack_begin (&pfile->nonexistent_file_ob, 0, 0,
 		  (void *(*) (long)) xmalloc,
 		  (void (*) (void *)) free);
+  pfile->dir_listings = htab_create_alloc (31, dir_listing_hash,
+					   dir_listing_eq, dir_listing_free,
+					   xcalloc, free);
 }
 
 /* Finalize everything in this source file.  */
@@ -1274,8 +1462,10 @@ _cpp_cleanup_files (cpp_reader *pfile)
   htab_delete (pfile->dir_hash);
   htab_delete (pfile->nonexistent_file_hash);
   obstack_free (&pfile->nonexistent_file_ob, 0);
+  htab_delete (pfile->dir_listings);
   free_file_hash_entries (pfile);
   destroy_all_cpp_files (pfile);
+  _cpp_destroy_header_cache (pfile);
 }
 
 /* Make the parser forget about files it has seen.  This can be useful
@@ -1452,6 +1642,12 @@ _cpp_pop_file_buffer (cpp_reader *pfile, _cpp_file *file,
   if (pfile->mi_valid && file->cmacro == NULL)
     file->cmacro = pfile->mi_cmacro;
 
+  /* Let later compilations know it too.  */
+  if (file->cmacro && CPP_OPTION (pfile, header_cache)
+      && !CPP_OPTION (pfile, traditional))
+    _cpp_header_cache_note_guard (pfile, file->path,
+				  (const char *) NODE_NAME (file->cmacro));
+
   /* Invalidate control macros in the #including file.  */
   pfile->mi_valid = false;
 
@@ -1522,6 +1718,123 @@ append_file_to_dir (const char *fname, cpp_dir *dir)
   return path;
 }
 
+/* Read the names in the directory of LISTING, or take them from the
+   -fheader-cache file.  */
+static void
+read_dir_listing (cpp_reader *pfile, struct dir_listing *listing)
+{
+  const char *dname = *listing->name ? listing->name : ".";
+  const char *cached;
+  char *name, *end;
+  size_t size = 0, alloc = 0;
+  bool have_stat;
+  struct stat st;
+
+  /* The directory is stat()ed before reading it, so that a change
+     while reading makes the cache entry out of date.  Relative names
+     aren't cached, since they depend on the current directory.  */
+  have_stat = (CPP_OPTION (pfile, header_cache)
+	       && IS_ABSOLUTE_PATH (dname)
+	       && stat (dname, &st) == 0);
+
+  if (have_stat
+      && _cpp_header_cache_listing (pfile, dname, &st, &cached, &size))
+    {
+      listing->names = XNEWVEC (char, size);
+      memcpy (listing->names, cached, size);
+    }
+  else
+    {
+      DIR *dir = opendir (dname);
+      struct dirent *d;
+
+      if (!dir)
+	return;
+
+      while ((d = readdir (dir)) != NULL)
+	{
+	  size_t len = strlen (d->d_name) + 1;
+
+	  if (size + len > alloc)
+	    {
+	      alloc = (size + len) * 2;
+	      listing->names = XRESIZEVEC (char, listing->names, alloc);
+	    }
+	  memcpy (listing->names + size, d->d_name, len);
+	  size += len;
+	}
+      closedir (dir);
+
+      if (have_stat)
+	_cpp_header_cache_note_listing (pfile, dname, &st, listing->names,
+					size);
+    }
+
+  listing->entries = htab_create_alloc (size / 8 + 1, htab_hash_string,
+					nonexistent_file_hash_eq,
+					NULL, xcalloc, free);
+  for (name = listing->names, end = name + size; name < end;
+       name += strlen (name) + 1)
+    *htab_find_slot (listing->entries, name, INSERT) = name;
+  listing->valid = true;
+}
+
+/* Return false if FNAME, to be looked up in DIR, is known not to exist
+   because the first component of its name isn't in the listing of
+   DIR.  */
+static bool
+dir_may_contain (cpp_reader *pfile, cpp_dir *dir, const char *fname)
+{
+  struct dir_listing *listing;
+  size_t len;
+  char *first;
+  void **slot;
+
+  if (!USE_DIR_LISTINGS
+      || dir->construct
+      || CPP_OPTION (pfile, remap)
+      || IS_ABSOLUTE_PATH (fname)
+      || dir == &pfile->no_search_path)
+    return true;
+
+  slot = htab_find_slot_with_hash (pfile->dir_listings, dir->name,
+				   htab_hash_string (dir->name), INSERT);
+  if (*slot == NULL)
+    {
+      listing = XCNEW (struct dir_listing);
+      listing->name = xstrdup (dir->name);
+      *slot = listing;
+    }
+  else
+    listing = (struct dir_listing *) *slot;
+
+  if (++listing->lookups < 2)
+    return true;
+  if (listing->lookups == 2)
+    read_dir_listing (pfile, listing);
+  if (!listing->valid)
+    return true;
+
+  for (len = 0; fname[len] && !IS_DIR_SEPARATOR (fname[len]); len++)
+    ;
+
+  /* A precompiled header may exist without the header itself.  */
+  first = (char *) alloca (len + sizeof ".gch");
+  memcpy (first, fname, len);
+  first[len] = '\0';
+  if (htab_find (listing->entries, first))
+    return true;
+
+  if (pfile->cb.valid_pch && fname[len] == '\0')
+    {
+      strcpy (first + len, ".gch");
+      if (htab_find (listing->entries, first))
+	return true;
+    }
+
+  return false;
+}
+
 /* Read a space delimited string of unlimited length from a stdio
    file F.  */
 static char *
@@ -0,0 +1,1052 @@
+/* Cache of system header contents shared between compilations.
+   Copyright (C) 2014 Free Software Foundation, Inc.
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 3, or (at your option) any
+later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.
+
+ In other words, you are welcome to use, share and improve this program.
+ You are forbidden to forbid anyone else to use, share and improve
+ what you give them.   Help stamp out software-hoarding!  */
+
+/* With -fheader-cache=FILE, the contents of headers found in system
+   include directories, already converted to the source character set,
+   are kept in FILE together with the results of failed lookups in
+   those directories.  Every compiler process maps FILE read-only, so
+   a header that is included by many translation units is only opened
+   and converted once; later lookups cost a single stat() of the
+   header, or of the directory for a failed lookup, to validate the
+   cached entry by modification time, inode and size.
+
+   The listings of the directories in the include chain, which
+   find_file_in_dir uses to reject candidates without trying to open
+   them, are kept as well; they are validated like failed lookups, by
+   the directory's modification time and inode.
+
+   Finally, the cache remembers the include guard of every header, not
+   only of system headers, together with the MD5 sum of its contents.
+   should_stack_file uses it to skip a header whose guard macro is
+   already defined without even reading it, as long as the header
+   hasn't changed; a header that has been touched, or is a copy of
+   another one, is recognized by its contents and skipped after reading
+   it, but before lexing it.
+
+   Headers, lookups and listings that miss in the cache are collected during the
+   compilation and written, together with the still valid old entries,
+   to a new FILE at the end.  The new file is renamed over the old one,
+   so concurrent compilations never see a partially written cache;
+   processes still using the old file keep their mapping.
+
+   Files modified within the last second before the compilation
+   started are not recorded, since a later modification in the same
+   second could go unnoticed on file systems with one second time
+   stamps.  */
+
+#include "config.h"
+#include "system.h"
+#include "cpplib.h"
+#include "internal.h"
+#include "md5.h"
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#ifndef O_BINARY
+# define O_BINARY 0
+#endif
+
+/* Magic string of a header cache file, including the format version.  */
+static const char hc_magic[8] = "gcchc03";
+
+/* Written in native byte order, to reject files from other hosts.  */
+#define HC_BYTE_ORDER 0x01020304
+
+/* The file starts with this header, followed by the entries sorted by
+   hash, the strings and the file contents.  All offsets are from the
+   start of the file.  */
+struct hc_header
+{
+  char magic[8];
+  unsigned int byte_order;
+  unsigned int entry_size;	/* sizeof (struct hc_entry) */
+  unsigned int count;		/* Number of entries.  */
+  unsigned int charset;		/* Offset of the input charset name.  */
+};
+
+/* The file doesn't exist.  */
+#define HCE_ABSENT	1
+/* Neither does the directory that would contain it.  */
+#define HCE_NO_DIR	2
+/* The path is a directory, followed by a '/', and the contents are
+   the NUL-separated names in it.  */
+#define HCE_LISTING	4
+/* Only the include guard of the file is cached, not its contents.  */
+#define HCE_NO_DATA	8
+
+struct hc_entry
+{
+  unsigned int hash;		/* htab_hash_string of the path.  */
+  unsigned int flags;		/* HCE_* */
+  unsigned int path;		/* Offset of the NUL-terminated path.  */
+  unsigned int data;		/* Offset of the converted contents.  */
+  unsigned int len;		/* Length of the converted contents.  */
+  unsigned int guard;		/* Offset of the include guard, or 0.  */
+  unsigned char digest[16];	/* MD5 sum of the converted contents.  */
+
+  /* Identity of the file or listed directory; for an absent file, of
+     its directory.  */
+  time_t mtime;
+  off_t size;
+  ino_t ino;
+  dev_t dev;
+};
+
+#define HC_ENTRIES_OFFSET \
+  ((sizeof (struct hc_header) + 7) & ~(size_t) 7)
+
+/* A directory containing absent files, stat()ed once per process.  */
+struct hc_dir
+{
+  char *name;
+  bool exists;
+  struct stat st;
+};
+
+/* The include guard of files with the MD5 sum DIGEST.  */
+struct hc_guard
+{
+  const unsigned char *digest;
+  const char *guard;
+};
+
+/* An entry to be added to the cache file.  */
+struct hc_pending
+{
+  char *path;
+  unsigned int hash;
+  unsigned int flags;
+  uchar *data;
+  unsigned int len;
+  char *guard;
+  unsigned char digest[16];
+  time_t mtime;
+  off_t size;
+  ino_t ino;
+  dev_t dev;
+};
+
+struct header_cache
+{
+  /* Name of the cache file.  */
+  const char *name;
+
+  /* Contents of the cache file, NULL if there was no usable one.
+     MAPPED tells whether they must be munmap()ed or freed.  */
+  const uchar *base;
+  size_t size;
+  bool mapped;
+  const struct hc_entry *entries;
+  unsigned int count;
+
+  /* Entries found to be out of date; they won't be saved again.  */
+  bool *dropped;
+  unsigned int n_dropped;
+
+  /* New entries (struct hc_pending) and directories (struct hc_dir),
+     both hashed by name.  */
+  htab_t pending;
+  htab_t dirs;
+
+  /* The include guards (struct hc_guard) of the old and new entries,
+     hashed by MD5 sum.  Filled on first use.  */
+  htab_t guards;
+
+  /* Time of the start of the compilation.  */
+  time_t now;
+
+  struct cpp_header_cache_stats stats;
+};
+
+static hashval_t
+hc_pending_hash (const void *p)
+{
+  return ((const struct hc_pending *) p)->hash;
+}
+
+static int
+hc_pending_eq (const void *p, const void *q)
+{
+  return strcmp (((const struct hc_pending *) p)->path,
+		 (const char *) q) == 0;
+}
+
+static void
+hc_pending_free (void *p)
+{
+  struct hc_pending *pending = (struct hc_pending *) p;
+
+  free (pending->path);
+  free (pending->data);
+  free (pending->guard);
+  free (pending);
+}
+
+static hashval_t
+hc_guard_hash (const void *p)
+{
+  const unsigned char *digest = ((const struct hc_guard *) p)->digest;
+  hashval_t h;
+
+  memcpy (&h, digest, sizeof h);
+  return h;
+}
+
+static int
+hc_guard_eq (const void *p, const void *q)
+{
+  return memcmp (((const struct hc_guard *) p)->digest,
+		 ((const struct hc_guard *) q)->digest, 16) == 0;
+}
+
+static hashval_t
+hc_dir_hash (const void *p)
+{
+  return htab_hash_string (((const struct hc_dir *) p)->name);
+}
+
+static int
+hc_dir_eq (const void *p, const void *q)
+{
+  return strcmp (((const struct hc_dir *) p)->name, (const char *) q) == 0;
+}
+
+static void
+hc_dir_free (void *p)
+{
+  struct hc_dir *dir = (struct hc_dir *) p;
+
+  free (dir->name);
+  free (dir);
+}
+
+/* Return the NUL-terminated string at OFFSET in the cache file, or
+   NULL if OFFSET is invalid.  */
+static const char *
+hc_string (struct header_cache *hc, unsigned int offset)
+{
+  if (offset >= hc->size
+      || !memchr (hc->base + offset, '\0', hc->size - offset))
+    return NULL;
+
+  return (const char *) hc->base + offset;
+}
+
+/* Release the contents of the cache file.  */
+static void
+unmap_header_cache (struct header_cache *hc)
+{
+  if (!hc->base)
+    return;
+
+#ifdef HAVE_SYS_MMAN_H
+  if (hc->mapped)
+    munmap ((void *) hc->base, hc->size);
+  else
+#endif
+    free ((void *) hc->base);
+
+  hc->base = NULL;
+  hc->entries = NULL;
+  hc->count = 0;
+}
+
+/* Map the cache file named by HC->name and check that it can be used
+   by PFILE.  A missing or unusable file is treated as empty.  */
+static void
+map_header_cache (cpp_reader *pfile, struct header_cache *hc)
+{
+  const struct hc_header *header;
+  const char *charset;
+  struct stat st;
+  int fd;
+
+  fd = open (hc->name, O_RDONLY | O_BINARY);
+  if (fd == -1)
+    return;
+
+  if (fstat (fd, &st) != 0
+      || st.st_size < (off_t) HC_ENTRIES_OFFSET
+      || st.st_size > (off_t) UINT_MAX)
+    {
+      close (fd);
+      return;
+    }
+
+  hc->size = st.st_size;
+
+#ifdef HAVE_SYS_MMAN_H
+  {
+    void *base = mmap (NULL, hc->size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (base != MAP_FAILED)
+      {
+	hc->base = (const uchar *) base;
+	hc->mapped = true;
+      }
+  }
+#endif
+
+  if (!hc->base)
+    {
+      uchar *buf = XNEWVEC (uchar, hc->size);
+      size_t total = 0;
+      ssize_t count;
+
+      while (total < hc->size
+	     && (count = read (fd, buf + total, hc->size - total)) > 0)
+	total += count;
+
+      if (total != hc->size)
+	{
+	  free (buf);
+	  close (fd);
+	  return;
+	}
+      hc->base = buf;
+    }
+
+  close (fd);
+
+  header = (const struct hc_header *) hc->base;
+  hc->entries = (const struct hc_entry *) (hc->base + HC_ENTRIES_OFFSET);
+  hc->count = header->count;
+
+  charset = hc_string (hc, header->charset);
+  if (memcmp (header->magic, hc_magic, sizeof hc_magic) != 0
+      || header->byte_order != HC_BYTE_ORDER
+      || header->entry_size != sizeof (struct hc_entry)
+      || header->count > ((hc->size - HC_ENTRIES_OFFSET)
+			  / sizeof (struct hc_entry))
+      || !charset
+      || strcmp (charset, CPP_OPTION (pfile, input_charset)) != 0)
+    {
+      unmap_header_cache (hc);
+      return;
+    }
+
+  hc->dropped = XCNEWVEC (bool, hc->count);
+}
+
+/* Return PFILE's header cache, opening it on first use.  */
+static struct header_cache *
+get_header_cache (cpp_reader *pfile)
+{
+  struct header_cache *hc = pfile->header_cache;
+
+  if (hc)
+    return hc;
+
+  hc = XCNEW (struct header_cache);
+  hc->name = CPP_OPTION (pfile, header_cache);
+  hc->now = time (NULL);
+  hc->pending = htab_create_alloc (127, hc_pending_hash, hc_pending_eq,
+				   hc_pending_free, xcalloc, free);
+  hc->dirs = htab_create_alloc (31, hc_dir_hash, hc_dir_eq,
+				hc_dir_free, xcalloc, free);
+  map_header_cache (pfile, hc);
+
+  pfile->header_cache = hc;
+  return hc;
+}
+
+/* Return the index of the valid entry for PATH, whose hash is HASH, or
+   -1 if there is none.  */
+static int
+lookup_entry (struct header_cache *hc, const char *path, hashval_t hash)
+{
+  unsigned int lo = 0, hi = hc->count;
+
+  while (lo < hi)
+    {
+      unsigned int mid = lo + (hi - lo) / 2;
+
+      if (hc->entries[mid].hash < hash)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  for (; lo < hc->count && hc->entries[lo].hash == hash; lo++)
+    {
+      const char *name = hc_string (hc, hc->entries[lo].path);
+
+      if (!hc->dropped[lo] && name && strcmp (name, path) == 0)
+	return lo;
+    }
+
+  return -1;
+}
+
+/* Return the directory that contains PATH, stat()ing it on first use.  */
+static struct hc_dir *
+lookup_dir (struct header_cache *hc, const char *path)
+{
+  const char *base = lbasename (path);
+  size_t len = base - path;
+  struct hc_dir *dir;
+  char *name;
+  void **slot;
+
+  /* Strip the separator, unless it is the root directory.  */
+  if (len > 1)
+    len--;
+
+  if (len == 0)
+    name = xstrdup (".");
+  else
+    name = xstrndup (path, len);
+
+  slot = htab_find_slot_with_hash (hc->dirs, name, htab_hash_string (name),
+				   INSERT);
+  if (*slot)
+    {
+      free (name);
+      return (struct hc_dir *) *slot;
+    }
+
+  dir = XNEW (struct hc_dir);
+  dir->name = name;
+  dir->exists = stat (name, &dir->st) == 0;
+  *slot = dir;
+
+  return dir;
+}
+
+/* Return true if the identity recorded in E matches ST.  */
+static bool
+same_identity (const struct hc_entry *e, const struct stat *st)
+{
+  return (e->mtime == st->st_mtime
+	  && e->ino == st->st_ino
+	  && e->dev == st->st_dev);
+}
+
+/* Forget entry I, because it is out of date.  */
+static void
+drop_entry (struct header_cache *hc, int i)
+{
+  hc->dropped[i] = true;
+  hc->n_dropped++;
+  hc->stats.stale++;
+}
+
+/* Look up PATH, a file in a system include directory, in the header
+   cache.  Return HC_PRESENT if the file exists and its contents are
+   cached, filling in *ST; HC_ABSENT if the file is known not to exist;
+   or HC_UNKNOWN if the file must be looked up normally.  */
+enum hc_result
+_cpp_header_cache_probe (cpp_reader *pfile, const char *path,
+			 struct stat *st)
+{
+  struct header_cache *hc = get_header_cache (pfile);
+  const struct hc_entry *e;
+  int i;
+
+  hc->stats.probes++;
+
+  i = lookup_entry (hc, path, htab_hash_string (path));
+  if (i < 0)
+    {
+      hc->stats.misses++;
+      return HC_UNKNOWN;
+    }
+
+  e = &hc->entries[i];
+  if (e->flags & (HCE_LISTING | HCE_NO_DATA))
+    {
+      hc->stats.misses++;
+      return HC_UNKNOWN;
+    }
+  else if (e->flags & HCE_ABSENT)
+    {
+      struct hc_dir *dir = lookup_dir (hc, path);
+
+      if ((e->flags & HCE_NO_DIR)
+	  ? !dir->exists
+	  : dir->exists && same_identity (e, &dir->st))
+	{
+	  hc->stats.absent_hits++;
+	  return HC_ABSENT;
+	}
+    }
+  else if (e->data <= hc->size
+	   && e->len <= hc->size - e->data
+	   && stat (path, st) == 0
+	   && S_ISREG (st->st_mode)
+	   && same_identity (e, st)
+	   && e->size == st->st_size)
+    {
+      hc->stats.hits++;
+      return HC_PRESENT;
+    }
+
+  drop_entry (hc, i);
+  return HC_UNKNOWN;
+}
+
+/* Copy the cached contents of PATH, for which _cpp_header_cache_probe
+   returned HC_PRESENT, into a new buffer padded like the buffers of
+   _cpp_convert_input.  Return false if PATH isn't cached.  */
+bool
+_cpp_header_cache_read (cpp_reader *pfile, const char *path,
+			const uchar **buffer, const uchar **buffer_start,
+			off_t *size)
+{
+  struct header_cache *hc = pfile->header_cache;
+  const struct hc_entry *e;
+  uchar *buf;
+  int i;
+
+  if (!hc)
+    return false;
+
+  i = lookup_entry (hc, path, htab_hash_string (path));
+  if (i < 0
+      || (hc->entries[i].flags & (HCE_ABSENT | HCE_LISTING | HCE_NO_DATA)))
+    return false;
+
+  e = &hc->entries[i];
+  buf = XNEWVEC (uchar, e->len + 16);
+  memcpy (buf, hc->base + e->data, e->len);
+  memset (buf + e->len, '\0', 16);
+  if (e->len && buf[e->len - 1] == '\r')
+    buf[e->len] = '\r';
+  else
+    buf[e->len] = '\n';
+
+  *buffer = *buffer_start = buf;
+  *size = e->len;
+  return true;
+}
+
+/* Return a new pending entry for PATH, or NULL if there already is
+   one.  */
+static struct hc_pending *
+new_pending (struct header_cache *hc, const char *path)
+{
+  hashval_t hash = htab_hash_string (path);
+  struct hc_pending *p;
+  void **slot;
+
+  slot = htab_find_slot_with_hash (hc->pending, path, hash, INSERT);
+  if (*slot)
+    return NULL;
+
+  p = XCNEW (struct hc_pending);
+  p->path = xstrdup (path);
+  p->hash = hash;
+  *slot = p;
+
+  return p;
+}
+
+/* Record the converted contents BUFFER, of length LEN, of PATH, a file
+   that wasn't found in the cache.  ST is the file's stat information
+   from before the conversion.  The contents themselves are only kept
+   if CONTENTS, i.e. for files in system include directories; for
+   other files just their MD5 sum is, until their include guard is
+   known.  */
+void
+_cpp_header_cache_note_file (cpp_reader *pfile, const char *path,
+			     const struct stat *st, const uchar *buffer,
+			     off_t len, bool contents)
+{
+  struct header_cache *hc = get_header_cache (pfile);
+  struct hc_pending *p;
+  int i;
+
+  if (!S_ISREG (st->st_mode)
+      || st->st_mtime >= hc->now - 1
+      || len > INT_MAX)
+    return;
+
+  /* Files outside system include directories are read even if they
+     are in the cache; don't record them again.  */
+  i = lookup_entry (hc, path, htab_hash_string (path));
+  if (i >= 0)
+    {
+      const struct hc_entry *e = &hc->entries[i];
+
+      if (!(e->flags & (HCE_ABSENT | HCE_LISTING))
+	  && (!contents || !(e->flags & HCE_NO_DATA))
+	  && same_identity (e, st)
+	  && e->size == st->st_size)
+	return;
+    }
+
+  p = new_pending (hc, path);
+  if (!p)
+    return;
+
+  md5_buffer ((const char *) buffer, len, p->digest);
+  if (contents)
+    {
+      p->data = XNEWVEC (uchar, len);
+      memcpy (p->data, buffer, len);
+      p->len = len;
+    }
+  else
+    p->flags = HCE_NO_DATA;
+  p->mtime = st->st_mtime;
+  p->size = st->st_size;
+  p->ino = st->st_ino;
+  p->dev = st->st_dev;
+}
+
+/* Record that PATH, a file in a system include directory, doesn't
+   exist.  */
+void
+_cpp_header_cache_note_absent (cpp_reader *pfile, const char *path)
+{
+  struct header_cache *hc = get_header_cache (pfile);
+  struct hc_dir *dir = lookup_dir (hc, path);
+  struct hc_pending *p;
+
+  if (dir->exists && dir->st.st_mtime >= hc->now - 1)
+    return;
+
+  p = new_pending (hc, path);
+  if (!p)
+    return;
+
+  p->flags = HCE_ABSENT;
+  if (dir->exists)
+    {
+      p->mtime = dir->st.st_mtime;
+      p->size = dir->st.st_size;
+      p->ino = dir->st.st_ino;
+      p->dev = dir->st.st_dev;
+    }
+  else
+    p->flags |= HCE_NO_DIR;
+}
+
+/* Return the include guard recorded for PATH, whose stat information
+   is ST, or NULL if there is none or PATH has changed since.  */
+const char *
+_cpp_header_cache_guard (cpp_reader *pfile, const char *path,
+			 const struct stat *st)
+{
+  struct header_cache *hc = get_header_cache (pfile);
+  const struct hc_entry *e;
+  const char *guard;
+  int i;
+
+  i = lookup_entry (hc, path, htab_hash_string (path));
+  if (i < 0)
+    return NULL;
+
+  e = &hc->entries[i];
+  if ((e->flags & (HCE_ABSENT | HCE_LISTING)) || !e->guard)
+    return NULL;
+
+  guard = hc_string (hc, e->guard);
+  if (!guard || !same_identity (e, st) || e->size != st->st_size)
+    {
+      drop_entry (hc, i);
+      return NULL;
+    }
+
+  hc->stats.guards++;
+  return guard;
+}
+
+/* Enter GUARD as the include guard of files with the MD5 sum DIGEST.
+   DIGEST and GUARD must live as long as the cache.  */
+static void
+enter_guard (struct header_cache *hc, const unsigned char *digest,
+	     const char *guard)
+{
+  struct hc_guard key, *g;
+  void **slot;
+
+  key.digest = digest;
+  slot = htab_find_slot (hc->guards, &key, INSERT);
+  if (*slot)
+    return;
+
+  g = XNEW (struct hc_guard);
+  g->digest = digest;
+  g->guard = guard;
+  *slot = g;
+}
+
+/* Return the include guard recorded for any file with the contents
+   BUFFER, of length LEN, which have been read from PATH, or NULL if
+   there is none.  */
+const char *
+_cpp_header_cache_guard_of_contents (cpp_reader *pfile, const char *path,
+				     const uchar *buffer, off_t len)
+{
+  struct header_cache *hc = get_header_cache (pfile);
+  struct hc_pending *p;
+  struct hc_guard key, *g;
+  unsigned char digest[16];
+
+  if (!hc->guards)
+    {
+      unsigned int i;
+
+      hc->guards = htab_create_alloc (127, hc_guard_hash, hc_guard_eq,
+				      free, xcalloc, free);
+      for (i = 0; i < hc->count; i++)
+	{
+	  const struct hc_entry *e = &hc->entries[i];
+	  const char *guard = e->guard ? hc_string (hc, e->guard) : NULL;
+
+	  if (guard && !(e->flags & (HCE_ABSENT | HCE_LISTING)))
+	    enter_guard (hc, e->digest, guard);
+	}
+    }
+
+  /* Reuse the MD5 sum computed by _cpp_header_cache_note_file.  */
+  p = (struct hc_pending *) htab_find_with_hash (hc->pending, path,
+						 htab_hash_string (path));
+  if (p)
+    key.digest = p->digest;
+  else
+    {
+      md5_buffer ((const char *) buffer, len, digest);
+      key.digest = digest;
+    }
+
+  g = (struct hc_guard *) htab_find (hc->guards, &key);
+  if (!g)
+    return NULL;
+
+  hc->stats.guards++;
+  return g->guard;
+}
+
+/* Record that GUARD is the include guard of PATH, which has been
+   noted with _cpp_header_cache_note_file in this compilation.  */
+void
+_cpp_header_cache_note_guard (cpp_reader *pfile, const char *path,
+			      const char *guard)
+{
+  struct header_cache *hc = pfile->header_cache;
+  struct hc_pending *p;
+
+  if (!hc)
+    return;
+
+  p = (struct hc_pending *) htab_find_with_hash (hc->pending, path,
+						 htab_hash_string (path));
+  if (!p || p->guard || (p->flags & (HCE_ABSENT | HCE_LISTING)))
+    return;
+
+  p->guard = xstrdup (guard);
+  if (hc->guards)
+    enter_guard (hc, p->digest, p->guard);
+}
+
+/* Return the key of the listing of directory DIR.  */
+static char *
+listing_key (const char *dir)
+{
+  return concat (dir, "/", NULL);
+}
+
+/* Look up the listing of directory DIR, whose stat information is ST.
+   If it is cached, point *NAMES to the NUL-separated names in DIR,
+   set *SIZE to their total size and return true.  */
+bool
+_cpp_header_cache_listing (cpp_reader *pfile, const char *dir,
+			   const struct stat *st, const char **names,
+			   size_t *size)
+{
+  struct header_cache *hc = get_header_cache (pfile);
+  const struct hc_entry *e;
+  char *key = listing_key (dir);
+  int i;
+
+  i = lookup_entry (hc, key, htab_hash_string (key));
+  free (key);
+  if (i < 0)
+    return false;
+
+  e = &hc->entries[i];
+  if (!(e->flags & HCE_LISTING)
+      || e->data > hc->size
+      || e->len > hc->size - e->data
+      || (e->len && hc->base[e->data + e->len - 1] != '\0')
+      || !same_identity (e, st))
+    {
+      drop_entry (hc, i);
+      return false;
+    }
+
+  hc->stats.listings++;
+  *names = (const char *) hc->base + e->data;
+  *size = e->len;
+  return true;
+}
+
+/* Record the NUL-separated names, of total size SIZE, in directory DIR,
+   whose stat information from before reading it is ST.  */
+void
+_cpp_header_cache_note_listing (cpp_reader *pfile, const char *dir,
+				const struct stat *st, const char *names,
+				size_t size)
+{
+  struct header_cache *hc = get_header_cache (pfile);
+  struct hc_pending *p;
+  char *key;
+
+  if (st->st_mtime >= hc->now - 1 || size > INT_MAX)
+    return;
+
+  key = listing_key (dir);
+  p = new_pending (hc, key);
+  free (key);
+  if (!p)
+    return;
+
+  p->flags = HCE_LISTING;
+  p->data = XNEWVEC (uchar, size);
+  memcpy (p->data, names, size);
+  p->len = size;
+  p->mtime = st->st_mtime;
+  p->size = st->st_size;
+  p->ino = st->st_ino;
+  p->dev = st->st_dev;
+}
+
+/* Collect the pending entries into the array at DATA, except for
+   those of files outside system include directories without an include
+   guard, which would be of no use.  */
+static int
+collect_pending (void **slot, void *data)
+{
+  struct hc_pending ***out = (struct hc_pending ***) data;
+  struct hc_pending *p = (struct hc_pending *) *slot;
+
+  if (!(p->flags & HCE_NO_DATA) || p->guard)
+    *(*out)++ = p;
+  return 1;
+}
+
+/* qsort comparison function for entries to be saved.  */
+static int
+hc_pending_cmp (const void *p1, const void *p2)
+{
+  const struct hc_pending *e1 = *(const struct hc_pending *const *) p1;
+  const struct hc_pending *e2 = *(const struct hc_pending *const *) p2;
+
+  if (e1->hash != e2->hash)
+    return e1->hash < e2->hash ? -1 : 1;
+  return strcmp (e1->path, e2->path);
+}
+
+/* Write the cache to a temporary file, then rename it over the cache
+   file.  Errors are silently ignored; the cache is just an
+   optimization.  */
+static void
+write_header_cache (cpp_reader *pfile, struct header_cache *hc,
+		    struct hc_pending **list, unsigned int count)
+{
+  const char *charset = CPP_OPTION (pfile, input_charset);
+  struct hc_header header;
+  size_t total, strings, offset, data;
+  unsigned int i, n;
+  char *tmpname;
+  FILE *f;
+  bool ok;
+
+  /* Leave out the entries that wouldn't fit the 32-bit offsets.  */
+  total = HC_ENTRIES_OFFSET + strlen (charset) + 1;
+  data = strlen (charset) + 1;
+  for (n = 0; n < count; n++)
+    {
+      size_t path_size = strlen (list[n]->path) + 1;
+      size_t more;
+
+      if (list[n]->guard)
+	path_size += strlen (list[n]->guard) + 1;
+      more = sizeof (struct hc_entry) + path_size + list[n]->len;
+
+      if (total + more > UINT_MAX)
+	break;
+      total += more;
+      data += path_size;
+    }
+  strings = HC_ENTRIES_OFFSET + n * sizeof (struct hc_entry);
+  data += strings;
+
+  tmpname = XNEWVEC (char, strlen (hc->name) + 32);
+  sprintf (tmpname, "%s.%ld", hc->name, (long) getpid ());
+  f = fopen (tmpname, "wb");
+  if (!f)
+    {
+      free (tmpname);
+      return;
+    }
+
+  memset (&header, 0, sizeof header);
+  memcpy (header.magic, hc_magic, sizeof hc_magic);
+  header.byte_order = HC_BYTE_ORDER;
+  header.entry_size = sizeof (struct hc_entry);
+  header.count = n;
+  header.charset = strings;
+  fwrite (&header, sizeof header, 1, f);
+  for (i = sizeof header; i < HC_ENTRIES_OFFSET; i++)
+    putc ('\0', f);
+
+  offset = strings + strlen (charset) + 1;
+  for (i = 0; i < n; i++)
+    {
+      struct hc_entry e;
+
+      memset (&e, 0, sizeof e);
+      e.hash = list[i]->hash;
+      e.flags = list[i]->flags;
+      e.path = offset;
+      e.data = data;
+      e.len = list[i]->len;
+      e.mtime = list[i]->mtime;
+      e.size = list[i]->size;
+      e.ino = list[i]->ino;
+      e.dev = list[i]->dev;
+      memcpy (e.digest, list[i]->digest, sizeof e.digest);
+
+      offset += strlen (list[i]->path) + 1;
+      if (list[i]->guard)
+	{
+	  e.guard = offset;
+	  offset += strlen (list[i]->guard) + 1;
+	}
+      fwrite (&e, sizeof e, 1, f);
+
+      data += list[i]->len;
+    }
+
+  fwrite (charset, strlen (charset) + 1, 1, f);
+  for (i = 0; i < n; i++)
+    {
+      fwrite (list[i]->path, strlen (list[i]->path) + 1, 1, f);
+      if (list[i]->guard)
+	fwrite (list[i]->guard, strlen (list[i]->guard) + 1, 1, f);
+    }
+  for (i = 0; i < n; i++)
+    fwrite (list[i]->data, list[i]->len, 1, f);
+
+  ok = !ferror (f);
+  ok &= fclose (f) == 0;
+  if (ok && rename (tmpname, hc->name) == 0)
+    hc->stats.written = n;
+  else
+    unlink (tmpname);
+
+  free (tmpname);
+}
+
+/* Save the header cache of PFILE, if anything changed.  */
+void
+_cpp_save_header_cache (cpp_reader *pfile)
+{
+  struct header_cache *hc = pfile->header_cache;
+  struct hc_pending **list, **end, *old;
+  unsigned int i, count, n_old;
+
+  if (!hc)
+    return;
+
+  /* Merge the still valid entries of the old file with the new ones.
+     The old entries point into the mapped file.  */
+  count = htab_elements (hc->pending) + hc->count;
+  list = end = XNEWVEC (struct hc_pending *, count);
+  htab_traverse_noresize (hc->pending, collect_pending, &end);
+  hc->stats.added = end - list;
+  if (hc->stats.added == 0 && hc->n_dropped == 0)
+    {
+      free (list);
+      return;
+    }
+
+  old = XNEWVEC (struct hc_pending, hc->count);
+  n_old = 0;
+  for (i = 0; i < hc->count; i++)
+    {
+      const struct hc_entry *e = &hc->entries[i];
+      const char *path = hc_string (hc, e->path);
+      struct hc_pending *p = &old[n_old];
+
+      if (hc->dropped[i] || !path
+	  || (!(e->flags & HCE_ABSENT)
+	      && (e->data > hc->size || e->len > hc->size - e->data))
+	  || htab_find_with_hash (hc->pending, path, e->hash))
+	continue;
+
+      p->path = (char *) path;
+      p->hash = e->hash;
+      p->flags = e->flags;
+      p->data = (uchar *) hc->base + e->data;
+      p->len = (e->flags & HCE_ABSENT) ? 0 : e->len;
+      p->guard = e->guard ? (char *) hc_string (hc, e->guard) : NULL;
+      memcpy (p->digest, e->digest, sizeof p->digest);
+      p->mtime = e->mtime;
+      p->size = e->size;
+      p->ino = e->ino;
+      p->dev = e->dev;
+      *end++ = p;
+      n_old++;
+    }
+
+  count = end - list;
+  qsort (list, count, sizeof (struct hc_pending *), hc_pending_cmp);
+  write_header_cache (pfile, hc, list, count);
+
+  free (old);
+  free (list);
+}
+
+/* Free the header cache of PFILE.  */
+void
+_cpp_destroy_header_cache (cpp_reader *pfile)
+{
+  struct header_cache *hc = pfile->header_cache;
+
+  if (!hc)
+    return;
+
+  unmap_header_cache (hc);
+  free (hc->dropped);
+  htab_delete (hc->pending);
+  htab_delete (hc->dirs);
+  if (hc->guards)
+    htab_delete (hc->guards);
+  free (hc);
+  pfile->header_cache = NULL;
+}
+
+/* Fill in *STATS with the statistics of PFILE's header cache.  */
+void
+cpp_get_header_cache_stats (cpp_reader *pfile,
+			    struct cpp_header_cache_stats *stats)
+{
+  if (pfile->header_cache)
+    *stats = pfile->header_cache->stats;
+  else
+    memset (stats, 0, sizeof *stats);
+}
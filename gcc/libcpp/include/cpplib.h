@@ -494,6 +494,10 @@ struct cpp_options
 
   /* True enables canonicalization of system header file paths. */
   bool canonical_system_headers;
+
+  /* If non-NULL, the file caching system headers between
+     compilations (-fheader-cache).  */
+  const char *header_cache;
 };
 
 /* Callback for header lookup for HEADER, which is the name of a
@@ -1026,6 +1030,34 @@ extern struct _cpp_file *cpp_get_file (cpp_buffer *);
 extern cpp_buffer *cpp_get_prev (cpp_buffer *);
 extern void cpp_clear_file_cache (cpp_reader *);
 
+/* In hdrcache.c */
+
+/* Statistics of the -fheader-cache file.  */
+struct cpp_header_cache_stats
+{
+  /* Lookups of files in system include directories.  */
+  unsigned int probes;
+  /* Lookups that found the file's contents in the cache.  */
+  unsigned int hits;
+  /* Lookups that found the file doesn't exist.  */
+  unsigned int absent_hits;
+  /* Lookups of files not in the cache.  */
+  unsigned int misses;
+  /* Lookups that found an out of date entry.  */
+  unsigned int stale;
+  /* Directory listings taken from the cache.  */
+  unsigned int listings;
+  /* Include guards found in the cache, for headers not read yet or
+     with the contents of a known header.  */
+  unsigned int guards;
+  /* New entries, and total entries, written back to the file.  */
+  unsigned int added;
+  unsigned int written;
+};
+
+extern void cpp_get_header_cache_stats (cpp_reader *,
+					struct cpp_header_cache_stats *);
+
 /* In pch.c */
 struct save_macro_data;
 extern int cpp_save_state (cpp_reader *, FILE *);
@@ -728,6 +728,9 @@ cpp_finish (cpp_reader *pfile, FILE *deps_stream)
   /* Report on headers that could use multiple include guards.  */
   if (CPP_OPTION (pfile, print_include_names))
     _cpp_report_missing_guards (pfile);
+
+  /* Write back the headers that weren't in the -fheader-cache file.  */
+  _cpp_save_header_cache (pfile);
 }
 
 static void
@@ -441,6 +441,13 @@ struct cpp_reader
   struct htab *nonexistent_file_hash;
   struct obstack nonexistent_file_ob;
 
+  /* The -fheader-cache file, opened on first use.  */
+  struct header_cache *header_cache;
+
+  /* Listings of the directories in the include chain (struct
+     dir_listing), hashed by name.  */
+  struct htab *dir_listings;
+
   /* Nonzero means don't look for #include "foo" the source-file
      directory.  */
   bool quote_ignores_source_dir;
@@ -644,6 +651,34 @@ extern bool _cpp_read_file_entries (cpp_reader *, FILE *);
 extern const char *_cpp_get_file_name (_cpp_file *);
 extern struct stat *_cpp_get_file_stat (_cpp_file *);
 
+/* In hdrcache.c */
+enum hc_result { HC_UNKNOWN, HC_ABSENT, HC_PRESENT };
+extern enum hc_result _cpp_header_cache_probe (cpp_reader *, const char *,
+					       struct stat *);
+extern bool _cpp_header_cache_read (cpp_reader *, const char *,
+				    const unsigned char **,
+				    const unsigned char **, off_t *);
+extern void _cpp_header_cache_note_file (cpp_reader *, const char *,
+					 const struct stat *,
+					 const unsigned char *, off_t, bool);
+extern void _cpp_header_cache_note_absent (cpp_reader *, const char *);
+extern const char *_cpp_header_cache_guard (cpp_reader *, const char *,
+					    const struct stat *);
+extern const char *_cpp_header_cache_guard_of_contents (cpp_reader *,
+							const char *,
+							const unsigned char *,
+							off_t);
+extern void _cpp_header_cache_note_guard (cpp_reader *, const char *,
+					  const char *);
+extern bool _cpp_header_cache_listing (cpp_reader *, const char *,
+				       const struct stat *, const char **,
+				       size_t *);
+extern void _cpp_header_cache_note_listing (cpp_reader *, const char *,
+					    const struct stat *,
+					    const char *, size_t);
+extern void _cpp_save_header_cache (cpp_reader *);
+extern void _cpp_destroy_header_cache (cpp_reader *);
+
 /* In expr.c */
 extern bool _cpp_parse_expr (cpp_reader *, bool);
 extern struct op *_cpp_expand_op_stack (cpp_reader *);
@@ -662,6 +697,15 @@ extern cpp_hashnode *_cpp_lex_identifier (cpp_reader *, const char *);
 extern int _cpp_remaining_tokens_num_in_context (cpp_context *);
 extern void _cpp_init_lexer (void);
 
+/* A line scanner, as used by _cpp_clean_line, and its name.  */
+struct search_line_kernel
+{
+  const char *name;
+  const unsigned char *(*search) (const unsigned char *,
+				  const unsigned char *);
+};
+extern const struct search_line_kernel *_cpp_search_line_kernels (void);
+
 /* In init.c.  */
 extern void _cpp_maybe_push_include_file (cpp_reader *);
 extern const char *cpp_named_operator2name (enum cpp_ttype type);
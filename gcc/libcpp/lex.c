@@ -471,6 +471,79 @@ search_line_sse42 (const uchar *s, const uchar *end)
 #define search_line_sse42 search_line_sse2
 #endif
 
+#ifdef HAVE_AVX2
+/* The character data of repl_chars, replicated for 32-byte vectors.  */
+static const char repl_chars32[4][32] __attribute__((aligned(32))) = {
+  { '\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n',
+    '\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n',
+    '\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n',
+    '\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n' },
+  { '\r', '\r', '\r', '\r', '\r', '\r', '\r', '\r',
+    '\r', '\r', '\r', '\r', '\r', '\r', '\r', '\r',
+    '\r', '\r', '\r', '\r', '\r', '\r', '\r', '\r',
+    '\r', '\r', '\r', '\r', '\r', '\r', '\r', '\r' },
+  { '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\',
+    '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\',
+    '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\',
+    '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\' },
+  { '?', '?', '?', '?', '?', '?', '?', '?',
+    '?', '?', '?', '?', '?', '?', '?', '?',
+    '?', '?', '?', '?', '?', '?', '?', '?',
+    '?', '?', '?', '?', '?', '?', '?', '?' },
+};
+
+/* A version of the fast scanner using AVX2 vectorized byte compare insns,
+   processing 32 bytes at a time.  Like the SSE2 version it only does
+   aligned loads, which never cross a page boundary.  */
+
+static const uchar *
+#ifndef __AVX2__
+__attribute__((__target__("avx2")))
+#endif
+search_line_avx2 (const uchar *s, const uchar *end ATTRIBUTE_UNUSED)
+{
+  typedef char v32qi __attribute__ ((__vector_size__ (32)));
+
+  const v32qi repl_nl = *(const v32qi *)repl_chars32[0];
+  const v32qi repl_cr = *(const v32qi *)repl_chars32[1];
+  const v32qi repl_bs = *(const v32qi *)repl_chars32[2];
+  const v32qi repl_qm = *(const v32qi *)repl_chars32[3];
+
+  unsigned int misalign, found, mask;
+  const v32qi *p;
+  v32qi data, t;
+
+  /* Align the source pointer.  */
+  misalign = (uintptr_t)s & 31;
+  p = (const v32qi *)((uintptr_t)s & -32);
+  data = *p;
+
+  /* Mask out the bytes before S in the first block, as in
+     search_line_sse2.  */
+  mask = -1u << misalign;
+
+  /* Main loop processing 32 bytes at a time.  */
+  goto start;
+  do
+    {
+      data = *++p;
+      mask = -1;
+
+    start:
+      t  = __builtin_ia32_pcmpeqb256 (data, repl_nl);
+      t |= __builtin_ia32_pcmpeqb256 (data, repl_cr);
+      t |= __builtin_ia32_pcmpeqb256 (data, repl_bs);
+      t |= __builtin_ia32_pcmpeqb256 (data, repl_qm);
+      found = __builtin_ia32_pmovmskb256 (t);
+      found &= mask;
+    }
+  while (!found);
+
+  found = __builtin_ctz (found);
+  return (const uchar *)p + found;
+}
+#endif
+
 /* Check the CPU capabilities.  */
 
 #include "../gcc/config/i386/cpuid.h"
@@ -478,6 +551,30 @@ search_line_sse42 (const uchar *s, const uchar *end)
 typedef const uchar * (*search_line_fast_type) (const uchar *, const uchar *);
 static search_line_fast_type search_line_fast;
 
+#ifdef HAVE_AVX2
+/* Return true if both the CPU and the OS, which has to save the YMM
+   registers, support AVX2.  */
+static bool
+cpu_supports_avx2 (void)
+{
+  unsigned int eax, ebx, ecx, edx;
+
+  if (__get_cpuid_max (0, NULL) < 7)
+    return false;
+
+  __cpuid (1, eax, ebx, ecx, edx);
+  if ((ecx & (bit_OSXSAVE | bit_AVX)) != (bit_OSXSAVE | bit_AVX))
+    return false;
+
+  __asm__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+  if ((eax & 6) != 6)
+    return false;
+
+  __cpuid_count (7, 0, eax, ebx, ecx, edx);
+  return (ebx & bit_AVX2) != 0;
+}
+#endif
+
 #define HAVE_init_vectorized_lexer 1
 static inline void
 init_vectorized_lexer (void)
@@ -494,6 +591,11 @@ init_vectorized_lexer (void)
   minimum = 1;
 #endif
 
+#ifdef HAVE_AVX2
+  if (cpu_supports_avx2 ())
+    impl = search_line_avx2;
+  else
+#endif
   if (minimum == 3)
     impl = search_line_sse42;
   else if (__get_cpuid (1, &dummy, &dummy, &ecx, &edx) || minimum == 2)
@@ -515,6 +617,22 @@ init_vectorized_lexer (void)
   search_line_fast = impl;
 }
 
+/* The scanners, in order of preference; each CPU that supports one
+   supports those before it too.  */
+#define HAVE_search_line_kernels 1
+static const struct search_line_kernel search_line_kernels[] = {
+  { "acc_char", search_line_acc_char },
+  { "mmx", search_line_mmx },
+  { "sse2", search_line_sse2 },
+#ifdef HAVE_SSE4
+  { "sse4.2", search_line_sse42 },
+#endif
+#ifdef HAVE_AVX2
+  { "avx2", search_line_avx2 },
+#endif
+  { NULL, NULL }
+};
+
 #elif (GCC_VERSION >= 4005) && defined(__ALTIVEC__)
 
 /* A vection of the fast scanner using AltiVec vectorized byte compares.  */
@@ -722,6 +840,41 @@ _cpp_init_lexer (void)
 #endif
 }
 
+/* Return the scanners usable on this host, up to the one the lexer
+   uses, terminated by an entry with a NULL name.  This is for
+   benchmarking them; see contrib/bench-search-line.c.  */
+
+const struct search_line_kernel *
+_cpp_search_line_kernels (void)
+{
+#ifdef HAVE_search_line_kernels
+  static struct search_line_kernel usable[ARRAY_SIZE (search_line_kernels)];
+  size_t i;
+
+  for (i = 0; search_line_kernels[i].name; i++)
+    {
+      usable[i] = search_line_kernels[i];
+      if (usable[i].search == search_line_fast)
+	{
+	  i++;
+	  break;
+	}
+    }
+  usable[i].name = NULL;
+  return usable;
+#else
+  static const struct search_line_kernel usable[] = {
+    { "acc_char", search_line_acc_char },
+    { "fast", search_line_fast },
+    { NULL, NULL }
+  };
+
+  if (search_line_fast == search_line_acc_char)
+    return usable + 1;
+  return usable;
+#endif
+}
+
 /* Returns with a logical line that contains no escaped newlines or
    trigraphs.  This is a time-critical inner loop.  */
 void
@@ -814,6 +967,17 @@ _cpp_clean_line (cpp_reader *pfile)
     slow_path:
       while (1)
 	{
+	  /* Move the run of ordinary characters up to the next \n, \r,
+	     \\ or ? in one go; only those need looking at.  */
+	  p = (uchar *) search_line_fast (s + 1, buffer->rlimit);
+	  if (p != s + 1)
+	    {
+	      size_t len = p - (s + 1);
+	      memmove (d + 1, s + 1, len);
+	      d += len;
+	      s += len;
+	    }
+
 	  c = *++s;
 	  *++d = c;
 
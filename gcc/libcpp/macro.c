@@ -2550,8 +2550,21 @@ cpp_sys_macro_p (cpp_reader *pfile)
   return node && node->value.macro && node->value.macro->syshdr;
 }
 
+/* Callbacks for _cpp_preprocess_dir_only that throw the text away.  */
+static void
+discard_lines (int lines ATTRIBUTE_UNUSED, const void *buf ATTRIBUTE_UNUSED,
+	       size_t size ATTRIBUTE_UNUSED)
+{
+}
+
+static void
+discard_line (source_location loc ATTRIBUTE_UNUSED)
+{
+}
+
 /* Read each token in, until end of the current file.  Directives are
-   transparently processed.  */
+   transparently processed.  With -fdirectives-only, only the
+   directives are.  */
 void
 cpp_scan_nooutput (cpp_reader *pfile)
 {
@@ -2565,6 +2578,17 @@ cpp_scan_nooutput (cpp_reader *pfile)
   if (CPP_OPTION (pfile, traditional))
     while (_cpp_read_logical_line_trad (pfile))
       ;
+  else if (CPP_OPTION (pfile, directives_only)
+	   && !CPP_OPTION (pfile, preprocessed))
+    {
+      /* Only the directives matter, e.g. for -M; don't tokenize the
+	 rest.  */
+      struct _cpp_dir_only_callbacks cb;
+
+      cb.print_lines = discard_lines;
+      cb.maybe_print_line = discard_line;
+      _cpp_preprocess_dir_only (pfile, &cb);
+    }
   else
     while (cpp_get_token (pfile)->type != CPP_EOF)
       ;
@@ -129,11 +129,11 @@ builtin_depends(
 {
 	LIST *targets = lol_get( args, 0 );
 	LIST *sources = lol_get( args, 1 );
-	LIST *l;
+	LISTITER l = list_begin( targets ), end = list_end( targets );
 
-	for( l = targets; l; l = list_next( l ) )
+	for( ; l != end; l = list_next( l ) )
 	{
-	    TARGET *t = bindtarget( l->string );
+	    TARGET *t = bindtarget( list_item( l ) );
 
 	    /* If doing INCLUDES, switch to the TARGET's include */
 	    /* TARGET, creating it if needed.  The internal include */
@@ -202,10 +202,11 @@ builtin_flags(
 	LOL	*args,
 	int	*jmp )
 {
-	LIST *l = lol_get( args, 0 );
+	LIST *targets = lol_get( args, 0 );
+	LISTITER l = list_begin( targets ), end = list_end( targets );
 
-	for( ; l; l = list_next( l ) )
-	    bindtarget( l->string )->flags |= parse->num;
+	for( ; l != end; l = list_next( l ) )
+	    bindtarget( list_item( l ) )->flags |= parse->num;
 
 	return L0;
 }
@@ -227,7 +228,7 @@ builtin_glob_back(
 	time_t	time )
 {
 	struct globbing *globbing = (struct globbing *)closure;
-	LIST		*l;
+	LISTITER	l, end;
 	PATHNAME	f;
 	char		buf[ MAXJPATH ];
 
@@ -238,8 +239,11 @@ builtin_glob_back(
 	f.f_dir.len = 0;
 	path_build( &f, buf, 0 );
 
-	for( l = globbing->patterns; l; l = l->next )
-	    if( !glob( l->string, buf ) )
+	l = list_begin( globbing->patterns );
+	end = list_end( globbing->patterns );
+
+	for( ; l != end; l = list_next( l ) )
+	    if( !glob( list_item( l ), buf ) )
 	{
 	    globbing->results = list_new( globbing->results, file, 0 );
 	    break;
@@ -252,16 +256,17 @@ builtin_glob(
 	LOL	*args,
 	int	*jmp )
 {
-	LIST *l = lol_get( args, 0 );
+	LIST *dirs = lol_get( args, 0 );
 	LIST *r = lol_get( args, 1 );
+	LISTITER l = list_begin( dirs ), end = list_end( dirs );
 
 	struct globbing globbing;
 
 	globbing.results = L0;
 	globbing.patterns = r;
 
-	for( ; l; l = list_next( l ) )
-	    file_dirscan( l->string, builtin_glob_back, &globbing );
+	for( ; l != end; l = list_next( l ) )
+	    file_dirscan( list_item( l ), builtin_glob_back, &globbing );
 
 	return globbing.results;
 }
@@ -276,19 +281,23 @@ builtin_match(
 	LOL	*args,
 	int	*jmp )
 {
-	LIST *l, *r;
+	LIST *patterns = lol_get( args, 0 );
+	LIST *strings = lol_get( args, 1 );
+	LISTITER l, r;
 	LIST *result = 0;
 
 	/* For each pattern */
 
-	for( l = lol_get( args, 0 ); l; l = l->next )
+	for( l = list_begin( patterns ); l != list_end( patterns ); 
+	     l = list_next( l ) )
 	{
-	    regexp *re = regcomp( l->string );
+	    regexp *re = regcomp( list_item( l ) );
 
 	    /* For each string to match against */
 
-	    for( r = lol_get( args, 1 ); r; r = r->next )
-		if( regexec( re, r->string ) )
+	    for( r = list_begin( strings ); r != list_end( strings ); 
+		 r = list_next( r ) )
+		if( regexec( re, list_item( r ) ) )
 	    {
 		int i, top;
 
@@ -136,19 +136,21 @@ compile_break(
  */
 
 static int
-lcmp( LIST *t, LIST *s )
+lcmp( LIST *tl, LIST *sl )
 {
+	LISTITER t = list_begin( tl ), tend = list_end( tl );
+	LISTITER s = list_begin( sl ), send = list_end( sl );
 	int status = 0;
 
-	while( !status && ( t || s ) )
+	while( !status && ( t != tend || s != send ) )
 	{
-	    const char *st = t ? t->string : "";
-	    const char *ss = s ? s->string : "";
+	    const char *st = t != tend ? list_item( t ) : "";
+	    const char *ss = s != send ? list_item( s ) : "";
 
 	    status = strcmp( st, ss );
 
-	    t = t ? list_next( t ) : t;
-	    s = s ? list_next( s ) : s;
+	    t = t != tend ? list_next( t ) : t;
+	    s = s != send ? list_next( s ) : s;
 	}
 
 	return status;
@@ -160,7 +162,8 @@ compile_eval(
 	LOL	*args,
 	int	*jmp )
 {
-	LIST *ll, *lr, *s, *t;
+	LIST *ll, *lr, *result;
+	LISTITER s, t;
 	int status = 0;
 
 	/* Short circuit lr eval for &&, ||, and 'in' */
@@ -196,17 +199,17 @@ compile_eval(
 		/* "a in b": make sure each of */
 		/* ll is equal to something in lr. */
 
-		for( t = ll; t; t = list_next( t ) )
+		for( t = list_begin( ll ); t != list_end( ll ); t = list_next( t ) )
 		{
-		    for( s = lr; s; s = list_next( s ) )
-			if( !strcmp( t->string, s->string ) )
+		    for( s = list_begin( lr ); s != list_end( lr ); s = list_next( s ) )
+			if( !strcmp( list_item( t ), list_item( s ) ) )
 			    break;
-		    if( !s ) break;
+		    if( s == list_end( lr ) ) break;
 		}
 
 		/* No more ll? Success */
 
-		if( !t ) status = 1;
+		if( t == list_end( ll ) ) status = 1;
 
 		break;
 
@@ -233,14 +236,14 @@ compile_eval(
 	/* In odd circumstances (like "" = "") */
 	/* we'll have to return a new string. */
 
-	if( !status ) t = 0;
-	else if( ll ) t = ll, ll = 0;
-	else if( lr ) t = lr, lr = 0;
-	else t = list_new( L0, "1", 0 );
+	if( !status ) result = 0;
+	else if( ll ) result = ll, ll = 0;
+	else if( lr ) result = lr, lr = 0;
+	else result = list_new( L0, "1", 0 );
 
 	if( ll ) list_free( ll );
 	if( lr ) list_free( lr );
-	return t;
+	return result;
 }
 
 /*
@@ -262,15 +265,16 @@ compile_foreach(
 {
 	LIST	*nv = (*p->left->func)( p->left, args, jmp );
 	LIST	*result = 0;
-	LIST	*l;
+	LISTITER l;
 
 	/* for each value for var */
 
-	for( l = nv; l && *jmp == JMP_NONE; l = list_next( l ) )
+	for( l = list_begin( nv ); l != list_end( nv ) && *jmp == JMP_NONE; 
+	     l = list_next( l ) )
 	{
 	    /* Reset $(p->string) for each val. */
 
-	    var_set( p->string, list_new( L0, l->string, 1 ), VAR_SET );
+	    var_set( p->string, list_new( L0, list_item( l ), 1 ), VAR_SET );
 
 	    /* Keep only last result. */
 
@@ -341,7 +345,7 @@ compile_include(
 
 	if( nt )
 	{
-	    TARGET *t = bindtarget( nt->string );
+	    TARGET *t = bindtarget( list_front( nt ) );
 
 	    /* Bind the include file under the influence of */
 	    /* "on-target" variables.  Though they are targets, */
@@ -394,7 +398,7 @@ compile_local(
 	LOL	*args,
 	int	*jmp )
 {
-	LIST *l;
+	LISTITER l;
 	SETTINGS *s = 0;
 	LIST	*nt = (*parse->left->func)( parse->left, args, jmp );
 	LIST	*ns = (*parse->right->func)( parse->right, args, jmp );
@@ -411,8 +415,8 @@ compile_local(
 
 	/* Initial value is ns */
 
-	for( l = nt; l; l = list_next( l ) )
-	    s = addsettings( s, 0, l->string, list_copy( (LIST*)0, ns ) );
+	for( l = list_begin( nt ); l != list_end( nt ); l = list_next( l ) )
+	    s = addsettings( s, 0, list_item( l ), list_copy( (LIST*)0, ns ) );
 
 	list_free( ns );
 	list_free( nt );
@@ -471,7 +475,7 @@ compile_on(
 
 	if( nt )
 	{
-	    TARGET *t = bindtarget( nt->string );
+	    TARGET *t = bindtarget( list_front( nt ) );
 	    SETTINGS *s = copysettings( t->settings );
 
 	    pushsettings( s );
@@ -502,7 +506,8 @@ compile_rule(
 {
 	LOL	nargs[1];
 	LIST	*result = 0;
-	LIST	*ll, *l;
+	LIST	*ll;
+	LISTITER l;
 	PARSE	*p;
 
 	/* list of rules to run -- normally 1! */
@@ -518,10 +523,10 @@ compile_rule(
 
 	/* Run rules, appending results from each */
 
-	for( l = ll; l; l = list_next( l ) )
+	for( l = list_begin( ll ); l != list_end( ll ); l = list_next( l ) )
 	{
 	    int localJmp = JMP_NONE;
-	    result = evaluate_rule( l->string, nargs, result, &localJmp );
+	    result = evaluate_rule( list_item( l ), nargs, result, &localJmp );
 	    if (localJmp == JMP_EOF)
 	    {
 			*jmp = JMP_EOF;
@@ -589,7 +594,7 @@ evaluate_rule(
 	{
 	    PARSE *parse = rule->procedure;
 	    SETTINGS *s = 0;
-	    LIST *l;
+	    LISTITER l;
 	    int i;
 
 # ifdef OPT_RULE_PROFILING_EXT
@@ -601,8 +606,9 @@ evaluate_rule(
 
 	    /* build parameters as local vars */
 
-	    for( l = rule->params, i = 0; l; l = l->next, i++ )
-		s = addsettings( s, 0, l->string, 
+	    for( l = list_begin( rule->params ), i = 0; 
+		 l != list_end( rule->params ); l = list_next( l ), i++ )
+		s = addsettings( s, 0, list_item( l ), 
 		    list_copy( L0, lol_get( args, i ) ) );
 
 	    /* Run rule. */
@@ -688,7 +694,7 @@ compile_set(
 {
 	LIST	*nt = (*parse->left->func)( parse->left, args, jmp );
 	LIST	*ns = (*parse->right->func)( parse->right, args, jmp );
-	LIST	*l;
+	LISTITER l;
 
 	if( DEBUG_COMPILE )
 	{
@@ -702,8 +708,8 @@ compile_set(
 	/* Call var_set to set variable */
 	/* var_set keeps ns, so need to copy it */
 
-	for( l = nt; l; l = list_next( l ) )
-	    var_set( l->string, list_copy( L0, ns ), parse->num );
+	for( l = list_begin( nt ); l != list_end( nt ); l = list_next( l ) )
+	    var_set( list_item( l ), list_copy( L0, ns ), parse->num );
 
 	list_free( nt );
 
@@ -814,7 +820,7 @@ compile_settings(
 	LIST	*nt = (*parse->left->func)( parse->left, args, jmp );
 	LIST	*ns = (*parse->third->func)( parse->third, args, jmp );
 	LIST	*targets = (*parse->right->func)( parse->right, args, jmp );
-	LIST	*ts;
+	LISTITER ts;
 
 	if( DEBUG_COMPILE )
 	{
@@ -831,14 +837,15 @@ compile_settings(
 	/* addsettings keeps ns, so need to copy it */
 	/* Pass append flag to addsettings() */
 
-	for( ts = targets; ts; ts = list_next( ts ) )
+	for( ts = list_begin( targets ); ts != list_end( targets ); 
+	     ts = list_next( ts ) )
 	{
-	    TARGET 	*t = bindtarget( ts->string );
-	    LIST	*l;
+	    TARGET 	*t = bindtarget( list_item( ts ) );
+	    LISTITER	l;
 
-	    for( l = nt; l; l = list_next( l ) )
+	    for( l = list_begin( nt ); l != list_end( nt ); l = list_next( l ) )
 		t->settings = addsettings( t->settings, parse->num,
-				l->string, list_copy( (LIST*)0, ns ) );
+				list_item( l ), list_copy( (LIST*)0, ns ) );
 	}
 
 	list_free( nt );
@@ -880,7 +887,7 @@ compile_switch(
 
 	for( parse = parse->right; parse; parse = parse->right )
 	{
-	    if( !glob( parse->left->string, nt ? nt->string : "" ) )
+	    if( !glob( parse->left->string, nt ? list_front( nt ) : "" ) )
 	    {
 		/* Get & exec parse tree for this case */
 		parse = parse->left->left;
@@ -179,16 +179,17 @@ execcmd(
 	    int i;
 	    char jobno[4];
 	    int gotpercent = 0;
+	    LISTITER s = list_begin( shell ), send = list_end( shell );
 
 	    sprintf( jobno, "%d", slot + 1 );
 
-	    for( i = 0; shell && i < MAXARGC; i++, shell = list_next( shell ) )
+	    for( i = 0; s != send && i < MAXARGC; i++, s = list_next( s ) )
 	    {
-		switch( shell->string[0] )
+		switch( list_item( s )[0] )
 		{
 		case '%':	argv[i] = string; gotpercent++; break;
 		case '!':	argv[i] = jobno; break;
-		default:	argv[i] = shell->string;
+		default:	argv[i] = list_item( s );
 		}
 		if( DEBUG_EXECCMD )
 		    printf( "argv[%d] = '%s'\n", i, argv[i] );
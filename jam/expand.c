@@ -181,7 +181,7 @@ var_expand(
 	{
 	    LIST *variables = 0;
 	    LIST *remainder = 0;
-	    LIST *vars;
+	    LISTITER vars;
 
 	    /* Recursively expand variable name & rest of input */
 
@@ -194,9 +194,11 @@ var_expand(
 
 	    /* For each variable name */
 
-	    for( vars = variables; vars; vars = list_next( vars ) )
+	    for( vars = list_begin( variables ); vars != list_end( variables ); 
+		 vars = list_next( vars ) )
 	    {
 		LIST *value, *evalue = 0;
+		LISTITER v, vend;
 		char *colon;
 		char *bracket;
 		char varname[ MAXSYM ];
@@ -206,7 +208,7 @@ var_expand(
 		/* Look for a : modifier in the variable name */
 		/* Must copy into varname so we can modify it */
 
-		strcpy( varname, vars->string );
+		strcpy( varname, list_item( vars ) );
 
 		if( colon = strchr( varname, MAGIC_COLON ) )
 		{
@@ -259,19 +261,26 @@ var_expand(
 
 		/* Handle start subscript */
 
-		while( sub1 > 0 && value )
-		    --sub1, value = list_next( value );
+		v = list_begin( value );
+		vend = list_end( value );
+
+		while( sub1 > 0 && v != vend )
+		    --sub1, v = list_next( v );
 
 		/* Empty w/ :E=default? */
 
-		if( !value && colon && edits.empty.ptr )
-		    evalue = value = list_new( L0, edits.empty.ptr, 0 );
+		if( v == vend && colon && edits.empty.ptr )
+		{
+		    evalue = list_new( L0, edits.empty.ptr, 0 );
+		    v = list_begin( evalue );
+		    vend = list_end( evalue );
+		}
 
 		/* For each variable value */
 
-		for( ; value; value = list_next( value ) )
+		for( ; v != vend; v = list_next( v ) )
 		{
-		    LIST *rem;
+		    LISTITER rem;
 		    char *out1;
 
 		    /* Handle end subscript (length actually) */
@@ -282,9 +291,9 @@ var_expand(
 		    /* Apply : mods, if present */
 
 		    if( colon && edits.filemods )
-			var_edit_file( value->string, out, &edits );
+			var_edit_file( list_item( v ), out, &edits );
 		    else
-			strcpy( out, value->string );
+			strcpy( out, list_item( v ) );
 
 		    if( colon && ( edits.upshift || edits.downshift ) )
 			var_edit_shift( out, &edits );
@@ -295,7 +304,8 @@ var_expand(
 		    /* rather than creating separate LIST elements. */
 
 		    if( colon && edits.join.ptr && 
-		      ( list_next( value ) || list_next( vars ) ) )
+		      ( list_next( v ) != vend || 
+			list_next( vars ) != list_end( variables ) ) )
 		    {
 			out += strlen( out );
 			strcpy( out, edits.join.ptr );
@@ -318,9 +328,10 @@ var_expand(
 
 		    out1 = out + strlen( out );
 
-		    for( rem = remainder; rem; rem = list_next( rem ) )
+		    for( rem = list_begin( remainder ); rem != list_end( remainder );
+			 rem = list_next( rem ) )
 		    {
-			strcpy( out1, rem->string );
+			strcpy( out1, list_item( rem ) );
 			l = list_new( l, out_buf, 0 );
 		    }
 		}
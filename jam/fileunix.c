@@ -105,10 +105,19 @@ struct ar_hdr		/* archive file member header - printable ascii */
 # endif	
 
 # ifdef OPT_STAT_CACHE_SERVER_EXT
+# ifdef OS_LINUX
+# include "linux_stat_cache.h"
+# define opendir	linux_stat_cache_opendir
+# define readdir	linux_stat_cache_readdir
+# define closedir	linux_stat_cache_closedir
+# define stat_cache_stat	linux_stat_cache_stat
+# else
 # include "beos_stat_cache.h"
 # define opendir	beos_stat_cache_opendir
 # define readdir	beos_stat_cache_readdir
 # define closedir	beos_stat_cache_closedir
+# define stat_cache_stat	beos_stat_cache_stat
+# endif
 # endif
 
 /*
@@ -178,7 +187,7 @@ file_time(
 	struct stat statbuf;
 
 # ifdef OPT_STAT_CACHE_SERVER_EXT
-	if( beos_stat_cache_stat( filename, &statbuf ) < 0 )
+	if( stat_cache_stat( filename, &statbuf ) < 0 )
 	    return -1;
 # else
 	if( stat( filename, &statbuf ) < 0 )
@@ -16,6 +16,7 @@
  * Internal routines:
  *
  *     hashrehash() - resize and rebuild hp->tab, the hash table
+ *     hashmore() - allocate another array of ITEMs
  *
  * 4/29/93 - ensure ITEM's are aligned
  * 11/04/02 (seiwald) - const-ing for string literals
@@ -25,12 +26,13 @@
 # include "jam.h"
 # include "hash.h"
 
-/* Header attached to all data items entered into a hash table. */
-
-struct hashhdr {
-	struct item *next;
-	unsigned int keyval;		/* for quick comparisons */
-} ;
+/*
+ * The table proper is an open-addressing (linear probing) array of
+ * slots, each holding the precomputed hash of its key alongside a
+ * pointer to the item, so probes rarely touch the items themselves.
+ * Items live in separately allocated arrays and never move, since
+ * callers hold on to the HASHDATA pointers handed back to them.
+ */
 
 /* This structure overlays the one handed to hashenter(). */
 /* It's actual size is given to hashinit(). */
@@ -40,24 +42,26 @@ struct hashdata {
 	/* rest of user data */
 } ;
 
-typedef struct item {
-	struct hashhdr hdr;
-	struct hashdata data;
-} ITEM ;
+typedef struct hashdata ITEM;
+
+typedef struct slot {
+	unsigned int keyval;		/* for quick comparisons */
+	ITEM *item;			/* 0 if slot is free */
+} SLOT ;
 
 # define MAX_LISTS 32
 
 struct hash 
 {
 	/*
-	 * the hash table, just an array of item pointers
+	 * the hash table, an array of slots; nel is a power of two
 	 */
 	struct {
 		int nel;
-		ITEM **base;
+		SLOT *base;
 	} tab;
 
-	int bloat;	/* tab.nel / items.nel */
+	int count;	/* ITEMs entered into the table */
 	int inel; 	/* initial number of elements */
 
 	/*
@@ -68,7 +72,7 @@ struct hash
 		int more;	/* how many more ITEMs fit in lists[ list ] */
 		char *next;	/* where to put more ITEMs in lists[ list ] */
 		int datalen;	/* length of records in this hash table */
-		int size;	/* sizeof( ITEM ) + aligned datalen */
+		int size;	/* aligned datalen */
 		int nel;	/* total ITEMs held by all lists[] */
 		int list;	/* index into lists[] */
 
@@ -82,6 +86,7 @@ struct hash
 } ;
 
 static void hashrehash( struct hash *hp );
+static void hashmore( struct hash *hp );
 static void hashstat( struct hash *hp );
 
 /*
@@ -94,15 +99,21 @@ hashitem(
 	HASHDATA **data,
 	int enter )
 {
-	ITEM **base;
-	register ITEM *i;
+	register SLOT *slot;
 	unsigned char *b = (unsigned char *)(*data)->key;
 	unsigned int keyval;
+	unsigned int mask;
+	unsigned int i;
 
 	if( enter && !hp->items.more )
+	    hashmore( hp );
+
+	/* Keep the table at most half full. */
+
+	if( enter && 2 * ( hp->count + 1 ) > hp->tab.nel )
 	    hashrehash( hp );
 
-	if( !enter && !hp->items.nel )
+	if( !enter && !hp->count )
 	    return 0;
 
 	keyval = *b;
@@ -110,26 +121,30 @@ hashitem(
 	while( *b )
 		keyval = keyval * 2147059363 + *b++;
 
-	base = hp->tab.base + ( keyval % hp->tab.nel );
+	/* Probe until we find the key or a free slot. There always is */
+	/* a free slot, as the table is kept at most half full. */
 
-	for( i = *base; i; i = i->hdr.next )
-	    if( keyval == i->hdr.keyval && 
-		!strcmp( i->data.key, (*data)->key ) )
+	mask = hp->tab.nel - 1;
+
+	for( i = keyval & mask; ( slot = hp->tab.base + i )->item; 
+	     i = ( i + 1 ) & mask )
+	    if( keyval == slot->keyval && 
+		!strcmp( slot->item->key, (*data)->key ) )
 	{
-		*data = &i->data;
+		*data = slot->item;
 		return !0;
 	}
 
 	if( enter ) 
 	{
-		i = (ITEM *)hp->items.next;
+		ITEM *item = (ITEM *)hp->items.next;
 		hp->items.next += hp->items.size;
 		hp->items.more--;
-		memcpy( (char *)&i->data, (char *)*data, hp->items.datalen );
-		i->hdr.keyval = keyval;
-		i->hdr.next = *base;
-		*base = i;
-		*data = &i->data;
+		memcpy( (char *)item, (char *)*data, hp->items.datalen );
+		slot->keyval = keyval;
+		slot->item = item;
+		hp->count++;
+		*data = item;
 	}
 
 	return 0;
@@ -141,42 +156,63 @@ hashitem(
 
 static void hashrehash( register struct hash *hp )
 {
-	int i = ++hp->items.list;
+	SLOT *oldbase = hp->tab.base;
+	int oldnel = hp->tab.nel;
+	unsigned int mask;
+	int i;
 
-	hp->items.more = i ? 2 * hp->items.nel : hp->inel;
-	hp->items.next = (char *)malloc( hp->items.more * hp->items.size );
+	/* The table size is a power of two, so that probing */
+	/* can mask instead of dividing. */
 
-	hp->items.lists[i].nel = hp->items.more;
-	hp->items.lists[i].base = hp->items.next;
-	hp->items.nel += hp->items.more;
+	hp->tab.nel = oldnel ? 2 * oldnel : 16;
 
-	if( hp->tab.base )
-		free( (char *)hp->tab.base );
+	hp->tab.base = (SLOT *)malloc( hp->tab.nel * sizeof( SLOT ) );
 
-	hp->tab.nel = hp->items.nel * hp->bloat;
-	hp->tab.base = (ITEM **)malloc( hp->tab.nel * sizeof(ITEM **) );
+	memset( (char *)hp->tab.base, '\0', hp->tab.nel * sizeof( SLOT ) );
 
-	memset( (char *)hp->tab.base, '\0', hp->tab.nel * sizeof( ITEM * ) );
+	/* Reinsert using the saved hash values; no key is rehashed. */
 
-	for( i = 0; i < hp->items.list; i++ )
+	mask = hp->tab.nel - 1;
+
+	for( i = 0; i < oldnel; i++ )
 	{
-		int nel = hp->items.lists[i].nel;
-		char *next = hp->items.lists[i].base;
+		SLOT *old = oldbase + i;
+		unsigned int j;
+
+		if( !old->item )
+			continue;
 
-		for( ; nel--; next += hp->items.size )
-		{
-			register ITEM *i = (ITEM *)next;
-			ITEM **ip = hp->tab.base + i->hdr.keyval % hp->tab.nel;
+		for( j = old->keyval & mask; hp->tab.base[ j ].item;
+		     j = ( j + 1 ) & mask )
+			;
 
-			i->hdr.next = *ip;
-			*ip = i;
-		}
+		hp->tab.base[ j ] = *old;
 	}
+
+	if( oldbase )
+		free( (char *)oldbase );
+}
+
+/*
+ * hashmore() - allocate another array of ITEMs
+ */
+
+static void hashmore( register struct hash *hp )
+{
+	int i = ++hp->items.list;
+
+	hp->items.more = i ? 2 * hp->items.nel : hp->inel;
+	hp->items.next = (char *)malloc( hp->items.more * hp->items.size );
+
+	hp->items.lists[i].nel = hp->items.more;
+	hp->items.lists[i].base = hp->items.next;
+	hp->items.nel += hp->items.more;
 }
 
 /* --- */
 
-# define ALIGNED(x) ( ( x + sizeof( ITEM ) - 1 ) & ~( sizeof( ITEM ) - 1 ) )
+# define ALIGNMENT sizeof( double )
+# define ALIGNED(x) ( ( x + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 ) )
 
 /*
  * hashinit() - initialize a hash table, returning a handle
@@ -189,12 +225,12 @@ hashinit(
 {
 	struct hash *hp = (struct hash *)malloc( sizeof( *hp ) );
 
-	hp->bloat = 3;
+	hp->count = 0;
 	hp->tab.nel = 0;
-	hp->tab.base = (ITEM **)0;
+	hp->tab.base = (SLOT *)0;
 	hp->items.more = 0;
 	hp->items.datalen = datalen;
-	hp->items.size = sizeof( struct hashhdr ) + ALIGNED( datalen );
+	hp->items.size = ALIGNED( datalen );
 	hp->items.list = -1;
 	hp->items.nel = 0;
 	hp->inel = 11;
@@ -230,28 +266,33 @@ hashdone( struct hash *hp )
 static void
 hashstat( struct hash *hp )
 {
-	ITEM **tab = hp->tab.base;
+	SLOT *tab = hp->tab.base;
 	int nel = hp->tab.nel;
+	unsigned int mask = nel - 1;
 	int count = 0;
-	int sets = 0;
-	int run = ( tab[ nel - 1 ] != (ITEM *)0 );
-	int i, here;
+	long probes = 0;
+	int i;
+
+	if( !tab )
+	    return;
 
-	for( i = nel; i > 0; i-- )
+	/* Count the probes needed to find each item again. */
+
+	for( i = 0; i < nel; i++ )
 	{
-		if( here = ( *tab++ != (ITEM *)0 ) )
-			count++;
-		if( here && !run )
-			sets++;
-		run = here;
+		if( !tab[ i ].item )
+			continue;
+
+		count++;
+		probes += ( ( i - ( tab[ i ].keyval & mask ) ) & mask ) + 1;
 	}
 
-	printf( "%s table: %d+%d+%d (%dK+%dK) items+table+hash, %f density\n",
+	printf( "%s table: %d+%d+%d (%dK+%dK) items+table+hash, %f probes\n",
 		hp->name, 
 		count, 
 		hp->items.nel,
 		hp->tab.nel,
 		hp->items.nel * hp->items.size / 1024,
-		hp->tab.nel * sizeof( ITEM ** ) / 1024,
-		(float)count / (float)sets );
+		(int)( hp->tab.nel * sizeof( SLOT ) / 1024 ),
+		count ? (float)probes / (float)count : 0.0 );
 }
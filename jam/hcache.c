@@ -78,7 +78,7 @@ cache_name(void)
 	LIST *hcachevar = var_get("HCACHEFILE");
 
 	if (hcachevar) {
-	    TARGET *t = bindtarget( hcachevar->string );
+	    TARGET *t = bindtarget( list_front( hcachevar ) );
 
 	    pushsettings( t->settings );
 	    t->boundname = search( t->name, &t->time );
@@ -103,7 +103,7 @@ cache_maxage(void)
     LIST *var = var_get("HCACHEMAXAGE");
 
     if (var) {
-	age = atoi(var->string);
+	age = atoi(list_front(var));
 	if (age < 0)
 	    age = 0;
     }
@@ -302,7 +302,7 @@ hcache_done()
 
     c = hcachelist;
     for (c = hcachelist; c; c = c->next) {
-	LIST	*l;
+	LISTITER	l;
 	char time_str[30];
 	char age_str[30];
 	char includes_count_str[30];
@@ -323,12 +323,14 @@ hcache_done()
 	write_netstring(f, time_str);
 	write_netstring(f, age_str);
 	write_netstring(f, includes_count_str);
-	for (l = c->includes; l; l = list_next(l)) {
-	    write_netstring(f, l->string);
+	for (l = list_begin(c->includes); l != list_end(c->includes);
+		l = list_next(l)) {
+	    write_netstring(f, list_item(l));
 	}
 	write_netstring(f, hdrscan_count_str);
-	for (l = c->hdrscan; l; l = list_next(l)) {
-	    write_netstring(f, l->string);
+	for (l = list_begin(c->hdrscan); l != list_end(c->hdrscan);
+		l = list_next(l)) {
+	    write_netstring(f, list_item(l));
 	}
 	fputs("\n", f);
 	header_count++;
@@ -364,16 +366,14 @@ hcache (TARGET *t, LIST *hdrscan)
     {
 	if (c->time == t->time)
 	{
-	    LIST *l1 = hdrscan, *l2 = c->hdrscan;
-	    while (l1 && l2) {
-		if (l1->string != l2->string) {
-		    l1 = NULL;
-		} else {
-		    l1 = list_next(l1);
-		    l2 = list_next(l2);
-		}
+	    int same = list_length(hdrscan) == list_length(c->hdrscan);
+	    LISTITER l1 = list_begin(hdrscan), l2 = list_begin(c->hdrscan);
+	    for (; same && l1 != list_end(hdrscan);
+		l1 = list_next(l1), l2 = list_next(l2)) {
+		if (list_item(l1) != list_item(l2))
+		    same = 0;
 	    }
-	    if (l1 || l2) {
+	    if (!same) {
 		if (DEBUG_HEADER)
 		    printf("HDRSCAN out of date in cache for %s\n",
 			   t->boundname);
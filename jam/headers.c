@@ -83,7 +83,7 @@ headers( TARGET *t )
 	if( lol_get( &lol, 1 ) )
 	{
 	    int jmp = JMP_NONE;
-	    list_free( evaluate_rule( hdrrule->string, &lol, L0, &jmp ) );
+	    list_free( evaluate_rule( list_front( hdrrule ), &lol, L0, &jmp ) );
 	}
 
 	/* Clean up */
@@ -108,16 +108,17 @@ headers1(
 	int	i;
 	int	rec = 0;
 	LIST	*result = 0;
+	LISTITER scan = list_begin( hdrscan ), end = list_end( hdrscan );
 	regexp	*re[ MAXINC ];
 	char	buf[ 1024 ];
 
 	if( !( f = fopen( file, "r" ) ) )
 	    return result;
 
-	while( rec < MAXINC && hdrscan )
+	while( rec < MAXINC && scan != end )
 	{
-	    re[rec++] = regcomp( hdrscan->string );
-	    hdrscan = list_next( hdrscan );
+	    re[rec++] = regcomp( list_item( scan ) );
+	    scan = list_next( scan );
 	}
 
 	while( fgets( buf, sizeof( buf ), f ) )
@@ -129,6 +129,8 @@
 
 # ifdef unix
 # include <sys/utsname.h>
+# include <sys/time.h>
+# include <sys/resource.h>
 # endif
 
 struct globs globs = {
@@ -148,6 +150,37 @@ struct globs globs = {
 
 static const char *othersyms[] = { OSMAJOR, OSMINOR, OSPLAT, JAMVERSYM, 0 } ;
 
+/*
+ * jam_clock() - seconds since some arbitrary point, for -ds and make1()
+ */
+
+double
+jam_clock()
+{
+# ifdef unix
+	struct timeval tv;
+	gettimeofday( &tv, 0 );
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+# else
+	return (double)clock() / CLOCKS_PER_SEC;
+# endif
+}
+
+/*
+ * jam_maxrss() - peak resident set size in KB, for -ds; 0 if unknown
+ */
+
+static long
+jam_maxrss()
+{
+# ifdef unix
+	struct rusage ru;
+	if( getrusage( RUSAGE_SELF, &ru ) == 0 )
+	    return ru.ru_maxrss;
+# endif
+	return 0;
+}
+
 /* Known for sure:
  *	mac needs arg_enviro
  *	OS2 needs extern environ
@@ -175,6 +208,7 @@ main( int argc, char **argv, char **arg_environ )
 	const char	*all = "all";
 	int		anyhow = 0;
 	int		status;
+	double		parsestart;
 
 # ifdef OS_MAC
 	InitGraf(&qd.thePort);
@@ -188,7 +222,8 @@ main( int argc, char **argv, char **arg_environ )
 
             printf( "-a      Build all targets, even if they are current.\n" );
             printf( "-dx     Display (a)actions (c)causes (d)dependencies\n" );
-	    printf( "        (m)make tree (x)commands (0-9) debug levels.\n" );
+	    printf( "        (m)make tree (s)statistics (x)commands\n" );
+	    printf( "        (0-9) debug levels.\n" );
 # ifdef OPT_RULE_PROFILING_EXT
 	    printf( "        (p)profile rules.\n" );
 # endif
@@ -270,6 +305,7 @@ main( int argc, char **argv, char **arg_environ )
 	    case 'c': DEBUG_CAUSES = 1; break;
 	    case 'd': DEBUG_DEPENDS = 1; break;
 	    case 'm': DEBUG_MAKEPROG = 1; break;
+	    case 's': DEBUG_STATS = 1; break;
 	    case 'x': DEBUG_EXEC = 1; break;
 # ifdef OPT_RULE_PROFILING_EXT
 	    case 'p': DEBUG_PROFILE_RULES = 1; break;
@@ -358,6 +394,9 @@ main( int argc, char **argv, char **arg_environ )
 	load_builtins();
 
 	/* Parse ruleset */
+
+	parsestart = jam_clock();
+
 #ifdef OPT_JAMFILE_CACHE_EXT
 	jcache_init();
 #endif
@@ -372,6 +411,10 @@ main( int argc, char **argv, char **arg_environ )
 	jcache_done();
 #endif
 
+	if( DEBUG_STATS )
+	    printf( "...parsed Jamfiles in %.3f seconds, %ldK max RSS...\n",
+		jam_clock() - parsestart, jam_maxrss() );
+
 	status = yyanyerrors();
 
 	/* Manually touch -t targets */
@@ -410,10 +453,8 @@ main( int argc, char **argv, char **arg_environ )
 			exit( EXITBAD );
 		}
 
-		for (i = 0; i < targetCount; i++) {
-			targets[i] = (char*)l->string;
-			l = l->next;
-		}
+		for (i = 0; i < targetCount; i++)
+			targets[i] = (char*)list_item(list_begin(l) + i);
 
 		argv = targets;
 		argc = targetCount;
@@ -434,6 +475,9 @@ main( int argc, char **argv, char **arg_environ )
 	donestamps();
 	donestr();
 
+	if( DEBUG_STATS )
+	    printf( "...%ldK max RSS...\n", jam_maxrss() );
+
 	/* close cmdout */
 
 	if( globs.cmdout )
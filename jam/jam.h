@@ -486,12 +486,12 @@
 
 /* Jam private definitions below. */
 
-# define DEBUG_MAX	15
+# define DEBUG_MAX	16
 
 /* Redefine DEBUG_MAX, if rule profiling support shall be compiled in. */
 # ifdef OPT_RULE_PROFILING_EXT
 # undef DEBUG_MAX
-# define DEBUG_MAX	16
+# define DEBUG_MAX	17
 # endif
 
 struct globs {
@@ -505,6 +505,8 @@ struct globs {
 
 extern struct globs globs;
 
+double	jam_clock();		/* seconds since some arbitrary point */
+
 # define DEBUG_MAKE	( globs.debug[ 1 ] )	/* -da show actions when executed */
 # define DEBUG_MAKEPROG	( globs.debug[ 3 ] )	/* -dm show progress of make0 */
 
@@ -528,7 +530,8 @@ extern struct globs globs;
 # define DEBUG_EXEC	( globs.debug[ 12 ] )	/* -dx show text of actions */
 # define DEBUG_DEPENDS	( globs.debug[ 13 ] )	/* -dd show dependency graph */
 # define DEBUG_CAUSES	( globs.debug[ 14 ] )	/* -dc show dependency graph */
+# define DEBUG_STATS	( globs.debug[ 15 ] )	/* -ds show parse/build time, memory */
 
 # ifdef OPT_RULE_PROFILING_EXT
-# define DEBUG_PROFILE_RULES	( globs.debug[ 15 ] )	/* -dp profile rules */
+# define DEBUG_PROFILE_RULES	( globs.debug[ 16 ] )	/* -dp profile rules */
 # endif
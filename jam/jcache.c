@@ -14,6 +14,7 @@
 #include "newstr.h"
 #include "pathsys.h"
 #include "parse.h"
+#include "compile.h"
 #include "rules.h"
 #include "search.h"
 #include "variable.h"
@@ -115,7 +116,8 @@ new_string_list(int block_size)
 		if (!resize_string_list(list, 0)) {
 			free(list);
 			list = 0;
-		}
+		} else
+			list->strings[0] = 0;	// null terminate
 	}
 	return list;
 }
@@ -244,16 +246,22 @@ typedef struct jamfile_cache {
 typedef struct jcache_entry {
 	char*			filename;	// name of the file
 	time_t			time;		// time stamp of the file
-	string_list*	strings;	// contents of the file
+	string_list*	strings;	// contents of the file, 0 if not loaded
+	char*			parse_data;	// serialized parse tree of the file, or 0
+	int				parse_size;	// size of the serialized parse tree
 	int				used;		// whether this cache entry has been used
 } jcache_entry;
 
+// the version line at the beginning of a cache file
+#define JCACHE_FILE_VERSION	"jcache version 2"
+
 // pointer to the jamfile cache
 static jamfile_cache* jamfileCache = 0;
 
 // jamfile cache prototypes
 static jamfile_cache* new_jamfile_cache(void);
 static void delete_jamfile_cache(jamfile_cache* cache);
+static void set_jcache_entry_parse(jcache_entry* entry, char* data, int size);
 static int init_jcache_entry(jcache_entry* entry, char *filename, time_t time,
 							 int used);
 static void cleanup_jcache_entry(jcache_entry* entry);
@@ -325,6 +333,8 @@ init_jcache_entry(jcache_entry* entry, char *filename, time_t time, int used)
 			strcpy(entry->filename, filename);
 		entry->time = time;
 		entry->strings = new_string_list(100);
+		entry->parse_data = 0;
+		entry->parse_size = 0;
 		entry->used = used;
 		// cleanup on error
 		if (!entry->filename || !entry->strings) {
@@ -352,9 +362,28 @@ cleanup_jcache_entry(jcache_entry* entry)
 			free(entry->filename);
 		if (entry->strings)
 			delete_string_list(entry->strings);
+		if (entry->parse_data)
+			free(entry->parse_data);
 	}
 }
 
+// set_jcache_entry_parse
+/*!	\brief Replaces the serialized parse tree of a jcache_entry.
+	\param entry The jcache_entry.
+	\param data The malloc()ed parse tree data, or 0. The entry takes over
+		   ownership.
+	\param size The size of the data.
+*/
+static
+void
+set_jcache_entry_parse(jcache_entry* entry, char* data, int size)
+{
+	if (entry->parse_data)
+		free(entry->parse_data);
+	entry->parse_data = data;
+	entry->parse_size = (data ? size : 0);
+}
+
 // add_jcache_entry
 /*!	\brief Adds a jcache_entry to a jamfile_cache.
 	\param cache The jamfile_cache.
@@ -494,15 +523,17 @@ read_jcache(jamfile_cache* cache, char* filename)
 			char buffer[512];
 			long count = 0;
 			int i;
-			result = !0;
-			// read number of cache entries
-			result = file_read_line_long(file, &count);
+			// check the version and read number of cache entries
+			result = file_read_line(file, buffer, sizeof(buffer))
+				&& strcmp(buffer, JCACHE_FILE_VERSION) == 0
+				&& file_read_line_long(file, &count);
 			// read the cache entries
 			for (i = 0; result && i < count; i++) {
 				char entryname[PATH_MAX];
 				long lineCount = 0;
+				long parseSize = 0;
 				time_t time = 0;
-				jcache_entry entry = { 0, 0, 0 };
+				jcache_entry entry = { 0, 0, 0, 0, 0, 0 };
 				// entry name, time and line count
 				if (file_read_line(file, entryname, sizeof(entryname))
 					&& strlen(entryname) > 0
@@ -525,6 +556,29 @@ read_jcache(jamfile_cache* cache, char* filename)
 							result = 0;
 						}
 					}
+					// the parse tree
+					if (result && (!file_read_line_long(file, &parseSize)
+							|| parseSize < 0)) {
+						fprintf(stderr, "warning: Invalid jamfile cache: "
+							"Failed to read parse tree size.\n");
+						result = 0;
+					}
+					if (result && parseSize > 0) {
+						char* data = (char*)malloc(parseSize);
+						if (data && fread(data, parseSize, 1, file) == 1
+							&& fgetc(file) == '\n') {
+							set_jcache_entry_parse(&entry, data, parseSize);
+							// the lines are not needed as long as the parse
+							// tree is valid
+							delete_string_list(entry.strings);
+							entry.strings = 0;
+						} else {
+							free(data);
+							fprintf(stderr, "warning: Invalid jamfile cache: "
+								"Failed to read parse tree.\n");
+							result = 0;
+						}
+					}
 				} else {
 					fprintf(stderr, "warning: Invalid jamfile cache: "
 						"Failed to read file info.\n");
@@ -565,8 +619,9 @@ write_jcache(jamfile_cache* cache)
 		if ((file = fopen(cache->cache_file, "w")) != 0) {
 			int count = cache->filenames->count;
 			int i;
-			// write number of cache entries
-			result = (fprintf(file, "%d\n", count) > 0);
+			// write version and number of cache entries
+			result = (fprintf(file, "%s\n%d\n", JCACHE_FILE_VERSION,
+				count) > 0);
 			// write the cache entries
 			for (i = 0; result && i < count; i++) {
 				char* entryname = cache->filenames->strings[i];
@@ -574,17 +629,28 @@ write_jcache(jamfile_cache* cache)
 				// entry name, time and line count
 				if (!entry) {
 					result = 0;
-				} else if (!entry->strings || !entry->used) {
+				} else if ((!entry->strings && !entry->parse_data)
+					|| !entry->used) {
 					// just skip the entry, if it is not loaded or not used
 				} else if (fprintf(file, "%s\n", entryname) > 0
-					&& (fprintf(file, "%ld\n", entry->time) > 0)
-					&& (fprintf(file, "%d\n", entry->strings->count) > 0)) {
+					&& (fprintf(file, "%ld\n", entry->time) > 0)) {
+					// the lines, unless there is a parse tree
+					int lineCount = (entry->parse_data || !entry->strings
+						? 0 : entry->strings->count);
 					int j;
-					// the lines
-					for (j = 0; result && j < entry->strings->count; j++) {
+					result = (fprintf(file, "%d\n", lineCount) > 0);
+					for (j = 0; result && j < lineCount; j++) {
 						const char* string = entry->strings->strings[j];
 						result = (fwrite(string, strlen(string), 1, file) > 0);
 					}
+					// the parse tree
+					if (result)
+						result = (fprintf(file, "%d\n", entry->parse_size) > 0);
+					if (result && entry->parse_size > 0) {
+						result = (fwrite(entry->parse_data, entry->parse_size,
+								1, file) == 1
+							&& fputc('\n', file) != EOF);
+					}
 				} else
 					result = 0;
 			}
@@ -613,7 +679,7 @@ jcache_name(void)
 		LIST *jcachevar = var_get("JCACHEFILE");
 
 		if (jcachevar) {
-			TARGET *t = bindtarget( jcachevar->string );
+			TARGET *t = bindtarget( list_front( jcachevar ) );
 
 			pushsettings( t->settings );
 			t->boundname = search( t->name, &t->time );
@@ -672,6 +738,9 @@ get_jcache(void)
 						delete_string_list(newEntry.strings);
 						newEntry.strings = entry->strings;
 						entry->strings = 0;
+						newEntry.parse_data = entry->parse_data;
+						newEntry.parse_size = entry->parse_size;
+						entry->parse_data = 0;
 
 						if (!add_jcache_entry(newCache, &newEntry)) {
 							fprintf(stderr, "Out of memory!\n");
@@ -755,11 +824,14 @@ jcache(char *_filename)
 				// up to date
 				strings = entry->strings->strings;
 			} else {
-				// obsolete
+				// obsolete or not loaded; the parse tree will be replaced
+				// as well
 				delete_string_list(entry->strings);
+				set_jcache_entry_parse(entry, 0, 0);
 				entry->strings = read_file(filename, 0);
 				entry->time = time;
-				strings = entry->strings->strings;
+				if (entry->strings)
+					strings = entry->strings->strings;
 			}
 		} else {
 			// not in cache
@@ -779,4 +851,467 @@ jcache(char *_filename)
 	return strings;
 }
 
+///////////////////////
+// parse tree caching
+//
+
+// the functions a PARSE node may refer to; a node's function is serialized
+// as its index in this table (plus one)
+static LIST *(*const kParseFunctions[])(PARSE *p, LOL *args, int *jmp) = {
+	0,	// plain nodes (cases, params, lols)
+	compile_append,
+	compile_break,
+	compile_eval,
+	compile_foreach,
+	compile_if,
+	compile_include,
+	compile_list,
+	compile_local,
+	compile_null,
+	compile_on,
+	compile_rule,
+	compile_rules,
+	compile_set,
+	compile_setcomp,
+	compile_setexec,
+	compile_settings,
+	compile_switch,
+	compile_while
+};
+
+#define PARSE_FUNCTION_COUNT \
+	(int)(sizeof(kParseFunctions) / sizeof(kParseFunctions[0]))
+
+// flags of a serialized PARSE node
+#define PARSE_HAS_STRING	0x01
+#define PARSE_HAS_STRING1	0x02
+
+// growable buffer a parse tree is serialized into
+typedef struct parse_buffer {
+	char*	data;
+	int		size;
+	int		capacity;
+	int		failed;
+} parse_buffer;
+
+// entry of the string table of a parse_writer
+typedef struct parse_string {
+	const char*	key;		// the string
+	int			index;		// its index in the string table
+} parse_string;
+
+// state while serializing a parse tree
+typedef struct parse_writer {
+	parse_buffer	nodes;			// serialized nodes
+	parse_buffer	strings;		// serialized string table
+	struct hash*	stringIndices;	// hash table of parse_strings
+	int				stringCount;	// number of strings in the table
+} parse_writer;
+
+// state while deserializing a parse tree
+typedef struct parse_reader {
+	const unsigned char*	data;
+	int						size;
+	int						position;
+	int						failed;
+	const char**			strings;		// the string table
+	int						stringCount;	// number of strings in the table
+} parse_reader;
+
+// write_parse_data
+static
+void
+write_parse_data(parse_buffer* buffer, const void* data, int size)
+{
+	if (buffer->failed)
+		return;
+
+	if (buffer->size + size > buffer->capacity) {
+		int newCapacity = (buffer->capacity ? buffer->capacity * 2 : 1024);
+		char* newData;
+		while (newCapacity < buffer->size + size)
+			newCapacity *= 2;
+		newData = (char*)realloc(buffer->data, newCapacity);
+		if (!newData) {
+			buffer->failed = !0;
+			return;
+		}
+		buffer->data = newData;
+		buffer->capacity = newCapacity;
+	}
+
+	memcpy(buffer->data + buffer->size, data, size);
+	buffer->size += size;
+}
+
+// write_parse_int
+static
+void
+write_parse_int(parse_buffer* buffer, int value)
+{
+	unsigned char bytes[4];
+	bytes[0] = (unsigned char)((unsigned)value >> 24);
+	bytes[1] = (unsigned char)((unsigned)value >> 16);
+	bytes[2] = (unsigned char)((unsigned)value >> 8);
+	bytes[3] = (unsigned char)value;
+	write_parse_data(buffer, bytes, 4);
+}
+
+// write_parse_string
+/*!	\brief Writes the string table index of a string to the node buffer.
+
+	Strings that are not in the table yet are added to it.
+*/
+static
+void
+write_parse_string(parse_writer* writer, const char* string)
+{
+	parse_string _entry;
+	parse_string* entry = &_entry;
+
+	entry->key = string;
+	if (hashenter(writer->stringIndices, (HASHDATA**)&entry)) {
+		int length = strlen(string);
+		entry->index = writer->stringCount++;
+		write_parse_int(&writer->strings, length);
+		write_parse_data(&writer->strings, string, length);
+	}
+
+	write_parse_int(&writer->nodes, entry->index);
+}
+
+// write_parse_tree
+/*!	\brief Serializes a parse tree into the node buffer.
+
+	A node is written as a byte containing its function index plus one,
+	a flags byte, its \c num, the string table indices of its strings, and
+	its left and third subtrees. Its right subtree follows directly, so that
+	the long right-recursive chains of rules don't recurse. A zero byte ends
+	the chain.
+
+	\param writer The writer the tree shall be written to.
+	\param parse The parse tree. May be 0.
+*/
+static
+void
+write_parse_tree(parse_writer* writer, PARSE* parse)
+{
+	for (; parse && !writer->nodes.failed; parse = parse->right) {
+		unsigned char header[2];
+		int index;
+
+		for (index = 0; index < PARSE_FUNCTION_COUNT; index++) {
+			if (kParseFunctions[index] == parse->func)
+				break;
+		}
+		if (index == PARSE_FUNCTION_COUNT) {
+			writer->nodes.failed = !0;
+			return;
+		}
+
+		header[0] = (unsigned char)(index + 1);
+		header[1] = (parse->string ? PARSE_HAS_STRING : 0)
+			| (parse->string1 ? PARSE_HAS_STRING1 : 0);
+		write_parse_data(&writer->nodes, header, 2);
+		write_parse_int(&writer->nodes, parse->num);
+		if (parse->string)
+			write_parse_string(writer, parse->string);
+		if (parse->string1)
+			write_parse_string(writer, parse->string1);
+
+		write_parse_tree(writer, parse->left);
+		write_parse_tree(writer, parse->third);
+	}
+
+	write_parse_data(&writer->nodes, "", 1);
+}
+
+// serialize_parse_tree
+/*!	\brief Serializes a parse tree.
+
+	The result consists of the number of strings, the string table (length
+	and characters of each string) and the nodes as written by
+	write_parse_tree().
+
+	\param parse The parse tree.
+	\param _size Pointer to a pre-allocated int the size of the result shall
+		   be written to.
+	\return The malloc()ed data, or 0, if an error occurred.
+*/
+static
+char*
+serialize_parse_tree(PARSE* parse, int* _size)
+{
+	parse_writer writer;
+	parse_buffer result = { 0, 0, 0, 0 };
+
+	memset(&writer, 0, sizeof(writer));
+	writer.stringIndices = hashinit(sizeof(parse_string), "jcache strings");
+
+	write_parse_tree(&writer, parse);
+
+	write_parse_int(&result, writer.stringCount);
+	write_parse_data(&result, writer.strings.data, writer.strings.size);
+	write_parse_data(&result, writer.nodes.data, writer.nodes.size);
+
+	hashdone(writer.stringIndices);
+	free(writer.strings.data);
+	free(writer.nodes.data);
+
+	if (writer.strings.failed || writer.nodes.failed || result.failed) {
+		free(result.data);
+		return 0;
+	}
+
+	*_size = result.size;
+	return result.data;
+}
+
+// read_parse_byte
+static
+int
+read_parse_byte(parse_reader* reader)
+{
+	if (reader->failed || reader->position >= reader->size) {
+		reader->failed = !0;
+		return 0;
+	}
+	return reader->data[reader->position++];
+}
+
+// read_parse_int
+static
+int
+read_parse_int(parse_reader* reader)
+{
+	const unsigned char* data;
+	if (reader->failed || reader->position + 4 > reader->size) {
+		reader->failed = !0;
+		return 0;
+	}
+	data = reader->data + reader->position;
+	reader->position += 4;
+	return (int)(((unsigned)data[0] << 24) | ((unsigned)data[1] << 16)
+		| ((unsigned)data[2] << 8) | (unsigned)data[3]);
+}
+
+// read_parse_strings
+/*!	\brief Reads the string table of a serialized parse tree.
+
+	The strings are entered via newstr(); \c reader->strings must be freed
+	by the caller.
+*/
+static
+void
+read_parse_strings(parse_reader* reader)
+{
+	char buffer[1024];
+	int count = read_parse_int(reader);
+	int i;
+
+	if (reader->failed || count < 0 || count > reader->size) {
+		reader->failed = !0;
+		return;
+	}
+
+	reader->strings = (const char**)malloc((count + 1) * sizeof(char*));
+	if (!reader->strings) {
+		reader->failed = !0;
+		return;
+	}
+
+	for (i = 0; i < count; i++) {
+		char* string = buffer;
+		int length = read_parse_int(reader);
+
+		if (reader->failed || length < 0
+			|| length > reader->size - reader->position) {
+			reader->failed = !0;
+			return;
+		}
+
+		if (length >= (int)sizeof(buffer)) {
+			string = (char*)malloc(length + 1);
+			if (!string) {
+				reader->failed = !0;
+				return;
+			}
+		}
+
+		memcpy(string, reader->data + reader->position, length);
+		string[length] = '\0';
+		reader->position += length;
+
+		reader->strings[i] = newstr(string);
+		reader->stringCount++;
+
+		if (string != buffer)
+			free(string);
+	}
+}
+
+// read_parse_string
+static
+const char*
+read_parse_string(parse_reader* reader)
+{
+	int index = read_parse_int(reader);
+	if (reader->failed || index < 0 || index >= reader->stringCount) {
+		reader->failed = !0;
+		return 0;
+	}
+	return copystr(reader->strings[index]);
+}
+
+// read_parse_tree
+/*!	\brief Deserializes a parse tree written by write_parse_tree().
+	\param reader The reader the tree shall be read from.
+	\return The parse tree, or 0, if the tree is empty or an error occurred.
+			In the latter case \c reader->failed is set.
+*/
+static
+PARSE*
+read_parse_tree(parse_reader* reader)
+{
+	PARSE* first = 0;
+	PARSE** link = &first;
+
+	while (!reader->failed) {
+		PARSE* parse;
+		const char* string = 0;
+		const char* string1 = 0;
+		int index = read_parse_byte(reader);
+		int flags;
+		int num;
+
+		if (index == 0)
+			break;
+		if (index > PARSE_FUNCTION_COUNT) {
+			reader->failed = !0;
+			break;
+		}
+
+		flags = read_parse_byte(reader);
+		num = read_parse_int(reader);
+		if (flags & PARSE_HAS_STRING)
+			string = read_parse_string(reader);
+		if (flags & PARSE_HAS_STRING1)
+			string1 = read_parse_string(reader);
+
+		parse = parse_make(kParseFunctions[index - 1], 0, 0, 0, string,
+			string1, num);
+		*link = parse;
+		link = &parse->right;
+
+		parse->left = read_parse_tree(reader);
+		parse->third = read_parse_tree(reader);
+	}
+
+	if (reader->failed && first) {
+		parse_free(first);
+		first = 0;
+	}
+	return first;
+}
+
+// find_current_jcache_entry
+/*!	\brief Looks up the up to date jcache_entry for a file.
+	\param filename The name of the file.
+	\return The jcache_entry, or 0, if the file is not cached or the entry is
+			obsolete.
+*/
+static
+jcache_entry*
+find_current_jcache_entry(const char* _filename)
+{
+	jamfile_cache* cache = get_jcache();
+	jcache_entry* entry;
+	time_t time;
+	// normalize the filename
+	char _normalizedPath[PATH_MAX];
+	char *filename = normalize_path(_filename, _normalizedPath,
+		sizeof(_normalizedPath));
+	if (!filename)
+		filename = (char*)_filename;
+
+	if (!cache || file_time(filename, &time) != 0)
+		return 0;
+
+	entry = find_jcache_entry(cache, filename);
+	if (!entry || entry->time != time)
+		return 0;
+	return entry;
+}
+
+// jcache_parse
+/*!	\brief Returns the cached parse tree of a Jamfile.
+
+	The caller owns the returned tree and must parse_free() it.
+
+	\param filename The name of the Jamfile.
+	\return The parse tree, or 0, if the file has no up to date cached parse
+			tree. The file must be parsed in that case.
+*/
+PARSE*
+jcache_parse(const char *filename)
+{
+	jcache_entry* entry = find_current_jcache_entry(filename);
+	parse_reader reader;
+	PARSE* parse = 0;
+
+	if (!entry || !entry->parse_data)
+		return 0;
+
+	memset(&reader, 0, sizeof(reader));
+	reader.data = (const unsigned char*)entry->parse_data;
+	reader.size = entry->parse_size;
+
+	read_parse_strings(&reader);
+	if (!reader.failed)
+		parse = read_parse_tree(&reader);
+	free(reader.strings);
+
+	if (reader.failed || !parse || reader.position != reader.size) {
+		// corrupt -- drop it, so the file will be read and parsed again
+		if (parse)
+			parse_free(parse);
+		set_jcache_entry_parse(entry, 0, 0);
+		return 0;
+	}
+
+	entry->used = !0;
+	return parse;
+}
+
+// jcache_save_parse
+/*!	\brief Stores the parse tree of a Jamfile in the cache.
+
+	To be called after the file has been read via jcache() and parsed
+	without errors.
+
+	\param filename The name of the Jamfile.
+	\param parse The parse tree of the complete file.
+*/
+void
+jcache_save_parse(const char *filename, PARSE *parse)
+{
+	jcache_entry* entry = find_current_jcache_entry(filename);
+	char* data;
+	int size;
+
+	// only store trees of files that have just been read
+	if (!entry || !entry->strings)
+		return;
+
+	data = serialize_parse_tree(parse, &size);
+	if (!data)
+		return;
+
+	set_jcache_entry_parse(entry, data, size);
+
+	// the lines aren't needed anymore
+	delete_string_list(entry->strings);
+	entry->strings = 0;
+}
+
 #endif	// OPT_JAMFILE_CACHE_EXT
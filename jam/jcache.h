@@ -3,8 +3,13 @@
 #ifndef _JCACHE_H
 #define _JCACHE_H
 
+struct _PARSE;
+
 void jcache_init(void);
 void jcache_done(void);
 char** jcache(char* filename);
 
+struct _PARSE* jcache_parse(const char* filename);
+void jcache_save_parse(const char* filename, struct _PARSE* parse);
+
 #endif	// _JCACHE_H
@@ -0,0 +1,237 @@
+/*
+ * This file is part of Jam - see jam.c for Copyright information.
+ */
+
+/*
+ * jtiming.c - database of action durations for critical path scheduling
+ *
+ * make1() orders the commands it can start by the expected time from
+ * starting a target's actions to the end of the build (the target's
+ * critical path).  The expected duration of each target's actions is
+ * taken from the previous runs, which are recorded in the file named
+ * by the JTIMINGFILE variable.  If JTIMINGFILE is unset, nothing is
+ * read or written and all targets are assumed to take equally long.
+ *
+ * The file is plain text: a version line, then one line per target
+ * with the duration in seconds and the bound name of the target.
+ * Entries of targets not built in a run are kept.
+ *
+ * External routines:
+ *
+ *	jtiming_get() - look up the recorded duration of a target's actions
+ *	jtiming_set() - record the duration of a target's actions
+ *	jtiming_default() - duration to assume for unknown targets
+ *	jtiming_done() - write the database back, if it changed
+ */
+
+# include "jam.h"
+# include "lists.h"
+# include "parse.h"
+# include "rules.h"
+# include "search.h"
+# include "variable.h"
+# include "hash.h"
+# include "newstr.h"
+# include "jtiming.h"
+
+# ifdef OPT_CRITICAL_PATH_EXT
+
+# define TIMING_FILE_VERSION "jtiming version 1"
+
+typedef struct _timing TIMING;
+
+struct _timing {
+	const char	*name;		/* bound name of the target */
+	double		seconds;	/* duration of its actions */
+	TIMING		*next;		/* next in timinglist */
+} ;
+
+static struct hash *timinghash = 0;
+static TIMING *timinglist = 0;
+static const char *timingfile = 0;
+static int timingcount = 0;
+static double timingsum = 0;
+static int changed = 0;
+
+/*
+ * jtiming_init() - read the database named by JTIMINGFILE, once
+ */
+
+static void
+jtiming_init()
+{
+	LIST	*var;
+	TARGET	*t;
+	FILE	*f;
+	char	buf[ MAXJPATH + 64 ];
+
+	if( timinghash )
+	    return;
+
+	timinghash = hashinit( sizeof( TIMING ), "timings" );
+
+	if( !( var = var_get( "JTIMINGFILE" ) ) )
+	    return;
+
+	/* Bind the file under the influence of "on-target" variables, */
+	/* so that LOCATE and SEARCH work as for HCACHEFILE. */
+
+	t = bindtarget( list_front( var ) );
+	pushsettings( t->settings );
+	t->boundname = search( t->name, &t->time );
+	popsettings( t->settings );
+
+	timingfile = copystr( t->boundname );
+
+	if( !( f = fopen( timingfile, "r" ) ) )
+	    return;
+
+	if( !fgets( buf, sizeof( buf ), f ) ||
+	    strncmp( buf, TIMING_FILE_VERSION, strlen( TIMING_FILE_VERSION ) ) )
+	{
+	    printf( "warning: ignoring invalid %s\n", timingfile );
+	    fclose( f );
+	    return;
+	}
+
+	while( fgets( buf, sizeof( buf ), f ) )
+	{
+	    TIMING	timing, *tm = &timing;
+	    char	*name;
+	    int		len = strlen( buf );
+
+	    if( len && buf[ len - 1 ] == '\n' )
+		buf[ --len ] = 0;
+
+	    if( !( name = strchr( buf, ' ' ) ) )
+		continue;
+
+	    *name++ = 0;
+	    tm->name = name;
+
+	    if( hashenter( timinghash, (HASHDATA **)&tm ) )
+	    {
+		tm->name = newstr( name );
+		tm->seconds = atof( buf );
+		tm->next = timinglist;
+		timinglist = tm;
+		timingcount++;
+		timingsum += tm->seconds;
+	    }
+	}
+
+	fclose( f );
+
+	if( DEBUG_STATS )
+	    printf( "...read %d action timings from %s...\n",
+		timingcount, timingfile );
+}
+
+/*
+ * jtiming_get() - look up the recorded duration of a target's actions
+ *
+ * Returns 0 if the target is not in the database.
+ */
+
+int
+jtiming_get(
+	const char	*target,
+	double		*seconds )
+{
+	TIMING	timing, *tm = &timing;
+
+	jtiming_init();
+
+	tm->name = target;
+
+	if( !hashcheck( timinghash, (HASHDATA **)&tm ) )
+	    return 0;
+
+	*seconds = tm->seconds;
+	return 1;
+}
+
+/*
+ * jtiming_set() - record the duration of a target's actions
+ *
+ * A known duration is averaged with the new one, to dampen the effect
+ * of a single slow run.
+ */
+
+void
+jtiming_set(
+	const char	*target,
+	double		seconds )
+{
+	TIMING	timing, *tm = &timing;
+
+	jtiming_init();
+
+	tm->name = target;
+
+	if( hashenter( timinghash, (HASHDATA **)&tm ) )
+	{
+	    tm->name = newstr( target );
+	    tm->seconds = seconds;
+	    tm->next = timinglist;
+	    timinglist = tm;
+	    timingcount++;
+	    timingsum += seconds;
+	}
+	else
+	{
+	    timingsum -= tm->seconds;
+	    tm->seconds = ( tm->seconds + seconds ) / 2;
+	    timingsum += tm->seconds;
+	}
+
+	changed = 1;
+}
+
+/*
+ * jtiming_default() - duration to assume for targets not in the database
+ *
+ * That's the average of the known durations, or 1 second if there are
+ * none, which makes the critical path the longest chain of actions.
+ */
+
+double
+jtiming_default()
+{
+	jtiming_init();
+
+	return timingcount ? timingsum / timingcount : 1.0;
+}
+
+/*
+ * jtiming_done() - write the database back, if it changed
+ */
+
+void
+jtiming_done()
+{
+	FILE	*f;
+	TIMING	*tm;
+
+	if( !timinghash )
+	    return;
+
+	if( changed && timingfile && ( f = fopen( timingfile, "w" ) ) )
+	{
+	    fprintf( f, "%s\n", TIMING_FILE_VERSION );
+
+	    for( tm = timinglist; tm; tm = tm->next )
+		fprintf( f, "%.3f %s\n", tm->seconds, tm->name );
+
+	    fclose( f );
+	}
+
+	hashdone( timinghash );
+	timinghash = 0;
+	timinglist = 0;
+	timingcount = 0;
+	timingsum = 0;
+	changed = 0;
+}
+
+# endif /* OPT_CRITICAL_PATH_EXT */
@@ -0,0 +1,16 @@
+/*
+ * This file is part of Jam - see jam.c for Copyright information.
+ */
+
+/*
+ * jtiming.h - database of action durations for critical path scheduling
+ */
+
+# ifdef OPT_CRITICAL_PATH_EXT
+
+int	jtiming_get( const char *target, double *seconds );
+void	jtiming_set( const char *target, double seconds );
+double	jtiming_default( void );
+void	jtiming_done( void );
+
+# endif
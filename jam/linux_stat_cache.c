@@ -0,0 +1,287 @@
+// linux_stat_cache.c
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "linux_stat_cache.h"
+#include "pathsys.h"
+#include "linux_stat_cache_server.h"
+
+// The DIR handles we hand out. If the server is not available, the real
+// DIR is used, otherwise the entries received from the server are iterated.
+typedef struct stat_cache_dir {
+	DIR				*dir;
+	char			*buffer;
+	char			*nextEntry;
+	int32_t			entryCount;
+	struct dirent	entry;
+} stat_cache_dir;
+
+static int sServerSocket = -1;
+static int sInitialized = 0;
+
+// get_socket_path
+static
+const char *
+get_socket_path(char *buffer, size_t bufferSize)
+{
+	const char *path = getenv(STAT_CACHE_SERVER_SOCKET_ENV);
+	if (path && *path)
+		return path;
+
+	snprintf(buffer, bufferSize, "%s%u", STAT_CACHE_SERVER_SOCKET_PREFIX,
+		(unsigned)getuid());
+	return buffer;
+}
+
+// get_server_socket
+static
+int
+get_server_socket()
+{
+	if (!sInitialized) {
+		char buffer[128];
+		const char *path = get_socket_path(buffer, sizeof(buffer));
+		struct sockaddr_un address;
+		int fd;
+
+		sInitialized = 1;
+
+		if (strlen(path) >= sizeof(address.sun_path))
+			return -1;
+
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+			return -1;
+
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		strcpy(address.sun_path, path);
+		if (connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+			close(fd);
+			return -1;
+		}
+
+		sServerSocket = fd;
+	}
+	return sServerSocket;
+}
+
+// disconnect
+//
+// Called when the communication with the server failed. We fall back to
+// the standard functions for the rest of the run.
+static
+void
+disconnect()
+{
+	if (sServerSocket >= 0) {
+		close(sServerSocket);
+		sServerSocket = -1;
+	}
+}
+
+// write_fully
+static
+int
+write_fully(int fd, const void *buffer, size_t size)
+{
+	const char *data = (const char*)buffer;
+	while (size > 0) {
+		ssize_t bytesWritten = write(fd, data, size);
+		if (bytesWritten < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		data += bytesWritten;
+		size -= bytesWritten;
+	}
+	return 0;
+}
+
+// read_fully
+static
+int
+read_fully(int fd, void *buffer, size_t size)
+{
+	char *data = (char*)buffer;
+	while (size > 0) {
+		ssize_t bytesRead = read(fd, data, size);
+		if (bytesRead < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		if (bytesRead == 0)
+			return -1;
+		data += bytesRead;
+		size -= bytesRead;
+	}
+	return 0;
+}
+
+// send_request
+static
+int
+send_request(int32_t command, const char *path)
+{
+	struct {
+		stat_cache_request	header;
+		char				path[STAT_CACHE_MAX_PATH_LENGTH];
+	} request;
+	int fd = get_server_socket();
+
+	if (fd < 0)
+		return -1;
+
+	// normalize the path
+	if (!path || !normalize_path(path, request.path, sizeof(request.path))) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	request.header.command = command;
+	request.header.pathLength = strlen(request.path) + 1;
+	if (write_fully(fd, &request,
+			sizeof(request.header) + request.header.pathLength) < 0) {
+		disconnect();
+		return -1;
+	}
+	return 0;
+}
+
+// linux_stat_cache_stat
+int
+linux_stat_cache_stat(const char *filename, struct stat *st)
+{
+	stat_cache_stat_reply reply;
+
+	// fall back to standard, if there is no server
+	if (get_server_socket() < 0)
+		return stat(filename, st);
+
+	// send the request and get the reply
+	if (send_request(STAT_CACHE_COMMAND_STAT, filename) < 0)
+		return stat(filename, st);
+
+	if (read_fully(sServerSocket, &reply, sizeof(reply)) < 0) {
+		disconnect();
+		return stat(filename, st);
+	}
+
+	if (reply.error != 0) {
+		errno = reply.error;
+		return -1;
+	}
+
+	*st = reply.st;
+	return 0;
+}
+
+// linux_stat_cache_opendir
+DIR *
+linux_stat_cache_opendir(const char *dirName)
+{
+	stat_cache_readdir_reply reply;
+	stat_cache_dir *dir;
+	int needFallback = 0;
+
+	dir = (stat_cache_dir*)malloc(sizeof(stat_cache_dir));
+	if (!dir) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	memset(dir, 0, sizeof(stat_cache_dir));
+
+	// send the request and get the reply header
+	if (send_request(STAT_CACHE_COMMAND_READDIR, dirName) < 0)
+		needFallback = 1;
+	else if (read_fully(sServerSocket, &reply, sizeof(reply)) < 0) {
+		disconnect();
+		needFallback = 1;
+	}
+
+	// fall back to standard, if there is no server
+	if (needFallback) {
+		dir->dir = opendir(dirName);
+		if (!dir->dir) {
+			free(dir);
+			return NULL;
+		}
+		return (DIR*)dir;
+	}
+
+	// get the entries
+	if (reply.bufferSize > 0) {
+		dir->buffer = (char*)malloc(reply.bufferSize);
+		if (!dir->buffer
+			|| read_fully(sServerSocket, dir->buffer, reply.bufferSize) < 0) {
+			// we can't resync with the server
+			disconnect();
+			free(dir->buffer);
+			free(dir);
+			errno = EIO;
+			return NULL;
+		}
+	}
+
+	if (reply.error != 0) {
+		free(dir->buffer);
+		free(dir);
+		errno = reply.error;
+		return NULL;
+	}
+
+	dir->nextEntry = dir->buffer;
+	dir->entryCount = reply.entryCount;
+
+	// a bit ugly, but anyway...
+	return (DIR*)dir;
+}
+
+// linux_stat_cache_readdir
+struct dirent *
+linux_stat_cache_readdir(DIR *_dir)
+{
+	stat_cache_dir *dir = (stat_cache_dir*)_dir;
+	size_t nameLength;
+
+	if (dir->dir)
+		return readdir(dir->dir);
+
+	if (dir->entryCount == 0)
+		return NULL;
+
+	nameLength = strlen(dir->nextEntry);
+	if (nameLength >= sizeof(dir->entry.d_name))
+		nameLength = sizeof(dir->entry.d_name) - 1;
+	memcpy(dir->entry.d_name, dir->nextEntry, nameLength);
+	dir->entry.d_name[nameLength] = '\0';
+
+	// get the next entry
+	dir->nextEntry += strlen(dir->nextEntry) + 1;
+	dir->entryCount--;
+
+	return &dir->entry;
+}
+
+// linux_stat_cache_closedir
+int
+linux_stat_cache_closedir(DIR *_dir)
+{
+	stat_cache_dir *dir = (stat_cache_dir*)_dir;
+	int result = 0;
+
+	if (dir->dir)
+		result = closedir(dir->dir);
+
+	free(dir->buffer);
+	free(dir);
+	return result;
+}
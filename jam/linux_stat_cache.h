@@ -0,0 +1,15 @@
+// linux_stat_cache.h
+
+#ifndef LINUX_STAT_CACHE_H
+#define LINUX_STAT_CACHE_H
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+int linux_stat_cache_stat(const char *filename, struct stat *st);
+
+DIR* linux_stat_cache_opendir(const char *dirName);
+struct dirent *linux_stat_cache_readdir(DIR *dir);
+int linux_stat_cache_closedir(DIR *dir);
+
+#endif	// LINUX_STAT_CACHE_H
@@ -0,0 +1,735 @@
+// linux_stat_cache_server.c
+//
+// Linux counterpart of the BeOS StatCacheServer. It serves stat() and
+// readdir() requests of jam clients from memory and uses inotify to keep the
+// cached data up to date. Clients connect via a Unix domain socket (cf.
+// linux_stat_cache_server.h).
+
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "linux_stat_cache_server.h"
+
+//#define DBG(x) { x; }
+#define DBG(x)
+#define OUT(format...) {printf(format); fflush(stdout);}
+
+#define MAX_CLIENTS			64
+#define PATH_HASH_SIZE		16384
+#define WATCH_HASH_SIZE		1024
+
+#define WATCH_EVENT_MASK	(IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE	\
+	| IN_DELETE | IN_DELETE_SELF | IN_MODIFY | IN_MOVE_SELF | IN_MOVED_FROM	\
+	| IN_MOVED_TO)
+#define ENTRY_EVENT_MASK	(IN_CREATE | IN_DELETE | IN_MOVED_FROM	\
+	| IN_MOVED_TO)
+
+// entry flags
+enum {
+	ENTRY_STAT_VALID	= 0x01,
+	ENTRY_DIR_VALID		= 0x02,
+};
+
+typedef struct cache_entry {
+	struct cache_entry	*hashNext;
+	struct cache_entry	*watchHashNext;
+	char				*path;
+	size_t				pathLength;
+	unsigned			hash;
+	int					flags;
+	int					watch;		// inotify watch descriptor or -1
+
+	// stat data
+	int					statError;
+	struct stat			st;
+
+	// directory data
+	int					dirError;
+	int32_t				entryCount;
+	int32_t				bufferSize;
+	char				*buffer;
+} cache_entry;
+
+static cache_entry *sPathHash[PATH_HASH_SIZE];
+static cache_entry *sWatchHash[WATCH_HASH_SIZE];
+static int sInotifyFD = -1;
+static int sListenSocket = -1;
+static const char *sSocketPath = NULL;
+static volatile sig_atomic_t sQuit = 0;
+
+// statistics
+static unsigned long sStatRequests = 0;
+static unsigned long sStatHits = 0;
+static unsigned long sReaddirRequests = 0;
+static unsigned long sReaddirHits = 0;
+
+// string_hash
+//
+// from the Dragon Book: a slightly modified hashpjw()
+static inline
+unsigned
+string_hash(const char *name)
+{
+	unsigned h = 0;
+	if (name) {
+		for (; *name; name++) {
+			unsigned g = h & 0xf0000000;
+			if (g)
+				h ^= g >> 24;
+			h = (h << 4) + *name;
+		}
+	}
+	return h;
+}
+
+// lookup_entry
+static
+cache_entry *
+lookup_entry(const char *path, int create)
+{
+	unsigned hash = string_hash(path);
+	cache_entry **slot = &sPathHash[hash % PATH_HASH_SIZE];
+	cache_entry *entry;
+
+	for (entry = *slot; entry; entry = entry->hashNext) {
+		if (entry->hash == hash && strcmp(entry->path, path) == 0)
+			return entry;
+	}
+
+	if (!create)
+		return NULL;
+
+	entry = (cache_entry*)calloc(1, sizeof(cache_entry));
+	if (!entry)
+		return NULL;
+	entry->path = strdup(path);
+	if (!entry->path) {
+		free(entry);
+		return NULL;
+	}
+	entry->pathLength = strlen(path);
+	entry->hash = hash;
+	entry->watch = -1;
+	entry->hashNext = *slot;
+	*slot = entry;
+	return entry;
+}
+
+// lookup_watch
+static
+cache_entry *
+lookup_watch(int watch)
+{
+	cache_entry *entry = sWatchHash[watch % WATCH_HASH_SIZE];
+	for (; entry; entry = entry->watchHashNext) {
+		if (entry->watch == watch)
+			return entry;
+	}
+	return NULL;
+}
+
+// remove_watch
+static
+void
+remove_watch(cache_entry *entry)
+{
+	cache_entry **slot;
+
+	if (entry->watch < 0)
+		return;
+
+	for (slot = &sWatchHash[entry->watch % WATCH_HASH_SIZE]; *slot;
+			slot = &(*slot)->watchHashNext) {
+		if (*slot == entry) {
+			*slot = entry->watchHashNext;
+			break;
+		}
+	}
+	entry->watchHashNext = NULL;
+	entry->watch = -1;
+}
+
+// invalidate_entry
+static
+void
+invalidate_entry(cache_entry *entry)
+{
+	DBG(OUT("invalidate: %s\n", entry->path));
+	entry->flags = 0;
+	free(entry->buffer);
+	entry->buffer = NULL;
+	entry->entryCount = 0;
+	entry->bufferSize = 0;
+}
+
+// invalidate_subtree
+//
+// Invalidates the entry with the given path and all entries below it and
+// drops their watches, since the watched inodes don't live at those paths
+// anymore. Walking the whole table is expensive, but only needed when
+// directories appear, vanish, or are renamed.
+static
+void
+invalidate_subtree(const char *path)
+{
+	size_t pathLength = strlen(path);
+	int i;
+
+	for (i = 0; i < PATH_HASH_SIZE; i++) {
+		cache_entry *entry;
+		for (entry = sPathHash[i]; entry; entry = entry->hashNext) {
+			if (entry->pathLength >= pathLength
+				&& strncmp(entry->path, path, pathLength) == 0
+				&& (entry->path[pathLength] == '\0'
+					|| entry->path[pathLength] == '/')) {
+				invalidate_entry(entry);
+				if (entry->watch >= 0) {
+					inotify_rm_watch(sInotifyFD, entry->watch);
+					remove_watch(entry);
+				}
+			}
+		}
+	}
+}
+
+// invalidate_all
+static
+void
+invalidate_all()
+{
+	int i;
+	for (i = 0; i < PATH_HASH_SIZE; i++) {
+		cache_entry *entry;
+		for (entry = sPathHash[i]; entry; entry = entry->hashNext)
+			invalidate_entry(entry);
+	}
+}
+
+// get_parent_path
+static
+void
+get_parent_path(const char *path, char *buffer)
+{
+	const char *lastSlash = strrchr(path, '/');
+	size_t length = (lastSlash ? lastSlash - path : 0);
+	if (length == 0) {
+		strcpy(buffer, "/");
+		return;
+	}
+	memcpy(buffer, path, length);
+	buffer[length] = '\0';
+}
+
+// watch_directory
+//
+// Makes sure the directory and all of its ancestors are watched. Watching
+// the ancestors is necessary to notice when one of them is renamed. Returns
+// the entry for the directory, or NULL, if it can't be watched.
+static
+cache_entry *
+watch_directory(const char *path)
+{
+	cache_entry *entry = lookup_entry(path, 1);
+	if (!entry)
+		return NULL;
+
+	if (entry->watch >= 0)
+		return entry;
+
+	if (strcmp(path, "/") != 0) {
+		char parentPath[STAT_CACHE_MAX_PATH_LENGTH];
+		get_parent_path(path, parentPath);
+		if (!watch_directory(parentPath))
+			return NULL;
+	}
+
+	entry->watch = inotify_add_watch(sInotifyFD, path,
+		WATCH_EVENT_MASK | IN_ONLYDIR);
+	if (entry->watch < 0) {
+		DBG(OUT("failed to watch %s: %s\n", path, strerror(errno)));
+		entry->watch = -1;
+		return NULL;
+	}
+
+	// inotify returns the same descriptor for the same inode. If the
+	// directory is already known under another path (e.g. via a symlink),
+	// we don't cache it under this one.
+	if (lookup_watch(entry->watch)) {
+		entry->watch = -1;
+		return NULL;
+	}
+
+	entry->watchHashNext = sWatchHash[entry->watch % WATCH_HASH_SIZE];
+	sWatchHash[entry->watch % WATCH_HASH_SIZE] = entry;
+	return entry;
+}
+
+// update_stat
+static
+void
+update_stat(cache_entry *entry, struct stat *st, int *error, int *cacheable)
+{
+	struct stat lst;
+
+	*cacheable = 1;
+
+	if (stat(entry->path, st) < 0) {
+		*error = errno;
+	} else
+		*error = 0;
+
+	// We only get notified about the link, not about its target. So don't
+	// cache symlinks.
+	if (lstat(entry->path, &lst) == 0 && S_ISLNK(lst.st_mode))
+		*cacheable = 0;
+}
+
+// handle_stat_request
+static
+void
+handle_stat_request(const char *path, stat_cache_stat_reply *reply)
+{
+	char parentPath[STAT_CACHE_MAX_PATH_LENGTH];
+	cache_entry *entry;
+	int cacheable;
+	int error;
+
+	sStatRequests++;
+	memset(reply, 0, sizeof(*reply));
+
+	entry = lookup_entry(path, 1);
+	if (entry && (entry->flags & ENTRY_STAT_VALID)) {
+		sStatHits++;
+		reply->error = entry->statError;
+		reply->st = entry->st;
+		return;
+	}
+
+	// we need the parent directory to be watched to cache the entry
+	get_parent_path(path, parentPath);
+	if (!entry || !watch_directory(parentPath)) {
+		if (stat(path, &reply->st) < 0)
+			reply->error = errno;
+		return;
+	}
+
+	update_stat(entry, &entry->st, &error, &cacheable);
+	entry->statError = error;
+	if (cacheable)
+		entry->flags |= ENTRY_STAT_VALID;
+
+	reply->error = entry->statError;
+	reply->st = entry->st;
+}
+
+// read_directory
+static
+int
+read_directory(const char *path, char **_buffer, int32_t *_bufferSize,
+	int32_t *_entryCount)
+{
+	DIR *dir = opendir(path);
+	struct dirent *dirent;
+	char *buffer = NULL;
+	size_t bufferSize = 0;
+	size_t bufferCapacity = 0;
+	int32_t entryCount = 0;
+
+	if (!dir)
+		return errno;
+
+	while ((dirent = readdir(dir)) != NULL) {
+		size_t nameLength = strlen(dirent->d_name) + 1;
+		if (bufferSize + nameLength > bufferCapacity) {
+			char *newBuffer;
+			bufferCapacity = (bufferCapacity + nameLength) * 2;
+			newBuffer = (char*)realloc(buffer, bufferCapacity);
+			if (!newBuffer) {
+				free(buffer);
+				closedir(dir);
+				return ENOMEM;
+			}
+			buffer = newBuffer;
+		}
+		memcpy(buffer + bufferSize, dirent->d_name, nameLength);
+		bufferSize += nameLength;
+		entryCount++;
+	}
+
+	closedir(dir);
+
+	*_buffer = buffer;
+	*_bufferSize = bufferSize;
+	*_entryCount = entryCount;
+	return 0;
+}
+
+// handle_readdir_request
+static
+void
+handle_readdir_request(const char *path, stat_cache_readdir_reply *reply,
+	char **_buffer, int *_freeBuffer)
+{
+	cache_entry *entry;
+
+	sReaddirRequests++;
+	memset(reply, 0, sizeof(*reply));
+	*_buffer = NULL;
+	*_freeBuffer = 0;
+
+	entry = lookup_entry(path, 1);
+	if (entry && (entry->flags & ENTRY_DIR_VALID)) {
+		sReaddirHits++;
+		reply->error = entry->dirError;
+		reply->entryCount = entry->entryCount;
+		reply->bufferSize = entry->bufferSize;
+		*_buffer = entry->buffer;
+		return;
+	}
+
+	if (!entry || !watch_directory(path)) {
+		// can't be cached
+		reply->error = read_directory(path, _buffer, &reply->bufferSize,
+			&reply->entryCount);
+		*_freeBuffer = 1;
+		return;
+	}
+
+	entry->dirError = read_directory(path, &entry->buffer, &entry->bufferSize,
+		&entry->entryCount);
+	entry->flags |= ENTRY_DIR_VALID;
+
+	reply->error = entry->dirError;
+	reply->entryCount = entry->entryCount;
+	reply->bufferSize = entry->bufferSize;
+	*_buffer = entry->buffer;
+}
+
+// process_inotify_buffer
+static
+void
+process_inotify_buffer(char *buffer, ssize_t bytesRead)
+{
+	char *event;
+
+	for (event = buffer; event < buffer + bytesRead;
+			event += sizeof(struct inotify_event)
+				+ ((struct inotify_event*)event)->len) {
+		struct inotify_event *ev = (struct inotify_event*)event;
+		cache_entry *dir;
+
+		if (ev->mask & IN_Q_OVERFLOW) {
+			// we missed events: start over
+			DBG(OUT("inotify queue overflow\n"));
+			invalidate_all();
+			continue;
+		}
+
+		dir = lookup_watch(ev->wd);
+		if (!dir)
+			continue;
+
+		if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+			// the directory itself is gone
+			invalidate_subtree(dir->path);
+			continue;
+		}
+
+		if (ev->len > 0) {
+			char path[STAT_CACHE_MAX_PATH_LENGTH];
+			cache_entry *entry;
+
+			snprintf(path, sizeof(path), "%s%s%s", dir->path,
+				(dir->pathLength > 1 ? "/" : ""), ev->name);
+
+			if ((ev->mask & ENTRY_EVENT_MASK) && (ev->mask & IN_ISDIR)) {
+				invalidate_subtree(path);
+			} else {
+				entry = lookup_entry(path, 0);
+				if (entry)
+					invalidate_entry(entry);
+			}
+
+			// the directory contents and its stat data changed as well
+			if (ev->mask & ENTRY_EVENT_MASK)
+				invalidate_entry(dir);
+		} else {
+			// the directory's own attributes changed
+			dir->flags &= ~ENTRY_STAT_VALID;
+		}
+	}
+}
+
+// process_inotify_events
+static
+void
+process_inotify_events()
+{
+	char buffer[64 * 1024]
+		__attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+	// A single read() may not get all of the queued events, so drain the
+	// non-blocking descriptor completely.
+	for (;;) {
+		ssize_t bytesRead = read(sInotifyFD, buffer, sizeof(buffer));
+		if (bytesRead < 0 && errno == EINTR)
+			continue;
+		if (bytesRead <= 0)
+			return;
+
+		process_inotify_buffer(buffer, bytesRead);
+	}
+}
+
+// write_fully
+static
+int
+write_fully(int fd, const void *buffer, size_t size)
+{
+	const char *data = (const char*)buffer;
+	while (size > 0) {
+		ssize_t bytesWritten = write(fd, data, size);
+		if (bytesWritten < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		data += bytesWritten;
+		size -= bytesWritten;
+	}
+	return 0;
+}
+
+// read_fully
+static
+int
+read_fully(int fd, void *buffer, size_t size)
+{
+	char *data = (char*)buffer;
+	while (size > 0) {
+		ssize_t bytesRead = read(fd, data, size);
+		if (bytesRead < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		if (bytesRead == 0)
+			return -1;
+		data += bytesRead;
+		size -= bytesRead;
+	}
+	return 0;
+}
+
+// handle_request
+//
+// Reads and answers a single request. Returns -1, if the client has gone
+// or misbehaves.
+static
+int
+handle_request(int fd)
+{
+	stat_cache_request request;
+	char path[STAT_CACHE_MAX_PATH_LENGTH];
+
+	// Inotify events that are still queued may invalidate data we are about
+	// to deliver, so process them first.
+	process_inotify_events();
+
+	if (read_fully(fd, &request, sizeof(request)) < 0)
+		return -1;
+	if (request.pathLength <= 0 || request.pathLength > (int32_t)sizeof(path)
+		|| read_fully(fd, path, request.pathLength) < 0) {
+		return -1;
+	}
+	path[request.pathLength - 1] = '\0';
+
+	switch (request.command) {
+		case STAT_CACHE_COMMAND_STAT:
+		{
+			stat_cache_stat_reply reply;
+			DBG(OUT("stat: %s\n", path));
+			handle_stat_request(path, &reply);
+			return write_fully(fd, &reply, sizeof(reply));
+		}
+
+		case STAT_CACHE_COMMAND_READDIR:
+		{
+			stat_cache_readdir_reply reply;
+			char *buffer;
+			int freeBuffer;
+			int result;
+			DBG(OUT("readdir: %s\n", path));
+			handle_readdir_request(path, &reply, &buffer, &freeBuffer);
+			if (reply.error != 0)
+				reply.bufferSize = reply.entryCount = 0;
+			result = write_fully(fd, &reply, sizeof(reply));
+			if (result == 0 && reply.bufferSize > 0)
+				result = write_fully(fd, buffer, reply.bufferSize);
+			if (freeBuffer)
+				free(buffer);
+			return result;
+		}
+
+		default:
+			return -1;
+	}
+}
+
+// create_listen_socket
+static
+int
+create_listen_socket(const char *path)
+{
+	struct sockaddr_un address;
+	int fd;
+
+	if (strlen(path) >= sizeof(address.sun_path)) {
+		fprintf(stderr, "Socket path too long: %s\n", path);
+		return -1;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to create socket: %s\n", strerror(errno));
+		return -1;
+	}
+
+	// check whether another server is running already, otherwise remove a
+	// stale socket
+	if (connect(fd, (struct sockaddr*)&address, sizeof(address)) == 0) {
+		fprintf(stderr, "A server is already running at %s\n", path);
+		close(fd);
+		return -1;
+	}
+	unlink(path);
+
+	// only the owner shall be able to connect
+	umask(077);
+
+	if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0
+		|| listen(fd, MAX_CLIENTS) < 0) {
+		fprintf(stderr, "Failed to listen on %s: %s\n", path,
+			strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+// quit_handler
+static
+void
+quit_handler(int signal)
+{
+	sQuit = 1;
+}
+
+// main
+int
+main(int argc, char **argv)
+{
+	char socketPathBuffer[128];
+	struct pollfd fds[MAX_CLIENTS + 2];
+	int clientCount = 0;
+	int i;
+
+	// determine the socket path
+	if (argc > 1) {
+		sSocketPath = argv[1];
+	} else {
+		sSocketPath = getenv(STAT_CACHE_SERVER_SOCKET_ENV);
+		if (!sSocketPath || !*sSocketPath) {
+			snprintf(socketPathBuffer, sizeof(socketPathBuffer), "%s%u",
+				STAT_CACHE_SERVER_SOCKET_PREFIX, (unsigned)getuid());
+			sSocketPath = socketPathBuffer;
+		}
+	}
+
+	// Non-blocking, since pending events are polled before each request.
+	sInotifyFD = inotify_init1(IN_NONBLOCK);
+	if (sInotifyFD < 0) {
+		fprintf(stderr, "Failed to initialize inotify: %s\n",
+			strerror(errno));
+		return 1;
+	}
+
+	sListenSocket = create_listen_socket(sSocketPath);
+	if (sListenSocket < 0)
+		return 1;
+
+	signal(SIGINT, quit_handler);
+	signal(SIGTERM, quit_handler);
+	signal(SIGPIPE, SIG_IGN);
+
+	OUT("jam stat cache server listening on %s\n", sSocketPath);
+
+	fds[0].fd = sListenSocket;
+	fds[0].events = POLLIN;
+	fds[1].fd = sInotifyFD;
+	fds[1].events = POLLIN;
+
+	while (!sQuit) {
+		if (poll(fds, clientCount + 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "poll() failed: %s\n", strerror(errno));
+			break;
+		}
+
+		if (fds[1].revents & POLLIN)
+			process_inotify_events();
+
+		// serve the clients
+		for (i = 2; i < clientCount + 2; i++) {
+			if (!fds[i].revents)
+				continue;
+			if (((fds[i].revents & (POLLERR | POLLHUP | POLLNVAL))
+					&& !(fds[i].revents & POLLIN))
+				|| handle_request(fds[i].fd) < 0) {
+				// client gone
+				close(fds[i].fd);
+				fds[i] = fds[clientCount + 1];
+				clientCount--;
+				i--;
+			}
+		}
+
+		// accept new clients
+		if (fds[0].revents & POLLIN) {
+			int fd = accept(sListenSocket, NULL, NULL);
+			if (fd >= 0) {
+				if (clientCount < MAX_CLIENTS) {
+					fds[clientCount + 2].fd = fd;
+					fds[clientCount + 2].events = POLLIN;
+					fds[clientCount + 2].revents = 0;
+					clientCount++;
+				} else
+					close(fd);
+			}
+		}
+	}
+
+	OUT("stat requests: %lu (%lu cached), readdir requests: %lu (%lu cached)\n",
+		sStatRequests, sStatHits, sReaddirRequests, sReaddirHits);
+
+	close(sListenSocket);
+	unlink(sSocketPath);
+	return 0;
+}
@@ -0,0 +1,44 @@
+// linux_stat_cache_server.h
+
+#ifndef LINUX_STAT_CACHE_SERVER_H
+#define LINUX_STAT_CACHE_SERVER_H
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+// common definitions used by server and client
+
+// The server listens on a Unix domain socket. Its path can be overridden by
+// setting the environment variable named below; by default a per-user socket
+// in /tmp is used.
+#define STAT_CACHE_SERVER_SOCKET_ENV	"JAM_STAT_CACHE_SOCKET"
+#define STAT_CACHE_SERVER_SOCKET_PREFIX	"/tmp/jam_stat_cache_server-"
+
+#define STAT_CACHE_MAX_PATH_LENGTH		4096
+
+enum {
+	STAT_CACHE_COMMAND_STAT		= 0,
+	STAT_CACHE_COMMAND_READDIR	= 1,
+};
+
+// A request consists of this header, immediately followed by pathLength
+// bytes of path, including the terminating null.
+typedef struct stat_cache_request {
+	int32_t		command;
+	int32_t		pathLength;
+} stat_cache_request;
+
+typedef struct stat_cache_stat_reply {
+	int32_t		error;
+	struct stat	st;
+} stat_cache_stat_reply;
+
+// A readdir reply consists of this header, immediately followed by
+// bufferSize bytes containing entryCount null-terminated entry names.
+typedef struct stat_cache_readdir_reply {
+	int32_t		error;
+	int32_t		entryCount;
+	int32_t		bufferSize;
+} stat_cache_readdir_reply;
+
+#endif	// LINUX_STAT_CACHE_SERVER_H
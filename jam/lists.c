@@ -7,15 +7,16 @@
 /*
  * lists.c - maintain lists of strings
  *
- * This implementation essentially uses a singly linked list, but
- * guarantees that the head element of every list has a valid pointer
- * to the tail of the list, so the new elements can efficiently and 
- * properly be appended to the end of a list.
+ * This implementation keeps the strings of a list in one contiguous,
+ * reference counted array.  Appending is amortized O(1) (the array
+ * grows by doubling), and copying a whole list only adds a reference;
+ * a shared list is duplicated by the first function that modifies it.
+ * Since jam tends to copy variable values far more often than it
+ * modifies them, most copies are never made.
  *
- * To avoid massive allocation, list_free() just tacks the whole freed
- * chain onto freelist and list_new() looks on freelist first for an
- * available list struct.  list_free() does not free the strings in the 
- * chain: it lazily lets list_new() do so.
+ * To avoid massive allocation, list_free() keeps lists of the minimal
+ * capacity on freelist and list_new() looks there first.  Strings are
+ * released through freestr() when the last reference goes away.
  *
  * 08/23/94 (seiwald) - new list_append()
  * 09/07/00 (seiwald) - documented lol_*() functions
@@ -28,8 +29,84 @@
 # include "newstr.h"
 # include "lists.h"
 
+# define LIST_MIN_CAPACITY	4
+
 static LIST *freelist = 0;	/* junkpile for list_free() */
 
+/*
+ * list_alloc() - allocate an empty list able to hold capacity strings
+ */
+
+static LIST *
+list_alloc( int capacity )
+{
+	LIST *l;
+
+	if( capacity <= LIST_MIN_CAPACITY && freelist )
+	{
+	    l = freelist;
+	    freelist = l->next;
+	}
+	else
+	{
+	    if( capacity < LIST_MIN_CAPACITY )
+		capacity = LIST_MIN_CAPACITY;
+
+	    l = (LIST *)malloc( sizeof( LIST ) + 
+		( capacity - 1 ) * sizeof( const char * ) );
+	    l->capacity = capacity;
+	}
+
+	l->refs = 1;
+	l->size = 0;
+
+	return l;
+}
+
+/*
+ * list_writable() - get a list that may be modified and has room for
+ *	at least extra more strings; l is consumed
+ */
+
+static LIST *
+list_writable( 
+	LIST	*l,
+	int	extra )
+{
+	int	need = l->size + extra;
+	int	capacity = l->capacity;
+	LIST	*nl;
+	int	i;
+
+	if( l->refs == 1 && need <= capacity )
+	    return l;
+
+	while( capacity < need )
+	    capacity *= 2;
+
+	if( l->refs == 1 )
+	{
+	    /* Ours alone: just grow it. */
+
+	    nl = (LIST *)realloc( (char *)l, sizeof( LIST ) + 
+		( capacity - 1 ) * sizeof( const char * ) );
+	    nl->capacity = capacity;
+	    return nl;
+	}
+
+	/* Shared: make our own copy. */
+
+	nl = list_alloc( capacity );
+
+	for( i = 0; i < l->size; i++ )
+	    nl->strings[ i ] = copystr( l->strings[ i ] );
+
+	nl->size = l->size;
+	l->refs--;
+
+	return nl;
+}
+
 /*
  * list_append() - append a list onto another one, returning total
  */
@@ -50,8 +127,15 @@ list_append(
 	else
 	{
 	    /* Graft two non-empty lists. */
-	    l->tail->next = nl;
-	    l->tail = nl->tail;
+
+	    int i;
+
+	    l = list_writable( l, nl->size );
+
+	    for( i = 0; i < nl->size; i++ )
+		l->strings[ l->size++ ] = copystr( nl->strings[ i ] );
+
+	    list_free( nl );
 	}
 
 	return l;
@@ -67,8 +151,6 @@ list_new(
 	const char *string,
 	int	copy )
 {
-	LIST *l;
-
 	if( DEBUG_LISTS )
 	    printf( "list > %s <\n", string );
 
@@ -76,31 +158,14 @@ list_new(
 
 	string = copy ? copystr( string ) : newstr( string );
 
-	/* Get list struct from freelist, if one available.  */
-	/* Otherwise allocate. */
-	/* If from freelist, must free string first */
+	/* Make room at the end, unsharing the list if necessary. */
 
-	if( freelist )
-	{
-	    l = freelist;
-	    freestr( l->string );
-	    freelist = freelist->next;
-	}
+	if( !head )
+	    head = list_alloc( LIST_MIN_CAPACITY );
 	else
-	{
-	    l = (LIST *)malloc( sizeof( *l ) );
-	}
-
-	/* If first on chain, head points here. */
-	/* If adding to chain, tack us on. */
-	/* Tail must point to this new, last element. */
-
-	if( !head ) head = l;
-	else head->tail->next = l;
-	head->tail = l;
-	l->next = 0;
+	    head = list_writable( head, 1 );
 
-	l->string = string;
+	head->strings[ head->size++ ] = string;
 
 	return head;
 }
@@ -114,8 +179,23 @@ list_copy(
 	LIST	*l,
 	LIST 	*nl )
 {
-	for( ; nl; nl = list_next( nl ) )
-	    l = list_new( l, nl->string, 1 );
+	int i;
+
+	if( !nl )
+	    return l;
+
+	/* Copying onto nothing: share nl. */
+
+	if( !l )
+	{
+	    nl->refs++;
+	    return nl;
+	}
+
+	l = list_writable( l, nl->size );
+
+	for( i = 0; i < nl->size; i++ )
+	    l->strings[ l->size++ ] = copystr( nl->strings[ i ] );
 
 	return l;
 }
@@ -130,13 +210,26 @@ list_sublist(
 	int	start,
 	int	count )
 {
-	LIST	*nl = 0;
+	LIST	*nl;
+	int	i;
+
+	if( !l || start >= l->size || count <= 0 )
+	    return L0;
+
+	if( count > l->size - start )
+	    count = l->size - start;
 
-	for( ; l && start--; l = list_next( l ) )
-	    ;
+	/* The whole thing?  Share it. */
 
-	for( ; l && count--; l = list_next( l ) )
-	    nl = list_new( nl, l->string, 1 );
+	if( !start && count == l->size )
+	    return list_copy( L0, l );
+
+	nl = list_alloc( count );
+
+	for( i = 0; i < count; i++ )
+	    nl->strings[ i ] = copystr( l->strings[ start + i ] );
+
+	nl->size = count;
 
 	return nl;
 }
@@ -148,13 +241,25 @@ list_sublist(
 void
 list_free( LIST	*head )
 {
-	/* Just tack onto freelist. */
+	int i;
+
+	if( !head || --head->refs )
+	    return;
 
-	if( head )
+	for( i = 0; i < head->size; i++ )
+	    freestr( head->strings[ i ] );
+
+	/* Keep small ones around on freelist. */
+
+	if( head->capacity == LIST_MIN_CAPACITY )
 	{
-	    head->tail->next = freelist;
+	    head->next = freelist;
 	    freelist = head;
 	}
+	else
+	{
+	    free( (char *)head );
+	}
 }
 
 /*
@@ -164,8 +269,10 @@ list_free( LIST	*head )
 void
 list_print( LIST *l )
 {
-	for( ; l; l = list_next( l ) )
-	    printf( "%s ", l->string );
+	LISTITER i = list_begin( l ), end = list_end( l );
+
+	for( ; i != end; i = list_next( i ) )
+	    printf( "%s ", list_item( i ) );
 }
 
 /*
@@ -175,12 +282,14 @@ list_print( LIST *l )
 void
 list_printq( FILE *out, LIST *l )
 {
+	LISTITER i = list_begin( l ), end = list_end( l );
+
 	/* Dump each word, enclosed in "s */
 	/* Suitable for Jambase use. */
 
-	for( ; l; l = list_next( l ) )
+	for( ; i != end; i = list_next( i ) )
 	{
-	    const char *p = l->string;
+	    const char *p = list_item( i );
 	    const char *ep = p + strlen( p );
 	    const char *op = p;
 
@@ -213,12 +322,7 @@ list_printq( FILE *out, LIST *l )
 int
 list_length( LIST *l )
 {
-	int n = 0;
-
-	for( ; l; l = list_next( l ), ++n )
-	    ;
-
-	return n;
+	return l ? l->size : 0;
 }
 
 /*
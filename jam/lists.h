@@ -33,6 +33,12 @@
  *	lol_get() - return one of the LISTs in the LOL
  *	lol_print() - debug print LISTS separated by ":"
  *
+ * Iterating over a list:
+ *
+ *	LISTITER i = list_begin( l ), end = list_end( l );
+ *	for( ; i != end; i = list_next( i ) )
+ *	    ... list_item( i ) ...
+ *
  * 04/13/94 (seiwald) - added shorthand L0 for null list pointer
  * 08/23/94 (seiwald) - new list_append()
  * 10/22/02 (seiwald) - list_new() now does its own newstr()/copystr()
@@ -42,16 +48,26 @@
 
 /*
  * LIST - list of strings
+ *
+ * A LIST is a reference counted array of strings.  list_copy() of a
+ * whole list just adds a reference; the array is only duplicated when
+ * a shared list is about to be modified (copy-on-write).  Functions
+ * taking a LIST to modify return the list to be used from then on.
+ * The empty list is always L0.
  */
 
 typedef struct _list LIST;
 
 struct _list {
-	LIST		*next;
-	LIST		*tail;		/* only valid in head node */
-	const char	*string;	/* private copy */
+	int		refs;		/* owners of this list */
+	int		size;		/* strings in use */
+	int		capacity;	/* strings allocated */
+	LIST		*next;		/* on the freelist */
+	const char	*strings[1];	/* private copies */
 } ;
 
+typedef const char **LISTITER;
+
 /*
  * LOL - list of LISTs
  */
@@ -73,7 +89,11 @@ void	list_print( LIST *l );
 int	list_length( LIST *l );
 LIST *	list_sublist( LIST *l, int start, int count );
 
-# define list_next( l ) ((l)->next)
+# define list_begin( l ) ( (l) ? (l)->strings : (LISTITER)0 )
+# define list_end( l ) ( (l) ? (l)->strings + (l)->size : (LISTITER)0 )
+# define list_next( i ) ( (i) + 1 )
+# define list_item( i ) ( *(i) )
+# define list_front( l ) ( (l)->strings[ 0 ] )
 
 # define L0 ((LIST *)0)
 
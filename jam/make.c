@@ -62,6 +62,7 @@
 # include "make.h"
 # include "headers.h"
 # include "command.h"
+# include "jtiming.h"
 
 # ifndef max
 # define max( a,b ) ((a)>(b)?(a):(b))
@@ -157,6 +158,10 @@ make(
 	for( i = 0; i < n_targets; i++ )
 	    status |= make1( bindtarget( targets[i] ) );
 
+#ifdef OPT_CRITICAL_PATH_EXT
+	jtiming_done();
+#endif
+
 	return status;
 }
 
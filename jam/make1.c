@@ -21,6 +21,7 @@
  *	make1b() - dependents of target built, now build target with make1c()
  *	make1c() - launch target's next command, call make1b() when done
  *	make1d() - handle command execution completion and call back make1c()
+ *	make1exec() - print and launch target's next command
  *
  * Internal support routines:
  *
@@ -29,6 +30,17 @@
  * 	make1settings() - for vars that get bound, build up replacement lists
  * 	make1bind() - bind targets that weren't bound in dependency analysis
  *
+ * Critical path scheduling (OPT_CRITICAL_PATH_EXT):
+ *
+ *	With -j, make1c() doesn't launch commands directly, but puts their
+ *	targets into a ready queue, from which make1run() starts them in
+ *	order of their critical path: the expected time from starting the
+ *	target's actions to the end of the build, computed by 
+ *	make1critical() from the action durations of previous runs (see 
+ *	jtiming.c).  Thus long chains, like a big link at the end, get 
+ *	started as early as possible.  The measured durations are recorded
+ *	for the next run; -ds prints busy and idle core time.
+ *
  * 04/16/94 (seiwald) - Split from make.c.
  * 04/21/94 (seiwald) - Handle empty "updated" actions.
  * 05/04/94 (seiwald) - async multiprocess (-j) support
@@ -61,11 +73,13 @@
 # include "make.h"
 # include "command.h"
 # include "execcmd.h"
+# include "jtiming.h"
 
 static void make1a( TARGET *t, TARGET *parent );
 static void make1b( TARGET *t );
 static void make1c( TARGET *t );
 static void make1d( void *closure, int status );
+static void make1exec( TARGET *t );
 
 static CMD *make1cmds( ACTIONS *a0 );
 static LIST *make1list( LIST *l, TARGETS *targets, int flags,
@@ -73,6 +87,30 @@ static LIST *make1list( LIST *l, TARGETS *targets, int flags,
 static SETTINGS *make1settings( LIST *vars );
 static void make1bind( TARGET *t, int warn );
 
+# ifdef OPT_CRITICAL_PATH_EXT
+static void make1critical( TARGET *t );
+static void make1queue( TARGET *t );
+static void make1run( void );
+
+/* Ready queue: a binary heap of targets, longest critical path first. */
+
+static struct {
+	TARGET	**targets;
+	int	count;
+	int	size;
+	int	seq;
+} ready[1] ;
+
+/* Time spent running commands, for -ds */
+
+static struct {
+	double	start;		/* first command started */
+	double	end;		/* last command finished */
+	double	busy;		/* sum of command durations */
+	int	commands;	/* number of commands run */
+} timing[1] ;
+# endif
+
 /* Ugly static - it's too hard to carry it through the callbacks. */
 
 static struct {
@@ -93,14 +131,41 @@ make1( TARGET *t )
 {
 	memset( (char *)counts, 0, sizeof( *counts ) );
 
+# ifdef OPT_CRITICAL_PATH_EXT
+	memset( (char *)timing, 0, sizeof( *timing ) );
+
+	/* Estimate the critical path of each target to be built. */
+
+	if( globs.jobs > 1 && !globs.noexec )
+	    make1critical( t );
+# endif
+
 	/* Recursively make the target and its dependents */
 
 	make1a( t, (TARGET *)0 );
 
 	/* Wait for any outstanding commands to finish running. */
 
+# ifdef OPT_CRITICAL_PATH_EXT
+	/* Start the queued commands; each completion may queue more. */
+
+	do
+	    make1run();
+	while( execwait() );
+
+	if( DEBUG_STATS && timing->commands )
+	{
+	    double wall = timing->end - timing->start;
+
+	    printf( "...ran %d command(s) in %.1f seconds: ",
+		timing->commands, wall );
+	    printf( "%.1f seconds busy, %.1f seconds idle with %d job(s)...\n",
+		timing->busy, wall * globs.jobs - timing->busy, globs.jobs );
+	}
+# else
 	while( execwait() )
 	    ;
+# endif
 
 	/* Talk about it */
 
@@ -281,29 +346,16 @@ make1c( TARGET *t )
 
 	if( cmd && t->status == EXEC_CMD_OK )
 	{
-	    if( DEBUG_MAKE )
-		if( DEBUG_MAKEQ || ! ( cmd->rule->flags & RULE_QUIETLY ) )
-	    {
-		printf( "%s ", cmd->rule->name );
-		list_print( lol_get( &cmd->args, 0 ) );
-		printf( "\n" );
-	    }
-
-	    if( DEBUG_EXEC )
-		printf( "%s\n", cmd->buf );
+# ifdef OPT_CRITICAL_PATH_EXT
+	    /* With -j, let make1run() pick the next command to start. */
 
-	    if( globs.cmdout )
-		fprintf( globs.cmdout, "%s", cmd->buf );
-
-	    if( globs.noexec )
+	    if( globs.jobs > 1 && !globs.noexec )
 	    {
-		make1d( t, EXEC_CMD_OK );
-	    } 
-	    else
-	    {
-		fflush( stdout );
-		execcmd( cmd->buf, make1d, t, cmd->shell );
+		make1queue( t );
+		return;
 	    }
+# endif
+	    make1exec( t );
 	}
 	else
 	{
@@ -327,6 +379,11 @@ make1c( TARGET *t )
 	    {
 	    case EXEC_CMD_OK:
 		++counts->made;
+# ifdef OPT_CRITICAL_PATH_EXT
+		if( !globs.noexec )
+		    jtiming_set( t->boundname ? t->boundname : t->name,
+			t->buildtime );
+# endif
 		break;
 	    case EXEC_CMD_FAIL:
 		++counts->failed;
@@ -342,6 +399,45 @@ make1c( TARGET *t )
 	}
 }
 
+/*
+ * make1exec() - print and launch target's next command
+ */
+
+static void
+make1exec( TARGET *t )
+{
+	CMD	*cmd = (CMD *)t->cmds;
+
+	if( DEBUG_MAKE )
+	    if( DEBUG_MAKEQ || ! ( cmd->rule->flags & RULE_QUIETLY ) )
+	{
+	    printf( "%s ", cmd->rule->name );
+	    list_print( lol_get( &cmd->args, 0 ) );
+	    printf( "\n" );
+	}
+
+	if( DEBUG_EXEC )
+	    printf( "%s\n", cmd->buf );
+
+	if( globs.cmdout )
+	    fprintf( globs.cmdout, "%s", cmd->buf );
+
+	if( globs.noexec )
+	{
+	    make1d( t, EXEC_CMD_OK );
+	} 
+	else
+	{
+	    fflush( stdout );
+# ifdef OPT_CRITICAL_PATH_EXT
+	    t->starttime = jam_clock();
+	    if( !timing->commands++ )
+		timing->start = t->starttime;
+# endif
+	    execcmd( cmd->buf, make1d, t, cmd->shell );
+	}
+}
+
 /*
  * make1d() - handle command execution completion and call back make1c()
  */
@@ -354,6 +450,15 @@ make1d(
 	TARGET	*t = (TARGET *)closure;
 	CMD	*cmd = (CMD *)t->cmds;
 
+# ifdef OPT_CRITICAL_PATH_EXT
+	if( !globs.noexec )
+	{
+	    timing->end = jam_clock();
+	    timing->busy += timing->end - t->starttime;
+	    t->buildtime += timing->end - t->starttime;
+	}
+# endif
+
 	/* Execcmd() has completed.  All we need to do is fiddle with the */
 	/* status and signal our completion so make1c() can run the next */
 	/* command.  On interrupts, we bail heavily. */
@@ -387,10 +492,12 @@ make1d(
 	if( status != EXEC_CMD_OK && !( cmd->rule->flags & RULE_UPDATED ) )
 	{
 	    LIST *targets = lol_get( &cmd->args, 0 );
+	    LISTITER i;
 
-	    for( ; targets; targets = list_next( targets ) )
-		if( !unlink( targets->string ) )
-		    printf( "...removing %s\n", targets->string );
+	    for( i = list_begin( targets ); i != list_end( targets ); 
+		 i = list_next( i ) )
+		if( !unlink( list_item( i ) ) )
+		    printf( "...removing %s\n", list_item( i ) );
 	}
 
 	/* Free this command and call make1c() to move onto next command. */
@@ -588,13 +695,13 @@ make1list(
 
 	if( flags & RULE_TOGETHER )
 	{
-	    LIST *m;
+	    LISTITER m;
 
-	    for( m = l; m; m = m->next )
-		if( !strcmp( m->string, t->boundname ) )
+	    for( m = list_begin( l ); m != list_end( l ); m = list_next( m ) )
+		if( !strcmp( list_item( m ), t->boundname ) )
 		    break;
 
-	    if( m )
+	    if( m != list_end( l ) )
 		continue;
 	}
 
@@ -614,15 +721,17 @@ static SETTINGS *
 make1settings( LIST *vars )
 {
 	SETTINGS *settings = 0;
+	LISTITER v;
 
-	for( ; vars; vars = list_next( vars ) )
+	for( v = list_begin( vars ); v != list_end( vars ); v = list_next( v ) )
 	{
-	    LIST *l = var_get( vars->string );
+	    LIST *l = var_get( list_item( v ) );
 	    LIST *nl = 0;
+	    LISTITER i;
 
-	    for( ; l; l = list_next( l ) ) 
+	    for( i = list_begin( l ); i != list_end( l ); i = list_next( i ) ) 
 	    {
-		TARGET *t = bindtarget( l->string );
+		TARGET *t = bindtarget( list_item( i ) );
 
 		/* Make sure the target is bound, warning if it is not in the */
 		/* dependency graph. */
@@ -637,7 +746,7 @@ make1settings( LIST *vars )
 
 	    /* Add to settings chain */
 
-	    settings = addsettings( settings, 0, vars->string, nl );
+	    settings = addsettings( settings, 0, list_item( v ), nl );
 	}
 
 	return settings;
@@ -671,3 +780,183 @@ make1bind(
 	t->binding = t->time ? T_BIND_EXISTS : T_BIND_MISSING;
 	popsettings( t->settings );
 }
+
+# ifdef OPT_CRITICAL_PATH_EXT
+
+/*
+ * make1postorder() - collect target's dependents, then target
+ */
+
+static void
+make1postorder( 
+	TARGET	*t,
+	TARGET	***list,
+	int	*count,
+	int	*size )
+{
+	TARGETS	*c;
+
+	if( t->cpstate )
+	    return;
+
+	/* Mark it on the stack, to skip circular dependencies. */
+
+	t->cpstate = 1;
+	t->critical = 0;
+
+	for( c = t->depends; c; c = c->next )
+	    make1postorder( c->target, list, count, size );
+
+	t->cpstate = 2;
+
+	if( *count == *size )
+	{
+	    *size = *size ? *size * 2 : 256;
+	    *list = (TARGET **)realloc( (char *)*list,
+		*size * sizeof( TARGET * ) );
+	}
+
+	(*list)[ (*count)++ ] = t;
+}
+
+/*
+ * make1critical() - compute the critical path of target and its dependents
+ *
+ * A target's critical path is the expected duration of its own actions
+ * plus the longest critical path among the targets depending on it.
+ * Walking the targets in reverse postorder visits every parent before
+ * its dependents, so one pass suffices.
+ */
+
+static void
+make1critical( TARGET *t )
+{
+	TARGET	**list = 0;
+	int	count = 0;
+	int	size = 0;
+	double	dflt = jtiming_default();
+
+	make1postorder( t, &list, &count, &size );
+
+	while( count-- )
+	{
+	    TARGET	*p = list[ count ];
+	    TARGETS	*c;
+	    double	seconds = 0;
+
+	    if( p->actions && p->fate >= T_FATE_BUILD &&
+		p->fate < T_FATE_BROKEN &&
+		!jtiming_get( p->boundname ? p->boundname : p->name, &seconds ) )
+		    seconds = dflt;
+
+	    p->critical += seconds;
+
+	    for( c = p->depends; c; c = c->next )
+		if( c->target->critical < p->critical )
+		    c->target->critical = p->critical;
+	}
+
+	free( (char *)list );
+}
+
+/*
+ * make1before() - does target a go before b in the ready queue?
+ */
+
+static int
+make1before( 
+	TARGET	*a,
+	TARGET	*b )
+{
+	if( a->critical != b->critical )
+	    return a->critical > b->critical;
+
+	return a->queueseq < b->queueseq;
+}
+
+/*
+ * make1queue() - put target with a command to run into the ready queue
+ */
+
+static void
+make1queue( TARGET *t )
+{
+	int	i;
+
+	if( ready->count == ready->size )
+	{
+	    ready->size = ready->size ? ready->size * 2 : 64;
+	    ready->targets = (TARGET **)realloc( (char *)ready->targets,
+		ready->size * sizeof( TARGET * ) );
+	}
+
+	t->queueseq = ready->seq++;
+
+	/* Sift up */
+
+	for( i = ready->count++; i; i = ( i - 1 ) / 2 )
+	{
+	    TARGET *p = ready->targets[ ( i - 1 ) / 2 ];
+
+	    if( !make1before( t, p ) )
+		break;
+
+	    ready->targets[ i ] = p;
+	}
+
+	ready->targets[ i ] = t;
+}
+
+/*
+ * make1run() - start the queued commands, longest critical path first
+ *
+ * execcmd() returns only once a job slot is free again, waiting for
+ * running commands as needed; their completions may queue more targets,
+ * so each pop picks the best target ready at that moment.  After an
+ * interrupt the queued targets fail without running their commands.
+ */
+
+static void
+make1run()
+{
+	while( ready->count )
+	{
+	    TARGET	*t = ready->targets[ 0 ];
+	    TARGET	*last = ready->targets[ --ready->count ];
+	    int		i = 0;
+
+	    /* Sift down */
+
+	    for( ;; )
+	    {
+		int c = 2 * i + 1;
+
+		if( c >= ready->count )
+		    break;
+
+		if( c + 1 < ready->count && 
+		    make1before( ready->targets[ c + 1 ], ready->targets[ c ] ) )
+			c++;
+
+		if( !make1before( ready->targets[ c ], last ) )
+		    break;
+
+		ready->targets[ i ] = ready->targets[ c ];
+		i = c;
+	    }
+
+	    ready->targets[ i ] = last;
+
+	    if( intr )
+	    {
+		t->status = EXEC_CMD_FAIL;
+		make1c( t );
+	    }
+	    else
+	    {
+		make1exec( t );
+	    }
+	}
+}
+
+# endif /* OPT_CRITICAL_PATH_EXT */
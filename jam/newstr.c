@@ -21,7 +21,9 @@
  *
  * This implementation builds a hash table of all strings, so that multiple 
  * calls of newstr() on the same string allocate memory for the string once.
- * Strings are never actually freed.
+ * The strings themselves are carved out of large blocks by simply bumping
+ * a pointer. Strings are never freed individually; donestr() releases all
+ * blocks at once.
  *
  * 11/04/02 (seiwald) - const-ing for string literals
  */
@@ -35,6 +37,82 @@ typedef const char *STRING;
 static struct hash *strhash = 0;
 static int strtotal = 0;
 
+/*
+ * STRBLOCK - a chunk of memory strings are allocated from
+ */
+
+typedef struct _strblock STRBLOCK;
+
+struct _strblock {
+	STRBLOCK	*next;
+	double		data[1];	/* aligned start of strings */
+} ;
+
+# define STRBLOCK_SIZE	( 64 * 1024 )
+
+static STRBLOCK *strblocks = 0;
+static char *strnext = 0;	/* free space in strblocks */
+static int strleft = 0;		/* bytes left at strnext */
+static int strblockstotal = 0;
+
+/*
+ * allocstr() - allocate space for a string of the given size
+ */
+
+static char *
+allocstr( int size )
+{
+	STRBLOCK *b;
+	int blocksize;
+	char *m;
+
+	if( size <= strleft )
+	{
+	    m = strnext;
+	    strnext += size;
+	    strleft -= size;
+	    return m;
+	}
+
+	/* Big strings get a block of their own, so that they don't */
+	/* waste what's left of the current one. */
+
+	blocksize = size > STRBLOCK_SIZE / 4 ? size : STRBLOCK_SIZE;
+
+	b = (STRBLOCK *)malloc( sizeof( STRBLOCK ) - sizeof( b->data ) 
+		+ blocksize );
+
+	if( !b )
+	{
+	    printf( "can't allocate memory for strings\n" );
+	    exit( EXITBAD );
+	}
+
+	strblockstotal += blocksize;
+	m = (char *)b->data;
+
+	if( blocksize == STRBLOCK_SIZE )
+	{
+	    b->next = strblocks;
+	    strblocks = b;
+	    strnext = m + size;
+	    strleft = blocksize - size;
+	}
+	else if( strblocks )
+	{
+	    /* keep the current block in front */
+	    b->next = strblocks->next;
+	    strblocks->next = b;
+	}
+	else
+	{
+	    b->next = 0;
+	    strblocks = b;
+	}
+
+	return m;
+}
+
 /*
  * newstr() - return a malloc'ed copy of a string
  */
@@ -52,7 +130,7 @@ newstr( const char *string )
 	if( hashenter( strhash, (HASHDATA **)&s ) )
 	{
 	    int l = strlen( string );
-	    char *m = (char *)malloc( l + 1 );
+	    char *m = allocstr( l + 1 );
 
 	    if (DEBUG_MEM)
 		    printf("newstr: allocating %d bytes\n", l + 1 );
@@ -94,5 +172,18 @@ donestr()
 	hashdone( strhash );
 
 	if( DEBUG_MEM )
-	    printf( "%dK in strings\n", strtotal / 1024 );
+	    printf( "%dK in strings (%dK allocated)\n", 
+		strtotal / 1024, strblockstotal / 1024 );
+
+	while( strblocks )
+	{
+	    STRBLOCK *b = strblocks;
+	    strblocks = b->next;
+	    free( (char *)b );
+	}
+
+	strhash = 0;
+	strnext = 0;
+	strleft = 0;
+	strtotal = strblockstotal = 0;
 }
@@ -21,12 +21,39 @@
 # include "scan.h"
 # include "newstr.h"
 # include "compile.h"
+# ifdef OPT_JAMFILE_CACHE_EXT
+# include "jcache.h"
+# endif
 
 static PARSE *yypsave;
 
 void
 parse_file( const char *f )
 {
+# ifdef OPT_JAMFILE_CACHE_EXT
+	/* Files other than the builtin Jambase and stdin are looked up */
+	/* in the jamfile cache.  If an up to date parse tree is cached, */
+	/* run it instead of scanning and parsing the file again. */
+
+	int cacheable = strcmp( f, "+" ) && strcmp( f, "-" );
+
+	if( cacheable )
+	{
+	    PARSE *p = jcache_parse( f );
+
+	    if( p )
+	    {
+		LOL l;
+		int jmp = 0; /* JMP_NONE */
+
+		lol_init( &l );
+		list_free( (*(p->func))( p, &l, &jmp ) );
+		parse_free( p );
+		return;
+	    }
+	}
+# endif
+
 	/* Suspend scan of current file */
 	/* and push this new file in the stream */
 
@@ -55,6 +82,15 @@ parse_file( const char *f )
 	    if( yyparse() || !( p = yypsave ) )
 		break;
 
+# ifdef OPT_JAMFILE_CACHE_EXT
+	    /* The first tree is the whole file.  Remember it. */
+
+	    if( cacheable && !yyanyerrors() )
+		jcache_save_parse( f, p );
+
+	    cacheable = 0;
+# endif
+
 	    /* Run the parse tree. */
 
 	    list_free( (*(p->func))( p, &l, &jmp ) );
@@ -154,8 +154,11 @@ targetlist(
 	TARGETS	*chain,
 	LIST 	*targets )
 {
-	for( ; targets; targets = list_next( targets ) )
-	    chain = targetentry( chain, bindtarget( targets->string ) );
+	LISTITER i;
+
+	for( i = list_begin( targets ); i != list_end( targets ); 
+	     i = list_next( i ) )
+	    chain = targetentry( chain, bindtarget( list_item( i ) ) );
 
 	return chain;
 }
@@ -172,6 +172,14 @@ struct _target {
 	int		asynccnt;	/* child deps outstanding */
 	TARGETS		*parents;	/* used by make1() for completion */
 	char		*cmds;		/* type-punned command list */
+
+# ifdef OPT_CRITICAL_PATH_EXT
+	char		cpstate;	/* make1critical() traversal state */
+	double		critical;	/* expected time from start to end */
+	double		starttime;	/* when the running command started */
+	double		buildtime;	/* time spent in commands so far */
+	int		queueseq;	/* order of entering the ready queue */
+# endif
 } ;
 
 RULE 	*bindrule( const char *rulename );
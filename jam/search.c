@@ -36,8 +36,8 @@ search(
 
 	if( varlist = var_get( "LOCATE" ) )
 	{
-	    f->f_root.ptr = varlist->string;
-	    f->f_root.len = strlen( varlist->string );
+	    f->f_root.ptr = list_front( varlist );
+	    f->f_root.len = strlen( list_front( varlist ) );
 
 	    path_build( f, buf, 1 );
 
@@ -50,10 +50,13 @@ search(
 	}
 	else if( varlist = var_get( "SEARCH" ) )
 	{
-	    while( varlist )
+	    LISTITER i;
+
+	    for( i = list_begin( varlist ); i != list_end( varlist ); 
+		 i = list_next( i ) )
 	    {
-		f->f_root.ptr = varlist->string;
-		f->f_root.len = strlen( varlist->string );
+		f->f_root.ptr = list_item( i );
+		f->f_root.len = strlen( list_item( i ) );
 
 		path_build( f, buf, 1 );
 
@@ -64,8 +67,6 @@ search(
 
 		if( *time )
 		    return newstr( buf );
-
-		varlist = list_next( varlist );
 	    }
 	}
 
@@ -177,22 +177,26 @@ var_string(
 	    if( dollar )
 	    {
 		LIST *l = var_expand( L0, lastword, out, lol, 0 );
+		LISTITER i = list_begin( l ), end = list_end( l );
 
 		out = lastword;
 
-		while( l )
+		while( i != end )
 		{
-		    int so = strlen( l->string );
+		    int so = strlen( list_item( i ) );
 
 		    if( out + so >= oute )
+		    {
+			list_free( l );
 			return -1;
+		    }
 
-		    strcpy( out, l->string );
+		    strcpy( out, list_item( i ) );
 		    out += so;
 
 		    /* Separate with space */
 
-		    if( l = list_next( l ) )
+		    if( ( i = list_next( i ) ) != end )
 			*out++ = ' ';
 		}
 